@@ -32,6 +32,7 @@ local extended_tests = {
     "test_noise_extended.lua",-- All noise functions, utilities, batch generation
     "test_algo_extended.lua", -- Cellular automata, erosion, maze, dungeon generation
     "test_geo_extended.lua",  -- Bresenham, bezier, flood fill, shapes, distances
+    "test_grid.lua",          -- Grid type, arithmetic, asGrid results
     "test_dialog_extended.lua",-- All dialog widgets and layout methods
     "test_items.lua"          -- Items namespace, search, info lookup
 }
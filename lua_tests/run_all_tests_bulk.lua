@@ -28,6 +28,7 @@ local test_files = {
     "test_noise_extended.lua",
     "test_algo_extended.lua",
     "test_geo_extended.lua",
+    "test_grid.lua",
     "test_dialog_extended.lua",
     "test_items.lua",
     
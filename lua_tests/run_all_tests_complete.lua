@@ -35,6 +35,7 @@ local test_files = {
     { name = "test_noise_extended.lua", category = "Extended API" },
     { name = "test_algo_extended.lua", category = "Extended API" },
     { name = "test_geo_extended.lua", category = "Extended API" },
+    { name = "test_grid.lua", category = "Extended API" },
     { name = "test_dialog_extended.lua", category = "Extended API" },
     { name = "test_items.lua", category = "Extended API" },
     
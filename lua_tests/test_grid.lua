@@ -0,0 +1,125 @@
+-- @Title: Test Grid API
+-- @Description: Verification tests for the Grid type and the functions that take it.
+local framework = require("framework")
+
+framework.test("Grid construction", function()
+    local g = Grid(4, 3)
+    framework.assert(g.width == 4, "width should be 4")
+    framework.assert(g.height == 3, "height should be 3")
+    framework.assert(#g == 12, "#grid should count the cells")
+    framework.assert(g:get(4, 3) == 0, "cells should start at 0")
+
+    local filled = Grid.new(2, 2, 5)
+    framework.assert(filled:get(1, 1) == 5, "fill value should be applied")
+    framework.assert(tostring(filled) == "Grid(2x2)", "tostring should show the size")
+end)
+
+framework.test("Grid rejects bad sizes", function()
+    framework.assert(not pcall(function() return Grid(0, 10) end), "zero width should error")
+    framework.assert(not pcall(function() return Grid(5000, 5000) end), "oversized grid should error")
+end)
+
+framework.test("Grid get/set bounds", function()
+    local g = Grid(3, 3)
+    g:set(2, 3, 7)
+    framework.assert(g:get(2, 3) == 7, "set value should be read back")
+    framework.assert(not pcall(function() return g:get(4, 1) end), "get outside should error")
+    framework.assert(not pcall(function() g:set(0, 1, 1) end), "set outside should error")
+end)
+
+framework.test("Grid table roundtrip", function()
+    local rows = {
+        {1, 2, 3},
+        {4, 5, 6}
+    }
+    local g = Grid.fromTable(rows)
+    framework.assert(g.width == 3 and g.height == 2, "size should come from the rows")
+    framework.assert(g:get(3, 2) == 6, "cell should match the table")
+
+    local back = g:toTable()
+    framework.assert(back[2][1] == 4, "toTable should keep the values")
+end)
+
+framework.test("Grid in-place arithmetic", function()
+    local g = Grid(2, 2, 1)
+    local same = g:add(2):mul(3)
+    framework.assert(same == g, "in-place methods should return the grid")
+    framework.assert(g:get(1, 1) == 9, "(1 + 2) * 3 should be 9")
+
+    g:set(1, 1, -4)
+    g:clamp(0, 5)
+    framework.assert(g:get(1, 1) == 0 and g:get(2, 2) == 5, "clamp failed")
+
+    g:threshold(3)
+    framework.assert(g:get(1, 1) == 0 and g:get(2, 2) == 1, "threshold failed")
+    framework.assert(g:count(1) == 3, "count failed")
+end)
+
+framework.test("Grid operators and reductions", function()
+    local a = Grid(2, 2, 2)
+    local b = Grid(2, 2, 3)
+    local c = a + b
+    framework.assert(c:get(1, 1) == 5, "grid + grid failed")
+    framework.assert(a:get(1, 1) == 2, "operators should not modify their operands")
+    framework.assert((a * 2):get(2, 2) == 4, "grid * number failed")
+    framework.assert((10 - a):get(1, 2) == 8, "number - grid failed")
+    framework.assert(c:sum() == 20, "sum failed")
+    framework.assert(not pcall(function() return a + Grid(3, 3) end), "size mismatch should error")
+
+    local n = Grid(3, 1)
+    n:set(1, 1, -2)
+    n:set(3, 1, 6)
+    n:normalize()
+    framework.assert(n:min() == 0 and n:max() == 1, "normalize should span [0, 1]")
+    framework.assert(math.abs(n:get(2, 1) - 0.25) < 0.0001, "normalize should rescale linearly")
+end)
+
+framework.test("Grid clone is independent", function()
+    local g = Grid(2, 2)
+    local copy = g:clone()
+    copy:set(1, 1, 1)
+    framework.assert(g:get(1, 1) == 0, "clone should not share cells")
+end)
+
+framework.test("noise.generateGrid asGrid", function()
+    local opts = {seed = 1234, frequency = 0.05}
+    local rows = noise.generateGrid(0, 0, 16, 8, opts)
+    opts.asGrid = true
+    local g = noise.generateGrid(0, 0, 16, 8, opts)
+    framework.assert(g.width == 16 and g.height == 8, "Grid should have the requested size")
+    framework.assert(math.abs(g:get(5, 3) - rows[3][5]) < 0.0001, "Grid and table should hold the same noise")
+end)
+
+framework.test("algo functions keep the input form", function()
+    local cave = algo.generateCave(30, 20, {seed = 7, asGrid = true})
+    framework.assert(cave.width == 30 and cave.height == 20, "generateCave asGrid should return a Grid")
+
+    local stepped = algo.cellularAutomata(cave, {iterations = 1})
+    framework.assert(stepped.width == 30, "cellularAutomata on a Grid should return a Grid")
+
+    local fromTable = algo.cellularAutomata(cave:toTable(), {iterations = 1})
+    framework.assert(type(fromTable) == "table", "cellularAutomata on a table should return a table")
+    framework.assert(fromTable[5][5] == stepped:get(5, 5), "both forms should give the same result")
+
+    local smoothed = algo.smooth(noise.generateGrid(0, 0, 10, 10, {asGrid = true}), {iterations = 1})
+    framework.assert(smoothed.height == 10, "smooth on a Grid should return a Grid")
+
+    local points = algo.generateRandomPoints(20, 20, 4, 1)
+    local regions = algo.voronoi(20, 20, points, {asGrid = true})
+    framework.assert(regions:min() >= 1 and regions:max() <= 4, "voronoi regions should be 1-based")
+end)
+
+framework.test("geo.floodFill on a Grid", function()
+    local g = Grid(5, 5)
+    g:set(3, 1, 1)
+    g:set(3, 2, 1)
+    g:set(3, 3, 1)
+    g:set(3, 4, 1)
+    g:set(3, 5, 1)
+    local filled = geo.floodFill(g, 1, 1, 2)
+    framework.assert(filled:count(2) == 10, "fill should stop at the wall")
+    framework.assert(g:get(1, 1) == 0, "floodFill should not modify its input")
+    framework.assert(#geo.getFloodFillPositions(g, 5, 5) == 10, "positions should cover the right side")
+end)
+
+framework.summary()
@@ -33,4 +33,165 @@ framework.test("getTile basic", function()
     framework.assert(type(tile) == "table" or type(tile) == "userdata" or type(tile) == "nil", "getTile should return tile or nil")
 end)
 
+framework.test("tilesIn stays inside the area", function()
+    if not app.hasMap() then return end
+
+    local map = app.map
+    local count = 0
+    for tile in map:tilesIn(140, 90, 100, 110, 7) do
+        framework.assert(tile.x >= 100 and tile.x <= 140, "tilesIn x out of range")
+        framework.assert(tile.y >= 90 and tile.y <= 110, "tilesIn y out of range")
+        framework.assert(tile.z == 7, "tilesIn z out of range")
+        count = count + 1
+    end
+
+    local expected = 0
+    for x = 100, 140 do
+        for y = 90, 110 do
+            if map:getTile(x, y, 7) then
+                expected = expected + 1
+            end
+        end
+    end
+    framework.assert(count == expected, "tilesIn should visit every tile in the area once")
+end)
+
+framework.test("forEachTile matches map.tiles", function()
+    if not app.hasMap() then return end
+
+    local map = app.map
+    local iterated = 0
+    for _ in map.tiles do
+        iterated = iterated + 1
+    end
+
+    local single = 0
+    local visited = map:forEachTile(function(tile)
+        single = single + 1
+    end)
+    framework.assert(single == iterated and visited == iterated, "forEachTile should visit every tile")
+
+    local batched = 0
+    map:forEachTile(function(tiles, n)
+        framework.assert(#tiles == n and n <= 64, "batch should hold n tiles")
+        batched = batched + n
+    end, { batch = 64 })
+    framework.assert(batched == iterated, "batched forEachTile should visit every tile")
+
+    local stopped = map:forEachTile(function()
+        return false
+    end)
+    framework.assert(stopped == math.min(iterated, 1), "returning false should stop forEachTile")
+end)
+
+framework.test("fillRegion and countItems", function()
+    if not app.hasMap() then return end
+
+    local map = app.map
+    local grass = 4526
+    local painted = map:fillRegion({ 300, 300, 309, 304 }, 7, grass, { borderize = false })
+    framework.assert(painted == 50, "fillRegion should paint every tile of the rect")
+
+    local total, perId = map:countItems({ x = 300, y = 300, width = 10, height = 5 }, { grass }, 7)
+    framework.assert(total == 50 and perId[grass] == 50, "countItems should find every painted ground")
+
+    local none = map:countItems({ 300, 300, 309, 304 }, grass, 6)
+    framework.assert(none == 0, "countItems should only look at the given floor")
+
+    local ok = pcall(function()
+        map:fillRegion({ 300, 300, 301, 301 }, 7, 0)
+    end)
+    framework.assert(not ok, "fillRegion should reject invalid ground ids")
+end)
+
+framework.test("applyGrid paints through the palette", function()
+    if not app.hasMap() then return end
+
+    local map = app.map
+    local grass = 4526
+    local grid = {
+        { 1, 0, 1 },
+        { 0, 1, 0 },
+    }
+    local painted = map:applyGrid({ 320, 320, 322, 321 }, 7, grid, { [1] = grass })
+    framework.assert(painted == 3, "applyGrid should only paint cells in the palette")
+    framework.assert(map:getTile(320, 320, 7).ground.id == grass, "grid[1][1] should land on the rect corner")
+    framework.assert(map:getTile(321, 321, 7).ground.id == grass, "grid[2][2] should land one tile in")
+
+    local flat = map:applyGrid({ 320, 330, 322, 330 }, 7, { 1, 1, 1 }, { [1] = grass }, { borderize = false })
+    framework.assert(flat == 3, "applyGrid should take flat arrays")
+
+    local bytes = map:applyGrid({ 320, 340, 323, 340 }, 7, string.char(1, 0, 0, 1), { [1] = grass }, { borderize = false })
+    framework.assert(bytes == 2, "applyGrid should take byte strings")
+end)
+
+framework.test("findItems sees action ids set from Lua", function()
+    if not app.hasMap() then return end
+
+    local map = app.map
+    local tile = map:getOrCreateTile(350, 350, 7)
+    local item = tile:addItem(2148)
+    local aid = 54321
+    framework.assert(#map:findItems({ actionId = aid }) == 0, "the action id should not be on the map yet")
+
+    item.actionId = aid
+    local found = map:findItems({ actionId = aid })
+    framework.assert(#found == 1, "findItems should find an action id set in place")
+    framework.assert(found[1].x == 350 and found[1].y == 350 and found[1].z == 7, "findItems should return the tile position")
+
+    item.actionId = 0
+    framework.assert(#map:findItems({ actionId = aid }) == 0, "findItems should drop a cleared action id")
+
+    local ok = pcall(function()
+        map:findItems({ actionId = aid, uniqueId = 1000 })
+    end)
+    framework.assert(not ok, "findItems should reject more than one field")
+end)
+
+framework.test("findItems sees ids changed by replaceItems", function()
+    if not app.hasMap() then return end
+
+    local map = app.map
+    local tile = map:getOrCreateTile(352, 350, 7)
+    tile:addItem(2148)
+    framework.assert(#map:findItems({ itemId = 2148 }) > 0, "the item should be indexed before the replace")
+
+    map:replaceItems({ [2148] = 2152 })
+    framework.assert(#map:findItems({ itemId = 2148 }) == 0, "findItems should not return replaced ids")
+    local found = map:findItems({ itemId = 2152 })
+    local seen = false
+    for _, pos in ipairs(found) do
+        if pos.x == 352 and pos.y == 350 and pos.z == 7 then
+            seen = true
+        end
+    end
+    framework.assert(seen, "findItems should find the new id where the old one was")
+end)
+
+framework.test("forEachTile batches look tiles up on every access", function()
+    if not app.hasMap() then return end
+
+    local map = app.map
+    map:getOrCreateTile(354, 350, 7)
+    local checked = false
+    map:forEachTile(function(tiles, n)
+        local pos = tiles[n].position
+        local before = tiles[n].itemCount
+        app.transaction("Test forEachTile batch", function()
+            map:getOrCreateTile(pos.x, pos.y, pos.z):addItem(2148)
+        end)
+        framework.assert(tiles[n] ~= nil and tiles[n].itemCount == before + 1, "batch entries should see the tile as it is now")
+        framework.assert(tiles[n + 1] == nil and tiles.x == nil, "entries outside the batch should be nil")
+
+        local listed = 0
+        for _ in ipairs(tiles) do
+            listed = listed + 1
+        end
+        framework.assert(listed == n, "ipairs should walk the whole batch")
+        checked = true
+        return false
+    end, { batch = 16 })
+    framework.assert(checked, "the batch callback should run")
+end)
+
 framework.summary()
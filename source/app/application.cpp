@@ -20,6 +20,7 @@
 #include "ui/theme.h"
 #include "ui/dialog_util.h"
 #include "app/application.h"
+#include "app/task_scheduler.h"
 #include "util/file_system.h"
 #include "editor/hotkey_manager.h"
 
@@ -33,6 +34,7 @@
 #include "lua/lua_scripts_window.h"
 #include "ui/result_window.h"
 #include "rendering/ui/minimap_window.h"
+#include "rendering/core/sprite_preloader.h"
 #include "ui/about_window.h"
 #include "ui/main_menubar.h"
 #include "app/updater.h"
@@ -42,6 +44,7 @@
 
 #include "game/materials.h"
 #include "map/map.h"
+#include "map/map_allocator.h"
 #include "game/complexitem.h"
 #include "game/creature.h"
 
@@ -57,9 +60,12 @@
 
 wxIMPLEMENT_APP_NO_MAIN(Application);
 
+// Tools that link the editor sources (tools/benchmarks) bring their own entry point
+#ifndef RME_NO_MAIN
 int main(int argc, char** argv) {
 	return wxEntry(argc, argv);
 }
+#endif
 
 // OnRun is implemented below
 
@@ -88,6 +94,8 @@ bool Application::OnInit() {
 	}
 	Theme::setType(theme);
 
+	g_scheduler.start(g_settings.getInteger(Config::WORKER_THREADS));
+
 	// Enable modern appearance handling (wxWidgets 3.3+)
 #if wxCHECK_VERSION(3, 3, 0)
 	switch (theme) {
@@ -357,6 +365,9 @@ void Application::Unload() {
 #endif
 
 	g_gui.CloseAllEditors();
+	// Closed maps are freed in the background; finish before anything they
+	// may touch is unloaded
+	MapAllocator::waitForReleases();
 	g_version.UnloadVersion();
 	g_hotkeys.SaveHotkeys();
 	g_gui.root->SaveRecentFiles();
@@ -375,6 +386,10 @@ int Application::OnExit() {
 	// Shutdown Lua scripting system
 	g_luaScripts.shutdown();
 
+	// Background work still queued (sprite decoding, indexing) is dropped
+	SpritePreloader::get().shutdown();
+	g_scheduler.stop();
+
 #ifdef _USE_PROCESS_COM
 	wxDELETE(m_proc_server);
 	wxDELETE(m_single_instance_checker);
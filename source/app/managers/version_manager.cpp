@@ -54,20 +54,15 @@ bool VersionManager::LoadVersion(ClientVersionID version, wxString& error, std::
 		// Destroy the previous version
 		UnloadVersion();
 
-		loaded_version = version;
-		if (!getLoadedVersion()->hasValidPaths()) {
-			if (!getLoadedVersion()->loadValidPaths()) {
-				error = "Couldn't load relevant asset files";
-				loaded_version = CLIENT_VERSION_NONE;
-				return false;
-			}
+		ClientVersion* client_version = ClientVersion::get(version);
+		if (!client_version->hasValidPaths() && !client_version->loadValidPaths()) {
+			error = "Couldn't load relevant asset files";
+			return false;
 		}
 
-		bool ret = LoadDataFiles(error, warnings);
+		bool ret = LoadVersionData(version, error, warnings);
 		if (ret) {
 			g_gui.LoadPerspective();
-		} else {
-			loaded_version = CLIENT_VERSION_NONE;
 		}
 
 		return ret;
@@ -75,6 +70,29 @@ bool VersionManager::LoadVersion(ClientVersionID version, wxString& error, std::
 	return true;
 }
 
+bool VersionManager::LoadVersionData(ClientVersionID version, wxString& error, std::vector<std::string>& warnings) {
+	if (ClientVersion::get(version) == nullptr) {
+		error = "Unsupported client version! (8)";
+		return false;
+	}
+
+	// Destroy the previous version
+	UnloadVersion();
+
+	loaded_version = version;
+	if (!getLoadedVersion()->hasValidPaths()) {
+		error = "Couldn't load relevant asset files";
+		loaded_version = CLIENT_VERSION_NONE;
+		return false;
+	}
+
+	if (!LoadDataFiles(error, warnings)) {
+		loaded_version = CLIENT_VERSION_NONE;
+		return false;
+	}
+	return true;
+}
+
 ClientVersionID VersionManager::GetCurrentVersionID() const {
 	if (!loaded_version.empty()) {
 		return getLoadedVersion()->getID();
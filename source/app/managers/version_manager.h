@@ -16,6 +16,9 @@ public:
 
 	void UnloadVersion();
 	bool LoadVersion(ClientVersionID ver, wxString& error, std::vector<std::string>& warnings, bool force = false);
+	// Loads the data files of a version without touching palettes, minimap or window layout,
+	// and without asking for the client directory when it is not configured
+	bool LoadVersionData(ClientVersionID ver, wxString& error, std::vector<std::string>& warnings);
 
 	// The current version loaded (returns CLIENT_VERSION_NONE if no version is loaded)
 	const ClientVersion& GetCurrentVersion() const;
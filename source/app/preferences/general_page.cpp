@@ -5,6 +5,7 @@
 #include "app/main.h"
 #include "app/preferences/preferences_layout.h"
 #include "app/settings.h"
+#include "app/task_scheduler.h"
 #include "ui/gui.h"
 
 namespace {
@@ -165,6 +166,7 @@ void GeneralPage::Apply() {
 	g_settings.setInteger(Config::UNDO_SIZE, undo_size_spin->GetValue());
 	g_settings.setInteger(Config::UNDO_MEM_SIZE, undo_mem_size_spin->GetValue());
 	g_settings.setInteger(Config::WORKER_THREADS, worker_threads_spin->GetValue());
+	g_scheduler.start(worker_threads_spin->GetValue());
 	g_settings.setInteger(Config::REPLACE_SIZE, replace_size_spin->GetValue());
 	const int selected_format = position_format_choice->GetSelection() == wxNOT_FOUND ? 0 : ClampPositionFormatSelection(position_format_choice->GetSelection());
 	g_settings.setInteger(Config::COPY_POSITION_FORMAT, selected_format);
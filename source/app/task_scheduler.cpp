@@ -0,0 +1,424 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "app/main.h"
+
+#include "app/task_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+TaskScheduler g_scheduler;
+
+namespace {
+	thread_local const TaskScheduler* current_scheduler = nullptr;
+	thread_local size_t current_worker = 0;
+
+	size_t priorityIndex(TaskPriority priority) {
+		return static_cast<size_t>(priority);
+	}
+}
+
+//=============================================================================
+// TaskGroup
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler, TaskPriority priority) :
+	scheduler(scheduler),
+	priority(priority) {
+	////
+}
+
+TaskGroup::~TaskGroup() {
+	cancel();
+	wait();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+	if (isCancelled()) {
+		return;
+	}
+	scheduler.submit(*this, std::move(task));
+}
+
+void TaskGroup::cancel() {
+	cancelled.store(true, std::memory_order_relaxed);
+}
+
+void TaskGroup::wait() {
+	if (scheduler.isWorkerThread()) {
+		while (!isIdle()) {
+			if (!scheduler.runOne(current_worker, true)) {
+				std::this_thread::yield();
+			}
+		}
+		// The last task may still be inside finishTask()
+		std::lock_guard<std::mutex> lock(idle_mutex);
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(idle_mutex);
+	idle_cv.wait(lock, [this] { return isIdle(); });
+}
+
+void TaskGroup::reset() {
+	ASSERT(isIdle());
+	cancelled.store(false, std::memory_order_relaxed);
+	total_work.store(0, std::memory_order_relaxed);
+	done_work.store(0, std::memory_order_relaxed);
+}
+
+double TaskGroup::getProgress() const {
+	const uint64_t total = getTotalWork();
+	if (total == 0) {
+		return 1.0;
+	}
+	return std::min(1.0, static_cast<double>(getDoneWork()) / static_cast<double>(total));
+}
+
+void TaskGroup::finishTask() {
+	// Under the lock so a waiter cannot destroy the group between the
+	// decrement and the notification.
+	std::lock_guard<std::mutex> lock(idle_mutex);
+	if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		idle_cv.notify_all();
+	}
+}
+
+//=============================================================================
+// TaskScheduler
+
+TaskScheduler::~TaskScheduler() {
+	stop();
+}
+
+void TaskScheduler::start(int worker_count) {
+	std::lock_guard<std::mutex> control(control_mutex);
+
+	const size_t count = static_cast<size_t>(std::clamp(worker_count, MIN_WORKERS, MAX_WORKERS));
+	if (count == workers.size()) {
+		return;
+	}
+
+	joinWorkers();
+
+	std::unique_lock<std::shared_mutex> pool(pool_mutex);
+	std::vector<Task> carried = takeQueuedTasks();
+
+	workers.clear();
+	for (size_t i = 0; i < count; ++i) {
+		workers.push_back(std::make_unique<Worker>());
+	}
+	for (size_t i = 0; i < carried.size(); ++i) {
+		Worker& worker = *workers[i % count];
+		worker.queues[priorityIndex(carried[i].group->getPriority())].push_back(std::move(carried[i]));
+	}
+	queued.store(carried.size(), std::memory_order_relaxed);
+	bulk_limit = std::max<int>(1, static_cast<int>(count) - 1);
+
+	quitting.store(false);
+	for (size_t i = 0; i < count; ++i) {
+		workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+	}
+	spdlog::info("Task scheduler running {} workers", count);
+}
+
+void TaskScheduler::stop() {
+	std::vector<Task> dropped;
+	{
+		std::lock_guard<std::mutex> control(control_mutex);
+		if (workers.empty()) {
+			return;
+		}
+
+		joinWorkers();
+
+		std::unique_lock<std::shared_mutex> pool(pool_mutex);
+		dropped = takeQueuedTasks();
+		workers.clear();
+		bulk_limit = 0;
+	}
+
+	for (Task& task : dropped) {
+		task.function = nullptr;
+		task.group->finishTask();
+	}
+	if (!dropped.empty()) {
+		spdlog::debug("Task scheduler dropped {} queued tasks on shutdown", dropped.size());
+	}
+}
+
+int TaskScheduler::getWorkerCount() const {
+	std::shared_lock<std::shared_mutex> lock(pool_mutex);
+	return static_cast<int>(workers.size());
+}
+
+bool TaskScheduler::isWorkerThread() const {
+	return current_scheduler == this;
+}
+
+void TaskScheduler::submit(TaskGroup& group, std::function<void()> function) {
+	group.pending.fetch_add(1, std::memory_order_acq_rel);
+	Task task { &group, std::move(function) };
+
+	{
+		std::shared_lock<std::shared_mutex> lock(pool_mutex);
+		if (!workers.empty()) {
+			// Workers keep what they spawn (it is likely hot in their cache),
+			// everyone else spreads tasks round-robin.
+			const size_t index = isWorkerThread() ? current_worker : next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+			Worker& worker = *workers[index];
+			{
+				std::lock_guard<std::mutex> queue_lock(worker.mutex);
+				worker.queues[priorityIndex(group.getPriority())].push_back(std::move(task));
+			}
+			queued.fetch_add(1, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> sleep_lock(sleep_mutex);
+			}
+			sleep_cv.notify_one();
+			return;
+		}
+	}
+
+	execute(task);
+}
+
+bool TaskScheduler::popTask(size_t self, TaskPriority priority, Task& task) {
+	const size_t slot = priorityIndex(priority);
+	const size_t count = workers.size();
+
+	{
+		Worker& own = *workers[self];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.queues[slot].empty()) {
+			task = std::move(own.queues[slot].back());
+			own.queues[slot].pop_back();
+			queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < count; ++i) {
+		Worker& victim = *workers[(self + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.queues[slot].empty()) {
+			task = std::move(victim.queues[slot].front());
+			victim.queues[slot].pop_front();
+			queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TaskScheduler::runOne(size_t self, bool helping) {
+	Task task;
+	if (popTask(self, TaskPriority::Interactive, task)) {
+		execute(task);
+		return true;
+	}
+
+	// Reserve a bulk slot before looking for bulk work. A waiter helping out
+	// already occupies a slot with the task it is blocked in.
+	if (helping) {
+		bulk_running.fetch_add(1, std::memory_order_acq_rel);
+	} else {
+		int running = bulk_running.load(std::memory_order_relaxed);
+		do {
+			if (running >= bulk_limit) {
+				return false;
+			}
+		} while (!bulk_running.compare_exchange_weak(running, running + 1, std::memory_order_acq_rel));
+	}
+
+	const bool found = popTask(self, TaskPriority::Bulk, task);
+	if (found) {
+		execute(task);
+	}
+	bulk_running.fetch_sub(1, std::memory_order_acq_rel);
+
+	if (found) {
+		// A worker may be asleep on a bulk task it was not allowed to take
+		std::lock_guard<std::mutex> sleep_lock(sleep_mutex);
+		sleep_cv.notify_one();
+	}
+	return found;
+}
+
+void TaskScheduler::execute(Task& task) {
+	TaskGroup& group = *task.group;
+	if (!group.isCancelled()) {
+		try {
+			task.function();
+		} catch (const std::exception& e) {
+			spdlog::error("TaskScheduler: task threw an exception: {}", e.what());
+		} catch (...) {
+			spdlog::error("TaskScheduler: task threw an unknown exception");
+		}
+	}
+	// Release captures before the group can be considered done
+	task.function = nullptr;
+	group.finishTask();
+}
+
+void TaskScheduler::workerLoop(size_t index) {
+	current_scheduler = this;
+	current_worker = index;
+
+	while (!quitting.load(std::memory_order_acquire)) {
+		if (runOne(index, false)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleep_cv.wait(lock, [this] {
+			if (quitting.load(std::memory_order_acquire)) {
+				return true;
+			}
+			// Bulk-only work that is over the cap does not count as runnable;
+			// the worker finishing a bulk task wakes us up again.
+			return queued.load(std::memory_order_acquire) > 0 && (hasInteractiveWork() || bulk_running.load(std::memory_order_acquire) < bulk_limit);
+		});
+	}
+
+	current_scheduler = nullptr;
+}
+
+bool TaskScheduler::hasInteractiveWork() {
+	const size_t slot = priorityIndex(TaskPriority::Interactive);
+	for (const auto& worker : workers) {
+		std::lock_guard<std::mutex> lock(worker->mutex);
+		if (!worker->queues[slot].empty()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::joinWorkers() {
+	quitting.store(true, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> sleep_lock(sleep_mutex);
+	}
+	sleep_cv.notify_all();
+
+	for (const auto& worker : workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
+}
+
+std::vector<TaskScheduler::Task> TaskScheduler::takeQueuedTasks() {
+	std::vector<Task> tasks;
+	for (const auto& worker : workers) {
+		std::lock_guard<std::mutex> lock(worker->mutex);
+		for (auto& queue : worker->queues) {
+			for (Task& task : queue) {
+				tasks.push_back(std::move(task));
+			}
+			queue.clear();
+		}
+	}
+	queued.store(0, std::memory_order_relaxed);
+	return tasks;
+}
+
+//=============================================================================
+// runOrdered
+
+void runOrdered(TaskScheduler& scheduler, TaskPriority priority, size_t count, const std::function<void(size_t)>& produce, const std::function<bool(size_t)>& consume, const std::function<void()>& idle) {
+	if (count == 0) {
+		return;
+	}
+
+	std::unique_ptr<bool[]> ready(new bool[count]());
+	std::mutex ready_mutex;
+	std::condition_variable ready_cv;
+	std::atomic<size_t> next_item { 0 };
+	std::atomic<bool> stopped { false };
+	std::exception_ptr error;
+
+	const auto fail = [&](std::exception_ptr exception) {
+		std::lock_guard<std::mutex> lock(ready_mutex);
+		if (!error) {
+			error = std::move(exception);
+		}
+		stopped = true;
+	};
+	// Claims and produces the next item; false once there is none left
+	const auto produceNext = [&]() {
+		const size_t item = next_item.fetch_add(1, std::memory_order_relaxed);
+		if (item >= count || stopped) {
+			return false;
+		}
+		try {
+			produce(item);
+		} catch (...) {
+			fail(std::current_exception());
+		}
+		{
+			std::lock_guard<std::mutex> lock(ready_mutex);
+			ready[item] = true;
+		}
+		ready_cv.notify_all();
+		return true;
+	};
+
+	TaskGroup group(scheduler, priority);
+	const size_t producers = std::min<size_t>(count, static_cast<size_t>(scheduler.getWorkerCount()));
+	for (size_t i = 0; i < producers; ++i) {
+		group.run([&produceNext]() {
+			while (produceNext()) { }
+		});
+	}
+
+	for (size_t item = 0; item < count && !stopped; ++item) {
+		std::unique_lock<std::mutex> lock(ready_mutex);
+		while (!ready[item] && !stopped) {
+			lock.unlock();
+			if (!produceNext()) {
+				if (idle) {
+					idle();
+				}
+				lock.lock();
+				ready_cv.wait_for(lock, std::chrono::milliseconds(50));
+				continue;
+			}
+			lock.lock();
+		}
+		if (stopped) {
+			break;
+		}
+		lock.unlock();
+
+		try {
+			if (!consume(item)) {
+				stopped = true;
+			}
+		} catch (...) {
+			fail(std::current_exception());
+		}
+	}
+
+	stopped = true;
+	group.wait();
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
@@ -0,0 +1,195 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_APP_TASK_SCHEDULER_H_
+#define RME_APP_TASK_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+class TaskScheduler;
+
+enum class TaskPriority : uint8_t {
+	Interactive, // The user is waiting on it (selection, sprites on screen)
+	Bulk, // Background indexing and batch operations
+};
+
+// A set of tasks that is waited on, cancelled and tracked together.
+//
+// The group must outlive its tasks; the destructor cancels whatever has not
+// started yet and waits for the rest. Cancelled tasks still queued are
+// dropped, running ones may poll isCancelled() to bail out early.
+class TaskGroup {
+public:
+	explicit TaskGroup(TaskScheduler& scheduler, TaskPriority priority = TaskPriority::Interactive);
+	~TaskGroup();
+
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+
+	void run(std::function<void()> task);
+
+	void cancel();
+	[[nodiscard]] bool isCancelled() const {
+		return cancelled.load(std::memory_order_relaxed);
+	}
+
+	// Blocks until every task of the group has run (or was dropped). Called
+	// from a worker it runs other queued tasks meanwhile, so tasks may wait
+	// on groups of their own.
+	void wait();
+	[[nodiscard]] bool isIdle() const {
+		return pending.load(std::memory_order_acquire) == 0;
+	}
+
+	// Re-arms an idle group after cancel() and zeroes its progress.
+	void reset();
+
+	// Progress aggregation: tasks announce work units up front with
+	// addWork() and report them with advance() from any thread.
+	void addWork(uint64_t units) {
+		total_work.fetch_add(units, std::memory_order_relaxed);
+	}
+	void advance(uint64_t units = 1) {
+		done_work.fetch_add(units, std::memory_order_relaxed);
+	}
+	[[nodiscard]] uint64_t getTotalWork() const {
+		return total_work.load(std::memory_order_relaxed);
+	}
+	[[nodiscard]] uint64_t getDoneWork() const {
+		return done_work.load(std::memory_order_relaxed);
+	}
+	// In [0, 1]; 1 when no work was announced.
+	[[nodiscard]] double getProgress() const;
+
+	TaskPriority getPriority() const {
+		return priority;
+	}
+
+private:
+	friend class TaskScheduler;
+
+	void finishTask();
+
+	TaskScheduler& scheduler;
+	const TaskPriority priority;
+
+	std::atomic<bool> cancelled = false;
+	std::atomic<uint32_t> pending = 0;
+	std::atomic<uint64_t> total_work = 0;
+	std::atomic<uint64_t> done_work = 0;
+
+	std::mutex idle_mutex;
+	std::condition_variable idle_cv;
+};
+
+// Editor-wide worker pool. Every worker owns one deque per priority; it pops
+// its own work LIFO and steals FIFO from the others when it runs dry.
+// Interactive tasks always go before bulk ones, and bulk tasks never occupy
+// every worker, so there is always one left to pick up interactive work.
+//
+// Without workers (before start() or after stop()) tasks run inline on the
+// submitting thread.
+class TaskScheduler {
+public:
+	// The pool never shrinks below this, a single worker would serialize
+	// sprite decoding behind whatever bulk job is running.
+	static constexpr int MIN_WORKERS = 2;
+	static constexpr int MAX_WORKERS = 64;
+
+	TaskScheduler() = default;
+	~TaskScheduler();
+
+	TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+	// Starts (or resizes to) the given number of workers, clamped to
+	// [MIN_WORKERS, MAX_WORKERS]. Queued tasks survive a resize.
+	void start(int worker_count);
+	// Joins the workers; tasks still queued are dropped.
+	void stop();
+
+	[[nodiscard]] int getWorkerCount() const;
+	[[nodiscard]] size_t getQueuedTasks() const {
+		return queued.load(std::memory_order_relaxed);
+	}
+	// True on one of this scheduler's worker threads.
+	[[nodiscard]] bool isWorkerThread() const;
+
+private:
+	friend class TaskGroup;
+
+	struct Task {
+		TaskGroup* group = nullptr;
+		std::function<void()> function;
+	};
+
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Task> queues[2]; // Indexed by TaskPriority
+		std::thread thread;
+	};
+
+	void submit(TaskGroup& group, std::function<void()> function);
+	// Runs one queued task if there is any; helping waiters ignore the bulk cap.
+	bool runOne(size_t self, bool helping);
+	bool popTask(size_t self, TaskPriority priority, Task& task);
+	void execute(Task& task);
+	bool hasInteractiveWork();
+	void workerLoop(size_t index);
+	void joinWorkers();
+	std::vector<Task> takeQueuedTasks();
+
+	std::mutex control_mutex; // Serializes start() and stop()
+	mutable std::shared_mutex pool_mutex; // Guards the workers vector against submitters
+	std::vector<std::unique_ptr<Worker>> workers;
+	int bulk_limit = 0;
+
+	std::atomic<bool> quitting = false;
+	std::atomic<size_t> queued = 0;
+	std::atomic<int> bulk_running = 0;
+	std::atomic<size_t> next_worker = 0;
+
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_cv;
+};
+
+// Runs produce(i) for every i in [0, count) on the scheduler and consume(i)
+// on the calling thread strictly in index order, each as soon as item i is
+// done, so results stream out while later items are still being produced.
+// Items are claimed in index order; while it waits for the next item the
+// calling thread produces unclaimed ones itself, so this also makes progress
+// with every worker busy. consume() returning false stops the run and skips
+// whatever was not claimed yet. idle() runs on the calling thread about every
+// 50 ms while it waits, for progress reports. The first exception thrown by
+// produce() or consume() stops the run too and is rethrown once no item is
+// being produced any more.
+void runOrdered(TaskScheduler& scheduler, TaskPriority priority, size_t count, const std::function<void(size_t)>& produce, const std::function<bool(size_t)>& consume, const std::function<void()>& idle = nullptr);
+
+extern TaskScheduler g_scheduler;
+
+#endif
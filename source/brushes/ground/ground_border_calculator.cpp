@@ -13,10 +13,20 @@
 #include <algorithm>
 
 void GroundBorderCalculator::calculate(BaseMap* map, Tile* tile) {
-	static const auto extractGroundBrushFromTile = [](BaseMap* map, int x, int y, int z) -> GroundBrush* {
-		Tile* tile = map->getTile(x, y, z);
-		if (tile) {
-			return tile->getGroundBrush();
+	thread_local Scratch scratch;
+	calculateBorders(*map, tile, scratch);
+}
+
+void GroundBorderCalculator::calculate(const BaseMap& map, Tile* tile, Scratch& scratch) {
+	calculateBorders(map, tile, scratch);
+}
+
+template <typename MapType>
+void GroundBorderCalculator::calculateBorders(MapType& map, Tile* tile, Scratch& scratch) {
+	const auto extractGroundBrushFromTile = [&map](int x, int y, int z) -> GroundBrush* {
+		const Tile* neighbour = map.getTile(x, y, z);
+		if (neighbour) {
+			return neighbour->getGroundBrush();
 		}
 		return nullptr;
 	};
@@ -48,13 +58,14 @@ void GroundBorderCalculator::calculate(BaseMap* map, Tile* tile) {
 		int nx = x + dx;
 		int ny = y + dy;
 
-		neighbours[i] = { false, extractGroundBrushFromTile(map, nx, ny, z) };
+		neighbours[i] = { false, extractGroundBrushFromTile(nx, ny, z) };
 	}
 
-	static std::vector<const GroundBrush::BorderBlock*> specificList;
+	std::vector<const GroundBrush::BorderBlock*>& specificList = scratch.specific_cases;
 	specificList.clear();
 
-	std::vector<GroundBrush::BorderCluster> borderList;
+	std::vector<GroundBrush::BorderCluster>& borderList = scratch.borders;
+	borderList.clear();
 	for (int32_t i = 0; i < 8; ++i) {
 		auto& [visited, other] = neighbours[i];
 		if (visited) {
@@ -6,15 +6,31 @@
 #define RME_GROUND_BORDER_CALCULATOR_H
 
 #include "app/main.h"
+#include "brushes/ground/ground_brush.h"
+
+#include <vector>
 
 class BaseMap;
 class Tile;
 
 /**
  * @brief Handles the calculation of ground borders.
+ *
+ * The calculation only reads the ground of the eight neighbours and only
+ * writes the tile itself, so tiles can be bordered concurrently as long as
+ * every thread brings its own Scratch and looks neighbours up through a
+ * const map (the non-const lookup caches the last grid cell).
  */
 class GroundBorderCalculator {
 public:
+	/**
+	 * @brief Working buffers for one thread, reused from tile to tile.
+	 */
+	struct Scratch {
+		std::vector<GroundBrush::BorderCluster> borders;
+		std::vector<const GroundBrush::BorderBlock*> specific_cases;
+	};
+
 	/**
 	 * @brief Calculates and applies borders for a specific tile.
 	 *
@@ -22,6 +38,19 @@ public:
 	 * @param tile The tile to calculate borders for.
 	 */
 	static void calculate(BaseMap* map, Tile* tile);
+
+	/**
+	 * @brief Re-entrant variant of calculate().
+	 *
+	 * @param map The map where the tile resides, only read.
+	 * @param tile The tile to calculate borders for.
+	 * @param scratch Buffers owned by the calling thread.
+	 */
+	static void calculate(const BaseMap& map, Tile* tile, Scratch& scratch);
+
+private:
+	template <typename MapType>
+	static void calculateBorders(MapType& map, Tile* tile, Scratch& scratch);
 };
 
 #endif // RME_GROUND_BORDER_CALCULATOR_H
@@ -71,10 +71,17 @@ void GroundBrush::draw(BaseMap* map, Tile* tile, void* parameter) {
 			return;
 		}
 	}
-	int chance = random(1, total_chance);
+	drawVariation(tile, random(1, total_chance));
+}
+
+void GroundBrush::drawVariation(Tile* tile, int roll) const {
+	if (border_items.empty()) {
+		return;
+	}
+
 	uint16_t id = 0;
 	for (const auto& item_block : border_items) {
-		if (chance < item_block.chance) {
+		if (roll < item_block.chance) {
 			id = item_block.id;
 			break;
 		}
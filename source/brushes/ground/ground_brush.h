@@ -39,6 +39,11 @@ public:
 	bool load(pugi::xml_node node, std::vector<std::string>& warnings) override;
 
 	void draw(BaseMap* map, Tile* tile, void* parameter) override;
+	// Places the ground variation selected by roll, in [1, getTotalChance()]
+	void drawVariation(Tile* tile, int roll) const;
+	int getTotalChance() const {
+		return total_chance;
+	}
 	void undraw(BaseMap* map, Tile* tile) override;
 	void getRelatedItems(std::vector<uint16_t>& items) override;
 
@@ -109,6 +109,20 @@ const WaypointChangeData* Change::getWaypointData() const {
 	return std::get_if<WaypointChangeData>(&data);
 }
 
+void Change::pack(UndoArena& arena) {
+	if (auto* t = std::get_if<std::unique_ptr<Tile>>(&data)) {
+		if (auto record = arena.pack(*t)) {
+			data = *record;
+		}
+	}
+}
+
+void Change::unpack(UndoArena& arena, BaseMap& map) {
+	if (auto* record = std::get_if<UndoArena::Record>(&data)) {
+		data = arena.unpack(*record, map, position);
+	}
+}
+
 uint32_t Change::memsize() const {
 	uint32_t mem = sizeof(*this);
 	if (auto* t = std::get_if<std::unique_ptr<Tile>>(&data)) {
@@ -133,14 +147,8 @@ Action::~Action() {
 	changes.clear();
 }
 
-size_t Action::approx_memsize() const {
-	uint32_t mem = sizeof(*this);
-	mem += changes.size() * (sizeof(Change) + sizeof(Tile) + sizeof(Item) + 6 /* approx overhead*/);
-	return mem;
-}
-
 size_t Action::memsize() const {
-	uint32_t mem = sizeof(*this);
+	size_t mem = sizeof(*this);
 	mem += sizeof(Change*) * 3 * changes.size();
 	for (const auto& c : changes) {
 		mem += c->memsize();
@@ -148,7 +156,20 @@ size_t Action::memsize() const {
 	return mem;
 }
 
+void Action::pack(UndoArena& arena) {
+	for (const auto& c : changes) {
+		c->pack(arena);
+	}
+}
+
+void Action::unpack(UndoArena& arena, BaseMap& map) {
+	for (const auto& c : changes) {
+		c->unpack(arena, map);
+	}
+}
+
 void Action::commit(DirtyList* dirty_list) {
+	DirtyList minimap_nodes;
 	editor.selection.start(Selection::INTERNAL);
 	ChangeList::const_iterator it = changes.begin();
 	while (it != changes.end()) {
@@ -172,6 +193,11 @@ void Action::commit(DirtyList* dirty_list) {
 				Tile* insertedTile = editor.map.getTile(pos);
 				Tile* displaced = displacedTile.get();
 
+				if (type != ACTION_SELECT) {
+					editor.map.getItemIndex().removeTile(pos, displaced);
+					editor.map.getItemIndex().addTile(pos, insertedTile);
+				}
+
 				// Update other nodes in the network
 				if (editor.live_manager.IsServer() && dirty_list) {
 					dirty_list->AddPosition(pos.x, pos.y, pos.z);
@@ -250,7 +276,7 @@ void Action::commit(DirtyList* dirty_list) {
 					dirty_list->AddChange(c);
 				}
 				if (type != ACTION_SELECT) {
-					g_minimap.MarkTileDirty(editor.map, pos);
+					minimap_nodes.AddPosition(pos.x, pos.y, pos.z);
 				}
 				break;
 			}
@@ -299,6 +325,9 @@ void Action::commit(DirtyList* dirty_list) {
 		++it;
 	}
 	editor.selection.finish(Selection::INTERNAL);
+	if (!minimap_nodes.Empty()) {
+		g_minimap.MarkDirty(editor.map, minimap_nodes);
+	}
 	commited = true;
 }
 
@@ -307,6 +336,7 @@ void Action::undo(DirtyList* dirty_list) {
 		return;
 	}
 
+	DirtyList minimap_nodes;
 	editor.selection.start(Selection::INTERNAL);
 	ChangeList::reverse_iterator it = changes.rbegin();
 
@@ -333,6 +363,11 @@ void Action::undo(DirtyList* dirty_list) {
 					std::unique_ptr<Tile> newtile_uptr = editor.map.swapTile(pos, std::move(old_uptr));
 					Tile* newtile = newtile_uptr.get();
 
+					if (type != ACTION_SELECT) {
+						editor.map.getItemIndex().removeTile(pos, newtile);
+						editor.map.getItemIndex().addTile(pos, oldtile);
+					}
+
 					// Update server side change list (for broadcast)
 					if (editor.live_manager.IsServer() && dirty_list) {
 						dirty_list->AddPosition(pos.x, pos.y, pos.z);
@@ -402,6 +437,10 @@ void Action::undo(DirtyList* dirty_list) {
 					std::unique_ptr<Tile> removedTile = editor.map.swapTile(pos, std::unique_ptr<Tile>());
 					Tile* removed = removedTile.get();
 
+					if (type != ACTION_SELECT) {
+						editor.map.getItemIndex().removeTile(pos, removed);
+					}
+
 					// Update server side change list (for broadcast)
 					if (editor.live_manager.IsServer() && dirty_list) {
 						dirty_list->AddPosition(pos.x, pos.y, pos.z);
@@ -430,7 +469,7 @@ void Action::undo(DirtyList* dirty_list) {
 					dirty_list->AddChange(c);
 				}
 				if (type != ACTION_SELECT) {
-					g_minimap.MarkTileDirty(editor.map, pos);
+					minimap_nodes.AddPosition(pos.x, pos.y, pos.z);
 				}
 				break;
 			}
@@ -480,6 +519,9 @@ void Action::undo(DirtyList* dirty_list) {
 		++it;
 	}
 	editor.selection.finish(Selection::INTERNAL);
+	if (!minimap_nodes.Empty()) {
+		g_minimap.MarkDirty(editor.map, minimap_nodes);
+	}
 	commited = false;
 }
 
@@ -494,27 +536,57 @@ BatchAction::~BatchAction() {
 }
 
 size_t BatchAction::memsize(bool recalc) const {
-	// Expensive operation, only evaluate once (won't change anyways)
+	// Walks every change, only evaluate when the batch was (re)packed
 	if (!recalc && memory_size > 0) {
 		return memory_size;
 	}
 
-	uint32_t mem = sizeof(*this);
+	size_t mem = sizeof(*this);
 	mem += sizeof(Action*) * 3 * batch.size();
+	mem += arena.memsize();
 
 	for (const auto& action : batch) {
-#ifdef __USE_EXACT_MEMSIZE__
 		mem += action->memsize();
-#else
-		// Less exact but MUCH faster
-		mem += action->approx_memsize();
-#endif
 	}
 
 	const_cast<BatchAction*>(this)->memory_size = mem;
 	return mem;
 }
 
+size_t BatchAction::changeCount() const {
+	size_t count = 0;
+	for (const auto& action : batch) {
+		count += action->size();
+	}
+	return count;
+}
+
+void BatchAction::pack() {
+	for (const auto& action : batch) {
+		action->pack(arena);
+	}
+	arena.shrink();
+	memsize(true);
+}
+
+void BatchAction::unpack() {
+	if (arena.empty()) {
+		return;
+	}
+	for (const auto& action : batch) {
+		action->unpack(arena, editor.map);
+	}
+	arena.clear();
+}
+
+bool BatchAction::compress() {
+	if (!arena.compress()) {
+		return false;
+	}
+	memsize(true);
+	return true;
+}
+
 void BatchAction::addAction(std::unique_ptr<Action> action) {
 	// If empty, do nothing.
 	if (action->size() == 0) {
@@ -20,6 +20,7 @@
 
 #include "map/position.h"
 #include "map/tile.h"
+#include "editor/undo_arena.h"
 
 #include <cstdint>
 #include <deque>
@@ -29,6 +30,7 @@
 #include <variant>
 #include <vector>
 
+class BaseMap;
 class Editor;
 class Tile;
 class House;
@@ -57,7 +59,7 @@ struct WaypointChangeData {
 
 class Change {
 private:
-	using Data = std::variant<std::monostate, std::unique_ptr<Tile>, HouseExitChangeData, WaypointChangeData>;
+	using Data = std::variant<std::monostate, std::unique_ptr<Tile>, UndoArena::Record, HouseExitChangeData, WaypointChangeData>;
 	ChangeType type;
 	Position position;
 	Data data;
@@ -75,13 +77,20 @@ public:
 	ChangeType getType() const {
 		return type;
 	}
+	const Position& getPosition() const {
+		return position;
+	}
+	// nullptr while the tile is packed into its batch's arena
 	const Tile* getTile() const;
 	const HouseExitChangeData* getHouseExitData() const;
 	const WaypointChangeData* getWaypointData() const;
 
-	// Get memory footprint
+	// Get memory footprint (packed tiles are accounted by their arena)
 	uint32_t memsize() const;
 
+	void pack(UndoArena& arena);
+	void unpack(UndoArena& arena, BaseMap& map);
+
 	friend class Action;
 };
 
@@ -115,7 +124,6 @@ public:
 	}
 
 	// Get memory footprint
-	size_t approx_memsize() const;
 	size_t memsize() const;
 	size_t size() const {
 		return changes.size();
@@ -133,6 +141,9 @@ public:
 		commit(dirty_list);
 	}
 
+	void pack(UndoArena& arena);
+	void unpack(UndoArena& arena, BaseMap& map);
+
 protected:
 	Action(Editor& editor, ActionIdentifier ident);
 
@@ -159,6 +170,7 @@ public:
 	size_t size() const {
 		return batch.size();
 	}
+	size_t changeCount() const;
 	ActionIdentifier getType() const {
 		return type;
 	}
@@ -182,12 +194,22 @@ protected:
 
 	void merge(BatchAction* other);
 
+	// Between steps the tiles held for undo/redo live in the arena as compact
+	// records; unpack() before undo()/redo(), pack() again afterwards.
+	void pack();
+	void unpack();
+	bool compress();
+	bool isCompressed() const {
+		return arena.isCompressed();
+	}
+
 	Editor& editor;
 	int timestamp;
-	uint32_t memory_size;
+	size_t memory_size;
 	ActionIdentifier type;
 	std::string label;
 	ActionVector batch;
+	UndoArena arena;
 
 	friend class ActionQueue;
 };
@@ -28,6 +28,16 @@
 #include "game/creature.h"
 #include "game/spawn.h"
 
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace {
+	// Batches this many steps away from the cursor get their arenas deflated
+	constexpr size_t UNCOMPRESSED_HISTORY = 8;
+	// Undo/redo steps slower than this are logged
+	constexpr double SLOW_STEP_MS = 100.0;
+}
+
 ActionQueue::ActionQueue(Editor& editor) :
 	current(0), memory_size(0), editor(editor) {
 	////
@@ -103,18 +113,10 @@ void ActionQueue::addBatch(std::unique_ptr<BatchAction> batch, int stacking_dela
 	}
 
 	while (current != actions.size()) {
-		memory_size -= actions.back()->memsize();
 		actions.pop_back();
 	}
 
-	while (memory_size > size_t(1024 * 1024 * g_settings.getInteger(Config::UNDO_MEM_SIZE)) && !actions.empty()) {
-		memory_size -= actions.front()->memsize();
-		actions.pop_front();
-		current--;
-	}
-
 	if (actions.size() > size_t(g_settings.getInteger(Config::UNDO_SIZE)) && !actions.empty()) {
-		memory_size -= actions.front()->memsize();
 		actions.pop_front();
 		current--;
 	}
@@ -124,18 +126,21 @@ void ActionQueue::addBatch(std::unique_ptr<BatchAction> batch, int stacking_dela
 			BatchAction* lastAction = actions.back().get();
 			if (lastAction->getType() == batch->getType() && g_settings.getInteger(Config::GROUP_ACTIONS) && time(nullptr) - stacking_delay < lastAction->timestamp) {
 				lastAction->merge(batch.get());
+				lastAction->pack();
 				lastAction->timestamp = time(nullptr);
-				memory_size -= lastAction->memsize();
-				memory_size += lastAction->memsize(true);
 				break;
 			}
 		}
-		memory_size += batch->memsize();
+		batch->pack();
 		batch->timestamp = time(nullptr);
 		actions.push_back(std::move(batch));
 		current++;
 	} while (false);
-	g_luaScripts.emit("actionChange");
+
+	compressOldBatches();
+	updateMemorySize();
+	enforceMemoryBudget();
+	g_luaScripts.emit(LuaScriptManager::EVENT_ACTION_CHANGE);
 }
 
 void ActionQueue::addAction(std::unique_ptr<Action> action, int stacking_delay) {
@@ -152,24 +157,98 @@ void ActionQueue::undo() {
 	if (current > 0) {
 		current--;
 		BatchAction* batch = actions[current].get();
+		const auto start = std::chrono::steady_clock::now();
+		batch->unpack();
 		batch->undo();
+		batch->pack();
+		recordLatency("Undo", current, start, stats.last_undo_ms, stats.max_undo_ms);
+
+		compressOldBatches();
+		updateMemorySize();
+		enforceMemoryBudget();
+		logStatistics("Undo", stats.last_undo_ms);
 		editor.notifyStateChange();
-		g_luaScripts.emit("actionChange");
+		g_luaScripts.emit(LuaScriptManager::EVENT_ACTION_CHANGE);
 	}
 }
 
 void ActionQueue::redo() {
 	if (current < actions.size()) {
 		BatchAction* batch = actions[current].get();
+		const auto start = std::chrono::steady_clock::now();
+		batch->unpack();
 		batch->redo();
+		batch->pack();
+		recordLatency("Redo", current, start, stats.last_redo_ms, stats.max_redo_ms);
 		current++;
+
+		compressOldBatches();
+		updateMemorySize();
+		enforceMemoryBudget();
+		logStatistics("Redo", stats.last_redo_ms);
 		editor.notifyStateChange();
-		g_luaScripts.emit("actionChange");
+		g_luaScripts.emit(LuaScriptManager::EVENT_ACTION_CHANGE);
 	}
 }
 
 void ActionQueue::clear() {
 	actions.clear();
 	current = 0;
-	g_luaScripts.emit("actionChange");
+	memory_size = 0;
+	g_luaScripts.emit(LuaScriptManager::EVENT_ACTION_CHANGE);
+}
+
+ActionQueue::Statistics ActionQueue::getStatistics() const {
+	Statistics result = stats;
+	result.memory_size = memory_size;
+	result.compressed_batches = std::ranges::count_if(actions, [](const std::unique_ptr<BatchAction>& batch) {
+		return batch->isCompressed();
+	});
+	return result;
+}
+
+void ActionQueue::updateMemorySize() {
+	memory_size = 0;
+	for (const auto& batch : actions) {
+		memory_size += batch->memsize();
+	}
+}
+
+void ActionQueue::enforceMemoryBudget() {
+	const size_t budget = size_t(1024 * 1024) * g_settings.getInteger(Config::UNDO_MEM_SIZE);
+
+	// Oldest history goes first; the batch the next undo needs always stays.
+	while (memory_size > budget && current > 1) {
+		memory_size -= actions.front()->memsize();
+		actions.pop_front();
+		current--;
+		++stats.evicted_batches;
+	}
+}
+
+void ActionQueue::compressOldBatches() {
+	// The cursor moves one step at a time, so only the batches that just fell
+	// out of the uncompressed window on either side need looking at.
+	if (current > UNCOMPRESSED_HISTORY) {
+		actions[current - UNCOMPRESSED_HISTORY - 1]->compress();
+	}
+	if (current + UNCOMPRESSED_HISTORY < actions.size()) {
+		actions[current + UNCOMPRESSED_HISTORY]->compress();
+	}
+}
+
+void ActionQueue::recordLatency(const char* step, size_t index, std::chrono::steady_clock::time_point start, double& last_ms, double& max_ms) {
+	last_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	max_ms = std::max(max_ms, last_ms);
+	if (last_ms >= SLOW_STEP_MS) {
+		spdlog::info("{} of \"{}\" ({} changes) took {:.1f} ms", step, getActionName(index), actions[index]->changeCount(), last_ms);
+	}
+}
+
+void ActionQueue::logStatistics(const char* step, double step_ms) const {
+	const Statistics snapshot = getStatistics();
+	spdlog::debug(
+		"{} took {:.1f} ms; history holds {} batches in {} KiB, {} compressed, {} evicted so far",
+		step, step_ms, actions.size(), snapshot.memory_size / 1024, snapshot.compressed_batches, snapshot.evicted_batches
+	);
 }
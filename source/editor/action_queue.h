@@ -18,6 +18,7 @@
 #ifndef RME_EDITOR_ACTION_QUEUE_H
 #define RME_EDITOR_ACTION_QUEUE_H
 
+#include <chrono>
 #include <deque>
 #include <string>
 #include <vector>
@@ -35,6 +36,16 @@ public:
 
 	using ActionList = std::deque<std::unique_ptr<BatchAction>>;
 
+	struct Statistics {
+		size_t memory_size = 0;
+		size_t compressed_batches = 0;
+		size_t evicted_batches = 0; // Dropped to stay inside Config::UNDO_MEM_SIZE
+		double last_undo_ms = 0.0;
+		double max_undo_ms = 0.0;
+		double last_redo_ms = 0.0;
+		double max_redo_ms = 0.0;
+	};
+
 	void resetTimer();
 
 	virtual std::unique_ptr<Action> createAction(ActionIdentifier ident);
@@ -63,11 +74,20 @@ public:
 	}
 	std::string getActionName(size_t index) const;
 
+	Statistics getStatistics() const;
+
 protected:
+	void updateMemorySize();
+	void enforceMemoryBudget();
+	void compressOldBatches();
+	void recordLatency(const char* step, size_t index, std::chrono::steady_clock::time_point start, double& last_ms, double& max_ms);
+	void logStatistics(const char* step, double step_ms) const;
+
 	size_t current;
 	size_t memory_size;
 	Editor& editor;
 	ActionList actions;
+	Statistics stats;
 };
 
 #endif
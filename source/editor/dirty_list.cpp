@@ -19,8 +19,49 @@
 #include "editor/dirty_list.h"
 #include "editor/action.h"
 
+#include <algorithm>
+
+namespace {
+	// Below this a comparison sort beats two passes over 16K-entry histograms.
+	constexpr size_t RADIX_SORT_MIN = 4096;
+	// Unread lists are compacted once they grow past this and twice their
+	// distinct size, so a list that keeps being fed stays proportional to the
+	// nodes it covers.
+	constexpr size_t COMPACT_MIN = 1 << 16;
+
+	void radixSort(std::span<DirtyList::ValueType> values) {
+		// Keys are 14 bits of node y at bit 4 and 14 bits of node x at bit 18;
+		// one stable pass per coordinate.
+		constexpr int RADIX_BITS = 14;
+		constexpr uint32_t RADIX_MASK = (1u << RADIX_BITS) - 1;
+
+		std::vector<DirtyList::ValueType> scratch(values.size());
+		std::vector<uint32_t> counts(size_t(1) << RADIX_BITS);
+		std::span<DirtyList::ValueType> from = values;
+		std::span<DirtyList::ValueType> to = scratch;
+		for (const int shift : { 4, 4 + RADIX_BITS }) {
+			std::ranges::fill(counts, 0);
+			for (const auto& value : from) {
+				++counts[(value.pos >> shift) & RADIX_MASK];
+			}
+			uint32_t offset = 0;
+			for (uint32_t& count : counts) {
+				const uint32_t n = count;
+				count = offset;
+				offset += n;
+			}
+			for (const auto& value : from) {
+				to[counts[(value.pos >> shift) & RADIX_MASK]++] = value;
+			}
+			std::swap(from, to);
+		}
+		// Two passes leave the result back in values.
+	}
+}
+
 DirtyList::DirtyList() :
-	owner(0) {
+	owner(0),
+	compact_at(COMPACT_MIN) {
 	;
 }
 
@@ -29,26 +70,44 @@ DirtyList::~DirtyList() {
 }
 
 void DirtyList::AddPosition(int x, int y, int z) {
-	uint32_t m = ((x >> 2) << 18) | ((y >> 2) << 4);
-	ValueType fi = { m, 0 };
-	SetType::iterator s = iset.find(fi);
-	if (s != iset.end()) {
-		ValueType v = *s;
-		iset.erase(s);
-		v.floors = (1 << z) | v.floors;
-		iset.insert(v);
-	} else {
-		ValueType v = { m, (uint32_t)(1 << z) };
-		iset.insert(v);
+	const uint32_t m = EncodePosition(x, y);
+	const uint32_t floor = 1u << z;
+	rects_valid = false;
+
+	// Tiles of an action mostly arrive node by node.
+	if (!entries.empty() && entries.back().pos == m) {
+		entries.back().floors |= floor;
+		return;
 	}
+
+	entries.push_back({ m, floor });
+	CompactIfLarge();
+}
+
+void DirtyList::Merge(const DirtyList& other) {
+	const auto nodes = other.GetPosList();
+	entries.insert(entries.end(), nodes.begin(), nodes.end());
+	ichanges.insert(ichanges.end(), other.ichanges.begin(), other.ichanges.end());
+	rects_valid = false;
+	CompactIfLarge();
 }
 
 void DirtyList::AddChange(Change* c) {
 	ichanges.push_back(c);
 }
 
-DirtyList::SetType& DirtyList::GetPosList() {
-	return iset;
+std::span<const DirtyList::ValueType> DirtyList::GetPosList() const {
+	Normalize();
+	return entries;
+}
+
+std::span<const DirtyList::Rect> DirtyList::GetRects() const {
+	if (!rects_valid) {
+		Normalize();
+		Coalesce();
+		rects_valid = true;
+	}
+	return rects;
 }
 
 DirtyList::ChangeList& DirtyList::GetChanges() {
@@ -67,8 +126,95 @@ uint32_t DirtyList::DecodeFloorsMask(const ValueType& value) {
 	return value.floors;
 }
 
-void DirtyList::ForEachNodeRect(const Visitor& visitor) const {
-	for (const auto& value : iset) {
-		visitor(DecodeNodeX(value), DecodeNodeY(value), DecodeFloorsMask(value));
+void DirtyList::CompactIfLarge() {
+	if (entries.size() >= compact_at) {
+		Normalize();
+		compact_at = std::max(COMPACT_MIN, entries.size() * 2);
+	}
+}
+
+void DirtyList::Normalize() const {
+	if (sorted_count == entries.size()) {
+		return;
+	}
+
+	const auto by_pos = [](const ValueType& a, const ValueType& b) {
+		return a.pos < b.pos;
+	};
+
+	// Only what was appended since the last read needs sorting.
+	const auto middle = entries.begin() + static_cast<std::ptrdiff_t>(sorted_count);
+	const std::span<ValueType> tail(middle, entries.end());
+	if (tail.size() >= RADIX_SORT_MIN) {
+		radixSort(tail);
+	} else {
+		std::sort(tail.begin(), tail.end(), by_pos);
+	}
+	if (sorted_count > 0) {
+		std::inplace_merge(entries.begin(), middle, entries.end(), by_pos);
+	}
+
+	size_t out = 0;
+	for (size_t i = 1; i < entries.size(); ++i) {
+		if (entries[i].pos == entries[out].pos) {
+			entries[out].floors |= entries[i].floors;
+		} else {
+			entries[++out] = entries[i];
+		}
+	}
+	entries.resize(entries.empty() ? 0 : out + 1);
+	sorted_count = entries.size();
+}
+
+void DirtyList::Coalesce() const {
+	rects.clear();
+
+	// Entries are sorted by node x, then y: first join each column into runs
+	// of consecutive nodes with the same floors, then extend the rectangles
+	// of the previous column by runs that line up with them exactly.
+	std::vector<size_t> previous; // Rectangles that end at the previous column, by y
+	std::vector<size_t> current;
+	int current_x = -1;
+	size_t match = 0;
+
+	size_t i = 0;
+	while (i < entries.size()) {
+		const int x = DecodeNodeX(entries[i]);
+		const int y = DecodeNodeY(entries[i]);
+		const uint32_t floors = entries[i].floors;
+
+		size_t end = i + 1;
+		while (end < entries.size() && entries[end].pos == entries[end - 1].pos + (1u << 4) && (entries[end].pos >> 18) == (entries[i].pos >> 18) && entries[end].floors == floors) {
+			++end;
+		}
+		const int height = static_cast<int>(end - i) * 4;
+		i = end;
+
+		if (x != current_x) {
+			if (x == current_x + 4) {
+				previous.swap(current);
+			} else {
+				previous.clear();
+			}
+			current.clear();
+			current_x = x;
+			match = 0;
+		}
+
+		while (match < previous.size() && rects[previous[match]].y < y) {
+			++match;
+		}
+		if (match < previous.size()) {
+			Rect& rect = rects[previous[match]];
+			if (rect.y == y && rect.height == height && rect.floors == floors) {
+				rect.width += 4;
+				current.push_back(previous[match]);
+				++match;
+				continue;
+			}
+		}
+
+		current.push_back(rects.size());
+		rects.push_back({ x, y, 4, height, floors });
 	}
 }
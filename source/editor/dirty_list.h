@@ -19,13 +19,19 @@
 #define RME_EDITOR_DIRTY_LIST_H
 
 #include <vector>
-#include <set>
+#include <span>
 #include <cstdint>
-#include <functional>
+#include <cstddef>
 
 class Change;
 
 // A dirty list represents a list of all tiles that was changed in an action
+//
+// Positions are tracked per 4x4 map node as a flat vector that is only
+// appended to; it is sorted and merged the first time it is read, so a paste
+// touching hundreds of thousands of tiles costs one push_back per tile and a
+// single sort. Readers get either the distinct nodes in (x, y) order or the
+// same nodes coalesced into rectangles that share a floor mask.
 class DirtyList {
 public:
 	DirtyList();
@@ -36,34 +42,50 @@ public:
 		uint32_t floors;
 	};
 
-	uint32_t owner;
-
-protected:
-	struct Comparator {
-		bool operator()(const ValueType& a, const ValueType& b) const {
-			return a.pos < b.pos;
-		}
+	// Tile-space rectangle of whole nodes, all dirty on the same floors.
+	struct Rect {
+		int x;
+		int y;
+		int width;
+		int height;
+		uint32_t floors;
 	};
 
-public:
-	using SetType = std::set<ValueType, Comparator>;
+	uint32_t owner;
+
 	using ChangeList = std::vector<Change*>;
-	using Visitor = std::function<void(int node_x, int node_y, uint32_t floors_mask)>;
 
 	void AddPosition(int x, int y, int z);
+	// Adds the distinct nodes and the changes of another list in one go.
+	void Merge(const DirtyList& other);
 	void AddChange(Change* c);
 	bool Empty() const {
-		return iset.empty() && ichanges.empty();
+		return entries.empty() && ichanges.empty();
 	}
-	SetType& GetPosList();
+
+	// Distinct nodes sorted by x, then y.
+	std::span<const ValueType> GetPosList() const;
+	std::span<const Rect> GetRects() const;
 	ChangeList& GetChanges();
+
 	static int DecodeNodeX(const ValueType& value);
 	static int DecodeNodeY(const ValueType& value);
 	static uint32_t DecodeFloorsMask(const ValueType& value);
-	void ForEachNodeRect(const Visitor& visitor) const;
 
 protected:
-	SetType iset;
+	static uint32_t EncodePosition(int x, int y) {
+		return (static_cast<uint32_t>(x >> 2) << 18) | (static_cast<uint32_t>(y >> 2) << 4);
+	}
+
+	void CompactIfLarge();
+	void Normalize() const;
+	void Coalesce() const;
+
+	mutable std::vector<ValueType> entries;
+	mutable std::vector<Rect> rects;
+	mutable size_t sorted_count = 0; // Leading entries known to be sorted and distinct
+	mutable bool rects_valid = true;
+	size_t compact_at;
 	ChangeList ichanges;
 };
 
@@ -25,7 +25,7 @@ namespace EditorOperations {
 		std::vector<std::pair<Tile*, Item*>> result;
 
 		void operator()(Map& map, Tile* tile, Item* item, long long done) {
-			if (done % SEARCH_UPDATE_INTERVAL == 0) {
+			if (done >= 0 && done % SEARCH_UPDATE_INTERVAL == 0) {
 				g_gui.SetLoadDone((unsigned int)(100 * done / map.getTileCount()));
 			}
 
@@ -40,6 +40,21 @@ namespace EditorOperations {
 				}
 			}
 		}
+
+		// parallel_foreach_ItemOnMap: a partial keeps every match up to the end of
+		// the page, merge() applies the page window in map order.
+		ItemSearcher fork() const {
+			return ItemSearcher(itemId, offset + maxCount);
+		}
+
+		void merge(ItemSearcher&& other) {
+			for (const auto& match : other.result) {
+				if (++totalMatches > offset && result.size() < static_cast<size_t>(maxCount)) {
+					result.push_back(match);
+				}
+			}
+			totalMatches += other.totalMatches - static_cast<uint32_t>(other.result.size());
+		}
 	};
 
 	struct MapSearcher {
@@ -65,6 +80,10 @@ namespace EditorOperations {
 			}
 		}
 
+		void merge(MapSearcher&& other) {
+			found.insert(found.end(), other.found.begin(), other.found.end());
+		}
+
 		wxString desc(Item* item) {
 			wxString label;
 			if (search_action) {
@@ -151,7 +170,7 @@ namespace EditorOperations {
 		std::vector<std::pair<Tile*, Creature*>> result;
 
 		void operator()(Map& map, Tile* tile, long long done) {
-			if (done % SEARCH_UPDATE_INTERVAL == 0) {
+			if (done >= 0 && done % SEARCH_UPDATE_INTERVAL == 0) {
 				g_gui.SetLoadDone(static_cast<uint32_t>(100 * done / map.getTileCount()));
 			}
 
@@ -166,6 +185,19 @@ namespace EditorOperations {
 				}
 			}
 		}
+
+		CreatureSearcher fork() const {
+			return CreatureSearcher(creatureBrush, offset + maxCount);
+		}
+
+		void merge(CreatureSearcher&& other) {
+			for (const auto& match : other.result) {
+				if (++totalMatches > offset && result.size() < static_cast<size_t>(maxCount)) {
+					result.push_back(match);
+				}
+			}
+			totalMatches += other.totalMatches - static_cast<uint32_t>(other.result.size());
+		}
 	};
 }
 
@@ -36,7 +36,9 @@ void EditorPersistence::loadMap(Editor& editor, const FileName& fn, const MapLoa
 	}
 
 	ScopedLoadingBar loadingBar("Loading OTBM map...");
-	editor.map.open(nstr(fn.GetFullPath()));
+	if (editor.map.open(nstr(fn.GetFullPath()))) {
+		editor.map.getItemIndex().build(editor.map);
+	}
 }
 
 void EditorPersistence::saveMap(Editor& editor, FileName filename, bool showdialog) {
@@ -428,6 +430,8 @@ void EditorPersistence::importSpawns(Editor& editor, Map& imported_map, const Po
 bool EditorPersistence::importMap(Editor& editor, FileName filename, int import_x_offset, int import_y_offset, ImportType house_import_type, ImportType spawn_import_type) {
 	editor.selection.clear();
 	editor.actionQueue->clear();
+	// Tiles are moved in below without going through actions
+	editor.map.getItemIndex().invalidate();
 
 	Map imported_map;
 	bool loaded = imported_map.open(nstr(filename.GetFullPath()));
@@ -423,7 +423,7 @@ void Selection::finish(SessionFlags flags) {
 	// Notify Lua scripts only if we're on the main thread and the selection actually changed
 	if (selectionChanged && !(flags & (INTERNAL | SUBTHREAD))) {
 		if (g_luaScripts.isInitialized()) {
-			g_luaScripts.emit("selectionChange");
+			g_luaScripts.emit(LuaScriptManager::EVENT_SELECTION_CHANGE);
 		}
 	}
 	selectionChanged = false;
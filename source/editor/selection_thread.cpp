@@ -28,7 +28,8 @@ SelectionThread::SelectionThread(Editor& editor, Position start, Position end) :
 	start(start),
 	end(end),
 	selection(editor),
-	result(nullptr) {
+	result(nullptr),
+	task(g_scheduler, TaskPriority::Interactive) {
 	////
 }
 
@@ -37,13 +38,11 @@ SelectionThread::~SelectionThread() {
 }
 
 void SelectionThread::Start() {
-	thread = std::thread(&SelectionThread::Work, this);
+	task.run([this]() { Work(); });
 }
 
 void SelectionThread::Wait() {
-	if (thread.joinable()) {
-		thread.join();
-	}
+	task.wait();
 }
 
 void SelectionThread::Work() {
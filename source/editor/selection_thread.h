@@ -18,8 +18,7 @@
 #ifndef RME_EDITOR_SELECTION_THREAD_H
 #define RME_EDITOR_SELECTION_THREAD_H
 
-#include <thread>
-
+#include "app/task_scheduler.h"
 #include "map/position.h"
 #include "editor/selection.h"
 
@@ -36,12 +35,13 @@ public:
 
 protected:
 	void Work();
-	std::thread thread;
 
 	Editor& editor;
 	Position start, end;
 	Selection selection;
 	std::unique_ptr<Action> result;
+	// Last, so the work is drained before the members it uses go away
+	TaskGroup task;
 
 	friend class Selection;
 };
@@ -0,0 +1,213 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "app/main.h"
+
+#include "editor/undo_arena.h"
+#include "map/basemap.h"
+#include "map/tile.h"
+#include "game/item.h"
+
+#include <cstring>
+#include <typeinfo>
+#include <spdlog/spdlog.h>
+#include <zlib.h>
+
+namespace {
+	enum : uint8_t {
+		ITEM_INLINE = 0,
+		ITEM_OBJECT = 1,
+	};
+
+	bool canInline(const Item& item) {
+		return item.getID() != 0 && typeid(item) == typeid(Item) && !item.hasAttributes() && !item.getInvalidOTBMData();
+	}
+}
+
+UndoArena::UndoArena() :
+	raw_size(0) {
+	////
+}
+
+UndoArena::~UndoArena() = default;
+
+template <typename T>
+void UndoArena::write(const T& value) {
+	const size_t offset = bytes.size();
+	bytes.resize(offset + sizeof(T));
+	memcpy(&bytes[offset], &value, sizeof(T));
+}
+
+template <typename T>
+T UndoArena::read(size_t& offset) const {
+	T value;
+	memcpy(&value, &bytes[offset], sizeof(T));
+	offset += sizeof(T);
+	return value;
+}
+
+std::optional<UndoArena::Record> UndoArena::pack(std::unique_ptr<Tile>& tile) {
+	if (!tile || tile->creature || tile->spawn || tile->invalidZones) {
+		return std::nullopt;
+	}
+	if (!decompress()) {
+		return std::nullopt;
+	}
+
+	const Record record { static_cast<uint32_t>(bytes.size()) };
+	write<uint32_t>(tile->house_id);
+	write<uint32_t>(tile->mapflags);
+	write<uint16_t>(tile->statflags);
+	write<uint8_t>(tile->minimapColor);
+
+	write<uint8_t>(tile->ground ? 1 : 0);
+	if (tile->ground) {
+		writeItem(std::move(tile->ground));
+	}
+
+	write<uint32_t>(static_cast<uint32_t>(tile->items.size()));
+	for (auto& item : tile->items) {
+		writeItem(std::move(item));
+	}
+
+	tile.reset();
+	return record;
+}
+
+std::unique_ptr<Tile> UndoArena::unpack(const Record& record, BaseMap& map, const Position& position) {
+	if (!decompress()) {
+		return nullptr;
+	}
+
+	std::unique_ptr<Tile> tile = map.allocator(map.createTileL(position));
+
+	size_t offset = record.offset;
+	tile->house_id = read<uint32_t>(offset);
+	tile->mapflags = read<uint32_t>(offset);
+	tile->statflags = read<uint16_t>(offset);
+	tile->minimapColor = read<uint8_t>(offset);
+
+	if (read<uint8_t>(offset)) {
+		tile->ground = readItem(offset);
+	}
+
+	const uint32_t count = read<uint32_t>(offset);
+	tile->items.reserve(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		if (std::unique_ptr<Item> item = readItem(offset)) {
+			tile->items.push_back(std::move(item));
+		}
+	}
+	return tile;
+}
+
+void UndoArena::writeItem(std::unique_ptr<Item> item) {
+	if (canInline(*item)) {
+		write<uint8_t>(ITEM_INLINE);
+		write<uint16_t>(item->getID());
+		write<uint16_t>(item->getSubtype());
+		write<uint8_t>(item->isSelected() ? 1 : 0);
+		return;
+	}
+
+	write<uint8_t>(ITEM_OBJECT);
+	write<uint32_t>(static_cast<uint32_t>(objects.size()));
+	objects.push_back(std::move(item));
+}
+
+std::unique_ptr<Item> UndoArena::readItem(size_t& offset) {
+	if (read<uint8_t>(offset) == ITEM_OBJECT) {
+		return std::move(objects[read<uint32_t>(offset)]);
+	}
+
+	const uint16_t id = read<uint16_t>(offset);
+	const uint16_t subtype = read<uint16_t>(offset);
+	const bool selected = read<uint8_t>(offset) != 0;
+
+	// Same reconstruction as Item::deepCopy
+	std::unique_ptr<Item> item = Item::Create(id, subtype);
+	if (item && selected) {
+		item->select();
+	}
+	return item;
+}
+
+void UndoArena::clear() {
+	bytes.clear();
+	objects.clear();
+	raw_size = 0;
+}
+
+void UndoArena::shrink() {
+	if (!isCompressed()) {
+		bytes.shrink_to_fit();
+	}
+	objects.shrink_to_fit();
+}
+
+bool UndoArena::compress() {
+	if (isCompressed()) {
+		return true;
+	}
+	if (bytes.empty()) {
+		return false;
+	}
+
+	std::vector<uint8_t> deflated(compressBound(static_cast<uLong>(bytes.size())));
+	uLongf deflatedSize = static_cast<uLongf>(deflated.size());
+	if (compress2(deflated.data(), &deflatedSize, bytes.data(), static_cast<uLong>(bytes.size()), Z_BEST_SPEED) != Z_OK) {
+		return false;
+	}
+	if (deflatedSize >= bytes.size()) {
+		return false;
+	}
+
+	deflated.resize(deflatedSize);
+	deflated.shrink_to_fit();
+	raw_size = bytes.size();
+	bytes = std::move(deflated);
+	return true;
+}
+
+bool UndoArena::decompress() {
+	if (!isCompressed()) {
+		return true;
+	}
+
+	std::vector<uint8_t> inflated(raw_size);
+	uLongf inflatedSize = static_cast<uLongf>(raw_size);
+	if (uncompress(inflated.data(), &inflatedSize, bytes.data(), static_cast<uLong>(bytes.size())) != Z_OK || inflatedSize != raw_size) {
+		spdlog::error("UndoArena: failed to inflate {} bytes of undo history", raw_size);
+		return false;
+	}
+
+	bytes = std::move(inflated);
+	raw_size = 0;
+	return true;
+}
+
+size_t UndoArena::memsize() const {
+	size_t mem = sizeof(*this);
+	mem += bytes.capacity();
+	mem += objects.capacity() * sizeof(std::unique_ptr<Item>);
+	for (const auto& item : objects) {
+		if (item) {
+			mem += item->memsize();
+		}
+	}
+	return mem;
+}
@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_EDITOR_UNDO_ARENA_H
+#define RME_EDITOR_UNDO_ARENA_H
+
+#include "map/position.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class BaseMap;
+class Item;
+class Tile;
+
+// Compact storage for the tiles an undo batch holds between undo/redo steps.
+//
+// A tile is written as a short record (house, flags, then one entry per item)
+// into a flat byte buffer shared by the whole batch. Plain items without
+// attributes, which is nearly everything a borderize or paste produces, are
+// stored inline as id/subtype/selection; anything whose state only lives in
+// the object (containers, doors, attributes, ...) is moved aside as-is.
+// Records are rebuilt into real tiles before the batch is undone or redone.
+class UndoArena {
+public:
+	struct Record {
+		uint32_t offset;
+	};
+
+	UndoArena();
+	~UndoArena();
+
+	UndoArena(const UndoArena&) = delete;
+	UndoArena& operator=(const UndoArena&) = delete;
+
+	// Consumes the tile on success. Tiles holding creatures, spawns or
+	// preserved invalid OTBM data are left alone; keep those as objects.
+	std::optional<Record> pack(std::unique_ptr<Tile>& tile);
+	std::unique_ptr<Tile> unpack(const Record& record, BaseMap& map, const Position& position);
+
+	void clear();
+	void shrink();
+
+	// Deflates the record buffer; unpacking or packing inflates it again.
+	bool compress();
+	bool isCompressed() const {
+		return raw_size != 0;
+	}
+
+	bool empty() const {
+		return bytes.empty() && objects.empty();
+	}
+	size_t memsize() const;
+
+private:
+	bool decompress();
+
+	template <typename T>
+	void write(const T& value);
+	template <typename T>
+	T read(size_t& offset) const;
+
+	void writeItem(std::unique_ptr<Item> item);
+	std::unique_ptr<Item> readItem(size_t& offset);
+
+	std::vector<uint8_t> bytes;
+	std::vector<std::unique_ptr<Item>> objects;
+	size_t raw_size; // Inflated size while compressed, 0 otherwise
+};
+
+#endif
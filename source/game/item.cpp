@@ -26,6 +26,7 @@
 #include "game/item.h"
 #include "brushes/managers/brush_manager.h"
 #include "item_definitions/core/item_definition_store.h"
+#include <mutex>
 #include <unordered_map>
 
 #include "brushes/ground/ground_brush.h"
@@ -77,25 +78,76 @@ std::unique_ptr<Item> Item::Create(uint16_t _type, uint16_t _subtype /*= 0xFFFF*
 Item::Item(unsigned short _type, unsigned short _count) :
 	id(_type),
 	subtype(1),
-	selected(false) {
+	selected(false),
+	hasInvalidOtbmData(false) {
 	if (hasSubtype()) {
 		subtype = _count;
 	}
 }
 
 Item::~Item() {
-	////
+	if (hasInvalidOtbmData) {
+		clearInvalidOTBMData();
+	}
+}
+
+namespace {
+	// Items loaded from broken OTBM nodes keep what they could not parse here.
+	// Loaders and the background grid release run on worker threads, hence the lock.
+	struct InvalidOTBMDataTable {
+		std::mutex mutex;
+		std::unordered_map<const Item*, std::unique_ptr<InvalidOTBMItemData>> entries;
+	};
+
+	InvalidOTBMDataTable& invalidOTBMDataTable() {
+		// Leaked so items destroyed during static destruction can still unregister.
+		static InvalidOTBMDataTable& table = *new InvalidOTBMDataTable;
+		return table;
+	}
+}
+
+const InvalidOTBMItemData* Item::getInvalidOTBMData() const {
+	if (!hasInvalidOtbmData) {
+		return nullptr;
+	}
+	InvalidOTBMDataTable& table = invalidOTBMDataTable();
+	std::scoped_lock lock(table.mutex);
+	const auto it = table.entries.find(this);
+	return it != table.entries.end() ? it->second.get() : nullptr;
+}
+
+void Item::setInvalidOTBMData(InvalidOTBMItemData data) {
+	auto stored = std::make_unique<InvalidOTBMItemData>(std::move(data));
+	InvalidOTBMDataTable& table = invalidOTBMDataTable();
+	std::scoped_lock lock(table.mutex);
+	table.entries[this] = std::move(stored);
+	hasInvalidOtbmData = true;
+}
+
+void Item::clearInvalidOTBMData() {
+	if (!hasInvalidOtbmData) {
+		return;
+	}
+	std::unique_ptr<InvalidOTBMItemData> removed; // Freed after the lock is released
+	InvalidOTBMDataTable& table = invalidOTBMDataTable();
+	std::scoped_lock lock(table.mutex);
+	const auto it = table.entries.find(this);
+	if (it != table.entries.end()) {
+		removed = std::move(it->second);
+		table.entries.erase(it);
+	}
+	hasInvalidOtbmData = false;
 }
 
 std::unique_ptr<Item> Item::deepCopy() const {
 	std::unique_ptr<Item> copy = Create(id, subtype);
 	if (copy) {
 		copy->selected = selected;
-		if (invalidOtbmData) {
-			copy->invalidOtbmData = std::make_unique<InvalidOTBMItemData>(*invalidOtbmData);
+		if (const InvalidOTBMItemData* invalidData = getInvalidOTBMData()) {
+			copy->setInvalidOTBMData(*invalidData);
 		}
 		if (attributes) {
-			copy->attributes = newd ItemAttributeMap(*attributes);
+			copy->attributes = ItemAttributeList::clone(*attributes);
 		}
 	}
 	return copy;
@@ -103,10 +155,10 @@ std::unique_ptr<Item> Item::deepCopy() const {
 
 uint32_t Item::memsize() const {
 	uint32_t mem = sizeof(*this);
-	if (invalidOtbmData) {
-		mem += static_cast<uint32_t>(invalidOtbmData->rawInlineBytes.capacity());
-		if (invalidOtbmData->rawNode) {
-			std::vector<const PreservedOTBMNode*> stack { &*invalidOtbmData->rawNode };
+	if (const InvalidOTBMItemData* invalidData = getInvalidOTBMData()) {
+		mem += static_cast<uint32_t>(invalidData->rawInlineBytes.capacity());
+		if (invalidData->rawNode) {
+			std::vector<const PreservedOTBMNode*> stack { &*invalidData->rawNode };
 			while (!stack.empty()) {
 				const PreservedOTBMNode* node = stack.back();
 				stack.pop_back();
@@ -265,23 +317,23 @@ int Item::getHeight() const {
 }
 
 void Item::setUniqueID(unsigned short n) {
-	setAttribute(ATTR_UID, n);
+	setAttribute(AttributeKeyTable::UID, n);
 }
 
 void Item::setActionID(unsigned short n) {
-	setAttribute(ATTR_AID, n);
+	setAttribute(AttributeKeyTable::AID, n);
 }
 
 void Item::setText(const std::string& str) {
-	setAttribute(ATTR_TEXT, str);
+	setAttribute(AttributeKeyTable::TEXT, str);
 }
 
 void Item::setDescription(const std::string& str) {
-	setAttribute(ATTR_DESC, str);
+	setAttribute(AttributeKeyTable::DESC, str);
 }
 
 void Item::setTier(unsigned short n) {
-	setAttribute(ATTR_TIER, n);
+	setAttribute(AttributeKeyTable::TIER, n);
 }
 
 double Item::getWeight() {
@@ -81,7 +81,7 @@ IMPLEMENT_INCREMENT_OP(SplashType)
 
 class Item : public ItemAttributes {
 public:
-	// Attribute keys
+	// Attribute key names; code inside the editor should prefer the AttributeKeyTable ids
 	inline static const std::string ATTR_UID = "uid";
 	inline static const std::string ATTR_AID = "aid";
 	inline static const std::string ATTR_TEXT = "text";
@@ -99,6 +99,11 @@ public:
 
 	virtual ~Item();
 
+	// Plain items (the bulk of any map) are carved from MapAllocator's item pool
+	// instead of the general heap; larger subclasses fall through to ::operator new.
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size) noexcept;
+
 	// Deep copy thingy
 	virtual std::unique_ptr<Item> deepCopy() const;
 
@@ -192,20 +197,17 @@ public:
 	bool typeExists() const {
 		return g_item_definitions.typeExists(id);
 	}
+	// Invalid OTBM data is rare, so it lives in a side table keyed by the item
+	// rather than taking a pointer in every item.
 	[[nodiscard]] bool isInvalidOTBMItem() const {
-		return invalidOtbmData != nullptr;
-	}
-	[[nodiscard]] const InvalidOTBMItemData* getInvalidOTBMData() const {
-		return invalidOtbmData.get();
-	}
-	void setInvalidOTBMData(InvalidOTBMItemData data) {
-		invalidOtbmData = std::make_unique<InvalidOTBMItemData>(std::move(data));
-	}
-	void clearInvalidOTBMData() {
-		invalidOtbmData.reset();
+		return hasInvalidOtbmData;
 	}
+	[[nodiscard]] const InvalidOTBMItemData* getInvalidOTBMData() const;
+	void setInvalidOTBMData(InvalidOTBMItemData data);
+	void clearInvalidOTBMData();
 	[[nodiscard]] InvalidOTBMItemMarkerColor invalidOTBMMarkerColor() const {
-		return invalidOtbmData ? invalidOtbmData->markerColor() : InvalidOTBMItemMarkerColor::None;
+		const InvalidOTBMItemData* data = getInvalidOTBMData();
+		return data ? data->markerColor() : InvalidOTBMItemMarkerColor::None;
 	}
 
 	// Usual attributes
@@ -300,7 +302,7 @@ public:
 		return static_cast<int>(getDefinition().attribute(ItemAttributeKey::AlwaysOnTopOrder));
 	}
 	bool isGroundTile() const {
-		return getDefinition().isGroundTile() || (invalidOtbmData && invalidOtbmData->isGroundLike());
+		return getDefinition().isGroundTile() || (hasInvalidOtbmData && getInvalidOTBMData()->isGroundLike());
 	}
 	bool isTranslucent() const {
 		return getDefinition().hasFlag(ItemFlag::Translucent);
@@ -402,7 +404,7 @@ public:
 		if (const auto definition = getDefinition()) {
 			return definition.name();
 		}
-		if (invalidOtbmData) {
+		if (hasInvalidOtbmData) {
 			return "Invalid Item";
 		}
 		return {};
@@ -410,7 +412,7 @@ public:
 	const std::string getFullName() const {
 		const auto definition = getDefinition();
 		if (!definition) {
-			return invalidOtbmData ? std::string("Invalid Item") : std::string();
+			return hasInvalidOtbmData ? std::string("Invalid Item") : std::string();
 		}
 		return std::string(definition.name()) + std::string(definition.editorSuffix());
 	}
@@ -471,7 +473,7 @@ protected:
 	// Subtype is either fluid type, count, subtype or charges
 	uint16_t subtype;
 	bool selected;
-	std::unique_ptr<InvalidOTBMItemData> invalidOtbmData;
+	bool hasInvalidOtbmData;
 
 private:
 	Item& operator=(const Item& i); // Can't copy
@@ -490,7 +492,7 @@ inline int Item::getCount() const {
 }
 
 inline uint16_t Item::getUniqueID() const {
-	const int32_t* a = getIntegerAttribute(ATTR_UID);
+	const int32_t* a = getIntegerAttribute(AttributeKeyTable::UID);
 	if (a) {
 		return *a;
 	}
@@ -498,7 +500,7 @@ inline uint16_t Item::getUniqueID() const {
 }
 
 inline uint16_t Item::getActionID() const {
-	const int32_t* a = getIntegerAttribute(ATTR_AID);
+	const int32_t* a = getIntegerAttribute(AttributeKeyTable::AID);
 	if (a) {
 		return *a;
 	}
@@ -506,7 +508,7 @@ inline uint16_t Item::getActionID() const {
 }
 
 inline uint16_t Item::getTier() const {
-	const int32_t* a = getIntegerAttribute(ATTR_TIER);
+	const int32_t* a = getIntegerAttribute(AttributeKeyTable::TIER);
 	if (a) {
 		return *a;
 	}
@@ -514,7 +516,7 @@ inline uint16_t Item::getTier() const {
 }
 
 inline std::string_view Item::getText() const {
-	const std::string* a = getStringAttribute(ATTR_TEXT);
+	const std::string* a = getStringAttribute(AttributeKeyTable::TEXT);
 	if (a) {
 		return *a;
 	}
@@ -522,7 +524,7 @@ inline std::string_view Item::getText() const {
 }
 
 inline std::string_view Item::getDescription() const {
-	const std::string* a = getStringAttribute(ATTR_DESC);
+	const std::string* a = getStringAttribute(AttributeKeyTable::DESC);
 	if (a) {
 		return *a;
 	}
@@ -19,17 +19,181 @@
 
 #include "game/item_attributes.h"
 #include "io/filehandle.h"
+#include <algorithm>
 #include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 #include <spdlog/spdlog.h>
 
+//=============================================================================
+// Attribute key intern table
+
+namespace {
+	struct KeyHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view key) const {
+			return std::hash<std::string_view> {}(key);
+		}
+	};
+
+	struct KeyTableData {
+		std::shared_mutex mutex;
+		std::deque<std::string> names; // deque: references stay valid as it grows
+		std::unordered_map<std::string, AttributeKeyId, KeyHash, std::equal_to<>> ids;
+
+		KeyTableData() {
+			// Order must match the constants in AttributeKeyTable
+			for (const char* name : { "uid", "aid", "text", "desc", "tier" }) {
+				ids.emplace(name, static_cast<AttributeKeyId>(names.size()));
+				names.emplace_back(name);
+			}
+		}
+	};
+
+	KeyTableData& keyTable() {
+		static KeyTableData table;
+		return table;
+	}
+}
+
+AttributeKeyId AttributeKeyTable::intern(std::string_view name) {
+	KeyTableData& table = keyTable();
+	{
+		std::shared_lock lock(table.mutex);
+		auto it = table.ids.find(name);
+		if (it != table.ids.end()) {
+			return it->second;
+		}
+	}
+
+	std::unique_lock lock(table.mutex);
+	auto [it, inserted] = table.ids.emplace(std::string(name), static_cast<AttributeKeyId>(table.names.size()));
+	if (inserted) {
+		table.names.emplace_back(name);
+	}
+	return it->second;
+}
+
+std::optional<AttributeKeyId> AttributeKeyTable::find(std::string_view name) {
+	KeyTableData& table = keyTable();
+	std::shared_lock lock(table.mutex);
+	auto it = table.ids.find(name);
+	if (it != table.ids.end()) {
+		return it->second;
+	}
+	return std::nullopt;
+}
+
+const std::string& AttributeKeyTable::name(AttributeKeyId key) {
+	KeyTableData& table = keyTable();
+	std::shared_lock lock(table.mutex);
+	return table.names[key];
+}
+
+//=============================================================================
+// Item attribute list
+
+static_assert(alignof(ItemAttributeList::Entry) <= alignof(std::max_align_t));
+static_assert(sizeof(uint32_t) * 2 % alignof(ItemAttributeList::Entry) == 0, "Entries must follow the header without padding");
+
+ItemAttributeList* ItemAttributeList::create(uint32_t capacity) {
+	void* memory = ::operator new(sizeof(ItemAttributeList) + capacity * sizeof(Entry));
+	return new (memory) ItemAttributeList(capacity);
+}
+
+ItemAttributeList* ItemAttributeList::clone(const ItemAttributeList& other) {
+	ItemAttributeList* list = create(std::max<uint32_t>(other.count, 1));
+	for (const Entry& entry : other) {
+		new (list->entries() + list->count) Entry(entry);
+		++list->count;
+	}
+	return list;
+}
+
+void ItemAttributeList::destroy(ItemAttributeList* list) noexcept {
+	if (list) {
+		list->~ItemAttributeList();
+		::operator delete(list);
+	}
+}
+
+ItemAttributeList::~ItemAttributeList() {
+	std::destroy_n(entries(), count);
+}
+
+ItemAttribute& ItemAttributeList::insert(ItemAttributeList*& list, AttributeKeyId key) {
+	if (!list) {
+		list = create(1);
+	}
+
+	Entry* first = list->entries();
+	Entry* last = first + list->count;
+	Entry* pos = std::lower_bound(first, last, key, [](const Entry& entry, AttributeKeyId k) { return entry.key < k; });
+	if (pos != last && pos->key == key) {
+		return pos->value;
+	}
+
+	const uint32_t index = static_cast<uint32_t>(pos - first);
+	if (list->count == list->capacity) {
+		ItemAttributeList* grown = create(list->capacity * 2);
+		std::uninitialized_move(first, last, grown->entries());
+		grown->count = list->count;
+		destroy(list);
+		list = grown;
+	}
+
+	// Open a gap at index and construct the new entry there
+	Entry* entries = list->entries();
+	if (index == list->count) {
+		new (entries + index) Entry { key, ItemAttribute() };
+	} else {
+		new (entries + list->count) Entry(std::move(entries[list->count - 1]));
+		std::move_backward(entries + index, entries + list->count - 1, entries + list->count);
+		entries[index] = Entry { key, ItemAttribute() };
+	}
+	++list->count;
+	return entries[index].value;
+}
+
+const ItemAttribute* ItemAttributeList::find(AttributeKeyId key) const {
+	const Entry* first = entries();
+	const Entry* last = first + count;
+	const Entry* pos = std::lower_bound(first, last, key, [](const Entry& entry, AttributeKeyId k) { return entry.key < k; });
+	if (pos != last && pos->key == key) {
+		return &pos->value;
+	}
+	return nullptr;
+}
+
+bool ItemAttributeList::erase(AttributeKeyId key) {
+	Entry* first = entries();
+	Entry* last = first + count;
+	Entry* pos = std::lower_bound(first, last, key, [](const Entry& entry, AttributeKeyId k) { return entry.key < k; });
+	if (pos == last || pos->key != key) {
+		return false;
+	}
+	std::move(pos + 1, last, pos);
+	std::destroy_at(last - 1);
+	--count;
+	return true;
+}
+
+//=============================================================================
+// Item attributes
+
 ItemAttributes::ItemAttributes() :
 	attributes(nullptr) {
 	////
 }
 
-ItemAttributes::ItemAttributes(const ItemAttributes& o) {
+ItemAttributes::ItemAttributes(const ItemAttributes& o) :
+	attributes(nullptr) {
 	if (o.attributes) {
-		attributes = newd ItemAttributeMap(*o.attributes);
+		attributes = ItemAttributeList::clone(*o.attributes);
 	}
 }
 
@@ -37,109 +201,126 @@ ItemAttributes::~ItemAttributes() {
 	clearAllAttributes();
 }
 
-void ItemAttributes::createAttributes() {
-	if (!attributes) {
-		attributes = newd ItemAttributeMap;
-	}
-}
-
 void ItemAttributes::clearAllAttributes() {
-	if (attributes) {
-		delete attributes;
-	}
+	ItemAttributeList::destroy(attributes);
 	attributes = nullptr;
 }
 
 ItemAttributeMap ItemAttributes::getAttributes() const {
+	ItemAttributeMap result;
 	if (attributes) {
-		return *attributes;
+		for (const auto& entry : *attributes) {
+			result.emplace(AttributeKeyTable::name(entry.key), entry.value);
+		}
 	}
-	return ItemAttributeMap();
+	return result;
+}
+
+void ItemAttributes::setAttribute(AttributeKeyId key, const ItemAttribute& value) {
+	ItemAttributeList::insert(attributes, key) = value;
+}
+
+void ItemAttributes::setAttribute(AttributeKeyId key, const std::string& value) {
+	ItemAttributeList::insert(attributes, key).set(value);
+}
+
+void ItemAttributes::setAttribute(AttributeKeyId key, int32_t value) {
+	ItemAttributeList::insert(attributes, key).set(value);
+}
+
+void ItemAttributes::setAttribute(AttributeKeyId key, double value) {
+	ItemAttributeList::insert(attributes, key).set(value);
+}
+
+void ItemAttributes::setAttribute(AttributeKeyId key, bool value) {
+	ItemAttributeList::insert(attributes, key).set(value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, const ItemAttribute& value) {
-	createAttributes();
-	(*attributes)[key] = value;
+	setAttribute(AttributeKeyTable::intern(key), value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, const std::string& value) {
-	createAttributes();
-	(*attributes)[key].set(value);
+	setAttribute(AttributeKeyTable::intern(key), value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, int32_t value) {
-	createAttributes();
-	(*attributes)[key].set(value);
+	setAttribute(AttributeKeyTable::intern(key), value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, double value) {
-	createAttributes();
-	(*attributes)[key].set(value);
+	setAttribute(AttributeKeyTable::intern(key), value);
 }
 
 void ItemAttributes::setAttribute(const std::string& key, bool value) {
-	createAttributes();
-	(*attributes)[key].set(value);
+	setAttribute(AttributeKeyTable::intern(key), value);
+}
+
+void ItemAttributes::eraseAttribute(AttributeKeyId key) {
+	if (attributes) {
+		attributes->erase(key);
+	}
 }
 
 void ItemAttributes::eraseAttribute(const std::string& key) {
 	if (!attributes) {
 		return;
 	}
-
-	ItemAttributeMap::iterator iter = attributes->find(key);
-
-	if (iter != attributes->end()) {
-		attributes->erase(iter);
+	if (const auto id = AttributeKeyTable::find(key)) {
+		attributes->erase(*id);
 	}
 }
 
-const std::string* ItemAttributes::getStringAttribute(const std::string& key) const {
+const ItemAttribute* ItemAttributes::findAttribute(AttributeKeyId key) const {
+	return attributes ? attributes->find(key) : nullptr;
+}
+
+const ItemAttribute* ItemAttributes::findAttribute(const std::string& key) const {
 	if (!attributes) {
 		return nullptr;
 	}
+	const auto id = AttributeKeyTable::find(key);
+	return id ? attributes->find(*id) : nullptr;
+}
 
-	ItemAttributeMap::iterator iter = attributes->find(key);
-	if (iter != attributes->end()) {
-		return iter->second.getString();
-	}
-	return nullptr;
+const std::string* ItemAttributes::getStringAttribute(AttributeKeyId key) const {
+	const ItemAttribute* attr = findAttribute(key);
+	return attr ? attr->getString() : nullptr;
 }
 
-const int32_t* ItemAttributes::getIntegerAttribute(const std::string& key) const {
-	if (!attributes) {
-		return nullptr;
-	}
+const int32_t* ItemAttributes::getIntegerAttribute(AttributeKeyId key) const {
+	const ItemAttribute* attr = findAttribute(key);
+	return attr ? attr->getInteger() : nullptr;
+}
 
-	ItemAttributeMap::iterator iter = attributes->find(key);
-	if (iter != attributes->end()) {
-		return iter->second.getInteger();
-	}
-	return nullptr;
+const double* ItemAttributes::getFloatAttribute(AttributeKeyId key) const {
+	const ItemAttribute* attr = findAttribute(key);
+	return attr ? attr->getFloat() : nullptr;
 }
 
-const double* ItemAttributes::getFloatAttribute(const std::string& key) const {
-	if (!attributes) {
-		return nullptr;
-	}
+const bool* ItemAttributes::getBooleanAttribute(AttributeKeyId key) const {
+	const ItemAttribute* attr = findAttribute(key);
+	return attr ? attr->getBoolean() : nullptr;
+}
 
-	ItemAttributeMap::iterator iter = attributes->find(key);
-	if (iter != attributes->end()) {
-		return iter->second.getFloat();
-	}
-	return nullptr;
+const std::string* ItemAttributes::getStringAttribute(const std::string& key) const {
+	const ItemAttribute* attr = findAttribute(key);
+	return attr ? attr->getString() : nullptr;
 }
 
-const bool* ItemAttributes::getBooleanAttribute(const std::string& key) const {
-	if (!attributes) {
-		return nullptr;
-	}
+const int32_t* ItemAttributes::getIntegerAttribute(const std::string& key) const {
+	const ItemAttribute* attr = findAttribute(key);
+	return attr ? attr->getInteger() : nullptr;
+}
 
-	ItemAttributeMap::iterator iter = attributes->find(key);
-	if (iter != attributes->end()) {
-		return iter->second.getBoolean();
-	}
-	return nullptr;
+const double* ItemAttributes::getFloatAttribute(const std::string& key) const {
+	const ItemAttribute* attr = findAttribute(key);
+	return attr ? attr->getFloat() : nullptr;
+}
+
+const bool* ItemAttributes::getBooleanAttribute(const std::string& key) const {
+	const ItemAttribute* attr = findAttribute(key);
+	return attr ? attr->getBoolean() : nullptr;
 }
 
 bool ItemAttributes::hasStringAttribute(const std::string& key) const {
@@ -244,7 +425,6 @@ bool ItemAttributes::unserializeAttributeMap(const IOMap& maphandle, BinaryNode*
 	uint16_t n;
 	if (stream->getU16(n)) {
 		spdlog::debug("unserializeAttributeMap: reading {} attributes", n);
-		createAttributes();
 
 		std::string key;
 		ItemAttribute attrib;
@@ -258,7 +438,7 @@ bool ItemAttributes::unserializeAttributeMap(const IOMap& maphandle, BinaryNode*
 				spdlog::warn("unserializeAttributeMap: failed to unserialize value for key='{}' (remaining={})", key, n + 1);
 				return false;
 			}
-			(*attributes)[key] = attrib;
+			setAttribute(AttributeKeyTable::intern(key), attrib);
 		}
 	}
 	return true;
@@ -266,20 +446,27 @@ bool ItemAttributes::unserializeAttributeMap(const IOMap& maphandle, BinaryNode*
 
 void ItemAttributes::serializeAttributeMap(const IOMap& maphandle, NodeFileWriteHandle& f) const {
 	// Maximum of 65535 attributes per item
-	f.addU16(std::min((size_t)0xFFFF, attributes->size()));
+	const size_t count = std::min<size_t>(0xFFFF, attributes->size());
+	f.addU16(static_cast<uint16_t>(count));
+
+	// Written in key name order, as the string-keyed map used to, so saves stay
+	// byte-identical regardless of the order keys were interned in.
+	std::vector<std::pair<const std::string*, const ItemAttribute*>> sorted;
+	sorted.reserve(attributes->size());
+	for (const auto& entry : *attributes) {
+		sorted.emplace_back(&AttributeKeyTable::name(entry.key), &entry.value);
+	}
+	std::ranges::sort(sorted, [](const auto& a, const auto& b) { return *a.first < *b.first; });
 
-	ItemAttributeMap::const_iterator attribute = attributes->begin();
-	int i = 0;
-	while (attribute != attributes->end() && i <= 0xFFFF) {
-		const std::string& key = attribute->first;
+	for (size_t i = 0; i < count; ++i) {
+		const std::string& key = *sorted[i].first;
 		if (key.size() > 0xFFFF) {
 			f.addString(key.substr(0, 65535));
 		} else {
 			f.addString(key);
 		}
 
-		attribute->second.serialize(maphandle, f);
-		++attribute, ++i;
+		sorted[i].second->serialize(maphandle, f);
 	}
 }
 
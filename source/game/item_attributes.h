@@ -19,7 +19,9 @@
 #define RME_ITEM_ATTRIBUTES_H_
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <optional>
 
 #include "io/filehandle.h"
 
@@ -40,7 +42,9 @@ public:
 	ItemAttribute(double f);
 	ItemAttribute(bool b);
 	ItemAttribute(const ItemAttribute& o);
+	ItemAttribute(ItemAttribute&& o) noexcept = default;
 	ItemAttribute& operator=(const ItemAttribute& o);
+	ItemAttribute& operator=(ItemAttribute&& o) noexcept = default;
 	~ItemAttribute();
 
 	enum Type {
@@ -71,8 +75,82 @@ private:
 	std::variant<std::monostate, std::string, int32_t, double, bool> m_value;
 };
 
+// Name -> value snapshot, for code that wants to see every attribute by name
+// (properties window, scripts). Items themselves store ItemAttributeList.
 using ItemAttributeMap = std::map<std::string, ItemAttribute>;
 
+using AttributeKeyId = uint32_t;
+
+// Global intern table for custom attribute names. Every distinct key string is
+// stored once and items refer to it by a small integer. The keys the editor uses
+// itself are registered up front so their ids are compile-time constants.
+class AttributeKeyTable {
+public:
+	static constexpr AttributeKeyId UID = 0;
+	static constexpr AttributeKeyId AID = 1;
+	static constexpr AttributeKeyId TEXT = 2;
+	static constexpr AttributeKeyId DESC = 3;
+	static constexpr AttributeKeyId TIER = 4;
+
+	// Returns the id for name, registering it if needed. Thread-safe.
+	static AttributeKeyId intern(std::string_view name);
+	// Returns the id for name without registering it.
+	static std::optional<AttributeKeyId> find(std::string_view name);
+	static const std::string& name(AttributeKeyId key);
+};
+
+// Attributes of a single item, kept sorted by key id in one allocation: a
+// small header followed directly by the entries. Items with one or two
+// attributes (an action id, a text) cost exactly one heap block. Even the
+// common uid/aid/tier are not kept inline in Item: they would grow every item
+// by 8 bytes, which only pays off once about one item in nine carries one.
+class ItemAttributeList {
+public:
+	struct Entry {
+		AttributeKeyId key;
+		ItemAttribute value;
+	};
+
+	static ItemAttributeList* create(uint32_t capacity);
+	static ItemAttributeList* clone(const ItemAttributeList& other);
+	static void destroy(ItemAttributeList* list) noexcept;
+
+	// Returns the value slot for key, inserting an empty one if missing. May
+	// reallocate, in which case list is updated to point at the new block.
+	static ItemAttribute& insert(ItemAttributeList*& list, AttributeKeyId key);
+
+	const ItemAttribute* find(AttributeKeyId key) const;
+	bool erase(AttributeKeyId key);
+
+	uint32_t size() const {
+		return count;
+	}
+	bool empty() const {
+		return count == 0;
+	}
+	const Entry* begin() const {
+		return entries();
+	}
+	const Entry* end() const {
+		return entries() + count;
+	}
+
+private:
+	ItemAttributeList(uint32_t capacity) :
+		count(0), capacity(capacity) { }
+	~ItemAttributeList();
+
+	Entry* entries() {
+		return reinterpret_cast<Entry*>(this + 1);
+	}
+	const Entry* entries() const {
+		return reinterpret_cast<const Entry*>(this + 1);
+	}
+
+	uint32_t count;
+	uint32_t capacity;
+};
+
 class ItemAttributes {
 public:
 	ItemAttributes();
@@ -84,6 +162,12 @@ public:
 	bool unserializeAttributeMap(const IOMap& maphandle, BinaryNode* node);
 
 public:
+	void setAttribute(AttributeKeyId key, const ItemAttribute& attr);
+	void setAttribute(AttributeKeyId key, const std::string& value);
+	void setAttribute(AttributeKeyId key, int32_t value);
+	void setAttribute(AttributeKeyId key, double value);
+	void setAttribute(AttributeKeyId key, bool set);
+
 	void setAttribute(const std::string& key, const ItemAttribute& attr);
 	void setAttribute(const std::string& key, const std::string& value);
 	void setAttribute(const std::string& key, int32_t value);
@@ -91,6 +175,11 @@ public:
 	void setAttribute(const std::string& key, bool set);
 
 	// returns nullptr if the attribute is not set
+	const std::string* getStringAttribute(AttributeKeyId key) const;
+	const int32_t* getIntegerAttribute(AttributeKeyId key) const;
+	const double* getFloatAttribute(AttributeKeyId key) const;
+	const bool* getBooleanAttribute(AttributeKeyId key) const;
+
 	const std::string* getStringAttribute(const std::string& key) const;
 	const int32_t* getIntegerAttribute(const std::string& key) const;
 	const double* getFloatAttribute(const std::string& key) const;
@@ -106,15 +195,17 @@ public:
 		return attributes && !attributes->empty();
 	}
 
+	void eraseAttribute(AttributeKeyId key);
 	void eraseAttribute(const std::string& key);
 
 	void clearAllAttributes();
 	ItemAttributeMap getAttributes() const;
 
 protected:
-	ItemAttributeMap* attributes;
+	ItemAttributeList* attributes;
 
-	void createAttributes();
+	const ItemAttribute* findAttribute(AttributeKeyId key) const;
+	const ItemAttribute* findAttribute(const std::string& key) const;
 };
 
 #endif
@@ -440,14 +440,8 @@ void BinaryNode::load() {
 		uint8_t* end = cache + cache_length;
 		uint8_t* p = start;
 
-		// Scan for special characters using a tight loop
-		// This avoids checking conditions and switch cases for every byte
-		for (; p < end; ++p) {
-			uint8_t c = *p;
-			if (c == NODE_START || c == NODE_END || c == ESCAPE_CHAR) {
-				break;
-			}
-		}
+		// Skip ahead to the next special character, several bytes at a time
+		p += NodeEscape::findSpecial(start, end - start);
 
 		// Append the chunk we scanned
 		size_t count = p - start;
@@ -720,3 +714,50 @@ bool NodeFileWriteHandle::addRAW(const uint8_t* ptr, size_t sz) {
 	writeBytes(ptr, sz);
 	return error_code == FILE_NO_ERROR;
 }
+
+bool NodeFileWriteHandle::addEncoded(const uint8_t* ptr, size_t sz) {
+	while (sz > 0 && error_code == FILE_NO_ERROR) {
+		const size_t count = std::min(sz, cache.size() - local_write_index);
+		memcpy(cache.data() + local_write_index, ptr, count);
+		local_write_index += count;
+		ptr += count;
+		sz -= count;
+		if (local_write_index >= cache.size()) {
+			if (!renewCache()) {
+				break;
+			}
+		}
+	}
+	return error_code == FILE_NO_ERROR;
+}
+
+void NodeFileWriteHandle::writeEscapedRuns(const uint8_t* ptr, size_t sz) {
+	while (sz > 0) {
+		size_t run = NodeEscape::findSpecial(ptr, sz);
+		sz -= run;
+		while (run > 0) {
+			const size_t count = std::min(run, cache.size() - local_write_index);
+			memcpy(cache.data() + local_write_index, ptr, count);
+			local_write_index += count;
+			ptr += count;
+			run -= count;
+			if (local_write_index >= cache.size() && !renewCache()) {
+				return;
+			}
+		}
+
+		if (sz == 0) {
+			return;
+		}
+
+		cache[local_write_index++] = ESCAPE_CHAR;
+		if (local_write_index >= cache.size() && !renewCache()) {
+			return;
+		}
+		cache[local_write_index++] = *ptr++;
+		if (local_write_index >= cache.size() && !renewCache()) {
+			return;
+		}
+		--sz;
+	}
+}
@@ -19,6 +19,7 @@
 #define RME_FILEHANDLE_H_
 
 #include "app/definitions.h"
+#include "io/node_escape.h"
 
 #include <stdexcept>
 #include <string>
@@ -32,6 +33,7 @@
 #include <iterator>
 #include <cstring>
 #include <string_view>
+#include <span>
 
 class wxFileName;
 using FileName = wxFileName;
@@ -367,6 +369,11 @@ public:
 		return true;
 	}
 
+	// The whole (escaped) buffer this handle reads from.
+	std::span<const uint8_t> buffer() const {
+		return { cache, cache_length };
+	}
+
 protected:
 	bool renewCache() override;
 
@@ -431,6 +438,10 @@ public:
 		return addRAW(reinterpret_cast<const uint8_t*>(c), strlen(c));
 	}
 
+	// Appends bytes that are already node-encoded (escaped and framed), such as the
+	// contents of a MemoryNodeFileWriteHandle, without escaping them again.
+	bool addEncoded(const uint8_t* ptr, size_t sz);
+
 	template <typename T>
 		requires std::is_trivially_copyable_v<T>
 	bool addValue(T val) {
@@ -450,25 +461,24 @@ protected:
 	size_t local_write_index;
 
 	FORCEINLINE void writeBytes(const uint8_t* ptr, size_t sz) {
-		while (sz > 0) {
-			if (*ptr == NODE_START || *ptr == NODE_END || *ptr == ESCAPE_CHAR) {
-				cache[local_write_index++] = ESCAPE_CHAR;
-				if (local_write_index >= cache.size()) {
-					if (!renewCache()) {
-						return;
-					}
+		// Most writes are single attributes of up to 8 bytes; if the cache can take
+		// them even fully escaped, skip the per-byte renew checks entirely.
+		if (sz <= sizeof(uint64_t) && cache.size() - local_write_index > 2 * sz) {
+			uint8_t* out = cache.data() + local_write_index;
+			for (size_t i = 0; i < sz; ++i) {
+				if (NodeEscape::isSpecial(ptr[i])) {
+					*out++ = ESCAPE_CHAR;
 				}
+				*out++ = ptr[i];
 			}
-			cache[local_write_index++] = *ptr;
-			if (local_write_index >= cache.size()) {
-				if (!renewCache()) {
-					return;
-				}
-			}
-			++ptr;
-			--sz;
+			local_write_index = out - cache.data();
+			return;
 		}
+		writeEscapedRuns(ptr, sz);
 	}
+
+	// Copies runs without special bytes with memcpy and escapes the bytes between them.
+	void writeEscapedRuns(const uint8_t* ptr, size_t sz);
 };
 
 class DiskNodeFileWriteHandle : public NodeFileWriteHandle {
@@ -23,12 +23,14 @@
 
 #include <format>
 #include <fstream>
+#include <span>
 #include <vector>
 #include <filesystem>
 #include <string_view>
 #include <spdlog/spdlog.h>
 
 #include "app/settings.h"
+#include "app/task_scheduler.h"
 #include "ext/pugixml.hpp"
 #include "ui/gui.h"
 #include "ui/dialog_util.h"
@@ -57,6 +59,60 @@
 using attribute_t = uint8_t;
 using flags_t = uint32_t;
 
+namespace {
+	// One node of an escaped OTBM buffer, from its NODE_START up to and including its NODE_END.
+	struct OTBMNodeRange {
+		size_t begin = 0;
+		size_t end = 0;
+		uint8_t type = 0;
+	};
+
+	// Collects the sibling nodes starting at offset (which must point at a NODE_START)
+	// up to the NODE_END that closes their parent. Any structural surprise returns false
+	// so the caller can leave damaged files to the serial reader and its recovery rules.
+	bool scanSiblingNodes(std::span<const uint8_t> data, size_t offset, std::vector<OTBMNodeRange>& out) {
+		size_t pos = offset;
+		while (pos < data.size()) {
+			if (data[pos] == NODE_END) {
+				return true;
+			}
+			if (data[pos] != NODE_START || pos + 1 >= data.size()) {
+				return false;
+			}
+
+			OTBMNodeRange range;
+			range.begin = pos;
+			range.type = data[pos + 1];
+			if (range.type == NODE_START || range.type == NODE_END || range.type == ESCAPE_CHAR) {
+				return false;
+			}
+
+			int depth = 0;
+			while (pos < data.size()) {
+				pos += NodeEscape::findSpecial(data.data() + pos, data.size() - pos);
+				if (pos >= data.size()) {
+					break;
+				}
+				const uint8_t c = data[pos++];
+				if (c == ESCAPE_CHAR) {
+					++pos;
+				} else if (c == NODE_START) {
+					++depth;
+				} else if (c == NODE_END && --depth == 0) {
+					break;
+				}
+			}
+			if (depth != 0 || pos > data.size()) {
+				return false;
+			}
+
+			range.end = pos;
+			out.push_back(range);
+		}
+		return false;
+	}
+}
+
 // Item OTBM operations delegated to ItemSerializationOTBM
 std::unique_ptr<Item> Item::Create_OTBM(const IOMap& maphandle, BinaryNode* stream) {
 	return ItemSerializationOTBM::createFromStream(maphandle, stream);
@@ -345,6 +401,15 @@ bool IOMapOTBM::readMapAttributes(Map& map, BinaryNode* mapHeaderNode) {
 }
 
 void IOMapOTBM::readMapNodes(Map& map, NodeFileReadHandle& f, BinaryNode* mapHeaderNode) {
+	if (g_scheduler.getWorkerCount() > 1) {
+		if (auto* memory_handle = dynamic_cast<MemoryNodeFileReadHandle*>(&f)) {
+			if (readMapNodesParallel(map, *memory_handle)) {
+				return;
+			}
+			spdlog::debug("Map nodes could not be pre-scanned, falling back to serial loading.");
+		}
+	}
+
 	spdlog::debug("Starting to read map nodes...");
 	int nodes_loaded = 0;
 
@@ -375,6 +440,91 @@ void IOMapOTBM::readMapNodes(Map& map, NodeFileReadHandle& f, BinaryNode* mapHea
 	}
 }
 
+bool IOMapOTBM::readMapNodesParallel(Map& map, MemoryNodeFileReadHandle& f) {
+	// The map data node has been read; if it has children the handle sits just past
+	// the NODE_START of the first one.
+	const std::span<const uint8_t> buffer = f.buffer();
+	const size_t first_child = f.tell() - 1;
+	if (f.tell() == 0 || first_child >= buffer.size() || buffer[first_child] != NODE_START) {
+		return false;
+	}
+
+	std::vector<OTBMNodeRange> nodes;
+	if (!scanSiblingNodes(buffer, first_child, nodes)) {
+		return false;
+	}
+
+	std::vector<size_t> areas;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (nodes[i].type == OTBM_TILE_AREA) {
+			areas.push_back(i);
+		}
+	}
+	if (areas.size() < 2) {
+		return false;
+	}
+
+	spdlog::debug("Decoding {} tile areas on {} workers...", areas.size(), g_scheduler.getWorkerCount());
+
+	struct DecodedArea {
+		std::vector<DecodedOTBMTile> tiles;
+		bool syntax_error = false;
+	};
+	std::vector<DecodedArea> decoded(nodes.size());
+	size_t merging = 0;
+
+	// Everything that touches the map happens in the consumer, in file order, so
+	// duplicate tiles, house creation and waypoint side effects resolve exactly as
+	// in the serial reader.
+	runOrdered(
+		g_scheduler, TaskPriority::Bulk, nodes.size(),
+		[&](size_t index) {
+			const OTBMNodeRange& range = nodes[index];
+			if (range.type != OTBM_TILE_AREA) {
+				return;
+			}
+			MemoryNodeFileReadHandle handle(buffer.data() + range.begin, range.end - range.begin);
+			uint8_t node_type;
+			if (BinaryNode* area_node = handle.getRootNode(); area_node && area_node->getByte(node_type)) {
+				TileSerializationOTBM::decodeTileArea(*this, area_node, decoded[index].tiles);
+			}
+			decoded[index].syntax_error = handle.error_code != FILE_NO_ERROR;
+		},
+		[&](size_t index) {
+			merging = index;
+			const OTBMNodeRange& range = nodes[index];
+			if (range.type != OTBM_TILE_AREA) {
+				MemoryNodeFileReadHandle handle(buffer.data() + range.begin, range.end - range.begin);
+				uint8_t node_type;
+				BinaryNode* node = handle.getRootNode();
+				if (!node || !node->getByte(node_type)) {
+					return true;
+				}
+				if (node_type == OTBM_TOWNS) {
+					readTowns(map, node);
+				} else if (node_type == OTBM_WAYPOINTS) {
+					readWaypoints(map, node);
+				}
+				return handle.error_code == FILE_NO_ERROR;
+			}
+
+			DecodedArea area = std::move(decoded[index]);
+			TileSerializationOTBM::mergeTileArea(map, area.tiles);
+
+			// The serial reader stops at the first syntax error, keep doing the same.
+			if (area.syntax_error) {
+				spdlog::warn("Syntax error in tile area at offset {}, remaining map nodes skipped.", range.begin);
+				return false;
+			}
+			return true;
+		},
+		[&]() {
+			g_gui.SetLoadDone(static_cast<int32_t>(100.0 * nodes[merging].begin / buffer.size()));
+		}
+	);
+	return true;
+}
+
 void IOMapOTBM::readTileArea(Map& map, BinaryNode* mapNode) {
 	TileSerializationOTBM::readTileArea(*this, map, mapNode);
 }
@@ -114,6 +114,10 @@ protected:
 	bool loadMapRoot(Map& map, NodeFileReadHandle& f, BinaryNode*& root, BinaryNode*& mapHeaderNode);
 	bool readMapAttributes(Map& map, BinaryNode* mapHeaderNode);
 	void readMapNodes(Map& map, NodeFileReadHandle& f, BinaryNode* mapHeaderNode);
+	// Decodes top-level tile areas on g_scheduler and merges them in file order.
+	// Returns false without touching the map when the buffer cannot be pre-scanned,
+	// in which case the caller falls back to the serial reader.
+	bool readMapNodesParallel(Map& map, MemoryNodeFileReadHandle& f);
 
 	void readTileArea(Map& map, BinaryNode* mapNode);
 	void readTowns(Map& map, BinaryNode* mapNode);
@@ -0,0 +1,224 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "io/mapped_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+	#include "util/common.h"
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& name, bool allow_mapping) {
+	close();
+
+	HANDLE handle = CreateFileW(string2wstring(name).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER length;
+	if (!GetFileSizeEx(handle, &length)) {
+		CloseHandle(handle);
+		return false;
+	}
+
+	file_handle = handle;
+	file_size = static_cast<size_t>(length.QuadPart);
+
+	if (allow_mapping) {
+		mapWholeFile();
+	}
+	return true;
+}
+
+bool MappedFile::mapWholeFile() {
+	if (file_size == 0) {
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(static_cast<HANDLE>(file_handle), nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data) {
+		CloseHandle(mapping);
+		return false;
+	}
+
+	mapping_handle = mapping;
+	mapped_data = static_cast<const uint8_t*>(data);
+	return true;
+}
+
+void MappedFile::close() {
+	if (mapped_data) {
+		UnmapViewOfFile(mapped_data);
+		mapped_data = nullptr;
+	}
+	if (mapping_handle) {
+		CloseHandle(static_cast<HANDLE>(mapping_handle));
+		mapping_handle = nullptr;
+	}
+	if (file_handle) {
+		CloseHandle(static_cast<HANDLE>(file_handle));
+		file_handle = nullptr;
+	}
+	file_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+	return file_handle != nullptr;
+}
+
+bool MappedFile::read(size_t offset, uint8_t* dest, size_t length) const {
+	if (offset > file_size || length > file_size - offset) {
+		return false;
+	}
+	if (mapped_data) {
+		std::memcpy(dest, mapped_data + offset, length);
+		return true;
+	}
+
+	while (length > 0) {
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFull);
+		overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+
+		const DWORD chunk = static_cast<DWORD>(std::min<size_t>(length, 0x40000000));
+		DWORD bytes_read = 0;
+		if (!ReadFile(static_cast<HANDLE>(file_handle), dest, chunk, &bytes_read, &overlapped) || bytes_read == 0) {
+			return false;
+		}
+		dest += bytes_read;
+		offset += bytes_read;
+		length -= bytes_read;
+	}
+	return true;
+}
+
+#else
+
+bool MappedFile::open(const std::string& name, bool allow_mapping) {
+	close();
+
+	const int handle = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+	if (handle < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(handle, &info) != 0) {
+		::close(handle);
+		return false;
+	}
+
+	fd = handle;
+	file_size = static_cast<size_t>(info.st_size);
+
+	if (allow_mapping) {
+		mapWholeFile();
+	}
+	return true;
+}
+
+bool MappedFile::mapWholeFile() {
+	if (file_size == 0) {
+		return false;
+	}
+
+	void* data = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	// Sprite lookups jump all over the archive; readahead would mostly be wasted.
+	madvise(data, file_size, MADV_RANDOM);
+
+	mapped_data = static_cast<const uint8_t*>(data);
+	return true;
+}
+
+void MappedFile::close() {
+	if (mapped_data) {
+		munmap(const_cast<uint8_t*>(mapped_data), file_size);
+		mapped_data = nullptr;
+	}
+	if (fd >= 0) {
+		::close(fd);
+		fd = -1;
+	}
+	file_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+	return fd >= 0;
+}
+
+bool MappedFile::read(size_t offset, uint8_t* dest, size_t length) const {
+	if (offset > file_size || length > file_size - offset) {
+		return false;
+	}
+	if (mapped_data) {
+		std::memcpy(dest, mapped_data + offset, length);
+		return true;
+	}
+
+	while (length > 0) {
+		const ssize_t bytes_read = pread(fd, dest, length, static_cast<off_t>(offset));
+		if (bytes_read < 0 && errno == EINTR) {
+			continue;
+		}
+		if (bytes_read <= 0) {
+			return false;
+		}
+		dest += bytes_read;
+		offset += static_cast<size_t>(bytes_read);
+		length -= static_cast<size_t>(bytes_read);
+	}
+	return true;
+}
+
+#endif
+
+std::span<const uint8_t> MappedFile::view(size_t offset, size_t length) const {
+	if (!mapped_data || offset > file_size || length > file_size - offset) {
+		return {};
+	}
+	return { mapped_data + offset, length };
+}
@@ -0,0 +1,70 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAPPED_FILE_H_
+#define RME_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Read-only view of a file that can be shared by any number of threads.
+// The file is memory-mapped when the platform allows it, so views are handed
+// out straight from the page cache. When mapping fails the file stays open
+// as a single handle and reads go through positional I/O (pread / overlapped
+// ReadFile), which needs no seek and therefore no locking.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& name, bool allow_mapping = true);
+	void close();
+
+	[[nodiscard]] bool isOpen() const;
+	[[nodiscard]] bool isMapped() const {
+		return mapped_data != nullptr;
+	}
+	[[nodiscard]] size_t size() const {
+		return file_size;
+	}
+
+	// Zero-copy view into the mapping. Returns an empty span when the file is not
+	// mapped or the range falls outside the file.
+	[[nodiscard]] std::span<const uint8_t> view(size_t offset, size_t length) const;
+
+	// Copies a range into caller storage. Works in both modes and is thread-safe.
+	[[nodiscard]] bool read(size_t offset, uint8_t* dest, size_t length) const;
+
+private:
+	bool mapWholeFile();
+
+#ifdef _WIN32
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#else
+	int fd = -1;
+#endif
+	const uint8_t* mapped_data = nullptr;
+	size_t file_size = 0;
+};
+
+#endif
@@ -0,0 +1,140 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_NODE_ESCAPE_H_
+#define RME_NODE_ESCAPE_H_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define RME_NODE_ESCAPE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define RME_NODE_ESCAPE_SSE2 1
+#endif
+
+// Helpers for the node file byte-stuffing scheme. NODE_START (0xFE), NODE_END
+// (0xFF) and ESCAPE_CHAR (0xFD) are the only bytes that need escaping, which
+// conveniently makes "special" the same as "byte >= 0xFD". That lets us scan
+// 32/16/8 bytes at a time and move everything in between with memcpy.
+namespace NodeEscape {
+	constexpr uint8_t FIRST_SPECIAL_BYTE = 0xFD;
+
+	[[nodiscard]] inline bool isSpecial(uint8_t c) {
+		return c >= FIRST_SPECIAL_BYTE;
+	}
+
+	// Returns the index of the first byte that needs escaping, or size if none does.
+	[[nodiscard]] inline size_t findSpecial(const uint8_t* data, size_t size) {
+		size_t i = 0;
+
+#if defined(RME_NODE_ESCAPE_AVX2)
+		const __m256i threshold = _mm256_set1_epi8(static_cast<char>(FIRST_SPECIAL_BYTE));
+		for (; i + 32 <= size; i += 32) {
+			const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			// max(c, 0xFD) == c  <=>  c >= 0xFD (unsigned)
+			const __m256i hit = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, threshold), chunk);
+			const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+			if (mask != 0) {
+				return i + std::countr_zero(mask);
+			}
+		}
+#endif
+
+#if defined(RME_NODE_ESCAPE_AVX2) || defined(RME_NODE_ESCAPE_SSE2)
+		const __m128i threshold16 = _mm_set1_epi8(static_cast<char>(FIRST_SPECIAL_BYTE));
+		for (; i + 16 <= size; i += 16) {
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			const __m128i hit = _mm_cmpeq_epi8(_mm_max_epu8(chunk, threshold16), chunk);
+			const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hit));
+			if (mask != 0) {
+				return i + std::countr_zero(mask);
+			}
+		}
+#endif
+
+		if constexpr (std::endian::native == std::endian::little) {
+			// SWAR: for each byte, (low 7 bits + 3) carries into bit 7 exactly when
+			// the low bits are >= 0x7D; combined with the byte's own bit 7 that is
+			// c >= 0xFD. The add cannot carry across bytes since 0x7F + 3 < 0x100.
+			constexpr uint64_t low_bits = 0x7F7F7F7F7F7F7F7Full;
+			constexpr uint64_t high_bits = 0x8080808080808080ull;
+			constexpr uint64_t bias = 0x0303030303030303ull;
+			for (; i + 8 <= size; i += 8) {
+				uint64_t word;
+				std::memcpy(&word, data + i, sizeof(word));
+				const uint64_t hit = ((word & low_bits) + bias) & word & high_bits;
+				if (hit != 0) {
+					return i + (std::countr_zero(hit) >> 3);
+				}
+			}
+		}
+
+		for (; i < size; ++i) {
+			if (isSpecial(data[i])) {
+				return i;
+			}
+		}
+		return size;
+	}
+
+	// Escapes size bytes from src into dst, which must have room for 2 * size bytes.
+	// Returns the number of bytes written.
+	inline size_t escape(const uint8_t* src, size_t size, uint8_t* dst) {
+		uint8_t* out = dst;
+		while (size > 0) {
+			const size_t run = findSpecial(src, size);
+			std::memcpy(out, src, run);
+			out += run;
+			src += run;
+			size -= run;
+			if (size == 0) {
+				break;
+			}
+			*out++ = 0xFD;
+			*out++ = *src++;
+			--size;
+		}
+		return static_cast<size_t>(out - dst);
+	}
+
+	// Reverses escape() for a buffer that contains no node markers. Returns the
+	// number of bytes written to dst (which may alias src).
+	inline size_t unescape(const uint8_t* src, size_t size, uint8_t* dst) {
+		uint8_t* out = dst;
+		while (size > 0) {
+			const size_t run = findSpecial(src, size);
+			std::memmove(out, src, run);
+			out += run;
+			src += run;
+			size -= run;
+			if (size < 2) {
+				break;
+			}
+			*out++ = src[1];
+			src += 2;
+			size -= 2;
+		}
+		return static_cast<size_t>(out - dst);
+	}
+}
+
+#endif
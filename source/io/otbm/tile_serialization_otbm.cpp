@@ -7,8 +7,10 @@
 #include "game/house.h"
 #include "io/otbm/item_serialization_otbm.h"
 #include "item_definitions/core/item_definition_store.h"
+#include "app/task_scheduler.h"
 #include "ui/gui.h"
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <vector>
 
@@ -92,52 +94,36 @@ namespace {
 	bool shouldTreatInlineItemAsGround(const Tile& tile) {
 		return !tile.hasGround() && tile.items.empty();
 	}
-}
-
-void TileSerializationOTBM::readTileArea(IOMapOTBM& iomap, Map& map, BinaryNode* mapNode) {
-	uint16_t base_x, base_y;
-	uint8_t base_z;
-	if (!mapNode->getU16(base_x) || !mapNode->getU16(base_y) || !mapNode->getU8(base_z)) {
-		return;
-	}
 
-	for (BinaryNode* tileNode : mapNode->children()) {
-		uint8_t tile_type;
+	// Reads the tile header that follows the type byte. house_id is left at 0 for
+	// plain tiles and for house tiles whose id could not be read.
+	bool readTileHeader(BinaryNode* tileNode, uint16_t base_x, uint16_t base_y, uint8_t base_z, Position& pos, uint8_t& tile_type, uint32_t& house_id) {
+		house_id = 0;
 		if (!tileNode->getByte(tile_type)) {
-			continue;
+			return false;
 		}
-
 		if (tile_type != OTBM_TILE && tile_type != OTBM_HOUSETILE) {
-			continue;
+			return false;
 		}
 
 		uint8_t x_offset, y_offset;
 		if (!tileNode->getU8(x_offset) || !tileNode->getU8(y_offset)) {
-			continue;
+			return false;
 		}
-
-		const Position pos(base_x + x_offset, base_y + y_offset, base_z);
-
-		if (map.getTile(pos)) {
-			continue;
-		}
-
-		Tile* tile = map.createTile(pos.x, pos.y, pos.z);
-		House* house = nullptr;
+		pos = Position(base_x + x_offset, base_y + y_offset, base_z);
 
 		if (tile_type == OTBM_HOUSETILE) {
-			uint32_t house_id;
-			if (tileNode->getU32(house_id) && house_id != 0) {
-				house = map.houses.getHouse(house_id);
-				if (!house) {
-					auto new_house = std::make_unique<House>(map);
-					house = new_house.get();
-					new_house->setID(house_id);
-					map.houses.addHouse(std::move(new_house));
-				}
+			uint32_t id;
+			if (tileNode->getU32(id)) {
+				house_id = id;
 			}
 		}
+		return true;
+	}
 
+	// Reads flags, inline items and item child nodes into tile. Touches nothing but
+	// the tile itself, so it is safe to run on detached tiles from worker threads.
+	void readTileContents(const IOMapOTBM& iomap, BinaryNode* tileNode, Tile* tile) {
 		uint8_t attribute;
 		bool stop_attributes = false;
 		while (!stop_attributes) {
@@ -237,72 +223,269 @@ void TileSerializationOTBM::readTileArea(IOMapOTBM& iomap, Map& map, BinaryNode*
 		}
 
 		TileOperations::update(tile);
-		if (house) {
-			house->addTile(tile);
-		}
 	}
-}
 
-void TileSerializationOTBM::writeTileData(const IOMapOTBM& iomap, const Map& map, NodeFileWriteHandle& f, const std::function<void(int)>& progressCb) {
-	uint32_t tiles_saved = 0;
-	bool first = true;
-	int local_x = -1, local_y = -1, local_z = -1;
+	// The OTBM_TILE_AREA node that is open while tiles are being written.
+	struct TileAreaCursor {
+		bool open = false;
+		int x = -1;
+		int y = -1;
+		int z = -1;
+	};
 
-	const uint64_t total_tiles = map.getTileCount();
+	bool isSavedTile(const Tile* tile) {
+		return tile && tile->size() != 0;
+	}
 
-	// Use modern ranges for iteration if possible, but the spatial hash grid iterator is already custom
-	auto sorted_cells = map.getGrid().getSortedCells();
-	for (const auto& sorted_cell : sorted_cells) {
-		SpatialHashGrid::GridCell* cell = sorted_cell.cell;
-		if (!cell) {
-			continue;
+	// Visits every tile the writer saves, in the exact order it saves them.
+	template <typename Visitor>
+	void forEachSavedTile(std::span<const SpatialHashGrid::SortedGridCell> cells, Visitor&& visitor) {
+		for (const auto& sorted_cell : cells) {
+			SpatialHashGrid::GridCell* cell = sorted_cell.cell;
+			if (!cell) {
+				continue;
+			}
+
+			for (int i = 0; i < SpatialHashGrid::NODES_IN_CELL; ++i) {
+				MapNode* node = cell->nodes[i].get();
+				if (!node) {
+					continue;
+				}
+
+				for (int j = 0; j < MAP_LAYERS; ++j) {
+					Floor* floor = node->getFloor(j);
+					if (!floor) {
+						continue;
+					}
+
+					for (int k = 0; k < SpatialHashGrid::TILES_PER_NODE; ++k) {
+						const Tile* save_tile = floor->locs[k].get();
+						if (isSavedTile(save_tile)) {
+							visitor(save_tile);
+						}
+					}
+				}
+			}
 		}
+	}
 
-		for (int i = 0; i < SpatialHashGrid::NODES_IN_CELL; ++i) {
-			MapNode* node = cell->nodes[i].get();
-			if (!node) {
+	// Same traversal as forEachSavedTile, backwards, stopping at the first hit.
+	const Tile* findLastSavedTile(std::span<const SpatialHashGrid::SortedGridCell> cells) {
+		for (auto cell_it = cells.rbegin(); cell_it != cells.rend(); ++cell_it) {
+			SpatialHashGrid::GridCell* cell = cell_it->cell;
+			if (!cell) {
 				continue;
 			}
 
-			for (int j = 0; j < MAP_LAYERS; ++j) {
-				Floor* floor = node->getFloor(j);
-				if (!floor) {
+			for (int i = SpatialHashGrid::NODES_IN_CELL - 1; i >= 0; --i) {
+				MapNode* node = cell->nodes[i].get();
+				if (!node) {
 					continue;
 				}
 
-				for (int k = 0; k < SpatialHashGrid::TILES_PER_NODE; ++k) {
-					Tile* save_tile = floor->locs[k].get();
-					if (!save_tile || save_tile->size() == 0) {
+				for (int j = MAP_LAYERS - 1; j >= 0; --j) {
+					Floor* floor = node->getFloor(j);
+					if (!floor) {
 						continue;
 					}
 
-					++tiles_saved;
-					if (tiles_saved % 8192 == 0 && total_tiles > 0 && progressCb) {
-						progressCb(std::min(100, static_cast<int>(100.0 * tiles_saved / total_tiles)));
+					for (int k = SpatialHashGrid::TILES_PER_NODE - 1; k >= 0; --k) {
+						const Tile* save_tile = floor->locs[k].get();
+						if (isSavedTile(save_tile)) {
+							return save_tile;
+						}
 					}
+				}
+			}
+		}
+		return nullptr;
+	}
 
-					const Position& pos = save_tile->getPosition();
+	TileAreaCursor areaOf(const Position& pos) {
+		return TileAreaCursor { .open = true, .x = pos.x & 0xFF00, .y = pos.y & 0xFF00, .z = pos.z };
+	}
 
-					// Decide if new node should be created
-					if (first || pos.x < local_x || pos.x >= local_x + 256 || pos.y < local_y || pos.y >= local_y + 256 || pos.z != local_z) {
-						if (!first) {
-							f.endNode();
-						}
-						first = false;
+	// Writes the tiles of cells, opening a new OTBM_TILE_AREA whenever a tile falls
+	// outside the one described by cursor. The last area is left open for the caller.
+	template <typename OnTile>
+	void writeCells(const IOMapOTBM& iomap, std::span<const SpatialHashGrid::SortedGridCell> cells, NodeFileWriteHandle& f, TileAreaCursor& cursor, OnTile&& onTile) {
+		forEachSavedTile(cells, [&](const Tile* save_tile) {
+			onTile();
 
-						f.addNode(OTBM_TILE_AREA);
-						f.addU16(local_x = pos.x & 0xFF00);
-						f.addU16(local_y = pos.y & 0xFF00);
-						f.addU8(local_z = pos.z);
-					}
+			const Position& pos = save_tile->getPosition();
 
-					serializeTile(iomap, save_tile, f);
+			// Decide if new node should be created
+			if (!cursor.open || pos.x < cursor.x || pos.x >= cursor.x + 256 || pos.y < cursor.y || pos.y >= cursor.y + 256 || pos.z != cursor.z) {
+				if (cursor.open) {
+					f.endNode();
 				}
+				cursor = areaOf(pos);
+
+				f.addNode(OTBM_TILE_AREA);
+				f.addU16(cursor.x);
+				f.addU16(cursor.y);
+				f.addU8(cursor.z);
 			}
+
+			TileSerializationOTBM::serializeTile(iomap, save_tile, f);
+		});
+	}
+
+	void attachToHouse(Map& map, Tile* tile, uint32_t house_id) {
+		if (house_id == 0) {
+			return;
+		}
+
+		House* house = map.houses.getHouse(house_id);
+		if (!house) {
+			auto new_house = std::make_unique<House>(map);
+			house = new_house.get();
+			new_house->setID(house_id);
+			map.houses.addHouse(std::move(new_house));
+		}
+		house->addTile(tile);
+	}
+}
+
+void TileSerializationOTBM::readTileArea(IOMapOTBM& iomap, Map& map, BinaryNode* mapNode) {
+	uint16_t base_x, base_y;
+	uint8_t base_z;
+	if (!mapNode->getU16(base_x) || !mapNode->getU16(base_y) || !mapNode->getU8(base_z)) {
+		return;
+	}
+
+	for (BinaryNode* tileNode : mapNode->children()) {
+		Position pos;
+		uint8_t tile_type;
+		uint32_t house_id;
+		if (!readTileHeader(tileNode, base_x, base_y, base_z, pos, tile_type, house_id)) {
+			continue;
+		}
+
+		if (map.getTile(pos)) {
+			continue;
+		}
+
+		Tile* tile = map.createTile(pos.x, pos.y, pos.z);
+		readTileContents(iomap, tileNode, tile);
+		attachToHouse(map, tile, house_id);
+	}
+}
+
+void TileSerializationOTBM::decodeTileArea(const IOMapOTBM& iomap, BinaryNode* mapNode, std::vector<DecodedOTBMTile>& out) {
+	uint16_t base_x, base_y;
+	uint8_t base_z;
+	if (!mapNode->getU16(base_x) || !mapNode->getU16(base_y) || !mapNode->getU8(base_z)) {
+		return;
+	}
+
+	for (BinaryNode* tileNode : mapNode->children()) {
+		Position pos;
+		uint8_t tile_type;
+		uint32_t house_id;
+		if (!readTileHeader(tileNode, base_x, base_y, base_z, pos, tile_type, house_id)) {
+			continue;
+		}
+
+		auto tile = std::make_unique<Tile>(pos.x, pos.y, pos.z);
+		readTileContents(iomap, tileNode, tile.get());
+		out.push_back(DecodedOTBMTile { .tile = std::move(tile), .house_id = house_id });
+	}
+}
+
+void TileSerializationOTBM::mergeTileArea(Map& map, std::vector<DecodedOTBMTile>& tiles) {
+	for (auto& decoded : tiles) {
+		const Position pos = decoded.tile->getPosition();
+		// Same first-wins rule as readTileArea: later duplicates are dropped.
+		if (map.getTile(pos)) {
+			continue;
 		}
+
+		Tile* tile = decoded.tile.get();
+		(void)map.setTile(pos, std::move(decoded.tile));
+		attachToHouse(map, tile, decoded.house_id);
+	}
+	tiles.clear();
+}
+
+void TileSerializationOTBM::writeTileData(const IOMapOTBM& iomap, const Map& map, NodeFileWriteHandle& f, const std::function<void(int)>& progressCb) {
+	const auto sorted_cells = map.getGrid().getSortedCells();
+	if (g_scheduler.getWorkerCount() > 1 && sorted_cells.size() > CELLS_PER_WRITE_CHUNK) {
+		writeTileDataParallel(iomap, map, sorted_cells, f, progressCb);
+		return;
 	}
 
-	if (!first) {
+	uint32_t tiles_saved = 0;
+	const uint64_t total_tiles = map.getTileCount();
+
+	TileAreaCursor cursor;
+	writeCells(iomap, sorted_cells, f, cursor, [&]() {
+		++tiles_saved;
+		if (tiles_saved % 8192 == 0 && total_tiles > 0 && progressCb) {
+			progressCb(std::min(100, static_cast<int>(100.0 * tiles_saved / total_tiles)));
+		}
+	});
+
+	if (cursor.open) {
+		f.endNode();
+	}
+}
+
+void TileSerializationOTBM::writeTileDataParallel(const IOMapOTBM& iomap, const Map& map, std::span<const SpatialHashGrid::SortedGridCell> cells, NodeFileWriteHandle& f, const std::function<void(int)>& progressCb) {
+	struct Chunk {
+		std::span<const SpatialHashGrid::SortedGridCell> cells;
+		TileAreaCursor entry;
+		std::unique_ptr<MemoryNodeFileWriteHandle> output;
+	};
+
+	// Each chunk is written on its own, so it needs to know which tile area is open
+	// when it starts. That is always the area of the last tile saved before it.
+	std::vector<Chunk> chunks;
+	chunks.reserve((cells.size() + CELLS_PER_WRITE_CHUNK - 1) / CELLS_PER_WRITE_CHUNK);
+	TileAreaCursor cursor;
+	for (size_t begin = 0; begin < cells.size(); begin += CELLS_PER_WRITE_CHUNK) {
+		Chunk& chunk = chunks.emplace_back();
+		chunk.cells = cells.subspan(begin, std::min(CELLS_PER_WRITE_CHUNK, cells.size() - begin));
+		chunk.entry = cursor;
+		if (const Tile* last = findLastSavedTile(chunk.cells)) {
+			cursor = areaOf(last->getPosition());
+		}
+	}
+	const TileAreaCursor final_cursor = cursor;
+
+	std::atomic<uint64_t> tiles_saved { 0 };
+	const uint64_t total_tiles = map.getTileCount();
+
+	// Chunks are appended strictly in key order; escaping is byte-local, so the
+	// concatenation is identical to what the serial writer produces.
+	runOrdered(
+		g_scheduler, TaskPriority::Bulk, chunks.size(),
+		[&](size_t index) {
+			Chunk& chunk = chunks[index];
+			chunk.output = std::make_unique<MemoryNodeFileWriteHandle>();
+			TileAreaCursor chunk_cursor = chunk.entry;
+			writeCells(iomap, chunk.cells, *chunk.output, chunk_cursor, [&]() {
+				tiles_saved.fetch_add(1, std::memory_order_relaxed);
+			});
+		},
+		[&](size_t index) {
+			const std::unique_ptr<MemoryNodeFileWriteHandle> output = std::move(chunks[index].output);
+			if (output) {
+				f.addEncoded(output->getMemory(), output->getSize());
+				if (output->error_code != FILE_NO_ERROR && f.error_code == FILE_NO_ERROR) {
+					f.error_code = output->error_code;
+				}
+			}
+			return true;
+		},
+		[&]() {
+			if (progressCb && total_tiles > 0) {
+				progressCb(std::min(100, static_cast<int>(100.0 * tiles_saved.load(std::memory_order_relaxed) / total_tiles)));
+			}
+		}
+	);
+
+	if (final_cursor.open) {
 		f.endNode();
 	}
 }
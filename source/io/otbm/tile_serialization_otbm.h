@@ -18,7 +18,13 @@
 #ifndef RME_TILE_SERIALIZATION_OTBM_H_
 #define RME_TILE_SERIALIZATION_OTBM_H_
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "map/spatial_hash_grid.h"
 
 class Map;
 class BinaryNode;
@@ -26,11 +32,28 @@ class NodeFileWriteHandle;
 class Tile;
 class IOMapOTBM;
 
+// A tile decoded away from the map, waiting to be placed by mergeTileArea.
+struct DecodedOTBMTile {
+	std::unique_ptr<Tile> tile;
+	uint32_t house_id = 0;
+};
+
 class TileSerializationOTBM {
 public:
 	static void readTileArea(IOMapOTBM& iomap, Map& map, BinaryNode* mapNode);
+	// Thread-safe half of readTileArea: decodes every tile of the area into detached tiles.
+	static void decodeTileArea(const IOMapOTBM& iomap, BinaryNode* mapNode, std::vector<DecodedOTBMTile>& out);
+	// Main-thread half of readTileArea: places decoded tiles in file order with the same first-wins and house rules.
+	static void mergeTileArea(Map& map, std::vector<DecodedOTBMTile>& tiles);
 	static void writeTileData(const IOMapOTBM& iomap, const Map& map, NodeFileWriteHandle& f, const std::function<void(int)>& progressCb = nullptr);
 	static void serializeTile(const IOMapOTBM& iomap, const Tile* tile, NodeFileWriteHandle& f);
+
+private:
+	// Number of grid cells serialized into one memory buffer by the parallel writer.
+	static constexpr size_t CELLS_PER_WRITE_CHUNK = 16;
+
+	// Serializes chunks of cells on g_scheduler and appends them to f in key order.
+	static void writeTileDataParallel(const IOMapOTBM& iomap, const Map& map, std::span<const SpatialHashGrid::SortedGridCell> cells, NodeFileWriteHandle& f, const std::function<void(int)>& progressCb);
 };
 
 #endif
@@ -2,10 +2,12 @@
 #define RME_ITEM_DEFINITIONS_CORE_ASSET_BUNDLE_H_
 
 #include "item_definitions/core/item_definition_store.h"
+#include "item_definitions/core/item_definition_snapshot.h"
 #include "item_definitions/core/missing_item_report.h"
 #include "item_definitions/formats/dat/dat_catalog.h"
 
 #include <memory>
+#include <optional>
 #include <vector>
 #include <wx/filename.h>
 
@@ -27,6 +29,17 @@ struct AssetBundle {
 	ItemDefinitionFragments fragments;
 	std::vector<ResolvedItemDefinitionRow> rows;
 	MissingItemReport missing_items;
+
+	// Snapshot of the resolved definitions. When one matched, fragments and
+	// rows stay empty and install() copies the store from it; if that copy
+	// fails, install() drops the snapshot and assembles from the request
+	// instead. Otherwise install() writes a new one from the rebuilt store.
+	std::unique_ptr<ItemDefinitionSnapshot> definition_snapshot;
+	std::optional<uint64_t> definition_key;
+	wxFileName definition_snapshot_path;
+	AssetLoadRequest definition_request;
+	std::vector<std::string> definition_warnings; // Raised while assembling, replayed on later loads
+	size_t definition_warnings_at = 0; // Where the replayed ones start in the load's warnings
 };
 
 #endif
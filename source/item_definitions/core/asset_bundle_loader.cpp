@@ -6,6 +6,10 @@
 #include "rendering/core/graphics_assembler.h"
 #include "rendering/core/sprite_archive.h"
 
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include <wx/filefn.h>
+
 namespace {
 	ItemDefinitionLoadInput toDefinitionInput(const AssetLoadRequest& request, const DatCatalog& dat_catalog) {
 		return ItemDefinitionLoadInput {
@@ -18,6 +22,16 @@ namespace {
 			.dat_catalog = &dat_catalog,
 		};
 	}
+
+	bool assembleDefinitions(AssetBundle& bundle, const ItemDefinitionLoadInput& input, wxString& error, std::vector<std::string>& warnings) {
+		const size_t first_warning = warnings.size();
+		ItemDefinitionsLoader definitions_loader;
+		if (!definitions_loader.assemble(input, bundle.fragments, bundle.rows, error, warnings, &bundle.missing_items)) {
+			return false;
+		}
+		bundle.definition_warnings.assign(warnings.begin() + first_warning, warnings.end());
+		return true;
+	}
 }
 
 bool AssetBundleLoader::load(const AssetLoadRequest& request, AssetBundle& bundle, wxString& error, std::vector<std::string>& warnings) const {
@@ -42,12 +56,25 @@ bool AssetBundleLoader::load(const AssetLoadRequest& request, AssetBundle& bundl
 		return false;
 	}
 
-	ItemDefinitionsLoader definitions_loader;
-	if (!definitions_loader.assemble(toDefinitionInput(request, bundle.dat_catalog), bundle.fragments, bundle.rows, error, warnings, &bundle.missing_items)) {
-		return false;
+	bundle.definition_request = request;
+	const ItemDefinitionLoadInput resolve_input = toDefinitionInput(request, bundle.dat_catalog);
+	if (request.client_version) {
+		bundle.definition_key = ItemDefinitionSnapshot::computeKey(resolve_input);
+		bundle.definition_snapshot_path = ItemDefinitionSnapshot::pathFor(*request.client_version);
+	}
+	if (bundle.definition_key) {
+		const size_t first_warning = warnings.size();
+		auto snapshot = std::make_unique<ItemDefinitionSnapshot>();
+		if (snapshot->open(bundle.definition_snapshot_path, *bundle.definition_key, bundle.missing_items, warnings)) {
+			spdlog::info("Item definitions loaded from snapshot {}", bundle.definition_snapshot_path.GetFullPath().utf8_string());
+			bundle.definition_snapshot = std::move(snapshot);
+			bundle.definition_warnings.assign(warnings.begin() + first_warning, warnings.end());
+			bundle.definition_warnings_at = first_warning;
+			return true;
+		}
 	}
 
-	return true;
+	return assembleDefinitions(bundle, resolve_input, error, warnings);
 }
 
 bool AssetBundleLoader::install(AssetBundle& bundle, GraphicManager& graphics, ItemDefinitionStore& store, wxString& error, std::vector<std::string>& warnings) const {
@@ -55,6 +82,32 @@ bool AssetBundleLoader::install(AssetBundle& bundle, GraphicManager& graphics, I
 		return false;
 	}
 
+	if (bundle.definition_snapshot) {
+		const bool installed = bundle.definition_snapshot->install(store);
+		bundle.definition_snapshot.reset();
+		if (installed) {
+			return true;
+		}
+
+		// Passed its checksum but does not match this build's layout. Drop it
+		// and assemble from the inputs as if it had never been there, taking
+		// back the warnings it replayed so they are not reported twice.
+		spdlog::warn("Item definition snapshot {} does not match this build, rebuilding", bundle.definition_snapshot_path.GetFullPath().utf8_string());
+		wxRemoveFile(bundle.definition_snapshot_path.GetFullPath());
+		const size_t replayed_end = std::min(warnings.size(), bundle.definition_warnings_at + bundle.definition_warnings.size());
+		if (bundle.definition_warnings_at < replayed_end) {
+			warnings.erase(warnings.begin() + bundle.definition_warnings_at, warnings.begin() + replayed_end);
+		}
+		bundle.definition_warnings.clear();
+		bundle.missing_items = {};
+		if (!assembleDefinitions(bundle, toDefinitionInput(bundle.definition_request, bundle.dat_catalog), error, warnings)) {
+			return false;
+		}
+	}
+
 	ItemDefinitionStoreBuilder::build(store, bundle.fragments.version, bundle.rows);
+	if (bundle.definition_key && ItemDefinitionSnapshot::write(bundle.definition_snapshot_path, *bundle.definition_key, store, bundle.missing_items, bundle.definition_warnings)) {
+		spdlog::info("Item definition snapshot written to {}", bundle.definition_snapshot_path.GetFullPath().utf8_string());
+	}
 	return true;
 }
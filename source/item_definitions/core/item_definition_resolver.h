@@ -8,6 +8,10 @@ struct DatCatalog;
 
 class ItemDefinitionResolver {
 public:
+	// Bump whenever resolve() would produce different rows from the same
+	// inputs; item definition snapshots keyed on an older value are rebuilt.
+	static constexpr uint32_t RESOLVER_VERSION = 1;
+
 	static bool resolve(const ItemDefinitionLoadInput& input, const ItemDefinitionFragments& fragments, std::vector<ResolvedItemDefinitionRow>& rows, wxString& error, std::vector<std::string>& warnings, MissingItemReport* missingReport = nullptr);
 
 private:
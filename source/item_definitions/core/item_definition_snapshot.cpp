@@ -0,0 +1,505 @@
+#include "item_definitions/core/item_definition_snapshot.h"
+
+#include "item_definitions/core/item_definition_recipe.h"
+#include "item_definitions/core/item_definition_resolver.h"
+#include "item_definitions/formats/dat/dat_item_parser.h"
+#include "item_definitions/formats/otb/otb_item_parser.h"
+#include "item_definitions/formats/xml/xml_item_parser.h"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <spdlog/spdlog.h>
+#include <wx/filefn.h>
+
+namespace {
+	constexpr char SNAPSHOT_MAGIC[8] = { 'R', 'M', 'E', 'I', 'D', 'S', 'N', 'P' };
+	constexpr const char* SNAPSHOT_FILE_NAME = "item_definitions.snapshot";
+
+	struct SnapshotHeader {
+		char magic[8];
+		uint32_t format_version;
+		uint32_t row_count;
+		uint64_t key;
+		uint32_t major_version;
+		uint32_t minor_version;
+		uint32_t build_number;
+		uint32_t reserved;
+		uint64_t columns_size; // Column section, directly after the header
+		uint64_t payload_size; // Everything after the header
+		uint64_t payload_hash;
+	};
+	static_assert(std::is_trivially_copyable_v<SnapshotHeader>);
+
+	//=========================================================================
+	// Content hashing
+
+	constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+
+	uint64_t load64(const uint8_t* data) {
+		uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint64_t hashRound(uint64_t acc, uint64_t lane) {
+		acc += lane * PRIME2;
+		return std::rotl(acc, 31) * PRIME1;
+	}
+
+	uint64_t avalanche(uint64_t h) {
+		h ^= h >> 33;
+		h *= PRIME2;
+		h ^= h >> 29;
+		h *= PRIME3;
+		h ^= h >> 32;
+		return h;
+	}
+
+	// Four independent lanes keep the multiplier busy; the inputs run to tens
+	// of megabytes and are hashed on every load.
+	uint64_t hashBytes(std::span<const uint8_t> data, uint64_t seed) {
+		const uint8_t* p = data.data();
+		const size_t size = data.size();
+		size_t i = 0;
+
+		uint64_t h;
+		if (size >= 32) {
+			uint64_t lanes[4] = { seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 };
+			for (; i + 32 <= size; i += 32) {
+				lanes[0] = hashRound(lanes[0], load64(p + i));
+				lanes[1] = hashRound(lanes[1], load64(p + i + 8));
+				lanes[2] = hashRound(lanes[2], load64(p + i + 16));
+				lanes[3] = hashRound(lanes[3], load64(p + i + 24));
+			}
+			h = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+		} else {
+			h = seed + PRIME3;
+		}
+
+		for (; i + 8 <= size; i += 8) {
+			h = std::rotl(h ^ hashRound(0, load64(p + i)), 27) * PRIME1 + PRIME3;
+		}
+		for (; i < size; ++i) {
+			h = std::rotl(h ^ (p[i] * PRIME3), 11) * PRIME1;
+		}
+		return avalanche(h ^ size);
+	}
+
+	uint64_t combine(uint64_t h, uint64_t value) {
+		return avalanche(h ^ (value + PRIME1 + (h << 6) + (h >> 2)));
+	}
+
+	bool hashFile(const wxFileName& path, uint64_t& hash) {
+		MappedFile file;
+		if (!file.open(path.GetFullPath().ToStdString())) {
+			return false;
+		}
+
+		if (file.isMapped()) {
+			hash = hashBytes(file.view(0, file.size()), 0);
+			return true;
+		}
+
+		std::vector<uint8_t> contents(file.size());
+		if (!contents.empty() && !file.read(0, contents.data(), contents.size())) {
+			return false;
+		}
+		hash = hashBytes(contents, 0);
+		return true;
+	}
+
+	//=========================================================================
+	// Encoding
+
+	class SnapshotWriter {
+	public:
+		template <typename T>
+		void value(const T& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			const auto* raw = reinterpret_cast<const uint8_t*>(&v);
+			bytes.insert(bytes.end(), raw, raw + sizeof(T));
+		}
+
+		void string(std::string_view text) {
+			value(static_cast<uint32_t>(text.size()));
+			bytes.insert(bytes.end(), text.begin(), text.end());
+		}
+
+		template <typename T>
+		void column(const std::vector<T>& values) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			value(static_cast<uint32_t>(sizeof(T)));
+			value(static_cast<uint32_t>(values.size()));
+			const auto* raw = reinterpret_cast<const uint8_t*>(values.data());
+			bytes.insert(bytes.end(), raw, raw + values.size() * sizeof(T));
+			align();
+		}
+
+		void column(const std::vector<std::string>& values) {
+			uint32_t offset = 0;
+			value(static_cast<uint32_t>(values.size()));
+			for (const std::string& text : values) {
+				value(offset);
+				offset += static_cast<uint32_t>(text.size());
+			}
+			value(offset);
+			for (const std::string& text : values) {
+				bytes.insert(bytes.end(), text.begin(), text.end());
+			}
+			align();
+		}
+
+		void align() {
+			bytes.resize((bytes.size() + 7) & ~size_t { 7 }, 0);
+		}
+
+		std::vector<uint8_t> bytes;
+	};
+
+	class SnapshotReader {
+	public:
+		explicit SnapshotReader(std::span<const uint8_t> data) :
+			data(data) {
+		}
+
+		template <typename T>
+		bool value(T& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (!ok || data.size() - pos < sizeof(T)) {
+				return ok = false;
+			}
+			std::memcpy(&v, data.data() + pos, sizeof(T));
+			pos += sizeof(T);
+			return true;
+		}
+
+		bool string(std::string& text) {
+			uint32_t length = 0;
+			if (!value(length) || data.size() - pos < length) {
+				return ok = false;
+			}
+			text.assign(reinterpret_cast<const char*>(data.data() + pos), length);
+			pos += length;
+			return true;
+		}
+
+		template <typename T>
+		bool column(std::vector<T>& values, uint32_t expected) {
+			uint32_t element_size = 0;
+			uint32_t count = 0;
+			if (!value(element_size) || !value(count) || element_size != sizeof(T) || count != expected) {
+				return ok = false;
+			}
+			const size_t length = static_cast<size_t>(count) * sizeof(T);
+			if (data.size() - pos < length) {
+				return ok = false;
+			}
+			values.resize(count);
+			if (length > 0) {
+				std::memcpy(values.data(), data.data() + pos, length);
+			}
+			pos += length;
+			return align();
+		}
+
+		bool column(std::vector<std::string>& values, uint32_t expected) {
+			uint32_t count = 0;
+			if (!value(count) || count != expected || (data.size() - pos) / sizeof(uint32_t) < static_cast<size_t>(count) + 1) {
+				return ok = false;
+			}
+			const uint8_t* offsets = data.data() + pos;
+			pos += (static_cast<size_t>(count) + 1) * sizeof(uint32_t);
+
+			uint32_t blob_size = 0;
+			std::memcpy(&blob_size, offsets + static_cast<size_t>(count) * sizeof(uint32_t), sizeof(uint32_t));
+			if (data.size() - pos < blob_size) {
+				return ok = false;
+			}
+			const char* blob = reinterpret_cast<const char*>(data.data() + pos);
+
+			values.clear();
+			values.reserve(count);
+			uint32_t begin = 0;
+			std::memcpy(&begin, offsets, sizeof(uint32_t));
+			for (uint32_t i = 0; i < count; ++i) {
+				uint32_t end = 0;
+				std::memcpy(&end, offsets + (static_cast<size_t>(i) + 1) * sizeof(uint32_t), sizeof(uint32_t));
+				if (end < begin || end > blob_size) {
+					return ok = false;
+				}
+				values.emplace_back(blob + begin, end - begin);
+				begin = end;
+			}
+			pos += blob_size;
+			return align();
+		}
+
+		bool align() {
+			const size_t aligned = (pos + 7) & ~size_t { 7 };
+			if (aligned > data.size()) {
+				return ok = false;
+			}
+			pos = aligned;
+			return ok;
+		}
+
+		bool ok = true;
+
+	private:
+		std::span<const uint8_t> data;
+		size_t pos = 0;
+	};
+
+	using MissingItemList = std::vector<MissingItemEntry> MissingItemReport::*;
+	constexpr MissingItemList MISSING_ITEM_LISTS[] = {
+		&MissingItemReport::missing_in_dat,
+		&MissingItemReport::missing_in_otb,
+		&MissingItemReport::xml_no_otb,
+		&MissingItemReport::otb_no_xml,
+	};
+}
+
+template <typename Store, typename Visitor>
+void ItemDefinitionSnapshot::visitColumns(Store& store, Visitor&& visit) {
+	visit(store.identity_.server_ids);
+	visit(store.identity_.groups);
+	visit(store.identity_.types);
+	visit(store.flags_.masks);
+	visit(store.attributes_.volumes);
+	visit(store.attributes_.max_text_lengths);
+	visit(store.attributes_.slot_positions);
+	visit(store.attributes_.weapon_types);
+	visit(store.attributes_.classifications);
+	visit(store.attributes_.border_base_ground_ids);
+	visit(store.attributes_.border_groups);
+	visit(store.attributes_.weights);
+	visit(store.attributes_.attacks);
+	visit(store.attributes_.defenses);
+	visit(store.attributes_.armors);
+	visit(store.attributes_.charges);
+	visit(store.attributes_.rotate_to);
+	visit(store.attributes_.way_speeds);
+	visit(store.attributes_.always_on_top_orders);
+	visit(store.attributes_.border_alignments);
+	visit(store.text_.names);
+	visit(store.text_.editor_suffixes);
+	visit(store.text_.descriptions);
+	visit(store.visual_.client_ids);
+}
+
+std::optional<uint64_t> ItemDefinitionSnapshot::computeKey(const ItemDefinitionLoadInput& input) {
+	const ClientVersion* client = input.client_version;
+	if (client == nullptr) {
+		return std::nullopt;
+	}
+
+	uint64_t key = combine(FORMAT_VERSION, static_cast<uint64_t>(input.mode));
+	key = combine(key, ItemDefinitionResolver::RESOLVER_VERSION);
+	key = combine(key, DatItemParser::PARSER_VERSION);
+	key = combine(key, OtbItemParser::PARSER_VERSION);
+	key = combine(key, XmlItemParser::PARSER_VERSION);
+	// The column layout of this build, so a snapshot written by a build with
+	// different column types misses instead of failing in install().
+	ItemDefinitionStore layout;
+	visitColumns(layout, [&](const auto& column) {
+		key = combine(key, sizeof(typename std::decay_t<decltype(column)>::value_type));
+	});
+	key = combine(key, client->getOtbMajor());
+	key = combine(key, client->getOtbId());
+	key = combine(key, client->getDatSignature());
+	key = combine(key, static_cast<uint64_t>(client->getDatFormat()));
+	key = combine(key, (client->isExtended() ? 1u : 0u) | (client->isTransparent() ? 2u : 0u) | (client->hasFrameDurations() ? 4u : 0u) | (client->hasFrameGroups() ? 8u : 0u));
+
+	const ItemDefinitionRecipe& recipe = ItemDefinitionRecipeRegistry::get(input.mode);
+	for (size_t i = 0; i < recipe.source_count; ++i) {
+		const wxFileName* path = nullptr;
+		switch (recipe.sources[i]) {
+			case ItemDefinitionSourceKind::Dat:
+				path = &input.dat_path;
+				break;
+			case ItemDefinitionSourceKind::Otb:
+				path = &input.otb_path;
+				break;
+			case ItemDefinitionSourceKind::Xml:
+				path = &input.xml_path;
+				break;
+			case ItemDefinitionSourceKind::Srv:
+			case ItemDefinitionSourceKind::Protobuf:
+				return std::nullopt;
+		}
+
+		uint64_t file_hash = 0;
+		if (!hashFile(*path, file_hash)) {
+			return std::nullopt;
+		}
+		key = combine(key, file_hash);
+	}
+	return key;
+}
+
+wxFileName ItemDefinitionSnapshot::pathFor(const ClientVersion& version) {
+	return wxFileName(version.getLocalDataPath().GetPath(), SNAPSHOT_FILE_NAME);
+}
+
+bool ItemDefinitionSnapshot::open(const wxFileName& path, uint64_t key, MissingItemReport& missing, std::vector<std::string>& warnings) {
+	close();
+	if (!path.FileExists() || !file.open(path.GetFullPath().ToStdString())) {
+		return false;
+	}
+
+	SnapshotHeader header;
+	if (file.size() < sizeof(header) || !file.read(0, reinterpret_cast<uint8_t*>(&header), sizeof(header))) {
+		close();
+		return false;
+	}
+	if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.format_version != FORMAT_VERSION || header.key != key) {
+		close();
+		return false;
+	}
+	if (header.payload_size != file.size() - sizeof(header) || header.columns_size > header.payload_size) {
+		spdlog::warn("Item definition snapshot {} is truncated, rebuilding", path.GetFullPath().utf8_string());
+		close();
+		return false;
+	}
+
+	std::span<const uint8_t> payload = file.view(sizeof(header), header.payload_size);
+	if (payload.empty() && header.payload_size > 0) {
+		fallback.resize(header.payload_size);
+		if (!file.read(sizeof(header), fallback.data(), fallback.size())) {
+			close();
+			return false;
+		}
+		payload = fallback;
+	}
+	if (hashBytes(payload, header.key) != header.payload_hash) {
+		spdlog::warn("Item definition snapshot {} failed its checksum, rebuilding", path.GetFullPath().utf8_string());
+		close();
+		return false;
+	}
+
+	MissingItemReport report;
+	std::vector<std::string> recorded;
+	SnapshotReader reader(payload.subspan(header.columns_size));
+	for (const MissingItemList list : MISSING_ITEM_LISTS) {
+		uint32_t count = 0;
+		reader.value(count);
+		for (uint32_t i = 0; i < count && reader.ok; ++i) {
+			MissingItemEntry entry;
+			reader.value(entry.server_id);
+			reader.value(entry.client_id);
+			reader.string(entry.name);
+			reader.string(entry.description);
+			(report.*list).push_back(std::move(entry));
+		}
+	}
+	uint32_t warning_count = 0;
+	reader.value(warning_count);
+	for (uint32_t i = 0; i < warning_count && reader.ok; ++i) {
+		reader.string(recorded.emplace_back());
+	}
+	if (!reader.ok) {
+		close();
+		return false;
+	}
+
+	columns = payload.first(header.columns_size);
+	row_count = header.row_count;
+	version.major_version = header.major_version;
+	version.minor_version = header.minor_version;
+	version.build_number = header.build_number;
+
+	missing = std::move(report);
+	warnings.insert(warnings.end(), std::make_move_iterator(recorded.begin()), std::make_move_iterator(recorded.end()));
+	return true;
+}
+
+bool ItemDefinitionSnapshot::install(ItemDefinitionStore& store) const {
+	if (!file.isOpen()) {
+		return false;
+	}
+
+	store.clear();
+	SnapshotReader reader(columns);
+	visitColumns(store, [&](auto& column) {
+		reader.column(column, row_count);
+	});
+	if (!reader.ok) {
+		store.clear();
+		return false;
+	}
+
+	store.rebuildIndex();
+	store.MajorVersion = version.major_version;
+	store.MinorVersion = version.minor_version;
+	store.BuildNumber = version.build_number;
+	return true;
+}
+
+void ItemDefinitionSnapshot::close() {
+	file.close();
+	fallback = {};
+	columns = {};
+	row_count = 0;
+	version = {};
+}
+
+bool ItemDefinitionSnapshot::write(const wxFileName& path, uint64_t key, const ItemDefinitionStore& store, const MissingItemReport& missing, std::span<const std::string> warnings) {
+	SnapshotWriter writer;
+	visitColumns(store, [&](const auto& column) {
+		writer.column(column);
+	});
+	const uint64_t columns_size = writer.bytes.size();
+
+	for (const MissingItemList list : MISSING_ITEM_LISTS) {
+		const std::vector<MissingItemEntry>& entries = missing.*list;
+		writer.value(static_cast<uint32_t>(entries.size()));
+		for (const MissingItemEntry& entry : entries) {
+			writer.value(entry.server_id);
+			writer.value(entry.client_id);
+			writer.string(entry.name);
+			writer.string(entry.description);
+		}
+	}
+	writer.value(static_cast<uint32_t>(warnings.size()));
+	for (const std::string& warning : warnings) {
+		writer.string(warning);
+	}
+
+	SnapshotHeader header {};
+	std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	header.format_version = FORMAT_VERSION;
+	header.row_count = static_cast<uint32_t>(store.identity_.server_ids.size());
+	header.key = key;
+	header.major_version = store.MajorVersion;
+	header.minor_version = store.MinorVersion;
+	header.build_number = store.BuildNumber;
+	header.columns_size = columns_size;
+	header.payload_size = writer.bytes.size();
+	header.payload_hash = hashBytes(writer.bytes, key);
+
+	// Written aside and renamed so a crash never leaves a half-written
+	// snapshot under the real name.
+	const wxString target = path.GetFullPath();
+	const wxString temporary = target + ".tmp";
+	{
+		std::ofstream out(temporary.ToStdString(), std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(writer.bytes.data()), static_cast<std::streamsize>(writer.bytes.size()));
+		if (!out) {
+			spdlog::warn("Could not write item definition snapshot {}", temporary.utf8_string());
+			out.close();
+			wxRemoveFile(temporary);
+			return false;
+		}
+	}
+	if (!wxRenameFile(temporary, target, true)) {
+		spdlog::warn("Could not replace item definition snapshot {}", target.utf8_string());
+		wxRemoveFile(temporary);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,51 @@
+#ifndef RME_ITEM_DEFINITION_SNAPSHOT_H_
+#define RME_ITEM_DEFINITION_SNAPSHOT_H_
+
+#include "item_definitions/core/item_definition_store.h"
+#include "item_definitions/core/missing_item_report.h"
+#include "io/mapped_file.h"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Binary image of a resolved ItemDefinitionStore, written next to the user's
+// per-version data so later loads can skip the dat/otb/xml parsers and the
+// resolver. The file is keyed by a content hash of every input file plus the
+// client settings that change how they are parsed; any difference (or a
+// corrupt or outdated file) is a miss and the store is rebuilt and rewritten.
+//
+// Layout: a fixed header, then the store's columns in declaration order as
+// raw arrays (8-byte aligned), string columns as offset tables plus a blob,
+// and finally the missing item report and the loader warnings to replay.
+class ItemDefinitionSnapshot {
+public:
+	static constexpr uint32_t FORMAT_VERSION = 1;
+
+	// Content key of everything the resolved store depends on. Empty when the
+	// input has no client version or one of its files cannot be read.
+	static std::optional<uint64_t> computeKey(const ItemDefinitionLoadInput& input);
+	static wxFileName pathFor(const ClientVersion& version);
+
+	// Maps the snapshot and checks its header, key and checksum, then reads
+	// back the report and warnings that were recorded with it.
+	bool open(const wxFileName& path, uint64_t key, MissingItemReport& missing, std::vector<std::string>& warnings);
+	// Copies the mapped columns into the store. Only valid after open().
+	bool install(ItemDefinitionStore& store) const;
+	void close();
+
+	static bool write(const wxFileName& path, uint64_t key, const ItemDefinitionStore& store, const MissingItemReport& missing, std::span<const std::string> warnings);
+
+private:
+	template <typename Store, typename Visitor>
+	static void visitColumns(Store& store, Visitor&& visit);
+
+	MappedFile file;
+	std::vector<uint8_t> fallback; // Payload copy when the file could not be mapped
+	std::span<const uint8_t> columns; // Everything after the header up to the report
+	uint32_t row_count = 0;
+	ItemDefinitionVersionInfo version;
+};
+
+#endif
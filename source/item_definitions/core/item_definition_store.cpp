@@ -162,6 +162,24 @@ void ItemDefinitionStore::append(ResolvedItemDefinitionRow row) {
 	max_server_id_ = std::max(max_server_id_, row.server_id);
 }
 
+void ItemDefinitionStore::rebuildIndex() {
+	const size_t count = identity_.server_ids.size();
+	server_to_index_.fill(0);
+	client_to_servers_.clear();
+	max_server_id_ = 0;
+	editor_.data.assign(count, ItemEditorData {});
+
+	for (size_t index = 0; index < count; ++index) {
+		const ServerItemId server_id = identity_.server_ids[index];
+		const ClientItemId client_id = visual_.client_ids[index];
+		server_to_index_[server_id] = static_cast<DefinitionId>(index) + 1;
+		if (client_id != 0) {
+			client_to_servers_[client_id].push_back(server_id);
+		}
+		max_server_id_ = std::max(max_server_id_, server_id);
+	}
+}
+
 bool ItemDefinitionStore::exists(ServerItemId server_id) const {
 	return server_to_index_[server_id] != 0;
 }
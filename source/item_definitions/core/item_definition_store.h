@@ -141,6 +141,11 @@ public:
 
 private:
 	friend class ItemDefinitionView;
+	friend class ItemDefinitionSnapshot;
+
+	// Rebuilds the lookup tables and editor data from the columns, after they
+	// were filled in bulk.
+	void rebuildIndex();
 
 	DefinitionId indexOf(ServerItemId server_id) const;
 	bool isFlagSet(DefinitionId index, ItemFlag flag) const;
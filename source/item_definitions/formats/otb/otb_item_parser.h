@@ -5,6 +5,10 @@
 
 class OtbItemParser : public IItemDefinitionParser {
 public:
+	// Bump whenever parse() would read different fragments from the same file;
+	// it is part of the item definition snapshot key.
+	static constexpr uint32_t PARSER_VERSION = 1;
+
 	bool parse(const ItemDefinitionLoadInput& input, ItemDefinitionFragments& fragments, wxString& error, std::vector<std::string>& warnings) const override;
 };
 
@@ -212,6 +212,15 @@ void LiveClient::send(NetworkMessage& message) {
 	});
 }
 
+void LiveClient::send(std::shared_ptr<const NetworkMessage> message) {
+	auto buffer = boost::asio::buffer(message->buffer.data(), message->size + 4);
+	boost::asio::async_write(*socket, buffer, [this, message = std::move(message)](const boost::system::error_code& error, size_t bytesTransferred) -> void {
+		if (error) {
+			logMessage(wxString() + getHostName() + ": " + error.message());
+		}
+	});
+}
+
 void LiveClient::updateCursor(const Position& position) {
 	LiveCursor cursor;
 	cursor.id = 77; // Unimportant, server fixes it for us
@@ -258,6 +267,7 @@ void LiveClient::sendHello() {
 	message.write<uint32_t>(g_version.GetCurrentVersion().getProtocolID());
 	message.write<std::string>(nstr(name));
 	message.write<std::string>(nstr(password));
+	message.write<uint32_t>(LIVE_CAPABILITIES);
 
 	send(message);
 }
@@ -289,7 +299,7 @@ void LiveClient::sendChanges(DirtyList& dirtyList) {
 	for (const auto& change : changeList) {
 		switch (change->getType()) {
 			case CHANGE_TILE: {
-				const Position& position = change->getTile()->getPosition();
+				const Position& position = change->getPosition();
 				sendTile(mapWriter, editor->map.getTile(position), &position);
 				break;
 			}
@@ -301,11 +311,9 @@ void LiveClient::sendChanges(DirtyList& dirtyList) {
 
 	NetworkMessage message;
 	message.write<uint8_t>(PACKET_CHANGE_LIST);
+	writeBytes(message, { mapWriter.getMemory(), mapWriter.getSize() });
 
-	std::string data(reinterpret_cast<const char*>(mapWriter.getMemory()), mapWriter.getSize());
-	message.write<std::string>(data);
-
-	send(message);
+	send(finishMessage(message, hasCapability(LIVE_CAP_ZLIB)));
 }
 
 void LiveClient::sendChat(const wxString& chatMessage) {
@@ -350,8 +358,21 @@ void LiveClient::parsePacket(NetworkMessage message) {
 				parseServerTalk(message);
 				break;
 			case PACKET_NODE:
-				parseNode(message);
+				parseNode(message, false);
 				break;
+			case PACKET_NODE_DELTA:
+				parseNode(message, true);
+				break;
+			case PACKET_COMPRESSED: {
+				NetworkMessage inflated;
+				if (!hasCapability(LIVE_CAP_ZLIB) || !readCompressed(message, inflated)) {
+					log->Message("Invalid compressed packet receieved!");
+					close();
+					return;
+				}
+				parsePacket(std::move(inflated));
+				break;
+			}
 			case PACKET_CURSOR_UPDATE:
 				parseCursorUpdate(message);
 				break;
@@ -379,6 +400,7 @@ void LiveClient::parseHello(NetworkMessage& message) {
 	map.setName("Live Map - " + message.read<std::string>());
 	map.setWidth(message.read<uint16_t>());
 	map.setHeight(message.read<uint16_t>());
+	capabilities = message.read<uint32_t>();
 
 	createEditorWindow();
 }
@@ -424,7 +446,7 @@ void LiveClient::parseServerTalk(NetworkMessage& message) {
 	);
 }
 
-void LiveClient::parseNode(NetworkMessage& message) {
+void LiveClient::parseNode(NetworkMessage& message, bool delta) {
 	uint32_t ind = message.read<uint32_t>();
 
 	// Extract node position
@@ -433,7 +455,15 @@ void LiveClient::parseNode(NetworkMessage& message) {
 	bool underground = ind & 1;
 
 	std::unique_ptr<Action> action = editor->actionQueue->createAction(ACTION_REMOTE);
-	receiveNode(message, *editor, action.get(), ndx, ndy, underground);
+	if (!receiveNode(message, *editor, action.get(), ndx, ndy, underground, delta)) {
+		// A delta is useless without the node it was made against; start over
+		// from a full copy.
+		if (delta) {
+			queryNode(ndx * 4, ndy * 4, underground);
+			sendNodeRequests();
+		}
+		return;
+	}
 	editor->actionQueue->addAction(std::move(action));
 
 	g_gui.RefreshView();
@@ -45,6 +45,8 @@ public:
 	void receiveHeader();
 	void receive(uint32_t packetSize);
 	void send(NetworkMessage& message);
+	// Message must already carry its size header; it is kept alive until written.
+	void send(std::shared_ptr<const NetworkMessage> message);
 
 	//
 	void updateCursor(const Position& position);
@@ -71,7 +73,7 @@ protected:
 	void parseClientAccepted(NetworkMessage& message);
 	void parseChangeClientVersion(NetworkMessage& message);
 	void parseServerTalk(NetworkMessage& message);
-	void parseNode(NetworkMessage& message);
+	void parseNode(NetworkMessage& message, bool delta);
 	void parseCursorUpdate(NetworkMessage& message);
 	void parseStartOperation(NetworkMessage& message);
 	void parseUpdateOperation(NetworkMessage& message);
@@ -0,0 +1,233 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "live/live_node_codec.h"
+
+#include <bit>
+#include <cstring>
+#include <zlib.h>
+
+namespace {
+	constexpr uint8_t NODE_END = 0xFF;
+
+	template <typename T>
+	void put(std::vector<uint8_t>& out, T value) {
+		const size_t offset = out.size();
+		out.resize(offset + sizeof(T));
+		memcpy(out.data() + offset, &value, sizeof(T));
+	}
+
+	template <typename T>
+	bool take(std::span<const uint8_t> in, size_t& offset, T& value) {
+		if (in.size() - offset < sizeof(T)) {
+			return false;
+		}
+		memcpy(&value, in.data() + offset, sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+}
+
+void LiveNodeImage::clear(uint16_t coveredFloors) {
+	coveredBits = coveredFloors;
+	floorBits = 0;
+	for (Floor& floor : floors) {
+		floor.tileBits = 0;
+	}
+	data.clear();
+}
+
+void LiveNodeImage::addFloor(int z) {
+	floorBits |= 1 << z;
+}
+
+void LiveNodeImage::addTile(int z, int index, std::span<const uint8_t> node) {
+	Floor& floor = floors[z];
+	floorBits |= 1 << z;
+	floor.tileBits |= 1 << index;
+	floor.digests[index] = LiveNodeCodec::digest(node);
+	floor.offsets[index] = static_cast<uint32_t>(data.size());
+	floor.sizes[index] = static_cast<uint32_t>(node.size());
+	data.insert(data.end(), node.begin(), node.end());
+}
+
+void LiveNodeBaseline::update(const LiveNodeImage& image) {
+	std::erase_if(floors, [covered = image.getCoveredBits()](const Floor& floor) {
+		return covered & (1 << floor.z);
+	});
+
+	for (int z = 0; z < LiveNodeImage::FLOORS; ++z) {
+		if (!(image.getFloorBits() & (1 << z))) {
+			continue;
+		}
+
+		Floor& floor = floors.emplace_back();
+		floor.z = static_cast<uint8_t>(z);
+		floor.tileBits = image.getTileBits(z);
+		for (int index = 0; index < LiveNodeImage::TILES; ++index) {
+			floor.digests[index] = (floor.tileBits & (1 << index)) ? image.getDigest(z, index) : 0;
+		}
+	}
+}
+
+const LiveNodeBaseline::Floor* LiveNodeBaseline::findFloor(int z) const {
+	for (const Floor& floor : floors) {
+		if (floor.z == z) {
+			return &floor;
+		}
+	}
+	return nullptr;
+}
+
+LiveNodeDiff LiveNodeCodec::full(const LiveNodeImage& image) {
+	LiveNodeDiff diff;
+	diff.floorBits = image.getFloorBits();
+	for (int z = 0; z < LiveNodeImage::FLOORS; ++z) {
+		if (diff.floorBits & (1 << z)) {
+			diff.changedBits[z] = image.getTileBits(z);
+			diff.clearedBits[z] = static_cast<uint16_t>(~image.getTileBits(z));
+		}
+	}
+	return diff;
+}
+
+LiveNodeDiff LiveNodeCodec::diff(const LiveNodeImage& image, const LiveNodeBaseline& baseline) {
+	LiveNodeDiff diff;
+	for (int z = 0; z < LiveNodeImage::FLOORS; ++z) {
+		if (!(image.getCoveredBits() & (1 << z))) {
+			continue;
+		}
+
+		const LiveNodeBaseline::Floor* base = baseline.findFloor(z);
+		const uint16_t tileBits = image.getTileBits(z);
+		const uint16_t baseBits = base ? base->tileBits : 0;
+
+		uint16_t changedBits = 0;
+		for (int index = 0; index < LiveNodeImage::TILES; ++index) {
+			const uint16_t bit = 1 << index;
+			if ((tileBits & bit) && (!(baseBits & bit) || base->digests[index] != image.getDigest(z, index))) {
+				changedBits |= bit;
+			}
+		}
+
+		diff.changedBits[z] = changedBits;
+		diff.clearedBits[z] = baseBits & ~tileBits;
+		if (diff.changedBits[z] != 0 || diff.clearedBits[z] != 0) {
+			diff.floorBits |= 1 << z;
+		}
+	}
+	return diff;
+}
+
+void LiveNodeCodec::write(std::vector<uint8_t>& out, const LiveNodeImage& image, const LiveNodeDiff& diff) {
+	put<uint16_t>(out, diff.floorBits);
+	for (int z = 0; z < LiveNodeImage::FLOORS; ++z) {
+		if (!(diff.floorBits & (1 << z))) {
+			continue;
+		}
+
+		const uint16_t changedBits = diff.changedBits[z];
+		put<uint16_t>(out, changedBits);
+		put<uint16_t>(out, diff.clearedBits[z]);
+		if (changedBits == 0) {
+			continue;
+		}
+
+		const size_t lengthOffset = out.size();
+		put<uint32_t>(out, 0);
+		for (int index = 0; index < LiveNodeImage::TILES; ++index) {
+			if (changedBits & (1 << index)) {
+				const auto tile = image.getTile(z, index);
+				out.insert(out.end(), tile.begin(), tile.end());
+			}
+		}
+		out.push_back(NODE_END);
+
+		const uint32_t length = static_cast<uint32_t>(out.size() - lengthOffset - sizeof(uint32_t));
+		memcpy(out.data() + lengthOffset, &length, sizeof(length));
+	}
+}
+
+size_t LiveNodeCodec::read(std::span<const uint8_t> in, std::vector<LiveFloorPatch>& floors) {
+	floors.clear();
+
+	size_t offset = 0;
+	uint16_t floorBits;
+	if (!take(in, offset, floorBits)) {
+		return 0;
+	}
+
+	for (int z = 0; z < LiveNodeImage::FLOORS; ++z) {
+		if (!(floorBits & (1 << z))) {
+			continue;
+		}
+
+		LiveFloorPatch& floor = floors.emplace_back();
+		floor.z = static_cast<uint8_t>(z);
+		if (!take(in, offset, floor.changedBits) || !take(in, offset, floor.clearedBits)) {
+			return 0;
+		}
+		if (floor.changedBits == 0) {
+			continue;
+		}
+
+		uint32_t length;
+		if (!take(in, offset, length) || length == 0 || in.size() - offset < length) {
+			return 0;
+		}
+		floor.stream = in.subspan(offset, length);
+		offset += length;
+	}
+	return offset;
+}
+
+bool LiveNodeCodec::compress(std::span<const uint8_t> in, std::vector<uint8_t>& out) {
+	uLongf size = compressBound(static_cast<uLong>(in.size()));
+	out.resize(size);
+	if (compress2(out.data(), &size, in.data(), static_cast<uLong>(in.size()), Z_BEST_SPEED) != Z_OK || size >= in.size()) {
+		return false;
+	}
+	out.resize(size);
+	return true;
+}
+
+bool LiveNodeCodec::decompress(std::span<const uint8_t> in, std::span<uint8_t> out) {
+	uLongf size = static_cast<uLongf>(out.size());
+	return uncompress(out.data(), &size, in.data(), static_cast<uLong>(in.size())) == Z_OK && size == out.size();
+}
+
+uint64_t LiveNodeCodec::digest(std::span<const uint8_t> bytes) {
+	// Only has to tell two versions of the same tile apart, so a word-at-a-time
+	// multiply/rotate mix is plenty.
+	uint64_t hash = 0x9E3779B97F4A7C15ull ^ bytes.size();
+	size_t offset = 0;
+	for (; offset + 8 <= bytes.size(); offset += 8) {
+		uint64_t word;
+		memcpy(&word, bytes.data() + offset, sizeof(word));
+		hash = std::rotl(hash ^ (word * 0xC2B2AE3D27D4EB4Full), 31) * 0x9E3779B97F4A7C15ull;
+	}
+
+	uint64_t tail = 0;
+	if (offset < bytes.size()) {
+		memcpy(&tail, bytes.data() + offset, bytes.size() - offset);
+	}
+	hash ^= tail * 0x165667B19E3779F9ull;
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDull;
+	hash ^= hash >> 33;
+	return hash;
+}
@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_LIVE_NODE_CODEC_H_
+#define RME_LIVE_NODE_CODEC_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Floor payload of PACKET_NODE / PACKET_NODE_DELTA and the PACKET_COMPRESSED
+// envelope. Tiles come in already serialized (one OTBM tile node each), so
+// nothing here depends on the map or the sockets.
+//
+// Floor payload: u16 floorBits, then for every floor in it
+//   u16 changedBits  tiles that follow in the stream
+//   u16 clearedBits  tiles the receiver resets to empty
+//   [u32 length, tile nodes + NODE_END] when changedBits != 0
+// A full node sends every non-empty tile as changed and clears the rest.
+
+// Non-empty tiles of the floors a node update covers, serialized once and
+// shared by every peer that receives the update.
+class LiveNodeImage {
+public:
+	static constexpr int FLOORS = 16;
+	static constexpr int TILES = 16;
+
+	void clear(uint16_t coveredFloors);
+
+	// Floors and tiles must be added in ascending order. A floor without tiles
+	// is still sent, which clears it on the receiving side.
+	void addFloor(int z);
+	void addTile(int z, int index, std::span<const uint8_t> node);
+
+	// Floors this image describes; a covered floor that is not present does
+	// not exist on the node.
+	uint16_t getCoveredBits() const {
+		return coveredBits;
+	}
+	uint16_t getFloorBits() const {
+		return floorBits;
+	}
+	uint16_t getTileBits(int z) const {
+		return floors[z].tileBits;
+	}
+	uint64_t getDigest(int z, int index) const {
+		return floors[z].digests[index];
+	}
+	std::span<const uint8_t> getTile(int z, int index) const {
+		return { data.data() + floors[z].offsets[index], floors[z].sizes[index] };
+	}
+
+private:
+	struct Floor {
+		uint16_t tileBits = 0;
+		std::array<uint64_t, TILES> digests {};
+		std::array<uint32_t, TILES> offsets {};
+		std::array<uint32_t, TILES> sizes {};
+	};
+
+	uint16_t coveredBits = 0;
+	uint16_t floorBits = 0;
+	std::array<Floor, FLOORS> floors {};
+	std::vector<uint8_t> data;
+};
+
+// Tile digests of what one peer was last sent for a node half. Only floors
+// that exist are kept, which is usually one or two.
+struct LiveNodeBaseline {
+	struct Floor {
+		uint8_t z;
+		uint16_t tileBits;
+		std::array<uint64_t, LiveNodeImage::TILES> digests;
+	};
+
+	// Replaces the floors the image covers and keeps the others.
+	void update(const LiveNodeImage& image);
+	const Floor* findFloor(int z) const;
+
+	std::vector<Floor> floors;
+};
+
+// Which tiles of an image go out. Two peers with the same diff are sent the
+// same bytes, which is what lets a broadcast share its packets.
+struct LiveNodeDiff {
+	uint16_t floorBits = 0;
+	std::array<uint16_t, LiveNodeImage::FLOORS> changedBits {};
+	std::array<uint16_t, LiveNodeImage::FLOORS> clearedBits {};
+
+	bool empty() const {
+		return floorBits == 0;
+	}
+	bool operator==(const LiveNodeDiff& other) const = default;
+};
+
+struct LiveFloorPatch {
+	uint8_t z;
+	uint16_t changedBits;
+	uint16_t clearedBits;
+	std::span<const uint8_t> stream; // Tile nodes + NODE_END, empty if nothing changed
+};
+
+class LiveNodeCodec {
+public:
+	// Payloads smaller than this are not worth a zlib stream.
+	static constexpr size_t MIN_COMPRESS_SIZE = 256;
+
+	static LiveNodeDiff full(const LiveNodeImage& image);
+	// Tiles whose digest differs from the baseline, plus the ones that became
+	// empty. Empty if the peer is already up to date.
+	static LiveNodeDiff diff(const LiveNodeImage& image, const LiveNodeBaseline& baseline);
+
+	static void write(std::vector<uint8_t>& out, const LiveNodeImage& image, const LiveNodeDiff& diff);
+	// Returns the number of bytes consumed, or 0 if the payload is malformed.
+	static size_t read(std::span<const uint8_t> in, std::vector<LiveFloorPatch>& floors);
+
+	// Fast zlib level; fails if the result would not be smaller than the input.
+	static bool compress(std::span<const uint8_t> in, std::vector<uint8_t>& out);
+	// out must be exactly the uncompressed size.
+	static bool decompress(std::span<const uint8_t> in, std::span<uint8_t> out);
+
+	static uint64_t digest(std::span<const uint8_t> bytes);
+};
+
+#endif
@@ -18,6 +18,8 @@
 #ifndef LIVE_PACKETS_H
 #define LIVE_PACKETS_H
 
+#include <cstdint>
+
 enum LivePacketType {
 	PACKET_HELLO_FROM_CLIENT = 0x10,
 	PACKET_READY_CLIENT = 0x11,
@@ -42,6 +44,19 @@ enum LivePacketType {
 	PACKET_START_OPERATION = 0x92,
 	PACKET_UPDATE_OPERATION = 0x93,
 	PACKET_CHAT_MESSAGE = 0x94,
+	PACKET_NODE_DELTA = 0x95,
+
+	// Either direction, once LIVE_CAP_ZLIB has been negotiated
+	PACKET_COMPRESSED = 0x7F,
 };
 
+// Sent by the client in its hello; the server answers with the subset it
+// supports in PACKET_HELLO_FROM_SERVER.
+enum LiveCapability : uint32_t {
+	LIVE_CAP_ZLIB = 1 << 0,
+	LIVE_CAP_NODE_DELTA = 1 << 1,
+};
+
+constexpr uint32_t LIVE_CAPABILITIES = LIVE_CAP_ZLIB | LIVE_CAP_NODE_DELTA;
+
 #endif
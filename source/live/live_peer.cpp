@@ -104,6 +104,15 @@ void LivePeer::send(NetworkMessage& message) {
 	});
 }
 
+void LivePeer::send(std::shared_ptr<const NetworkMessage> message) {
+	auto buffer = boost::asio::buffer(message->buffer.data(), message->size + 4);
+	boost::asio::async_write(socket, buffer, [this, message = std::move(message)](const boost::system::error_code& error, size_t bytesTransferred) -> void {
+		if (error) {
+			logMessage(wxString() + getHostName() + ": " + error.message());
+		}
+	});
+}
+
 void LivePeer::parseLoginPacket(NetworkMessage message) {
 	uint8_t packetType;
 	while (message.position < message.buffer.size()) {
@@ -150,6 +159,16 @@ void LivePeer::parseEditorPacket(NetworkMessage message) {
 			case PACKET_CLIENT_TALK:
 				parseChatMessage(message);
 				break;
+			case PACKET_COMPRESSED: {
+				NetworkMessage inflated;
+				if (!hasCapability(LIVE_CAP_ZLIB) || !readCompressed(message, inflated)) {
+					log->Message("Invalid compressed packet receieved, connection severed.");
+					close();
+					return;
+				}
+				parseEditorPacket(std::move(inflated));
+				break;
+			}
 			default: {
 				log->Message("Invalid editor packet receieved, connection severed.");
 				close();
@@ -190,6 +209,7 @@ void LivePeer::parseHello(NetworkMessage& message) {
 	uint32_t clientVersion = message.read<uint32_t>();
 	std::string nickname = message.read<std::string>();
 	std::string password = message.read<std::string>();
+	capabilities = message.read<uint32_t>() & LIVE_CAPABILITIES;
 
 	if (server->getPassword() != wxString(password.c_str(), wxConvUTF8)) {
 		log->Message("Client tried to connect, but used the wrong password, connection refused.");
@@ -240,13 +260,15 @@ void LivePeer::parseReady(NetworkMessage& message) {
 	outMessage.write<std::string>(map.getName());
 	outMessage.write<uint16_t>(map.getWidth());
 	outMessage.write<uint16_t>(map.getHeight());
+	outMessage.write<uint32_t>(capabilities);
 
 	send(outMessage);
 }
 
 void LivePeer::parseNodeRequest(NetworkMessage& message) {
 	Map& map = server->getEditor()->map;
-	for (uint32_t nodes = message.read<uint32_t>(); nodes != 0; --nodes) {
+	NetworkMessage nodes;
+	for (uint32_t remaining = message.read<uint32_t>(); remaining != 0; --remaining) {
 		uint32_t ind = message.read<uint32_t>();
 
 		int32_t ndx = ind >> 18;
@@ -255,8 +277,28 @@ void LivePeer::parseNodeRequest(NetworkMessage& message) {
 
 		MapNode* node = map.createLeaf(ndx * 4, ndy * 4);
 		if (node) {
-			sendNode(clientId, node, ndx, ndy, underground ? 0xFF00 : 0x00FF);
+			writeRequestedNode(nodes, node, ndx, ndy, underground);
 		}
+
+		if (nodes.size >= NODE_BATCH_SIZE) {
+			send(finishMessage(nodes, hasCapability(LIVE_CAP_ZLIB)));
+			nodes.clear();
+		}
+	}
+
+	if (nodes.size > 0) {
+		send(finishMessage(nodes, hasCapability(LIVE_CAP_ZLIB)));
+	}
+}
+
+void LivePeer::writeRequestedNode(NetworkMessage& message, MapNode* node, int32_t ndx, int32_t ndy, bool underground) {
+	const uint32_t index = nodeIndex(ndx, ndy, underground);
+	node->setVisible(clientId, underground, true);
+
+	buildNodeImage(nodeImage, node, underground ? 0xFF00 : 0x00FF);
+	writeNode(message, PACKET_NODE, index, nodeImage, LiveNodeCodec::full(nodeImage));
+	if (hasCapability(LIVE_CAP_NODE_DELTA)) {
+		nodeBaselines[index].update(nodeImage);
 	}
 }
 
@@ -264,8 +306,11 @@ void LivePeer::parseReceiveChanges(NetworkMessage& message) {
 	Editor& editor = *server->getEditor();
 
 	// -1 on address since we skip the first START_NODE when sending
-	const std::string& data = message.read<std::string>();
-	mapReader.assign(reinterpret_cast<const uint8_t*>(data.c_str() - 1), data.size());
+	const std::span<const uint8_t> data = readBytes(message);
+	if (data.empty()) {
+		return;
+	}
+	mapReader.assign(data.data() - 1, data.size() + 1);
 
 	BinaryNode* rootNode = mapReader.getRootNode();
 	BinaryNode* tileNode = rootNode->getChild();
@@ -51,11 +51,16 @@ public:
 	void receiveHeader();
 	void receive(uint32_t packetSize);
 	void send(NetworkMessage& message);
+	// Message must already carry its size header; it is kept alive until written.
+	void send(std::shared_ptr<const NetworkMessage> message);
 
 	//
 	void updateCursor(const Position& position) { }
 
 protected:
+	// Full node for a request; also where this peer's delta baseline starts.
+	void writeRequestedNode(NetworkMessage& message, MapNode* node, int32_t ndx, int32_t ndy, bool underground);
+
 	void parseLoginPacket(NetworkMessage message);
 	void parseEditorPacket(NetworkMessage message);
 
@@ -85,6 +90,12 @@ protected:
 
 	bool connected;
 
+	// What this peer was last sent per node half (keyed by nodeIndex), so
+	// broadcasts only carry the tiles that changed since. In-order delivery
+	// means every earlier packet is applied before a delta arrives; a client
+	// that dropped the node asks for it again, which resets the baseline.
+	std::unordered_map<uint32_t, LiveNodeBaseline> nodeBaselines;
+
 	friend class LiveLogTab;
 	friend class LiveServer;
 };
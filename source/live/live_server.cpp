@@ -25,6 +25,8 @@
 
 #include "editor/editor.h"
 
+#include <algorithm>
+
 LiveServer::LiveServer(Editor& editor) :
 	LiveSocket(),
 	clients(), acceptor(nullptr), socket(nullptr), editor(&editor),
@@ -101,7 +103,7 @@ void LiveServer::acceptClient() {
 		if (error) {
 			//
 		} else {
-			auto peer = std::make_unique<LivePeer>(this, std::move(*socket));
+			auto peer = std::make_shared<LivePeer>(this, std::move(*socket));
 			peer->log = log;
 			peer->receiveHeader();
 
@@ -186,34 +188,144 @@ void LiveServer::broadcastNodes(DirtyList& dirtyList) {
 		return;
 	}
 
+	// Peers are shared so the snapshot stays valid if one disconnects while
+	// we send; nothing below needs the lock.
+	std::vector<std::shared_ptr<LivePeer>> peers;
+	// The peer whose edit this is gets no packet, but its delta baselines must
+	// still move to the new image, or a later revert diffs to nothing for it
+	std::shared_ptr<LivePeer> owner;
+	{
+		std::lock_guard<std::mutex> lock(clientMutex);
+		peers.reserve(clients.size());
+		for (const auto& clientEntry : clients) {
+			const uint32_t clientId = clientEntry.second->getClientId();
+			if (dirtyList.owner == 0 || dirtyList.owner != clientId) {
+				peers.push_back(clientEntry.second);
+			} else if (clientEntry.second->hasCapability(LIVE_CAP_NODE_DELTA)) {
+				owner = clientEntry.second;
+			}
+		}
+	}
+
+	if (peers.empty() && !owner) {
+		return;
+	}
+
+	// Each peer gets its nodes in batches so zlib sees more than one node at a
+	// time. Peers with the same diff of a node share its serialized packet, and
+	// peers whose batches came out identical share the finished message.
+	struct SharedNode {
+		uint8_t packetType;
+		LiveNodeDiff diff;
+		NetworkMessage packet;
+	};
+	std::vector<SharedNode> shared;
+	std::vector<NetworkMessage> batches(peers.size());
+
+	auto flush = [&]() {
+		std::vector<size_t> source(peers.size());
+		for (size_t i = 0; i < peers.size(); ++i) {
+			source[i] = i;
+			for (size_t j = 0; j < i; ++j) {
+				const NetworkMessage& batch = batches[i];
+				const NetworkMessage& other = batches[j];
+				if (source[j] == j && batch.size > 0 && batch.size == other.size && peers[i]->hasCapability(LIVE_CAP_ZLIB) == peers[j]->hasCapability(LIVE_CAP_ZLIB) && memcmp(&batch.buffer[4], &other.buffer[4], batch.size) == 0) {
+					source[i] = j;
+					break;
+				}
+			}
+		}
+
+		std::vector<std::shared_ptr<const NetworkMessage>> finished(peers.size());
+		for (size_t i = 0; i < peers.size(); ++i) {
+			if (batches[i].size == 0) {
+				continue;
+			}
+			if (source[i] == i) {
+				finished[i] = finishMessage(batches[i], peers[i]->hasCapability(LIVE_CAP_ZLIB));
+			} else {
+				finished[i] = finished[source[i]];
+			}
+			peers[i]->send(finished[i]);
+		}
+
+		for (NetworkMessage& batch : batches) {
+			batch.clear();
+		}
+	};
+
 	for (const auto& ind : dirtyList.GetPosList()) {
 		int32_t ndx = ind.pos >> 18;
 		int32_t ndy = (ind.pos >> 4) & 0x3FFF;
-		uint32_t floors = ind.floors;
 
 		MapNode* node = editor->map.getLeaf(ndx * 4, ndy * 4);
 		if (!node) {
 			continue;
 		}
 
-		std::lock_guard<std::mutex> lock(clientMutex);
-		for (auto& clientEntry : clients) {
-			LivePeer* peer = clientEntry.second.get();
-
-			const uint32_t clientId = peer->getClientId();
-			if (dirtyList.owner != 0 && dirtyList.owner == clientId) {
+		bool full = false;
+		for (const bool underground : { true, false }) {
+			const uint32_t floorMask = ind.floors & (underground ? 0xFF00 : 0x00FF);
+			if (floorMask == 0) {
 				continue;
 			}
 
-			if (node->isVisible(clientId, true)) {
-				peer->sendNode(clientId, node, ndx, ndy, floors & 0xFF00);
+			const uint32_t index = nodeIndex(ndx, ndy, underground);
+			bool built = false;
+			shared.clear();
+
+			if (owner && node->isVisible(owner->getClientId(), underground)) {
+				buildNodeImage(nodeImage, node, floorMask);
+				built = true;
+				owner->nodeBaselines[index].update(nodeImage);
 			}
 
-			if (node->isVisible(clientId, false)) {
-				peer->sendNode(clientId, node, ndx, ndy, floors & 0x00FF);
+			for (size_t i = 0; i < peers.size(); ++i) {
+				LivePeer& peer = *peers[i];
+				if (!node->isVisible(peer.getClientId(), underground)) {
+					continue;
+				}
+				if (!built) {
+					buildNodeImage(nodeImage, node, floorMask);
+					built = true;
+				}
+
+				uint8_t packetType = PACKET_NODE;
+				LiveNodeDiff diff;
+				LiveNodeBaseline* baseline = nullptr;
+				if (peer.hasCapability(LIVE_CAP_NODE_DELTA)) {
+					baseline = &peer.nodeBaselines[index];
+					diff = LiveNodeCodec::diff(nodeImage, *baseline);
+					packetType = PACKET_NODE_DELTA;
+					if (diff.empty()) {
+						continue;
+					}
+				} else {
+					diff = LiveNodeCodec::full(nodeImage);
+				}
+
+				auto it = std::ranges::find_if(shared, [&](const SharedNode& entry) {
+					return entry.packetType == packetType && entry.diff == diff;
+				});
+				if (it == shared.end()) {
+					shared.push_back({ packetType, diff, NetworkMessage() });
+					writeNode(shared.back().packet, packetType, index, nodeImage, diff);
+					it = std::prev(shared.end());
+				}
+
+				writeRaw(batches[i], { &it->packet.buffer[4], it->packet.size });
+				full = full || batches[i].size >= NODE_BATCH_SIZE;
+				if (baseline) {
+					baseline->update(nodeImage);
+				}
 			}
 		}
+
+		if (full) {
+			flush();
+		}
 	}
+	flush();
 }
 
 void LiveServer::broadcastCursor(const LiveCursor& cursor) {
@@ -24,7 +24,7 @@
 
 LiveSocket::LiveSocket() :
 	cursors(), mapReader(nullptr, 0), mapWriter(),
-	mapVersion(MapVersion(MAP_OTBM_4, OTB_VERSION_NONE)), log(nullptr),
+	mapVersion(MapVersion(MAP_OTBM_4, OTB_VERSION_NONE)), capabilities(0), log(nullptr),
 	name("User"), password("") {
 	//
 }
@@ -90,141 +90,169 @@ void LiveSocket::logMessage(const wxString& message) {
 	});
 }
 
-void LiveSocket::receiveNode(NetworkMessage& message, Editor& editor, Action* action, int32_t ndx, int32_t ndy, bool underground) {
+uint32_t LiveSocket::nodeIndex(int32_t ndx, int32_t ndy, bool underground) {
+	return (static_cast<uint32_t>(ndx) << 18) | (static_cast<uint32_t>(ndy) << 4) | (underground ? 1 : 0);
+}
+
+bool LiveSocket::receiveNode(NetworkMessage& message, Editor& editor, Action* action, int32_t ndx, int32_t ndy, bool underground, bool delta) {
+	const std::span<const uint8_t> payload(message.buffer.data() + message.position, message.buffer.size() - message.position);
+	const size_t length = LiveNodeCodec::read(payload, floorPatches);
+	if (length == 0) {
+		log->Message("Warning: Received malformed node (" + std::to_string(ndx * 4) + "/" + std::to_string(ndy * 4) + ")");
+		message.position = message.buffer.size();
+		return false;
+	}
+	message.position += length;
+
 	MapNode* node = editor.map.getLeaf(ndx * 4, ndy * 4);
-	if (!node) {
+	if (delta && (!node || !node->isVisible(underground))) {
+		return false;
+	} else if (!node) {
 		log->Message("Warning: Received update for unknown tile (" + std::to_string(ndx * 4) + "/" + std::to_string(ndy * 4) + "/" + (underground ? "true" : "false") + ")");
-		return;
+		return false;
 	}
 
 	node->setRequested(underground, false);
 	node->setVisible(underground, true);
 
-	uint16_t floorBits = message.read<uint16_t>();
-	if (floorBits == 0) {
-		return;
-	}
-
-	for (uint_fast8_t z = 0; z < MAP_LAYERS; ++z) {
-		if (testFlags(floorBits, static_cast<uint64_t>(1) << z)) {
-			receiveFloor(message, editor, action, ndx, ndy, z, node, node->getFloor(z));
-		}
+	for (const LiveFloorPatch& patch : floorPatches) {
+		receiveFloor(patch, editor, action, ndx, ndy, node);
 	}
+	return true;
 }
 
-void LiveSocket::sendNode(uint32_t clientId, MapNode* node, int32_t ndx, int32_t ndy, uint32_t floorMask) {
-	bool underground;
-	if (floorMask & 0xFF00) {
-		if (floorMask & 0x00FF) {
-			underground = false;
-		} else {
-			underground = true;
-		}
-	} else {
-		underground = false;
-	}
-
-	// Send message
-	NetworkMessage message;
-	message.write<uint8_t>(PACKET_NODE);
-	message.write<uint32_t>((static_cast<uint32_t>(ndx) << 18) | (static_cast<uint32_t>(ndy) << 4) | ((floorMask & 0xFF00) ? 1 : 0));
+void LiveSocket::buildNodeImage(LiveNodeImage& image, MapNode* node, uint32_t floorMask) {
+	image.clear(static_cast<uint16_t>(floorMask));
 
-	if (!node) {
-		message.write<uint8_t>(0x00);
-	} else {
-		node->setVisible(clientId, underground, true);
+	// All tiles go through one writer pass; the spans are taken afterwards
+	// because the writer may reallocate while it grows.
+	struct TileRange {
+		uint8_t z;
+		uint8_t index;
+		uint32_t begin;
+		uint32_t end;
+	};
+	std::vector<TileRange> ranges;
 
-		uint16_t sendMask = 0;
-		for (uint32_t z = 0; z < MAP_LAYERS; ++z) {
-			uint32_t bit = 1 << z;
-			if (node->getFloor(z) && testFlags(floorMask, bit)) {
-				sendMask |= bit;
-			}
+	mapWriter.reset();
+	for (uint32_t z = 0; z < MAP_LAYERS; ++z) {
+		Floor* floor = node->getFloor(z);
+		if (!floor || !testFlags(floorMask, static_cast<uint64_t>(1) << z)) {
+			continue;
 		}
 
-		message.write<uint16_t>(sendMask);
-		for (uint32_t z = 0; z < MAP_LAYERS; ++z) {
-			if (testFlags(sendMask, static_cast<uint64_t>(1) << z)) {
-				sendFloor(message, node->getFloor(z));
+		image.addFloor(z);
+		for (uint_fast8_t index = 0; index < LiveNodeImage::TILES; ++index) {
+			Tile* tile = floor->locs[index].get();
+			if (tile && tile->size() > 0) {
+				const uint32_t begin = static_cast<uint32_t>(mapWriter.getSize());
+				sendTile(mapWriter, tile, nullptr);
+				ranges.push_back({ static_cast<uint8_t>(z), index, begin, static_cast<uint32_t>(mapWriter.getSize()) });
 			}
 		}
 	}
 
-	send(message);
+	const uint8_t* memory = mapWriter.getMemory();
+	for (const TileRange& range : ranges) {
+		image.addTile(range.z, range.index, { memory + range.begin, range.end - range.begin });
+	}
 }
 
-void LiveSocket::receiveFloor(NetworkMessage& message, Editor& editor, Action* action, int32_t ndx, int32_t ndy, int32_t z, MapNode* node, Floor* floor) {
-	Map& map = editor.map;
+void LiveSocket::writeNode(NetworkMessage& message, uint8_t packetType, uint32_t ind, const LiveNodeImage& image, const LiveNodeDiff& diff) {
+	nodeBuffer.clear();
+	LiveNodeCodec::write(nodeBuffer, image, diff);
 
-	uint16_t tileBits = message.read<uint16_t>();
-	if (tileBits == 0) {
-		for (uint_fast8_t x = 0; x < 4; ++x) {
-			for (uint_fast8_t y = 0; y < 4; ++y) {
-				action->addChange(std::make_unique<Change>(std::move(map.allocator(node->createTile(ndx * 4 + x, ndy * 4 + y, z)))));
-			}
-		}
-		return;
+	message.write<uint8_t>(packetType);
+	message.write<uint32_t>(ind);
+	writeRaw(message, nodeBuffer);
+}
+
+std::shared_ptr<const NetworkMessage> LiveSocket::finishMessage(NetworkMessage& message, bool compress) {
+	auto finished = std::make_shared<NetworkMessage>();
+
+	std::vector<uint8_t> compressed;
+	const std::span<const uint8_t> raw(message.buffer.data() + 4, message.size);
+	if (compress && message.size >= LiveNodeCodec::MIN_COMPRESS_SIZE && LiveNodeCodec::compress(raw, compressed)) {
+		finished->write<uint8_t>(PACKET_COMPRESSED);
+		finished->write<uint32_t>(static_cast<uint32_t>(message.size));
+		writeBytes(*finished, compressed);
+	} else {
+		*finished = std::move(message);
 	}
 
-	// -1 on address since we skip the first START_NODE when sending
-	std::string data = message.read<std::string>();
-	data.insert(0, 1, ' ');
-	mapReader.assign(reinterpret_cast<const uint8_t*>(data.c_str()), data.size());
+	memcpy(&finished->buffer[0], &finished->size, 4);
+	return finished;
+}
 
-	BinaryNode* rootNode = mapReader.getRootNode();
-	BinaryNode* tileNode = rootNode->getChild();
+bool LiveSocket::readCompressed(NetworkMessage& message, NetworkMessage& inflated) {
+	const uint32_t size = message.read<uint32_t>();
+	const std::span<const uint8_t> compressed = readBytes(message);
 
-	Position position(0, 0, z);
-	for (uint_fast8_t x = 0; x < 4; ++x) {
-		for (uint_fast8_t y = 0; y < 4; ++y) {
-			position.x = (ndx * 4) + x;
-			position.y = (ndy * 4) + y;
+	inflated.clear();
+	inflated.buffer.resize(4 + size);
+	inflated.size = size;
+	return !compressed.empty() && LiveNodeCodec::decompress(compressed, { inflated.buffer.data() + 4, size });
+}
 
-			if (testFlags(tileBits, static_cast<uint64_t>(1) << ((x * 4) + y))) {
-				receiveTile(tileNode, editor, action, &position);
-				tileNode->advance();
-			} else {
-				action->addChange(std::make_unique<Change>(std::move(map.allocator(node->createTile(position.x, position.y, z)))));
-			}
-		}
-	}
-	mapReader.close();
+void LiveSocket::writeBytes(NetworkMessage& message, std::span<const uint8_t> bytes) {
+	message.write<uint32_t>(static_cast<uint32_t>(bytes.size()));
+	writeRaw(message, bytes);
 }
 
-void LiveSocket::sendFloor(NetworkMessage& message, Floor* floor) {
-	uint16_t tileBits = 0;
-	for (uint_fast8_t x = 0; x < 4; ++x) {
-		for (uint_fast8_t y = 0; y < 4; ++y) {
-			uint_fast8_t index = (x * 4) + y;
+void LiveSocket::writeRaw(NetworkMessage& message, std::span<const uint8_t> bytes) {
+	message.expand(bytes.size());
+	if (!bytes.empty()) {
+		memcpy(&message.buffer[message.position], bytes.data(), bytes.size());
+	}
+	message.position += bytes.size();
+}
 
-			Tile* tile = floor->locs[index].get();
-			if (tile && tile->size() > 0) {
-				tileBits |= (1 << index);
-			}
-		}
+std::span<const uint8_t> LiveSocket::readBytes(NetworkMessage& message) {
+	const uint32_t length = message.read<uint32_t>();
+	if (message.buffer.size() - message.position < length) {
+		message.position = message.buffer.size();
+		return {};
 	}
 
-	message.write<uint16_t>(tileBits);
-	if (tileBits == 0) {
-		return;
+	const std::span<const uint8_t> bytes(message.buffer.data() + message.position, length);
+	message.position += length;
+	return bytes;
+}
+
+void LiveSocket::receiveFloor(const LiveFloorPatch& patch, Editor& editor, Action* action, int32_t ndx, int32_t ndy, MapNode* node) {
+	Map& map = editor.map;
+
+	BinaryNode* tileNode = nullptr;
+	if (patch.changedBits != 0) {
+		// -1 on address since the reader skips the first START_NODE, which is
+		// never sent; that byte is the tail of the length prefix.
+		mapReader.assign(patch.stream.data() - 1, patch.stream.size() + 1);
+		tileNode = mapReader.getRootNode()->getChild();
 	}
 
-	mapWriter.reset();
+	Position position(0, 0, patch.z);
 	for (uint_fast8_t x = 0; x < 4; ++x) {
 		for (uint_fast8_t y = 0; y < 4; ++y) {
-			uint_fast8_t index = (x * 4) + y;
-			if (testFlags(tileBits, static_cast<uint64_t>(1) << index)) {
-				sendTile(mapWriter, floor->locs[index].get(), nullptr);
+			const uint16_t bit = 1 << ((x * 4) + y);
+			position.x = (ndx * 4) + x;
+			position.y = (ndy * 4) + y;
+
+			if (testFlags(patch.changedBits, bit)) {
+				if (tileNode) {
+					receiveTile(tileNode, editor, action, &position);
+					if (!tileNode->advance()) {
+						tileNode = nullptr;
+					}
+				}
+			} else if (testFlags(patch.clearedBits, bit)) {
+				action->addChange(std::make_unique<Change>(std::move(map.allocator(node->createTile(position.x, position.y, patch.z)))));
 			}
 		}
 	}
-	mapWriter.endNode();
 
-	std::string stream(
-		reinterpret_cast<char*>(mapWriter.getMemory()),
-		mapWriter.getSize()
-	);
-	message.write<std::string>(stream);
+	if (patch.changedBits != 0) {
+		mapReader.close();
+	}
 }
 
 void LiveSocket::receiveTile(BinaryNode* node, Editor& editor, Action* action, const Position* position) {
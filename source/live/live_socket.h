@@ -21,11 +21,14 @@
 #include "map/position.h"
 #include "net/net_connection.h"
 #include "live/live_packets.h"
+#include "live/live_node_codec.h"
 #include "io/filehandle.h"
 #include "io/iomap.h"
 
 #include <memory>
+#include <span>
 #include <unordered_map>
+#include <vector>
 
 class LiveLogTab;
 class Action;
@@ -56,6 +59,10 @@ public:
 	std::string getHostName() const;
 	std::vector<LiveCursor> getCursorList() const;
 
+	bool hasCapability(LiveCapability capability) const {
+		return (capabilities & capability) != 0;
+	}
+
 	//
 	void logMessage(const wxString& message);
 
@@ -69,10 +76,31 @@ public:
 
 protected:
 	// receive / send methods
-	void receiveNode(NetworkMessage& message, Editor& editor, Action* action, int32_t ndx, int32_t ndy, bool underground);
-	void sendNode(uint32_t clientId, MapNode* node, int32_t ndx, int32_t ndy, uint32_t floorMask);
-	void receiveFloor(NetworkMessage& message, Editor& editor, Action* action, int32_t ndx, int32_t ndy, int32_t z, MapNode* node, Floor* floor);
-	void sendFloor(NetworkMessage& message, Floor* floor);
+	static uint32_t nodeIndex(int32_t ndx, int32_t ndy, bool underground);
+	// Applies a PACKET_NODE / PACKET_NODE_DELTA body. Returns false if the
+	// payload was malformed or the node is not loaded here; a delta also needs
+	// the node to have been received before.
+	bool receiveNode(NetworkMessage& message, Editor& editor, Action* action, int32_t ndx, int32_t ndy, bool underground, bool delta);
+	void receiveFloor(const LiveFloorPatch& patch, Editor& editor, Action* action, int32_t ndx, int32_t ndy, MapNode* node);
+	// Serializes every non-empty tile of the floors in floorMask.
+	void buildNodeImage(LiveNodeImage& image, MapNode* node, uint32_t floorMask);
+	// Appends a PACKET_NODE / PACKET_NODE_DELTA carrying the diff of the image.
+	void writeNode(NetworkMessage& message, uint8_t packetType, uint32_t ind, const LiveNodeImage& image, const LiveNodeDiff& diff);
+
+	// Writes the size header, wrapping the message in PACKET_COMPRESSED first
+	// when asked to and it pays off.
+	static std::shared_ptr<const NetworkMessage> finishMessage(NetworkMessage& message, bool compress);
+	// Reads the rest of a PACKET_COMPRESSED into a message of its own.
+	static bool readCompressed(NetworkMessage& message, NetworkMessage& inflated);
+
+	// u32 length prefixed byte strings, for payloads that outgrow write<std::string>
+	static void writeBytes(NetworkMessage& message, std::span<const uint8_t> bytes);
+	static std::span<const uint8_t> readBytes(NetworkMessage& message);
+	static void writeRaw(NetworkMessage& message, std::span<const uint8_t> bytes);
+
+	// Node packets are batched up to about this much per message, which gives
+	// zlib something to work with without holding a whole paste back.
+	static constexpr size_t NODE_BATCH_SIZE = 64 * 1024;
 
 	void receiveTile(BinaryNode* node, Editor& editor, Action* action, const Position* position);
 	void sendTile(MemoryNodeFileWriteHandle& writer, Tile* tile, const Position* position);
@@ -90,6 +118,12 @@ protected:
 	MemoryNodeFileWriteHandle mapWriter;
 	VirtualIOMap mapVersion;
 
+	// Negotiated LIVE_CAP_* set, zero until the handshake is done
+	uint32_t capabilities;
+	LiveNodeImage nodeImage;
+	std::vector<uint8_t> nodeBuffer;
+	std::vector<LiveFloorPatch> floorPatches;
+
 	LiveLogTab* log;
 
 	wxString name;
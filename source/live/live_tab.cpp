@@ -198,7 +198,7 @@ void LiveLogTab::OnDeselectChatbox(wxFocusEvent& evt) {
 	g_hotkeys.EnableHotkeys();
 }
 
-void LiveLogTab::UpdateClientList(const std::unordered_map<uint32_t, std::unique_ptr<LivePeer>>& updatedClients) {
+void LiveLogTab::UpdateClientList(const std::unordered_map<uint32_t, std::shared_ptr<LivePeer>>& updatedClients) {
 	std::lock_guard<std::mutex> lock(clients_mutex);
 	// Delete old rows
 	if (user_list->GetNumberRows() > 0) {
@@ -61,7 +61,8 @@ namespace LuaAPI {
 		// Register HTTP client
 		registerHttp(lua);
 
-		// Register procedural generation APIs
+		// Register procedural generation APIs (Grid first, they all take it)
+		registerGrid(lua);
 		registerNoise(lua);
 		registerAlgo(lua);
 		registerGeo(lua);
@@ -20,6 +20,9 @@
 
 #include "lua_sol_config.h"
 
+#include <functional>
+#include <string>
+
 // Forward declarations
 class Tile;
 
@@ -40,6 +43,13 @@ namespace LuaAPI {
 
 	// Called by tile modification functions to track changes
 	void markTileForUndo(Tile* tile, bool originallyExisted = true);
+	// Called by edits that change items in place without an Action; the
+	// current map's item index drops its entries and the next search rescans
+	void markItemsChanged();
+
+	// Runs fn as one undoable step: inside app.transaction its changes join
+	// that transaction, otherwise they are committed on their own under name
+	void runInTransaction(const std::string& name, const std::function<void()>& fn);
 
 	void registerColor(sol::state& lua);
 	void registerCreature(sol::state& lua);
@@ -49,6 +59,7 @@ namespace LuaAPI {
 	void registerHttp(sol::state& lua);
 
 	// Procedural generation APIs
+	void registerGrid(sol::state& lua);
 	void registerNoise(sol::state& lua);
 	void registerAlgo(sol::state& lua);
 	void registerGeo(sol::state& lua);
@@ -17,6 +17,7 @@
 
 #include "app/main.h"
 #include "lua_api_algo.h"
+#include "lua_api_grid.h"
 
 #include <vector>
 #include <random>
@@ -28,23 +29,6 @@
 
 namespace LuaAPI {
 
-	// Helper: convert Lua table to 2D grid
-	static std::vector<std::vector<int>> tableToGrid(const sol::table& tbl, int width, int height) {
-		std::vector<std::vector<int>> grid(height, std::vector<int>(width, 0));
-
-		for (int y = 1; y <= height; ++y) {
-			if (tbl[y].valid() && tbl[y].get_type() == sol::type::table) {
-				sol::table row = tbl[y];
-				for (int x = 1; x <= width; ++x) {
-					if (row[x].valid()) {
-						grid[y - 1][x - 1] = row[x].get<int>();
-					}
-				}
-			}
-		}
-		return grid;
-	}
-
 	// Helper: convert 2D grid to Lua table
 	static sol::table gridToTable(const std::vector<std::vector<int>>& grid, sol::state_view& lua) {
 		sol::table result = lua.create_table();
@@ -58,36 +42,6 @@ namespace LuaAPI {
 		return result;
 	}
 
-	// Helper: convert Lua table to 2D float grid
-	static std::vector<std::vector<float>> tableToFloatGrid(const sol::table& tbl, int width, int height) {
-		std::vector<std::vector<float>> grid(height, std::vector<float>(width, 0.0f));
-
-		for (int y = 1; y <= height; ++y) {
-			if (tbl[y].valid() && tbl[y].get_type() == sol::type::table) {
-				sol::table row = tbl[y];
-				for (int x = 1; x <= width; ++x) {
-					if (row[x].valid()) {
-						grid[y - 1][x - 1] = row[x].get<float>();
-					}
-				}
-			}
-		}
-		return grid;
-	}
-
-	// Helper: convert 2D float grid to Lua table
-	static sol::table floatGridToTable(const std::vector<std::vector<float>>& grid, sol::state_view& lua) {
-		sol::table result = lua.create_table();
-		for (size_t y = 0; y < grid.size(); ++y) {
-			sol::table row = lua.create_table();
-			for (size_t x = 0; x < grid[y].size(); ++x) {
-				row[x + 1] = grid[y][x];
-			}
-			result[y + 1] = row;
-		}
-		return result;
-	}
-
 	// BSP Node for dungeon generation
 	struct BSPNode {
 		int x, y, w, h;
@@ -106,86 +60,82 @@ namespace LuaAPI {
 
 		// algo.cellularAutomata(grid, options) -> grid
 		// Run cellular automata simulation (useful for caves, organic shapes)
-		// grid: 2D table where 1 = wall, 0 = floor
+		// grid: Grid or 2D table where 1 = wall, 0 = floor; returned in the same form
 		// options: { iterations, birthLimit, deathLimit, width, height }
-		algoTable.set_function("cellularAutomata", [](sol::table inputGrid, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
+		algoTable.set_function("cellularAutomata", [](sol::object inputGrid, sol::optional<sol::table> options, sol::this_state s) -> sol::object {
 			sol::state_view lua(s);
 
 			int iterations = 4;
 			int birthLimit = 4; // Become wall if neighbors >= birthLimit
 			int deathLimit = 3; // Stay wall if neighbors >= deathLimit
-			int width = 0;
+			int width = 0; // 0 takes the grid's size
 			int height = 0;
 
-			// Get dimensions from grid
-			if (inputGrid[1].valid()) {
-				height = static_cast<int>(inputGrid.size());
-				if (inputGrid[1].get_type() == sol::type::table) {
-					sol::table firstRow = inputGrid[1];
-					width = static_cast<int>(firstRow.size());
-				}
-			}
-
 			if (options) {
 				sol::table opts = *options;
 				iterations = opts.get_or(std::string("iterations"), 4);
 				birthLimit = opts.get_or(std::string("birthLimit"), 4);
 				deathLimit = opts.get_or(std::string("deathLimit"), 3);
-				width = opts.get_or(std::string("width"), width);
-				height = opts.get_or(std::string("height"), height);
+				width = opts.get_or(std::string("width"), 0);
+				height = opts.get_or(std::string("height"), 0);
 			}
 
-			if (width <= 0 || height <= 0) {
+			if (isEmptyTableGrid(inputGrid)) {
 				return inputGrid; // Return unchanged if invalid dimensions
 			}
 
-			auto grid = tableToGrid(inputGrid, width, height);
+			const GridArgument input(inputGrid, "algo.cellularAutomata", width, height);
+			width = input->getWidth();
+			height = input->getHeight();
 
-			// Run iterations
-			for (int iter = 0; iter < iterations; ++iter) {
-				std::vector<std::vector<int>> newGrid = grid;
+			LuaGrid grid = *input;
+			LuaGrid newGrid = grid;
 
-				for (int y = 0; y < height; ++y) {
-					for (int x = 0; x < width; ++x) {
-						// Count neighbors (8-directional)
-						int neighbors = 0;
-						for (int dy = -1; dy <= 1; ++dy) {
-							for (int dx = -1; dx <= 1; ++dx) {
-								if (dx == 0 && dy == 0) {
-									continue;
-								}
-								int nx = x + dx;
-								int ny = y + dy;
-								// Treat edges as walls
-								if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
-									neighbors++;
-								} else if (grid[ny][nx] == 1) {
-									neighbors++;
+			// Run iterations; every cell is rewritten, so the buffers just swap
+			for (int iter = 0; iter < iterations; ++iter) {
+				forEachRowBand(0, height, width, [&](int begin, int end) {
+					for (int y = begin; y < end; ++y) {
+						for (int x = 0; x < width; ++x) {
+							// Count neighbors (8-directional)
+							int neighbors = 0;
+							for (int dy = -1; dy <= 1; ++dy) {
+								for (int dx = -1; dx <= 1; ++dx) {
+									if (dx == 0 && dy == 0) {
+										continue;
+									}
+									int nx = x + dx;
+									int ny = y + dy;
+									// Treat edges as walls
+									if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
+										neighbors++;
+									} else if (grid.at(nx, ny) == 1.0f) {
+										neighbors++;
+									}
 								}
 							}
-						}
 
-						// Apply rules
-						if (grid[y][x] == 1) {
-							// Wall survives if enough neighbors
-							newGrid[y][x] = (neighbors >= deathLimit) ? 1 : 0;
-						} else {
-							// Floor becomes wall if too many neighbors
-							newGrid[y][x] = (neighbors >= birthLimit) ? 1 : 0;
+							// Apply rules
+							if (grid.at(x, y) == 1.0f) {
+								// Wall survives if enough neighbors
+								newGrid.at(x, y) = (neighbors >= deathLimit) ? 1.0f : 0.0f;
+							} else {
+								// Floor becomes wall if too many neighbors
+								newGrid.at(x, y) = (neighbors >= birthLimit) ? 1.0f : 0.0f;
+							}
 						}
 					}
-				}
+				});
 
-				grid = newGrid;
+				std::swap(grid, newGrid);
 			}
 
-			return gridToTable(grid, lua);
+			return input.result(lua, std::move(grid), true);
 		});
 
 		// algo.generateCave(width, height, options) -> grid
 		// Generate a cave map using cellular automata
-		// options: { fillProbability, iterations, birthLimit, deathLimit, seed }
-		algoTable.set_function("generateCave", [](int width, int height, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
+		// options: { fillProbability, iterations, birthLimit, deathLimit, seed, asGrid }
+		algoTable.set_function("generateCave", [](int width, int height, sol::optional<sol::table> options, sol::this_state s) -> sol::object {
 			sol::state_view lua(s);
 
 			if (width <= 0 || height <= 0) {
@@ -212,48 +162,50 @@ namespace LuaAPI {
 			std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 
 			// Initialize random grid
-			std::vector<std::vector<int>> grid(height, std::vector<int>(width, 0));
+			LuaGrid grid(width, height);
 			for (int y = 0; y < height; ++y) {
 				for (int x = 0; x < width; ++x) {
 					// Edges are always walls
 					if (x == 0 || x == width - 1 || y == 0 || y == height - 1) {
-						grid[y][x] = 1;
+						grid.at(x, y) = 1.0f;
 					} else {
-						grid[y][x] = (dist(rng) < fillProbability) ? 1 : 0;
+						grid.at(x, y) = (dist(rng) < fillProbability) ? 1.0f : 0.0f;
 					}
 				}
 			}
 
-			// Run cellular automata
+			// Run cellular automata; the edges never change and the interior is
+			// rewritten every time, so the buffers just swap
+			LuaGrid newGrid = grid;
 			for (int iter = 0; iter < iterations; ++iter) {
-				std::vector<std::vector<int>> newGrid = grid;
-
-				for (int y = 1; y < height - 1; ++y) {
-					for (int x = 1; x < width - 1; ++x) {
-						int neighbors = 0;
-						for (int dy = -1; dy <= 1; ++dy) {
-							for (int dx = -1; dx <= 1; ++dx) {
-								if (dx == 0 && dy == 0) {
-									continue;
-								}
-								if (grid[y + dy][x + dx] == 1) {
-									neighbors++;
+				forEachRowBand(1, height - 1, width, [&](int begin, int end) {
+					for (int y = begin; y < end; ++y) {
+						for (int x = 1; x < width - 1; ++x) {
+							int neighbors = 0;
+							for (int dy = -1; dy <= 1; ++dy) {
+								for (int dx = -1; dx <= 1; ++dx) {
+									if (dx == 0 && dy == 0) {
+										continue;
+									}
+									if (grid.at(x + dx, y + dy) == 1.0f) {
+										neighbors++;
+									}
 								}
 							}
-						}
 
-						if (grid[y][x] == 1) {
-							newGrid[y][x] = (neighbors >= deathLimit) ? 1 : 0;
-						} else {
-							newGrid[y][x] = (neighbors >= birthLimit) ? 1 : 0;
+							if (grid.at(x, y) == 1.0f) {
+								newGrid.at(x, y) = (neighbors >= deathLimit) ? 1.0f : 0.0f;
+							} else {
+								newGrid.at(x, y) = (neighbors >= birthLimit) ? 1.0f : 0.0f;
+							}
 						}
 					}
-				}
+				});
 
-				grid = newGrid;
+				std::swap(grid, newGrid);
 			}
 
-			return gridToTable(grid, lua);
+			return pushGrid(lua, std::move(grid), wantsGrid(options), true);
 		});
 
 		// ========================================
@@ -262,22 +214,20 @@ namespace LuaAPI {
 
 		// algo.erode(heightmap, options) -> heightmap
 		// Hydraulic erosion simulation for terrain
-		// heightmap: 2D table of float values [0, 1]
+		// heightmap: Grid or 2D table of float values [0, 1]; returned in the same form
 		// options: { iterations, erosionRadius, inertia, sedimentCapacity, minSlope, erosionSpeed, depositSpeed, evaporateSpeed, gravity }
-		algoTable.set_function("erode", [](sol::table inputHeightmap, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
+		algoTable.set_function("erode", [](sol::object inputHeightmap, sol::optional<sol::table> options, sol::this_state s) -> sol::object {
 			sol::state_view lua(s);
 
-			// Get dimensions
-			int height = 0;
-			int width = 0;
-			if (inputHeightmap[1].valid()) {
-				height = static_cast<int>(inputHeightmap.size());
-				if (inputHeightmap[1].get_type() == sol::type::table) {
-					sol::table firstRow = inputHeightmap[1];
-					width = static_cast<int>(firstRow.size());
-				}
+			if (isEmptyTableGrid(inputHeightmap)) {
+				return inputHeightmap;
 			}
 
+			// Get dimensions
+			const GridArgument input(inputHeightmap, "algo.erode");
+			const int height = input->getHeight();
+			const int width = input->getWidth();
+
 			if (width <= 2 || height <= 2) {
 				return inputHeightmap;
 			}
@@ -311,7 +261,7 @@ namespace LuaAPI {
 				maxDropletLifetime = std::max(1, opts.get_or(std::string("maxDropletLifetime"), 30));
 			}
 
-			auto heightmap = tableToFloatGrid(inputHeightmap, width, height);
+			LuaGrid heightmap = *input;
 
 			std::mt19937 rng(seed);
 			std::uniform_real_distribution<float> dist(0.0f, 1.0f);
@@ -351,10 +301,10 @@ namespace LuaAPI {
 				xi = std::max(0, std::min(xi, width - 2));
 				yi = std::max(0, std::min(yi, height - 2));
 
-				float h00 = heightmap[yi][xi];
-				float h10 = heightmap[yi][xi + 1];
-				float h01 = heightmap[yi + 1][xi];
-				float h11 = heightmap[yi + 1][xi + 1];
+				float h00 = heightmap.at(xi, yi);
+				float h10 = heightmap.at(xi + 1, yi);
+				float h01 = heightmap.at(xi, yi + 1);
+				float h11 = heightmap.at(xi + 1, yi + 1);
 
 				return h00 * (1 - fx) * (1 - fy) + h10 * fx * (1 - fy) + h01 * (1 - fx) * fy + h11 * fx * fy;
 			};
@@ -367,8 +317,8 @@ namespace LuaAPI {
 				xi = std::max(1, std::min(xi, width - 2));
 				yi = std::max(1, std::min(yi, height - 2));
 
-				float gx = (heightmap[yi][xi + 1] - heightmap[yi][xi - 1]) * 0.5f;
-				float gy = (heightmap[yi + 1][xi] - heightmap[yi - 1][xi]) * 0.5f;
+				float gx = (heightmap.at(xi + 1, yi) - heightmap.at(xi - 1, yi)) * 0.5f;
+				float gy = (heightmap.at(xi, yi + 1) - heightmap.at(xi, yi - 1)) * 0.5f;
 
 				return { gx, gy };
 			};
@@ -427,7 +377,7 @@ namespace LuaAPI {
 						// Deposit at current position
 						int hx = std::min(std::max(nodeX, 0), width - 1);
 						int hy = std::min(std::max(nodeY, 0), height - 1);
-						heightmap[hy][hx] += amountToDeposit;
+						heightmap.at(hx, hy) += amountToDeposit;
 					} else {
 						// Erode terrain
 						float amountToErode = std::min((capacity - sediment) * erosionSpeed, -deltaHeight);
@@ -439,7 +389,7 @@ namespace LuaAPI {
 
 							if (ex >= 0 && ex < width && ey >= 0 && ey < height) {
 								float weightedErode = amountToErode * brushWeights[erosionRadius][j];
-								heightmap[ey][ex] -= weightedErode;
+								heightmap.at(ex, ey) -= weightedErode;
 								sediment += weightedErode;
 							}
 						}
@@ -453,24 +403,22 @@ namespace LuaAPI {
 				}
 			}
 
-			return floatGridToTable(heightmap, lua);
+			return input.result(lua, std::move(heightmap));
 		});
 
 		// algo.thermalErode(heightmap, options) -> heightmap
 		// Thermal erosion (talus/slope erosion)
-		algoTable.set_function("thermalErode", [](sol::table inputHeightmap, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
+		algoTable.set_function("thermalErode", [](sol::object inputHeightmap, sol::optional<sol::table> options, sol::this_state s) -> sol::object {
 			sol::state_view lua(s);
 
-			int height = 0;
-			int width = 0;
-			if (inputHeightmap[1].valid()) {
-				height = static_cast<int>(inputHeightmap.size());
-				if (inputHeightmap[1].get_type() == sol::type::table) {
-					sol::table firstRow = inputHeightmap[1];
-					width = static_cast<int>(firstRow.size());
-				}
+			if (isEmptyTableGrid(inputHeightmap)) {
+				return inputHeightmap;
 			}
 
+			const GridArgument input(inputHeightmap, "algo.thermalErode");
+			const int height = input->getHeight();
+			const int width = input->getWidth();
+
 			if (width <= 2 || height <= 2) {
 				return inputHeightmap;
 			}
@@ -486,18 +434,20 @@ namespace LuaAPI {
 				erosionAmount = opts.get_or(std::string("erosionAmount"), 0.5f);
 			}
 
-			auto heightmap = tableToFloatGrid(inputHeightmap, width, height);
+			LuaGrid heightmap = *input;
+			LuaGrid newHeightmap = heightmap;
 
 			// 4-directional neighbors
 			const int dx[] = { 0, 1, 0, -1 };
 			const int dy[] = { -1, 0, 1, 0 };
 
+			// Transfers reach into neighbouring rows, so this stays on one thread
 			for (int iter = 0; iter < iterations; ++iter) {
-				auto newHeightmap = heightmap;
+				std::ranges::copy(heightmap.values(), newHeightmap.values().begin());
 
 				for (int y = 1; y < height - 1; ++y) {
 					for (int x = 1; x < width - 1; ++x) {
-						float currentHeight = heightmap[y][x];
+						float currentHeight = heightmap.at(x, y);
 
 						// Find maximum difference
 						float maxDiff = 0;
@@ -506,7 +456,7 @@ namespace LuaAPI {
 						for (int i = 0; i < 4; ++i) {
 							int nx = x + dx[i];
 							int ny = y + dy[i];
-							float diff = currentHeight - heightmap[ny][nx];
+							float diff = currentHeight - heightmap.at(nx, ny);
 							if (diff > maxDiff) {
 								maxDiff = diff;
 								maxIdx = i;
@@ -516,16 +466,16 @@ namespace LuaAPI {
 						// Erode if slope exceeds talus angle
 						if (maxDiff > talusAngle && maxIdx >= 0) {
 							float transfer = (maxDiff - talusAngle) * erosionAmount * 0.5f;
-							newHeightmap[y][x] -= transfer;
-							newHeightmap[y + dy[maxIdx]][x + dx[maxIdx]] += transfer;
+							newHeightmap.at(x, y) -= transfer;
+							newHeightmap.at(x + dx[maxIdx], y + dy[maxIdx]) += transfer;
 						}
 					}
 				}
 
-				heightmap = newHeightmap;
+				std::swap(heightmap, newHeightmap);
 			}
 
-			return floatGridToTable(heightmap, lua);
+			return input.result(lua, std::move(heightmap));
 		});
 
 		// ========================================
@@ -533,20 +483,18 @@ namespace LuaAPI {
 		// ========================================
 
 		// algo.smooth(grid, options) -> grid
-		// Gaussian-like smoothing for grids
-		algoTable.set_function("smooth", [](sol::table inputGrid, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
+		// Gaussian-like smoothing for grids (Grid or 2D table, returned in the same form)
+		algoTable.set_function("smooth", [](sol::object inputGrid, sol::optional<sol::table> options, sol::this_state s) -> sol::object {
 			sol::state_view lua(s);
 
-			int height = 0;
-			int width = 0;
-			if (inputGrid[1].valid()) {
-				height = static_cast<int>(inputGrid.size());
-				if (inputGrid[1].get_type() == sol::type::table) {
-					sol::table firstRow = inputGrid[1];
-					width = static_cast<int>(firstRow.size());
-				}
+			if (isEmptyTableGrid(inputGrid)) {
+				return inputGrid;
 			}
 
+			const GridArgument input(inputGrid, "algo.smooth");
+			const int height = input->getHeight();
+			const int width = input->getWidth();
+
 			if (width <= 2 || height <= 2) {
 				return inputGrid;
 			}
@@ -566,42 +514,47 @@ namespace LuaAPI {
 				kernelSize++;
 			}
 
-			auto grid = tableToFloatGrid(inputGrid, width, height);
+			LuaGrid grid = *input;
+			LuaGrid newGrid = grid;
 
 			int radius = kernelSize / 2;
 
 			for (int iter = 0; iter < iterations; ++iter) {
-				auto newGrid = grid;
-
-				for (int y = radius; y < height - radius; ++y) {
-					for (int x = radius; x < width - radius; ++x) {
-						float sum = 0;
-						int count = 0;
-
-						for (int dy = -radius; dy <= radius; ++dy) {
-							for (int dx = -radius; dx <= radius; ++dx) {
-								sum += grid[y + dy][x + dx];
-								count++;
+				// The border the kernel does not fit in keeps its values
+				std::ranges::copy(grid.values(), newGrid.values().begin());
+
+				forEachRowBand(radius, height - radius, static_cast<size_t>(width) * kernelSize * kernelSize, [&](int begin, int end) {
+					for (int y = begin; y < end; ++y) {
+						for (int x = radius; x < width - radius; ++x) {
+							float sum = 0;
+							int count = 0;
+
+							for (int dy = -radius; dy <= radius; ++dy) {
+								for (int dx = -radius; dx <= radius; ++dx) {
+									sum += grid.at(x + dx, y + dy);
+									count++;
+								}
 							}
-						}
 
-						newGrid[y][x] = sum / count;
+							newGrid.at(x, y) = sum / count;
+						}
 					}
-				}
+				});
 
-				grid = newGrid;
+				std::swap(grid, newGrid);
 			}
 
-			return floatGridToTable(grid, lua);
+			return input.result(lua, std::move(grid));
 		});
 
 		// ========================================
 		// VORONOI DIAGRAM
 		// ========================================
 
-		// algo.voronoi(width, height, points) -> grid of region indices
+		// algo.voronoi(width, height, points, options) -> grid of region indices
 		// Generate Voronoi diagram from seed points
-		algoTable.set_function("voronoi", [](int width, int height, sol::table points, sol::this_state s) -> sol::table {
+		// options: { asGrid }
+		algoTable.set_function("voronoi", [](int width, int height, sol::table points, sol::optional<sol::table> options, sol::this_state s) -> sol::object {
 			sol::state_view lua(s);
 
 			if (width <= 0 || height <= 0) {
@@ -623,29 +576,31 @@ namespace LuaAPI {
 				return lua.create_table();
 			}
 
-			std::vector<std::vector<int>> grid(height, std::vector<int>(width, 0));
+			LuaGrid grid(width, height);
 
-			for (int y = 0; y < height; ++y) {
-				for (int x = 0; x < width; ++x) {
-					float minDist = std::numeric_limits<float>::max();
-					int closestRegion = 0;
+			forEachRowBand(0, height, static_cast<size_t>(width) * seedPoints.size(), [&](int begin, int end) {
+				for (int y = begin; y < end; ++y) {
+					for (int x = 0; x < width; ++x) {
+						float minDist = std::numeric_limits<float>::max();
+						int closestRegion = 0;
 
-					for (size_t i = 0; i < seedPoints.size(); ++i) {
-						float dx = (float)(x - seedPoints[i].first);
-						float dy = (float)(y - seedPoints[i].second);
-						float dist = dx * dx + dy * dy; // Squared distance for speed
+						for (size_t i = 0; i < seedPoints.size(); ++i) {
+							float dx = (float)(x - seedPoints[i].first);
+							float dy = (float)(y - seedPoints[i].second);
+							float dist = dx * dx + dy * dy; // Squared distance for speed
 
-						if (dist < minDist) {
-							minDist = dist;
-							closestRegion = static_cast<int>(i + 1); // 1-indexed for Lua
+							if (dist < minDist) {
+								minDist = dist;
+								closestRegion = static_cast<int>(i + 1); // 1-indexed for Lua
+							}
 						}
-					}
 
-					grid[y][x] = closestRegion;
+						grid.at(x, y) = static_cast<float>(closestRegion);
+					}
 				}
-			}
+			});
 
-			return gridToTable(grid, lua);
+			return pushGrid(lua, std::move(grid), wantsGrid(options), true);
 		});
 
 		// algo.generateRandomPoints(width, height, count, seed) -> table of points
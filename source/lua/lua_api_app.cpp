@@ -254,8 +254,39 @@ namespace LuaAPI {
 	// Global accessor for tile modification tracking (used by lua_api_tile.cpp)
 	void markTileForUndo(Tile* tile, bool originallyExisted) {
 		if (LuaTransaction::getInstance().isActive()) {
+			// The transaction's Action swaps the tile and keeps the index current
 			LuaTransaction::getInstance().markTileModified(tile, originallyExisted);
+		} else {
+			markItemsChanged();
+		}
+	}
+
+	void markItemsChanged() {
+		if (Editor* editor = g_gui.GetCurrentEditor()) {
+			editor->getMap()->getItemIndex().invalidate();
+		}
+	}
+
+	void runInTransaction(const std::string& name, const std::function<void()>& fn) {
+		LuaTransaction& trans = LuaTransaction::getInstance();
+		if (trans.isActive()) {
+			fn();
+			return;
+		}
+
+		Editor* editor = g_gui.GetCurrentEditor();
+		if (!editor) {
+			throw sol::error("No map open");
+		}
+
+		trans.begin(editor, name);
+		try {
+			fn();
+		} catch (...) {
+			trans.rollback();
+			throw;
 		}
+		trans.commit();
 	}
 
 	// ============================================================================
@@ -17,6 +17,7 @@
 
 #include "app/main.h"
 #include "lua_api_geo.h"
+#include "lua_api_grid.h"
 #include <random>
 
 #include <vector>
@@ -246,41 +247,26 @@ namespace LuaAPI {
 		// ========================================
 
 		// geo.floodFill(grid, startX, startY, newValue, options) -> grid
-		// Flood fill algorithm (4-connected or 8-connected)
-		geoTable.set_function("floodFill", [](sol::table inputGrid, int startX, int startY, int newValue, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
+		// Flood fill algorithm (4-connected or 8-connected) on a Grid or 2D
+		// table, returned in the same form
+		geoTable.set_function("floodFill", [](sol::object inputGrid, int startX, int startY, float newValue, sol::optional<sol::table> options, sol::this_state s) -> sol::object {
 			sol::state_view lua(s);
 
-			// Get dimensions
-			int height = static_cast<int>(inputGrid.size());
-			int width = 0;
-			if (inputGrid[1].valid() && inputGrid[1].get_type() == sol::type::table) {
-				sol::table firstRow = inputGrid[1];
-				width = static_cast<int>(firstRow.size());
-			}
-
-			if (width <= 0 || height <= 0) {
+			if (isEmptyTableGrid(inputGrid)) {
 				return inputGrid;
 			}
 
+			// Get dimensions
+			const GridArgument input(inputGrid, "geo.floodFill");
+			const int height = input->getHeight();
+			const int width = input->getWidth();
+
 			bool eightConnected = false;
 			if (options) {
 				sol::table opts = *options;
 				eightConnected = opts.get_or(std::string("eightConnected"), false);
 			}
 
-			// Convert to grid
-			std::vector<std::vector<int>> grid(height, std::vector<int>(width, 0));
-			for (int y = 1; y <= height; ++y) {
-				if (inputGrid[y].valid() && inputGrid[y].get_type() == sol::type::table) {
-					sol::table row = inputGrid[y];
-					for (int x = 1; x <= width; ++x) {
-						if (row[x].valid()) {
-							grid[y - 1][x - 1] = row[x].get<int>();
-						}
-					}
-				}
-			}
-
 			// Adjust for 1-indexed Lua
 			int sx = startX - 1;
 			int sy = startY - 1;
@@ -289,15 +275,17 @@ namespace LuaAPI {
 				return inputGrid;
 			}
 
-			int oldValue = grid[sy][sx];
+			const float oldValue = input->at(sx, sy);
 			if (oldValue == newValue) {
 				return inputGrid;
 			}
 
+			LuaGrid grid = *input;
+
 			// BFS flood fill
 			std::queue<std::pair<int, int>> queue;
 			queue.push({ sx, sy });
-			grid[sy][sx] = newValue; // Mark as visited
+			grid.at(sx, sy) = newValue; // Mark as visited
 
 			// Direction arrays
 			const int dx4[] = { 0, 1, 0, -1 };
@@ -316,62 +304,37 @@ namespace LuaAPI {
 				for (int i = 0; i < numDirs; ++i) {
 					int nx = cx + dx[i];
 					int ny = cy + dy[i];
-					if (nx >= 0 && nx < width && ny >= 0 && ny < height && grid[ny][nx] == oldValue) {
-						grid[ny][nx] = newValue; // Mark as visited on enqueue
+					if (nx >= 0 && nx < width && ny >= 0 && ny < height && grid.at(nx, ny) == oldValue) {
+						grid.at(nx, ny) = newValue; // Mark as visited on enqueue
 						queue.push({ nx, ny });
 					}
 				}
 			}
 
-			// Convert back to Lua table
-			sol::table result = lua.create_table();
-			for (int y = 0; y < height; ++y) {
-				sol::table row = lua.create_table();
-				for (int x = 0; x < width; ++x) {
-					row[x + 1] = grid[y][x];
-				}
-				result[y + 1] = row;
-			}
-
-			return result;
+			return input.result(lua, std::move(grid), true);
 		});
 
 		// geo.getFloodFillPositions(grid, startX, startY, options) -> table of positions
 		// Returns all positions that would be filled without modifying the grid
-		geoTable.set_function("getFloodFillPositions", [](sol::table inputGrid, int startX, int startY, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
+		geoTable.set_function("getFloodFillPositions", [](sol::object inputGrid, int startX, int startY, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
 			sol::state_view lua(s);
 			sol::table result = lua.create_table();
 
-			int height = static_cast<int>(inputGrid.size());
-			int width = 0;
-			if (inputGrid[1].valid() && inputGrid[1].get_type() == sol::type::table) {
-				sol::table firstRow = inputGrid[1];
-				width = static_cast<int>(firstRow.size());
-			}
-
-			if (width <= 0 || height <= 0) {
+			if (isEmptyTableGrid(inputGrid)) {
 				return result;
 			}
 
+			const GridArgument input(inputGrid, "geo.getFloodFillPositions");
+			const LuaGrid& grid = *input;
+			const int height = grid.getHeight();
+			const int width = grid.getWidth();
+
 			bool eightConnected = false;
 			if (options) {
 				sol::table opts = *options;
 				eightConnected = opts.get_or(std::string("eightConnected"), false);
 			}
 
-			// Convert to grid
-			std::vector<std::vector<int>> grid(height, std::vector<int>(width, 0));
-			for (int y = 1; y <= height; ++y) {
-				if (inputGrid[y].valid() && inputGrid[y].get_type() == sol::type::table) {
-					sol::table row = inputGrid[y];
-					for (int x = 1; x <= width; ++x) {
-						if (row[x].valid()) {
-							grid[y - 1][x - 1] = row[x].get<int>();
-						}
-					}
-				}
-			}
-
 			int sx = startX - 1;
 			int sy = startY - 1;
 
@@ -379,12 +342,12 @@ namespace LuaAPI {
 				return result;
 			}
 
-			int targetValue = grid[sy][sx];
+			const float targetValue = grid.at(sx, sy);
 
-			std::vector<std::vector<bool>> visited(height, std::vector<bool>(width, false));
+			std::vector<uint8_t> visited(static_cast<size_t>(width) * height, 0);
 			std::queue<std::pair<int, int>> queue;
 			queue.push({ sx, sy });
-			visited[sy][sx] = true;
+			visited[static_cast<size_t>(sy) * width + sx] = 1;
 
 			const int dx4[] = { 0, 1, 0, -1 };
 			const int dy4[] = { -1, 0, 1, 0 };
@@ -409,8 +372,8 @@ namespace LuaAPI {
 				for (int i = 0; i < numDirs; ++i) {
 					int nx = cx + dx[i];
 					int ny = cy + dy[i];
-					if (nx >= 0 && nx < width && ny >= 0 && ny < height && !visited[ny][nx] && grid[ny][nx] == targetValue) {
-						visited[ny][nx] = true;
+					if (nx >= 0 && nx < width && ny >= 0 && ny < height && !visited[static_cast<size_t>(ny) * width + nx] && grid.at(nx, ny) == targetValue) {
+						visited[static_cast<size_t>(ny) * width + nx] = 1;
 						queue.push({ nx, ny });
 					}
 				}
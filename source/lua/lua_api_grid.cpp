@@ -0,0 +1,314 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "app/main.h"
+#include "lua_api_grid.h"
+#include "app/task_scheduler.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <string>
+
+namespace LuaAPI {
+
+	LuaGrid::LuaGrid(int width, int height, float fill) :
+		width(width),
+		height(height) {
+		if (width <= 0 || height <= 0 || static_cast<int64_t>(width) * height > MAX_CELLS) {
+			throw sol::error("Grid: size must be positive and at most " + std::to_string(MAX_CELLS) + " cells, got " + std::to_string(width) + "x" + std::to_string(height));
+		}
+		cells.assign(static_cast<size_t>(width) * height, fill);
+	}
+
+	LuaGrid LuaGrid::fromTable(const sol::table& rows, int width, int height) {
+		if (height <= 0) {
+			height = static_cast<int>(rows.size());
+		}
+		if (width <= 0) {
+			sol::optional<sol::table> first = rows.raw_get<sol::optional<sol::table>>(1);
+			width = first ? static_cast<int>(first->size()) : 0;
+		}
+
+		LuaGrid grid(width, height);
+		for (int y = 0; y < height; ++y) {
+			sol::optional<sol::table> row = rows.raw_get<sol::optional<sol::table>>(y + 1);
+			if (!row) {
+				continue;
+			}
+			std::span<float> cells = grid.row(y);
+			for (int x = 0; x < width; ++x) {
+				cells[x] = row->raw_get<sol::optional<float>>(x + 1).value_or(0.0f);
+			}
+		}
+		return grid;
+	}
+
+	sol::table LuaGrid::toTable(sol::state_view lua, bool wholeNumbers) const {
+		sol::table rows = lua.create_table(height, 0);
+		for (int y = 0; y < height; ++y) {
+			std::span<const float> cells = row(y);
+			sol::table out = lua.create_table(width, 0);
+			for (int x = 0; x < width; ++x) {
+				if (wholeNumbers) {
+					out.raw_set(x + 1, static_cast<int64_t>(cells[x]));
+				} else {
+					out.raw_set(x + 1, cells[x]);
+				}
+			}
+			rows.raw_set(y + 1, out);
+		}
+		return rows;
+	}
+
+	GridArgument::GridArgument(const sol::object& value, const char* function, int width, int height) {
+		if (value.is<LuaGrid>()) {
+			grid = &value.as<const LuaGrid&>();
+		} else if (value.get_type() == sol::type::table) {
+			converted = LuaGrid::fromTable(value.as<sol::table>(), width, height);
+			grid = &*converted;
+		} else {
+			throw sol::error(std::string(function) + ": expected a Grid or a table of rows");
+		}
+	}
+
+	sol::object GridArgument::result(sol::state_view lua, LuaGrid&& computed, bool wholeNumbers) const {
+		return pushGrid(lua, std::move(computed), isGrid(), wholeNumbers);
+	}
+
+	sol::object pushGrid(sol::state_view lua, LuaGrid&& grid, bool asGrid, bool wholeNumbers) {
+		if (asGrid) {
+			return sol::make_object(lua, std::move(grid));
+		}
+		return grid.toTable(lua, wholeNumbers);
+	}
+
+	bool isEmptyTableGrid(const sol::object& grid) {
+		if (grid.get_type() != sol::type::table) {
+			return false;
+		}
+		sol::optional<sol::table> firstRow = grid.as<sol::table>().raw_get<sol::optional<sol::table>>(1);
+		return !firstRow || firstRow->size() == 0;
+	}
+
+	bool wantsGrid(const sol::optional<sol::table>& options) {
+		return options && options->get_or(std::string("asGrid"), false);
+	}
+
+	void forEachRowBand(int first, int last, size_t cellsPerRow, const std::function<void(int, int)>& fn) {
+		// Below this a task costs more to hand out than to run
+		constexpr size_t MIN_CELLS_PER_BAND = 16384;
+
+		if (last <= first) {
+			return;
+		}
+		const size_t rows = static_cast<size_t>(last - first);
+		const size_t cells = rows * std::max<size_t>(cellsPerRow, 1);
+		const size_t workers = static_cast<size_t>(g_scheduler.getWorkerCount());
+		if (workers < 2 || cells < 2 * MIN_CELLS_PER_BAND) {
+			fn(first, last);
+			return;
+		}
+
+		// A few bands per worker, so the ones that finish early can steal
+		const size_t bands = std::min({ workers * 4, cells / MIN_CELLS_PER_BAND, rows });
+		TaskGroup group(g_scheduler, TaskPriority::Interactive);
+		for (size_t band = 0; band < bands; ++band) {
+			const int begin = first + static_cast<int>(rows * band / bands);
+			const int end = first + static_cast<int>(rows * (band + 1) / bands);
+			group.run([&fn, begin, end]() { fn(begin, end); });
+		}
+		group.wait();
+	}
+
+	namespace {
+		// Plain loops over contiguous floats, left for the compiler to vectorize
+		template <typename Op>
+		void combine(LuaGrid& grid, const sol::object& operand, const char* function, Op op) {
+			std::span<float> cells = grid.values();
+			if (operand.get_type() == sol::type::number) {
+				const float value = operand.as<float>();
+				for (float& cell : cells) {
+					cell = op(cell, value);
+				}
+				return;
+			}
+			if (operand.is<LuaGrid>()) {
+				const LuaGrid& other = operand.as<const LuaGrid&>();
+				if (!grid.sameSize(other)) {
+					throw sol::error(std::string("Grid:") + function + ": grids differ in size");
+				}
+				std::span<const float> others = other.values();
+				for (size_t i = 0; i < cells.size(); ++i) {
+					cells[i] = op(cells[i], others[i]);
+				}
+				return;
+			}
+			throw sol::error(std::string("Grid:") + function + ": expected a number or a Grid");
+		}
+
+		template <typename Op>
+		void combineScalarFirst(float value, LuaGrid& grid, Op op) {
+			for (float& cell : grid.values()) {
+				cell = op(value, cell);
+			}
+		}
+
+		// In-place method returning the grid itself, so calls can be chained
+		template <typename Op>
+		auto inPlace(const char* function, Op op) {
+			return [function, op](sol::userdata self, const sol::object& operand) {
+				combine(self.as<LuaGrid&>(), operand, function, op);
+				return self;
+			};
+		}
+
+		// Binary operator returning a new grid: grid op (number | grid), number op grid
+		template <typename Op>
+		auto binaryOperator(const char* function, Op op) {
+			return sol::overload(
+				[function, op](const LuaGrid& grid, const sol::object& operand) {
+					LuaGrid result = grid;
+					combine(result, operand, function, op);
+					return result;
+				},
+				[op](float value, const LuaGrid& grid) {
+					LuaGrid result = grid;
+					combineScalarFirst(value, result, op);
+					return result;
+				}
+			);
+		}
+
+		void checkCell(const char* function, const LuaGrid& grid, int x, int y) {
+			if (!grid.contains(x - 1, y - 1)) {
+				throw sol::error(std::string("Grid:") + function + ": (" + std::to_string(x) + ", " + std::to_string(y) + ") is outside the " + std::to_string(grid.getWidth()) + "x" + std::to_string(grid.getHeight()) + " grid");
+			}
+		}
+
+		std::pair<float, float> minMax(const LuaGrid& grid) {
+			float lo = std::numeric_limits<float>::max();
+			float hi = std::numeric_limits<float>::lowest();
+			for (float cell : grid.values()) {
+				lo = std::min(lo, cell);
+				hi = std::max(hi, cell);
+			}
+			return { lo, hi };
+		}
+	}
+
+	void registerGrid(sol::state& lua) {
+		lua.new_usertype<LuaGrid>(
+			"Grid",
+			sol::call_constructor, sol::factories([](int width, int height, sol::optional<float> fill) { return LuaGrid(width, height, fill.value_or(0.0f)); }),
+			"new", sol::factories([](int width, int height, sol::optional<float> fill) { return LuaGrid(width, height, fill.value_or(0.0f)); }),
+			"fromTable", [](sol::table rows) {
+				return LuaGrid::fromTable(rows);
+			},
+
+			// Properties
+			"width", sol::property(&LuaGrid::getWidth),
+			"height", sol::property(&LuaGrid::getHeight),
+
+			// Cell access (1-based)
+			"get", [](const LuaGrid& grid, int x, int y) {
+				checkCell("get", grid, x, y);
+				return grid.at(x - 1, y - 1);
+			},
+			"set", [](LuaGrid& grid, int x, int y, float value) {
+				checkCell("set", grid, x, y);
+				grid.at(x - 1, y - 1) = value;
+			},
+			"toTable", [](const LuaGrid& grid, sol::this_state ts) {
+				return grid.toTable(sol::state_view(ts));
+			},
+			"clone", [](const LuaGrid& grid) {
+				return LuaGrid(grid);
+			},
+
+			// In-place arithmetic, each returns the grid
+			"fill", [](sol::userdata self, float value) {
+				std::span<float> cells = self.as<LuaGrid&>().values();
+				std::fill(cells.begin(), cells.end(), value);
+				return self;
+			},
+			"add", inPlace("add", std::plus<float>()),
+			"sub", inPlace("sub", std::minus<float>()),
+			"mul", inPlace("mul", std::multiplies<float>()),
+			"div", inPlace("div", std::divides<float>()),
+			"clamp", [](sol::userdata self, float lo, float hi) {
+				for (float& cell : self.as<LuaGrid&>().values()) {
+					cell = std::clamp(cell, lo, hi);
+				}
+				return self;
+			},
+			// Cells below t become below (0), the rest above (1)
+			"threshold", [](sol::userdata self, float t, sol::optional<float> below, sol::optional<float> above) {
+				const float low = below.value_or(0.0f);
+				const float high = above.value_or(1.0f);
+				for (float& cell : self.as<LuaGrid&>().values()) {
+					cell = cell < t ? low : high;
+				}
+				return self;
+			},
+			// Rescales the cells to [lo, hi], [0, 1] by default
+			"normalize", [](sol::userdata self, sol::optional<float> lo, sol::optional<float> hi) {
+				LuaGrid& grid = self.as<LuaGrid&>();
+				const float outLo = lo.value_or(0.0f);
+				const float outHi = hi.value_or(1.0f);
+				const auto [inLo, inHi] = minMax(grid);
+				const float scale = inHi > inLo ? (outHi - outLo) / (inHi - inLo) : 0.0f;
+				for (float& cell : grid.values()) {
+					cell = outLo + (cell - inLo) * scale;
+				}
+				return self;
+			},
+
+			// Reductions
+			"min", [](const LuaGrid& grid) {
+				return minMax(grid).first;
+			},
+			"max", [](const LuaGrid& grid) {
+				return minMax(grid).second;
+			},
+			"sum", [](const LuaGrid& grid) {
+				double sum = 0.0;
+				for (float cell : grid.values()) {
+					sum += cell;
+				}
+				return sum;
+			},
+			"count", [](const LuaGrid& grid, float value) {
+				std::span<const float> cells = grid.values();
+				return static_cast<uint64_t>(std::count(cells.begin(), cells.end(), value));
+			},
+
+			// Operators, each returns a new grid
+			sol::meta_function::addition, binaryOperator("add", std::plus<float>()),
+			sol::meta_function::subtraction, binaryOperator("sub", std::minus<float>()),
+			sol::meta_function::multiplication, binaryOperator("mul", std::multiplies<float>()),
+			sol::meta_function::division, binaryOperator("div", std::divides<float>()),
+			sol::meta_function::length, [](const LuaGrid& grid) {
+				return grid.size();
+			},
+			sol::meta_function::to_string, [](const LuaGrid& grid) {
+				return "Grid(" + std::to_string(grid.getWidth()) + "x" + std::to_string(grid.getHeight()) + ")";
+			}
+		);
+	}
+
+} // namespace LuaAPI
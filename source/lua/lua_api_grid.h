@@ -0,0 +1,137 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_LUA_API_GRID_H
+#define RME_LUA_API_GRID_H
+
+#include "lua_api.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace LuaAPI {
+
+	// Width x height numbers in one row-major float buffer, exposed to Lua as
+	// Grid. The noise, algo and geo functions take and return it as is, where
+	// rows of Lua tables cost one Lua value per cell at every step. Whole
+	// numbers are exact up to 2^24, which covers every id a script uses.
+	// Coordinates are 0-based here and 1-based in Lua.
+	class LuaGrid {
+	public:
+		// 4096x4096, 64 MiB
+		static constexpr int64_t MAX_CELLS = int64_t(1) << 24;
+
+		LuaGrid() = default;
+		// Throws sol::error unless 0 < width * height <= MAX_CELLS
+		LuaGrid(int width, int height, float fill = 0.0f);
+
+		int getWidth() const {
+			return width;
+		}
+		int getHeight() const {
+			return height;
+		}
+		size_t size() const {
+			return cells.size();
+		}
+		bool contains(int x, int y) const {
+			return x >= 0 && x < width && y >= 0 && y < height;
+		}
+		bool sameSize(const LuaGrid& other) const {
+			return width == other.width && height == other.height;
+		}
+
+		float& at(int x, int y) {
+			return cells[static_cast<size_t>(y) * width + x];
+		}
+		float at(int x, int y) const {
+			return cells[static_cast<size_t>(y) * width + x];
+		}
+		std::span<float> row(int y) {
+			return { cells.data() + static_cast<size_t>(y) * width, static_cast<size_t>(width) };
+		}
+		std::span<const float> row(int y) const {
+			return { cells.data() + static_cast<size_t>(y) * width, static_cast<size_t>(width) };
+		}
+		std::span<float> values() {
+			return cells;
+		}
+		std::span<const float> values() const {
+			return cells;
+		}
+
+		// Rows of numbers (rows[y][x]), width taken from the first row unless
+		// given. Missing cells are 0.
+		static LuaGrid fromTable(const sol::table& rows, int width = 0, int height = 0);
+		// wholeNumbers pushes Lua integers, for grids of ids and flags
+		sol::table toTable(sol::state_view lua, bool wholeNumbers = false) const;
+
+	private:
+		int width = 0;
+		int height = 0;
+		std::vector<float> cells;
+	};
+
+	// A grid argument from Lua. A Grid is read in place, rows of numbers are
+	// converted once. result() hands a computed grid back in the form the
+	// caller passed in.
+	class GridArgument {
+	public:
+		// width/height narrow a table to its top-left corner, 0 takes its size
+		GridArgument(const sol::object& value, const char* function, int width = 0, int height = 0);
+
+		const LuaGrid& operator*() const {
+			return *grid;
+		}
+		const LuaGrid* operator->() const {
+			return grid;
+		}
+		bool isGrid() const {
+			return !converted;
+		}
+
+		sol::object result(sol::state_view lua, LuaGrid&& computed, bool wholeNumbers = false) const;
+
+	private:
+		std::optional<LuaGrid> converted;
+		const LuaGrid* grid = nullptr;
+	};
+
+	// A Grid when asGrid is set, rows of numbers otherwise
+	sol::object pushGrid(sol::state_view lua, LuaGrid&& grid, bool asGrid, bool wholeNumbers = false);
+
+	// Rows-of-numbers tables without cells, which the algorithms hand back
+	// untouched
+	bool isEmptyTableGrid(const sol::object& grid);
+
+	// options.asGrid, for the functions that create grids from scratch
+	bool wantsGrid(const sol::optional<sol::table>& options);
+
+	// Calls fn(begin, end) on bands of the rows [first, last) spread over the
+	// task scheduler and returns once all are done; small jobs run inline.
+	// fn may only write to its own rows.
+	void forEachRowBand(int first, int last, size_t cellsPerRow, const std::function<void(int, int)>& fn);
+
+	// Register the Grid type
+	void registerGrid(sol::state& lua);
+}
+
+#endif // RME_LUA_API_GRID_H
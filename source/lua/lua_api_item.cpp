@@ -17,6 +17,7 @@
 
 #include "app/main.h"
 #include "lua_api_item.h"
+#include "lua_api.h"
 #include "game/item.h"
 #include "game/items.h"
 
@@ -76,12 +77,14 @@ namespace LuaAPI {
 					throw sol::error("item.actionId: value must be between 0 and 65535.");
 				}
 				item.setActionID(static_cast<uint16_t>(aid));
+				markItemsChanged();
 			}),
 			"uniqueId", sol::property([](const Item& item) -> int { return item.getUniqueID(); }, [](Item& item, int uid) {
 				if (uid < 0 || uid > 65535) {
 					throw sol::error("item.uniqueId: value must be between 0 and 65535.");
 				}
 				item.setUniqueID(static_cast<uint16_t>(uid));
+				markItemsChanged();
 			}),
 			"tier", sol::property([](const Item& item) -> int { return item.getTier(); }, [](Item& item, int tier) {
 				if (tier < 0 || tier > 65535) {
@@ -123,7 +126,11 @@ namespace LuaAPI {
 
 			// Methods
 			"clone", [](const Item& item) { return item.deepCopy(); },
-			"rotate", &Item::doRotate,
+			"rotate", [](Item& item) {
+				// Rotating swaps the server id
+				item.doRotate();
+				markItemsChanged();
+			},
 
 			// String representation
 			sol::meta_function::to_string, [](const Item& item) {
@@ -18,64 +18,636 @@
 #include "app/main.h"
 #include "lua_api_map.h"
 #include "lua_api.h"
+#include "lua_api_grid.h"
 #include "map/map.h"
 #include "map/basemap.h"
 #include "map/tile.h"
+#include "map/map_item_index.h"
+#include "map/map_tile_cursor.h"
+#include "map/tile_operations.h"
 #include "map/position.h"
+#include "game/item.h"
 #include "ui/gui.h"
 #include "editor/editor.h"
+#include "ui/replace_tool/replacement_engine.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 namespace LuaAPI {
 
-	// Custom iterator for Map tiles to use in Lua for-loops
-	// Iterator for Map Tiles
+	// Iterator for Map Tiles. Streams tiles straight off the grid, so a loop
+	// starts at once and costs no memory however large the map; tiles the
+	// loop body creates or deletes are handled by the cursor. Iteration ends
+	// if the map is closed or replaced.
 	class LuaMapTileIterator {
 	public:
-		LuaMapTileIterator(Map* mapPtr) :
+		LuaMapTileIterator(Map* mapPtr, const std::optional<MapTileCursor::Area>& area = std::nullopt) :
 			map(mapPtr),
-			mapGeneration(mapPtr ? mapPtr->getGeneration() : 0),
-			currentIndex(0) {
-			Editor* currentEditor = g_gui.GetCurrentEditor();
-			if (currentEditor && currentEditor->getMap() == map && map && map->getGeneration() == mapGeneration) {
-				for (auto it = map->begin(); it != map->end(); ++it) {
-					TileLocation* loc = &(*it);
-					if (loc && loc->get()) {
-						positions.push_back(loc->get()->getPosition());
-					}
+			mapGeneration(mapPtr ? mapPtr->getGeneration() : 0) {
+			if (isCurrent()) {
+				if (area) {
+					cursor.emplace(*map, *area);
+				} else {
+					cursor.emplace(*map);
 				}
 			}
 		}
 
-		std::tuple<sol::object, sol::object> next(sol::this_state ts) {
-			sol::state_view lua(ts);
-
-			Editor* currentEditor = g_gui.GetCurrentEditor();
-			if (!currentEditor || currentEditor->getMap() != map || !map || map->getGeneration() != mapGeneration) {
-				return std::make_tuple(sol::nil, sol::nil);
+		Tile* nextTile() {
+			if (!cursor || !isCurrent()) {
+				return nullptr;
 			}
+			return cursor->next();
+		}
 
-			// Find next valid tile
-			while (currentIndex < positions.size()) {
-				Position pos = positions[currentIndex++];
-				Tile* tile = map->getTile(pos);
-				if (tile) {
-					return std::make_tuple(
-						sol::make_object(lua, tile),
-						sol::make_object(lua, tile)
-					);
-				}
+		size_t nextTiles(std::span<Tile*> tiles) {
+			if (!cursor || !isCurrent()) {
+				return 0;
 			}
+			return cursor->next(tiles);
+		}
+
+		std::tuple<sol::object, sol::object> next(sol::this_state ts) {
+			sol::state_view lua(ts);
 
+			if (Tile* tile = nextTile()) {
+				return std::make_tuple(
+					sol::make_object(lua, tile),
+					sol::make_object(lua, tile)
+				);
+			}
 			return std::make_tuple(sol::nil, sol::nil);
 		}
 
 	private:
+		bool isCurrent() const {
+			Editor* currentEditor = g_gui.GetCurrentEditor();
+			return currentEditor && currentEditor->getMap() == map && map && map->getGeneration() == mapGeneration;
+		}
+
 		Map* map;
 		uint64_t mapGeneration;
-		std::vector<Position> positions;
-		size_t currentIndex;
+		std::optional<MapTileCursor> cursor;
 	};
 
+	namespace {
+		int checkedCoordinate(const char* function, int value, int max) {
+			if (value < 0 || value > max) {
+				throw sol::error(std::string(function) + ": Invalid coordinate " + std::to_string(value));
+			}
+			return value;
+		}
+
+		// tilesIn(x1, y1, x2, y2[, z]) or tilesIn(from, to); corners in any order
+		MapTileCursor::Area readArea(sol::variadic_args va) {
+			int x1, y1, x2, y2, z1, z2;
+			if (va.size() == 2 && va[0].is<Position>() && va[1].is<Position>()) {
+				const Position from = va[0].as<Position>();
+				const Position to = va[1].as<Position>();
+				x1 = from.x;
+				y1 = from.y;
+				z1 = from.z;
+				x2 = to.x;
+				y2 = to.y;
+				z2 = to.z;
+			} else if (va.size() == 4 || va.size() == 5) {
+				x1 = va[0].as<int>();
+				y1 = va[1].as<int>();
+				x2 = va[2].as<int>();
+				y2 = va[3].as<int>();
+				if (va.size() == 5 && va[4].get_type() != sol::type::lua_nil) {
+					z1 = z2 = va[4].as<int>();
+				} else {
+					z1 = 0;
+					z2 = MAP_MAX_LAYER;
+				}
+			} else {
+				throw sol::error("tilesIn expects (x1, y1, x2, y2[, z]) or (Position, Position)");
+			}
+
+			MapTileCursor::Area area;
+			area.min_x = checkedCoordinate("tilesIn", std::min(x1, x2), 65535);
+			area.max_x = checkedCoordinate("tilesIn", std::max(x1, x2), 65535);
+			area.min_y = checkedCoordinate("tilesIn", std::min(y1, y2), 65535);
+			area.max_y = checkedCoordinate("tilesIn", std::max(y1, y2), 65535);
+			area.min_z = checkedCoordinate("tilesIn", std::min(z1, z2), MAP_MAX_LAYER);
+			area.max_z = checkedCoordinate("tilesIn", std::max(z1, z2), MAP_MAX_LAYER);
+			return area;
+		}
+
+		sol::object makeTileIterator(sol::this_state ts, Map* map, const std::optional<MapTileCursor::Area>& area) {
+			sol::state_view lua(ts);
+			auto iterator = std::make_shared<LuaMapTileIterator>(map, area);
+
+			// Return the iterator function that Lua will call repeatedly
+			return sol::make_object(lua, [iterator](sol::this_state ts) {
+				return iterator->next(ts);
+			});
+		}
+
+		template <typename Result>
+		bool stopRequested(Result& result) {
+			return result.return_count() > 0 && result.get_type() == sol::type::boolean && !result.template get<bool>();
+		}
+
+		// map:forEachTile(fn[, options]) -> number of tiles visited
+		// options: { batch = N } hands fn a fresh array of up to N tiles per call
+		// (plus its length) instead of one tile, cutting the number of calls
+		// between C++ and Lua. Returning false from fn stops the walk.
+		//
+		// A batch only holds positions: every tiles[i] looks its tile up again,
+		// so fn may change the map freely in either form. An entry whose tile
+		// was deleted reads as nil, and all of them do once the map is closed.
+		uint64_t forEachTile(Map* map, sol::function fn, sol::optional<sol::table> options, sol::this_state ts) {
+			sol::state_view lua(ts);
+
+			int batch = 0;
+			if (options) {
+				batch = options->get_or(std::string("batch"), 0);
+				if (batch < 0) {
+					throw sol::error("forEachTile: batch cannot be negative");
+				}
+			}
+
+			LuaMapTileIterator iterator(map);
+			uint64_t visited = 0;
+			if (batch == 0) {
+				while (Tile* tile = iterator.nextTile()) {
+					++visited;
+					auto result = fn(tile);
+					if (stopRequested(result)) {
+						break;
+					}
+				}
+				return visited;
+			}
+
+			const uint64_t generation = map->getGeneration();
+			std::vector<Tile*> tiles(static_cast<size_t>(batch));
+			while (true) {
+				const size_t count = iterator.nextTiles(tiles);
+				if (count == 0) {
+					break;
+				}
+				visited += count;
+
+				auto positions = std::make_shared<std::vector<Position>>(count);
+				for (size_t i = 0; i < count; ++i) {
+					(*positions)[i] = tiles[i]->getPosition();
+				}
+				sol::table meta = lua.create_table();
+				meta[sol::meta_function::index] = [map, generation, positions](sol::table, sol::object key) -> Tile* {
+					if (!key.is<int>()) {
+						return nullptr;
+					}
+					const int index = key.as<int>();
+					if (index < 1 || static_cast<size_t>(index) > positions->size()) {
+						return nullptr;
+					}
+					Editor* editor = g_gui.GetCurrentEditor();
+					if (!editor || editor->getMap() != map || map->getGeneration() != generation) {
+						return nullptr;
+					}
+					return map->getTile((*positions)[index - 1]);
+				};
+				meta[sol::meta_function::length] = [count](sol::table) {
+					return count;
+				};
+				sol::table chunk = lua.create_table();
+				chunk[sol::metatable_key] = meta;
+
+				auto result = fn(chunk, count);
+				if (stopRequested(result) || count < tiles.size()) {
+					break;
+				}
+			}
+			return visited;
+		}
+
+		// Largest region fillRegion/applyGrid take in one call (4096x4096)
+		constexpr int64_t MAX_REGION_TILES = int64_t(1) << 24;
+
+		// Inclusive rectangle on one floor
+		struct Region {
+			int min_x, min_y, max_x, max_y;
+
+			int width() const {
+				return max_x - min_x + 1;
+			}
+			int height() const {
+				return max_y - min_y + 1;
+			}
+			bool contains(int x, int y) const {
+				return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+			}
+		};
+
+		template <typename Key>
+		int rectField(const char* function, const sol::table& rect, Key key) {
+			sol::optional<int> value = rect[key];
+			if (!value) {
+				throw sol::error(std::string(function) + ": rect expects { x1, y1, x2, y2 }, { x = , y = , width = , height = } or { min = Position, max = Position }");
+			}
+			return *value;
+		}
+
+		// { x1, y1, x2, y2 }, { x = , y = , width = , height = } or bounds such
+		// as app.selection.bounds ({ min = Position, max = Position })
+		Region readRegion(const char* function, const sol::table& rect) {
+			int x1, y1, x2, y2;
+			sol::optional<Position> from = rect["min"];
+			sol::optional<Position> to = rect["max"];
+			if (from && to) {
+				x1 = from->x;
+				y1 = from->y;
+				x2 = to->x;
+				y2 = to->y;
+			} else if (rect["width"].valid()) {
+				x1 = rectField(function, rect, "x");
+				y1 = rectField(function, rect, "y");
+				const int width = rectField(function, rect, "width");
+				const int height = rectField(function, rect, "height");
+				if (width < 1 || height < 1) {
+					throw sol::error(std::string(function) + ": rect width and height must be positive");
+				}
+				x2 = x1 + width - 1;
+				y2 = y1 + height - 1;
+			} else {
+				x1 = rectField(function, rect, 1);
+				y1 = rectField(function, rect, 2);
+				x2 = rectField(function, rect, 3);
+				y2 = rectField(function, rect, 4);
+			}
+
+			Region region;
+			region.min_x = checkedCoordinate(function, std::min(x1, x2), 65535);
+			region.max_x = checkedCoordinate(function, std::max(x1, x2), 65535);
+			region.min_y = checkedCoordinate(function, std::min(y1, y2), 65535);
+			region.max_y = checkedCoordinate(function, std::max(y1, y2), 65535);
+			return region;
+		}
+
+		void checkRegionSize(const char* function, const Region& region) {
+			if (static_cast<int64_t>(region.width()) * region.height() > MAX_REGION_TILES) {
+				throw sol::error(std::string(function) + ": rect is larger than 4096x4096 tiles");
+			}
+		}
+
+		void requireCurrentMap(const char* function, Map* map) {
+			Editor* editor = g_gui.GetCurrentEditor();
+			if (!map || !editor || editor->getMap() != map) {
+				throw sol::error(std::string(function) + ": map is not open in the current editor");
+			}
+		}
+
+		uint16_t checkedGroundId(const char* function, int groundId) {
+			if (groundId < 1 || groundId > 65535) {
+				throw sol::error(std::string(function) + ": ground item id must be between 1 and 65535");
+			}
+			const std::unique_ptr<Item> ground = Item::Create(static_cast<uint16_t>(groundId));
+			if (!ground || !ground->isGroundTile()) {
+				throw sol::error(std::string(function) + ": " + std::to_string(groundId) + " is not a ground item");
+			}
+			return static_cast<uint16_t>(groundId);
+		}
+
+		bool borderizeOption(const sol::optional<sol::table>& options) {
+			return options ? options->get_or(std::string("borderize"), true) : true;
+		}
+
+		// Sets the ground of every tile of region where grounds (row-major over
+		// region) is non-zero, creating tiles as needed. With borderize, borders
+		// are worked out once at the end for the painted tiles and their
+		// neighbours, as a ground brush stroke does, rather than after every
+		// tile. Callers run this inside a transaction.
+		uint64_t paintGrounds(Map* map, const Region& region, int z, std::span<const uint16_t> grounds, bool borderize) {
+			const int width = region.width();
+			uint64_t painted = 0;
+			for (int y = region.min_y; y <= region.max_y; ++y) {
+				const uint16_t* row = grounds.data() + static_cast<size_t>(y - region.min_y) * width;
+				for (int x = region.min_x; x <= region.max_x; ++x) {
+					const uint16_t groundId = row[x - region.min_x];
+					if (groundId == 0) {
+						continue;
+					}
+
+					Tile* tile = map->getTile(x, y, z);
+					if (tile) {
+						markTileForUndo(tile);
+					} else {
+						tile = map->getOrCreateTile(Position(x, y, z));
+						markTileForUndo(tile, false);
+					}
+					if (borderize) {
+						TileOperations::cleanBorders(tile);
+					}
+					tile->setGround(Item::Create(groundId));
+					tile->modify();
+					++painted;
+				}
+			}
+
+			if (!borderize || painted == 0) {
+				return painted;
+			}
+
+			const auto paintedAt = [&](int x, int y) {
+				return region.contains(x, y) && grounds[static_cast<size_t>(y - region.min_y) * width + (x - region.min_x)] != 0;
+			};
+			const auto nearPainted = [&](int x, int y) {
+				for (int dy = -1; dy <= 1; ++dy) {
+					for (int dx = -1; dx <= 1; ++dx) {
+						if (paintedAt(x + dx, y + dy)) {
+							return true;
+						}
+					}
+				}
+				return false;
+			};
+
+			for (int y = std::max(region.min_y - 1, 0); y <= std::min(region.max_y + 1, 65535); ++y) {
+				for (int x = std::max(region.min_x - 1, 0); x <= std::min(region.max_x + 1, 65535); ++x) {
+					if (!nearPainted(x, y)) {
+						continue;
+					}
+
+					if (Tile* tile = map->getTile(x, y, z)) {
+						if (!paintedAt(x, y)) {
+							markTileForUndo(tile);
+						}
+						TileOperations::borderize(tile, map);
+						tile->modify();
+						continue;
+					}
+
+					// Empty neighbours only get a tile if a border lands on them
+					std::unique_ptr<Tile> edge(map->allocator(map->createTileL(x, y, z)));
+					TileOperations::borderize(edge.get(), map);
+					if (!edge->empty()) {
+						Tile* placed = edge.get();
+						(void)map->setTile(x, y, z, std::move(edge));
+						markTileForUndo(placed, false);
+						placed->modify();
+					}
+				}
+			}
+			return painted;
+		}
+
+		// map:fillRegion(rect, z, groundId[, options]) -> tiles painted
+		uint64_t fillRegion(Map* map, sol::table rect, int z, int groundId, sol::optional<sol::table> options) {
+			requireCurrentMap("fillRegion", map);
+			const Region region = readRegion("fillRegion", rect);
+			checkRegionSize("fillRegion", region);
+			checkedCoordinate("fillRegion", z, MAP_MAX_LAYER);
+
+			const std::vector<uint16_t> grounds(static_cast<size_t>(region.width()) * region.height(), checkedGroundId("fillRegion", groundId));
+			const bool borderize = borderizeOption(options);
+
+			uint64_t painted = 0;
+			runInTransaction("Fill region", [&]() {
+				painted = paintGrounds(map, region, z, grounds, borderize);
+			});
+			return painted;
+		}
+
+		// Grid value to ground id, 0 where the palette has no entry
+		class GroundPalette {
+		public:
+			explicit GroundPalette(const sol::table& palette) {
+				for (const auto& [key, value] : palette) {
+					if (key.get_type() != sol::type::number || value.get_type() != sol::type::number) {
+						throw sol::error("applyGrid: palette must map numbers to ground item ids");
+					}
+					grounds[static_cast<int64_t>(std::floor(key.as<double>()))] = checkedGroundId("applyGrid", value.as<int>());
+				}
+			}
+
+			uint16_t operator()(double value) const {
+				const auto it = grounds.find(static_cast<int64_t>(std::floor(value)));
+				return it != grounds.end() ? it->second : 0;
+			}
+
+		private:
+			std::unordered_map<int64_t, uint16_t> grounds;
+		};
+
+		// Reads the region's cells out of grid: a Grid, rows of numbers
+		// (grid[y][x], as the algo functions return), one flat row-major array,
+		// or a string with one byte per cell. Missing cells stay 0.
+		std::vector<uint16_t> readGroundGrid(const Region& region, const sol::object& grid, const GroundPalette& palette) {
+			const size_t width = static_cast<size_t>(region.width());
+			const size_t height = static_cast<size_t>(region.height());
+			std::vector<uint16_t> grounds(width * height, 0);
+
+			if (grid.is<LuaGrid>()) {
+				const LuaGrid& cells = grid.as<const LuaGrid&>();
+				const int rows = std::min(cells.getHeight(), region.height());
+				const int columns = std::min(cells.getWidth(), region.width());
+				for (int y = 0; y < rows; ++y) {
+					std::span<const float> row = cells.row(y);
+					for (int x = 0; x < columns; ++x) {
+						grounds[static_cast<size_t>(y) * width + x] = palette(row[x]);
+					}
+				}
+				return grounds;
+			}
+
+			if (grid.get_type() == sol::type::string) {
+				const std::string_view bytes = grid.as<std::string_view>();
+				if (bytes.size() < grounds.size()) {
+					throw sol::error("applyGrid: grid string is shorter than the rect (" + std::to_string(bytes.size()) + " < " + std::to_string(grounds.size()) + " bytes)");
+				}
+				for (size_t i = 0; i < grounds.size(); ++i) {
+					grounds[i] = palette(static_cast<uint8_t>(bytes[i]));
+				}
+				return grounds;
+			}
+
+			if (grid.get_type() != sol::type::table) {
+				throw sol::error("applyGrid: grid must be a Grid, a table or a string");
+			}
+
+			const sol::table cells = grid.as<sol::table>();
+			if (cells.raw_get<sol::object>(1).get_type() == sol::type::table) {
+				for (size_t y = 0; y < height; ++y) {
+					sol::optional<sol::table> row = cells.raw_get<sol::optional<sol::table>>(y + 1);
+					if (!row) {
+						continue;
+					}
+					for (size_t x = 0; x < width; ++x) {
+						if (sol::optional<double> value = row->raw_get<sol::optional<double>>(x + 1)) {
+							grounds[y * width + x] = palette(*value);
+						}
+					}
+				}
+			} else {
+				for (size_t i = 0; i < grounds.size(); ++i) {
+					if (sol::optional<double> value = cells.raw_get<sol::optional<double>>(i + 1)) {
+						grounds[i] = palette(*value);
+					}
+				}
+			}
+			return grounds;
+		}
+
+		// map:applyGrid(rect, z, grid, palette[, options]) -> tiles painted
+		uint64_t applyGrid(Map* map, sol::table rect, int z, sol::object grid, sol::table palette, sol::optional<sol::table> options) {
+			requireCurrentMap("applyGrid", map);
+			const Region region = readRegion("applyGrid", rect);
+			checkRegionSize("applyGrid", region);
+			checkedCoordinate("applyGrid", z, MAP_MAX_LAYER);
+
+			const std::vector<uint16_t> grounds = readGroundGrid(region, grid, GroundPalette(palette));
+			const bool borderize = borderizeOption(options);
+
+			uint64_t painted = 0;
+			runInTransaction("Apply grid", [&]() {
+				painted = paintGrounds(map, region, z, grounds, borderize);
+			});
+			return painted;
+		}
+
+		// map:countItems(rect, ids[, z]) -> total, { [id] = count }
+		// Counts grounds and items lying on tiles, not container contents.
+		std::tuple<uint64_t, sol::table> countItems(Map* map, sol::table rect, sol::object ids, sol::optional<int> z, sol::this_state ts) {
+			sol::state_view lua(ts);
+			if (!map) {
+				throw sol::error("countItems: invalid map");
+			}
+
+			std::vector<uint16_t> wanted;
+			const auto addId = [&](int id) {
+				if (id < 1 || id > 65535) {
+					throw sol::error("countItems: item id must be between 1 and 65535");
+				}
+				wanted.push_back(static_cast<uint16_t>(id));
+			};
+			if (ids.get_type() == sol::type::number) {
+				addId(ids.as<int>());
+			} else if (ids.get_type() == sol::type::table) {
+				const sol::table list = ids.as<sol::table>();
+				for (size_t i = 1; i <= list.size(); ++i) {
+					addId(list.raw_get<int>(i));
+				}
+			} else {
+				throw sol::error("countItems: ids must be an item id or an array of them");
+			}
+
+			const Region region = readRegion("countItems", rect);
+			MapTileCursor::Area area;
+			area.min_x = region.min_x;
+			area.max_x = region.max_x;
+			area.min_y = region.min_y;
+			area.max_y = region.max_y;
+			area.min_z = z ? checkedCoordinate("countItems", *z, MAP_MAX_LAYER) : 0;
+			area.max_z = z ? *z : MAP_MAX_LAYER;
+
+			std::bitset<65536> lookup;
+			std::unordered_map<uint16_t, uint64_t> counts;
+			for (uint16_t id : wanted) {
+				lookup.set(id);
+				counts[id] = 0;
+			}
+
+			uint64_t total = 0;
+			const auto count = [&](const Item* item) {
+				if (lookup.test(item->getID())) {
+					++counts[item->getID()];
+					++total;
+				}
+			};
+
+			MapTileCursor cursor(*map, area);
+			while (Tile* tile = cursor.next()) {
+				if (tile->ground) {
+					count(tile->ground.get());
+				}
+				for (const auto& item : tile->items) {
+					count(item.get());
+				}
+			}
+
+			sol::table perId = lua.create_table(0, static_cast<int>(counts.size()));
+			for (const auto& [id, n] : counts) {
+				perId[id] = n;
+			}
+			return std::make_tuple(total, perId);
+		}
+
+		// map:findItems({ itemId = n } | { actionId = n } | { uniqueId = n })
+		// -> positions of the tiles holding such an item, container contents
+		// included, in map order. Served by the map's item index.
+		sol::table findItems(Map* map, sol::table query, sol::this_state ts) {
+			sol::state_view lua(ts);
+			if (!map) {
+				throw sol::error("findItems: invalid map");
+			}
+
+			constexpr std::pair<const char*, MapItemIndex::Field> FIELDS[] = {
+				{ "itemId", MapItemIndex::Field::ServerId },
+				{ "actionId", MapItemIndex::Field::ActionId },
+				{ "uniqueId", MapItemIndex::Field::UniqueId },
+			};
+			std::optional<std::pair<MapItemIndex::Field, uint16_t>> lookup;
+			for (const auto& [name, field] : FIELDS) {
+				const sol::optional<int> value = query.get<sol::optional<int>>(name);
+				if (!value) {
+					continue;
+				}
+				if (lookup) {
+					throw sol::error("findItems: give exactly one of itemId, actionId or uniqueId");
+				}
+				if (*value < 1 || *value > 65535) {
+					throw sol::error(std::string("findItems: ") + name + " must be between 1 and 65535");
+				}
+				lookup.emplace(field, static_cast<uint16_t>(*value));
+			}
+			if (!lookup) {
+				throw sol::error("findItems: give exactly one of itemId, actionId or uniqueId");
+			}
+
+			const std::vector<Position> positions = map->getItemIndex().findPositions(*map, lookup->first, lookup->second);
+			sol::table result = lua.create_table(static_cast<int>(positions.size()), 0);
+			for (size_t i = 0; i < positions.size(); ++i) {
+				result[i + 1] = positions[i];
+			}
+			return result;
+		}
+
+		// map:replaceItems({ [fromId] = toId, ... }) -> replaces every ground
+		// and item with fromId, container contents included, the same way the
+		// Replace Items tool does on the whole map. Not undoable.
+		void replaceItems(Map* map, sol::table pairs) {
+			requireCurrentMap("replaceItems", map);
+
+			std::vector<ReplacementRule> rules;
+			for (const auto& [key, value] : pairs) {
+				if (!key.is<int>() || !value.is<int>()) {
+					throw sol::error("replaceItems: expected a table of { [fromId] = toId }");
+				}
+				const int fromId = key.as<int>();
+				const int toId = value.as<int>();
+				if (fromId < 1 || fromId > 65535 || toId < 1 || toId > 65535) {
+					throw sol::error("replaceItems: item ids must be between 1 and 65535");
+				}
+				rules.push_back(ReplacementRule { .fromId = static_cast<uint16_t>(fromId), .targets = { ReplacementTarget { .id = static_cast<uint16_t>(toId), .probability = 100 } } });
+			}
+
+			ReplacementEngine engine;
+			engine.ExecuteReplacement(g_gui.GetCurrentEditor(), rules, ReplaceScope::AllMap);
+		}
+	}
+
 	// Iterator for Spawns
 	class LuaMapSpawnIterator {
 	public:
@@ -183,16 +755,23 @@ namespace LuaAPI {
 
 			// Tiles iterator - allows: for tile in map.tiles do ... end
 			"tiles", sol::property([](Map* map, sol::this_state ts) {
-				sol::state_view lua(ts);
+				return makeTileIterator(ts, map, std::nullopt);
+			}),
 
-				// Return an iterator function
-				auto iterator = std::make_shared<LuaMapTileIterator>(map);
+			// Area-bounded tiles iterator - for tile in map:tilesIn(x1, y1, x2, y2, z) do ... end
+			"tilesIn", [](Map* map, sol::variadic_args va, sol::this_state ts) {
+				return makeTileIterator(ts, map, readArea(va));
+			},
 
-				// Return the iterator function that Lua will call repeatedly
-				return sol::make_object(lua, [iterator](sol::this_state ts) {
-					return iterator->next(ts);
-				});
-			}),
+			// Calls fn for every tile, or for batches of them
+			"forEachTile", &forEachTile,
+
+			// Bulk edits, each one undo step (or part of the enclosing transaction)
+			"fillRegion", &fillRegion,
+			"applyGrid", &applyGrid,
+			"countItems", &countItems,
+			"findItems", &findItems,
+			"replaceItems", &replaceItems,
 
 			// Spawns iterator - allows: for tile in map.spawns do ... end
 			"spawns", sol::property([](Map* map, sol::this_state ts) {
@@ -17,8 +17,11 @@
 
 #include "app/main.h"
 #include "lua_api_noise.h"
+#include "lua_api_grid.h"
 #include "ext/fast_noise_lite.h"
 
+#include <span>
+
 namespace LuaAPI {
 
 	// Helper to create configured noise generator
@@ -389,11 +392,11 @@ namespace LuaAPI {
 		// BATCH GENERATION (for performance)
 		// ========================================
 
-		// noise.generateGrid(x1, y1, x2, y2, options) -> table of values
-		// Generate noise values for a grid area (faster than individual calls)
-		noiseTable.set_function("generateGrid", [](int x1, int y1, int x2, int y2, sol::optional<sol::table> options, sol::this_state s) -> sol::table {
+		// noise.generateGrid(x1, y1, x2, y2, options) -> table of values, or Grid with asGrid
+		// Generate noise values for a grid area (faster than individual calls),
+		// rows spread over the worker threads
+		noiseTable.set_function("generateGrid", [](int x1, int y1, int x2, int y2, sol::optional<sol::table> options, sol::this_state s) -> sol::object {
 			sol::state_view lua(s);
-			sol::table result = lua.create_table();
 
 			if (x1 > x2 || y1 > y2) {
 				throw sol::error("noise.generateGrid: x1 must be <= x2 and y1 must be <= y2");
@@ -402,7 +405,9 @@ namespace LuaAPI {
 			const int64_t width = static_cast<int64_t>(x2) - static_cast<int64_t>(x1) + 1;
 			const int64_t height = static_cast<int64_t>(y2) - static_cast<int64_t>(y1) + 1;
 
-			constexpr int64_t MAX_GRID_CELLS = 1000000;
+			// Tables cost a Lua value per cell, a Grid only its float
+			const bool asGrid = wantsGrid(options);
+			const int64_t MAX_GRID_CELLS = asGrid ? LuaGrid::MAX_CELLS : 1000000;
 			if (width <= 0 || height <= 0 || width > MAX_GRID_CELLS / height) {
 				throw sol::error("noise.generateGrid: Requested grid is too large (exceeds " + std::to_string(MAX_GRID_CELLS) + " cells)");
 			}
@@ -442,16 +447,19 @@ namespace LuaAPI {
 				noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
 			}
 
-			// Generate values
-			for (int64_t y = y1; y <= y2; ++y) {
-				sol::table row = lua.create_table();
-				for (int64_t x = x1; x <= x2; ++x) {
-					row[x - static_cast<int64_t>(x1) + 1] = noise.GetNoise(static_cast<float>(x), static_cast<float>(y));
+			// Generate values; GetNoise is const, so the generator is shared
+			LuaGrid grid(static_cast<int>(width), static_cast<int>(height));
+			forEachRowBand(0, grid.getHeight(), grid.getWidth(), [&](int begin, int end) {
+				for (int y = begin; y < end; ++y) {
+					std::span<float> row = grid.row(y);
+					const float noiseY = static_cast<float>(static_cast<int64_t>(y1) + y);
+					for (int x = 0; x < grid.getWidth(); ++x) {
+						row[x] = noise.GetNoise(static_cast<float>(static_cast<int64_t>(x1) + x), noiseY);
+					}
 				}
-				result[y - static_cast<int64_t>(y1) + 1] = row;
-			}
+			});
 
-			return result;
+			return pushGrid(lua, std::move(grid), asGrid);
 		});
 
 		// noise.clearCache()
@@ -39,6 +39,13 @@ LuaScriptManager& LuaScriptManager::getInstance() {
 	return instance;
 }
 
+LuaScriptManager::LuaScriptManager() {
+	// Order must match the EVENT_* constants
+	for (const char* name : { "actionChange", "selectionChange", "brushChange" }) {
+		getEventId(name);
+	}
+}
+
 bool LuaScriptManager::initialize() {
 	if (initialized) {
 		return true;
@@ -91,31 +98,106 @@ void LuaScriptManager::registerContextMenuItem(const std::string& label, sol::fu
 	contextMenuItems.push_back(item);
 }
 
+LuaScriptManager::EventId LuaScriptManager::getEventId(std::string_view eventName) {
+	if (const std::optional<EventId> eventId = findEventId(eventName)) {
+		return *eventId;
+	}
+
+	const EventId eventId = static_cast<EventId>(eventBuckets.size());
+	eventIds.emplace(std::string(eventName), eventId);
+	eventBuckets.push_back(EventBucket { std::string(eventName) });
+	return eventId;
+}
+
+std::optional<LuaScriptManager::EventId> LuaScriptManager::findEventId(std::string_view eventName) const {
+	auto it = eventIds.find(eventName);
+	if (it == eventIds.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+void LuaScriptManager::publishEventListeners(EventBucket& bucket, EventListenerList listeners) {
+	if (listeners.empty()) {
+		bucket.listeners.reset();
+	} else {
+		bucket.listeners = std::make_shared<const EventListenerList>(std::move(listeners));
+	}
+}
+
 int LuaScriptManager::addEventListener(const std::string& eventName, sol::function callback, sol::this_state ts) {
 	sol::state_view lua(ts);
 	EventListener listener;
 	listener.id = nextListenerId++;
-	listener.eventName = eventName;
+	listener.eventId = getEventId(eventName);
 	listener.callback = callback;
 	listener.ownerScriptDir = lua["SCRIPT_DIR"].get_or(std::string(""));
 	listener.ownerScriptId = getScriptContextIdentifier(lua);
-	eventListeners.push_back(listener);
-	return listener.id;
+	// Anchored in the main state, which outlives the coroutine ts may be
+	sol::state_view mainState(engine.getState());
+	listener.scriptDirValue = sol::make_object(mainState, listener.ownerScriptDir);
+	listener.scriptIdValue = sol::make_object(mainState, listener.ownerScriptId);
+
+	EventBucket& bucket = eventBuckets[listener.eventId];
+	EventListenerList listeners = bucket.listeners ? *bucket.listeners : EventListenerList {};
+	const int listenerId = listener.id;
+	listeners.push_back(std::move(listener));
+	publishEventListeners(bucket, std::move(listeners));
+	return listenerId;
 }
 
 bool LuaScriptManager::removeEventListener(int listenerId) {
-	for (auto it = eventListeners.begin(); it != eventListeners.end(); ++it) {
-		if (it->id == listenerId) {
-			eventListeners.erase(it);
-			return true;
+	return removeEventListenersIf([listenerId](const EventListener& listener) {
+		return listener.id == listenerId;
+	});
+}
+
+bool LuaScriptManager::removeEventListenersIf(const std::function<bool(const EventListener&)>& predicate) {
+	bool removed = false;
+	for (EventBucket& bucket : eventBuckets) {
+		if (!bucket.listeners || std::ranges::none_of(*bucket.listeners, predicate)) {
+			continue;
+		}
+
+		EventListenerList remaining;
+		remaining.reserve(bucket.listeners->size() - 1);
+		for (const EventListener& listener : *bucket.listeners) {
+			if (!predicate(listener)) {
+				remaining.push_back(listener);
+			}
 		}
+		publishEventListeners(bucket, std::move(remaining));
+		removed = true;
+	}
+	return removed;
+}
+
+std::vector<LuaScriptManager::EventStats> LuaScriptManager::getEventStats() const {
+	std::vector<EventStats> stats;
+	for (const EventBucket& bucket : eventBuckets) {
+		const size_t listeners = bucket.listeners ? bucket.listeners->size() : 0;
+		if (listeners == 0 && bucket.dispatches == 0) {
+			continue;
+		}
+		stats.push_back(EventStats { bucket.name, listeners, bucket.dispatches, bucket.total, bucket.longest });
+	}
+	return stats;
+}
+
+void LuaScriptManager::resetEventStats() {
+	for (EventBucket& bucket : eventBuckets) {
+		bucket.dispatches = 0;
+		bucket.total = std::chrono::nanoseconds::zero();
+		bucket.longest = std::chrono::nanoseconds::zero();
 	}
-	return false;
 }
 
 void LuaScriptManager::clearAllCallbacks() {
 	contextMenuItems.clear();
-	eventListeners.clear();
+	// Ids stay registered, callers may have cached them
+	for (EventBucket& bucket : eventBuckets) {
+		bucket.listeners.reset();
+	}
 	nextListenerId = 1;
 	mapOverlays.clear();
 	mapOverlayShows.clear();
@@ -606,6 +688,7 @@ void LuaScriptManager::discoverScripts() {
 	engine.shutdown();
 	scripts.clear();
 	clearAllCallbacks();
+	resetEventStats();
 	++overlayRevision;
 
 	if (!engine.initialize()) {
@@ -893,12 +976,9 @@ void LuaScriptManager::removeScriptRegistrations(const std::string& scriptId) {
 			}),
 		contextMenuItems.end());
 
-	eventListeners.erase(
-		std::remove_if(eventListeners.begin(), eventListeners.end(),
-			[&scriptId](const EventListener& listener) {
-				return listener.ownerScriptId == scriptId;
-			}),
-		eventListeners.end());
+	removeEventListenersIf([&scriptId](const EventListener& listener) {
+		return listener.ownerScriptId == scriptId;
+	});
 
 	mapOverlays.erase(
 		std::remove_if(mapOverlays.begin(), mapOverlays.end(),
@@ -23,8 +23,13 @@
 
 #include "lua_sol_config.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <memory>
@@ -101,22 +106,55 @@ public:
 	}
 
 	// Event System
+	//
+	// Event names are interned to ids, and every id has its own listener list.
+	// A published list is never modified: adding or removing a listener
+	// publishes a new one, and emit holds on to the list it started with. So
+	// emitting copies nothing, and listeners added or removed by a callback
+	// take effect from the next emit.
+	using EventId = uint32_t;
+	// Events the editor emits itself, interned first
+	static constexpr EventId EVENT_ACTION_CHANGE = 0;
+	static constexpr EventId EVENT_SELECTION_CHANGE = 1;
+	static constexpr EventId EVENT_BRUSH_CHANGE = 2;
+
 	struct EventListener {
 		int id;
-		std::string eventName;
+		EventId eventId;
 		sol::function callback;
 		std::string ownerScriptDir;
 		std::string ownerScriptId;
+		// The two above as Lua strings, so dispatch sets them without converting
+		sol::object scriptDirValue;
+		sol::object scriptIdValue;
+	};
+	// Dispatch cost of one event since the last reset
+	struct EventStats {
+		std::string name;
+		size_t listeners = 0;
+		uint64_t dispatches = 0;
+		std::chrono::nanoseconds total { 0 };
+		std::chrono::nanoseconds longest { 0 };
 	};
+
+	// Returns the id for eventName, registering it if needed
+	EventId getEventId(std::string_view eventName);
 	int addEventListener(const std::string& eventName, sol::function callback, sol::this_state ts);
 	bool removeEventListener(int listenerId);
+	// Events that have listeners or were dispatched, in id order
+	std::vector<EventStats> getEventStats() const;
+	void resetEventStats();
 
 	class ScriptContextGuard {
 	public:
 		ScriptContextGuard(sol::state& state, const std::string& scriptDir, const std::string& scriptId) :
-			state(state),
-			oldScriptDir(state["SCRIPT_DIR"].get_or(std::string(""))),
-			oldScriptId(state["SCRIPT_ID"].get_or(std::string(""))) {
+			ScriptContextGuard(state) {
+			state["SCRIPT_DIR"] = scriptDir;
+			state["SCRIPT_ID"] = scriptId;
+		}
+		// Values already pushed to Lua once, for the dispatch path
+		ScriptContextGuard(sol::state& state, const sol::object& scriptDir, const sol::object& scriptId) :
+			ScriptContextGuard(state) {
 			state["SCRIPT_DIR"] = scriptDir;
 			state["SCRIPT_ID"] = scriptId;
 		}
@@ -127,62 +165,39 @@ public:
 		}
 
 	private:
+		explicit ScriptContextGuard(sol::state& state) :
+			state(state),
+			oldScriptDir(state["SCRIPT_DIR"].get<sol::object>()),
+			oldScriptId(state["SCRIPT_ID"].get<sol::object>()) {
+		}
+
 		sol::state& state;
-		std::string oldScriptDir;
-		std::string oldScriptId;
+		sol::object oldScriptDir;
+		sol::object oldScriptId;
 	};
 
 	template <typename... Args>
-	void emit(const std::string& eventName, Args&&... args) {
-		if (!initialized) {
-			return;
-		}
-
-		auto captured_args = std::make_tuple(std::forward<Args>(args)...);
-
-		// Iterate over a copy to allow callbacks to modify the listener list safely
-		std::vector<EventListener> listenersCopy = eventListeners;
-		for (const auto& listener : listenersCopy) {
-			if (listener.eventName == eventName && listener.callback.valid()) {
-				ScriptContextGuard guard(engine.getState(), listener.ownerScriptDir, listener.ownerScriptId);
-
-				try {
-					std::apply(listener.callback, captured_args);
-				} catch (const sol::error& e) {
-					logOutput("Error in event listener '" + eventName + "': " + e.what(), true);
-				}
-			}
-		}
+	void emit(EventId eventId, Args&&... args) {
+		dispatch(eventId, false, args...);
 	}
 
 	template <typename... Args>
-	bool emitCancellable(const std::string& eventName, Args&&... args) {
-		if (!initialized) {
-			return false;
+	void emit(std::string_view eventName, Args&&... args) {
+		if (const std::optional<EventId> eventId = findEventId(eventName)) {
+			dispatch(*eventId, false, args...);
 		}
+	}
 
-		auto captured_args = std::make_tuple(std::forward<Args>(args)...);
+	// Stops at the first listener returning true and returns whether one did
+	template <typename... Args>
+	bool emitCancellable(EventId eventId, Args&&... args) {
+		return dispatch(eventId, true, args...);
+	}
 
-		// Iterate over a copy to allow callbacks to modify the listener list safely
-		std::vector<EventListener> listenersCopy = eventListeners;
-		bool consumed = false;
-		for (const auto& listener : listenersCopy) {
-			if (listener.eventName == eventName && listener.callback.valid()) {
-				ScriptContextGuard guard(engine.getState(), listener.ownerScriptDir, listener.ownerScriptId);
-
-				try {
-					sol::object result = std::apply(listener.callback, captured_args);
-
-					if (result.valid() && result.is<bool>() && result.as<bool>()) {
-						consumed = true;
-						break; // Stop propagation
-					}
-				} catch (const sol::error& e) {
-					logOutput("Event '" + eventName + "' error: " + std::string(e.what()), true);
-				}
-			}
-		}
-		return consumed;
+	template <typename... Args>
+	bool emitCancellable(std::string_view eventName, Args&&... args) {
+		const std::optional<EventId> eventId = findEventId(eventName);
+		return eventId && dispatch(*eventId, true, args...);
 	}
 
 	// Clear all registered callbacks (called before script reload)
@@ -226,7 +241,7 @@ public:
 	}
 
 private:
-	LuaScriptManager() = default;
+	LuaScriptManager();
 	~LuaScriptManager() = default;
 	LuaScriptManager(const LuaScriptManager&) = delete;
 	LuaScriptManager& operator=(const LuaScriptManager&) = delete;
@@ -238,7 +253,6 @@ private:
 	LuaOutputCallback outputCallback;
 	mutable std::mutex outputMutex;
 	std::vector<ContextMenuItem> contextMenuItems;
-	std::vector<EventListener> eventListeners;
 	int nextListenerId = 1;
 	std::vector<MapOverlay> mapOverlays;
 	std::vector<MapOverlayShowItem> mapOverlayShows;
@@ -250,6 +264,69 @@ private:
 	void runAutoScripts();
 	void registerOverlayFunctions(sol::table& ctx, std::shared_ptr<std::vector<MapOverlayCommand>>& out, const MapViewInfo& view);
 	void removeScriptRegistrations(const std::string& scriptId);
+
+	using EventListenerList = std::vector<EventListener>;
+	struct EventBucket {
+		std::string name;
+		std::shared_ptr<const EventListenerList> listeners; // nullptr while empty
+		uint64_t dispatches = 0;
+		std::chrono::nanoseconds total { 0 };
+		std::chrono::nanoseconds longest { 0 };
+	};
+	struct EventNameHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const {
+			return std::hash<std::string_view> {}(name);
+		}
+	};
+
+	std::vector<EventBucket> eventBuckets; // Indexed by EventId
+	std::unordered_map<std::string, EventId, EventNameHash, std::equal_to<>> eventIds;
+
+	std::optional<EventId> findEventId(std::string_view eventName) const;
+	void publishEventListeners(EventBucket& bucket, EventListenerList listeners);
+	bool removeEventListenersIf(const std::function<bool(const EventListener&)>& predicate);
+
+	template <typename... Args>
+	bool dispatch(EventId eventId, bool cancellable, const Args&... args) {
+		if (!initialized || eventId >= eventBuckets.size() || !eventBuckets[eventId].listeners) {
+			return false;
+		}
+
+		// A callback may publish a new list, or register an event and grow
+		// eventBuckets; this keeps the current list alive either way
+		const std::shared_ptr<const EventListenerList> listeners = eventBuckets[eventId].listeners;
+		const auto start = std::chrono::steady_clock::now();
+
+		bool consumed = false;
+		for (const EventListener& listener : *listeners) {
+			if (!listener.callback.valid()) {
+				continue;
+			}
+			ScriptContextGuard guard(engine.getState(), listener.scriptDirValue, listener.scriptIdValue);
+
+			try {
+				if (!cancellable) {
+					listener.callback(args...);
+					continue;
+				}
+				sol::object result = listener.callback(args...);
+				if (result.valid() && result.is<bool>() && result.as<bool>()) {
+					consumed = true;
+					break; // Stop propagation
+				}
+			} catch (const sol::error& e) {
+				logOutput("Error in event listener '" + eventBuckets[eventId].name + "': " + e.what(), true);
+			}
+		}
+
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+		EventBucket& bucket = eventBuckets[eventId];
+		++bucket.dispatches;
+		bucket.total += elapsed;
+		bucket.longest = std::max(bucket.longest, elapsed);
+		return consumed;
+	}
 };
 
 // Global accessor macro
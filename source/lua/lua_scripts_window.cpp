@@ -30,6 +30,7 @@
 #include <wx/msgdlg.h>
 #include <wx/sizer.h>
 
+#include <chrono>
 #include <filesystem>
 
 namespace {
@@ -39,6 +40,11 @@ wxString BuildScriptLabel(const LuaScript& script) {
 	return label;
 }
 
+// Microseconds with one decimal, dispatches are usually well below a millisecond
+wxString FormatMicroseconds(std::chrono::nanoseconds duration) {
+	return wxString::Format("%.1f", static_cast<double>(duration.count()) / 1000.0);
+}
+
 wxIcon MakeTintedIcon(std::string_view assetPath, wxWindow* window) {
 	const wxBitmap bitmap = IMAGE_MANAGER.GetBitmap(
 		assetPath,
@@ -60,6 +66,11 @@ LuaScriptsWindow::LuaScriptsWindow(wxWindow* parent) :
 	BuildUI();
 	ApplyTheme();
 	RefreshScriptList();
+	RefreshEventStats();
+
+	event_stats_timer.SetOwner(this);
+	Bind(wxEVT_TIMER, &LuaScriptsWindow::OnEventStatsTimer, this, event_stats_timer.GetId());
+	event_stats_timer.Start(1000);
 
 	g_luaScripts.setOutputCallback([this](const std::string& msg, bool isError) {
 		if (wxThread::IsMain()) {
@@ -76,6 +87,7 @@ LuaScriptsWindow::LuaScriptsWindow(wxWindow* parent) :
 }
 
 LuaScriptsWindow::~LuaScriptsWindow() {
+	event_stats_timer.Stop();
 	g_luaScripts.setOutputCallback(nullptr);
 	if (instance == this) {
 		instance = nullptr;
@@ -127,6 +139,19 @@ void LuaScriptsWindow::BuildUI() {
 	script_list->AppendToggleColumn("On", wxDATAVIEW_CELL_ACTIVATABLE, Theme::Grid(10), wxALIGN_CENTER, wxDATAVIEW_COL_RESIZABLE);
 	script_list->AppendIconTextColumn("Script", wxDATAVIEW_CELL_INERT, Theme::Grid(64), wxALIGN_LEFT, wxDATAVIEW_COL_RESIZABLE | wxDATAVIEW_COL_SORTABLE);
 	listSizer->Add(script_list, 1, wxEXPAND);
+
+	// Time spent in each event's listeners since the scripts were loaded
+	auto* eventSizer = new wxStaticBoxSizer(wxVERTICAL, listPanel, "Event Dispatch");
+	event_list = new wxDataViewListCtrl(eventSizer->GetStaticBox(), wxID_ANY, wxDefaultPosition, wxDefaultSize, wxDV_SINGLE | wxDV_ROW_LINES);
+	event_list->AppendTextColumn("Event", wxDATAVIEW_CELL_INERT, Theme::Grid(32), wxALIGN_LEFT, wxDATAVIEW_COL_RESIZABLE);
+	event_list->AppendTextColumn("Listeners", wxDATAVIEW_CELL_INERT, Theme::Grid(14), wxALIGN_RIGHT, wxDATAVIEW_COL_RESIZABLE);
+	event_list->AppendTextColumn("Calls", wxDATAVIEW_CELL_INERT, Theme::Grid(14), wxALIGN_RIGHT, wxDATAVIEW_COL_RESIZABLE);
+	event_list->AppendTextColumn("Avg (us)", wxDATAVIEW_CELL_INERT, Theme::Grid(14), wxALIGN_RIGHT, wxDATAVIEW_COL_RESIZABLE);
+	event_list->AppendTextColumn("Max (us)", wxDATAVIEW_CELL_INERT, Theme::Grid(14), wxALIGN_RIGHT, wxDATAVIEW_COL_RESIZABLE);
+	event_list->SetMinSize(wxSize(-1, Theme::Grid(24)));
+	eventSizer->Add(event_list, 1, wxEXPAND | wxALL, padding);
+	listSizer->Add(eventSizer, 0, wxEXPAND | wxTOP, padding);
+
 	listPanel->SetSizer(listSizer);
 
 	auto* outputPanel = new wxPanel(main_splitter);
@@ -224,6 +249,32 @@ void LuaScriptsWindow::ApplyTheme() {
 		console_output->SetBackgroundColour(Theme::Get(Theme::Role::Background));
 		console_output->SetForegroundColour(Theme::Get(Theme::Role::Text));
 	}
+	if (event_list) {
+		event_list->SetBackgroundColour(Theme::Get(Theme::Role::Background));
+		event_list->SetForegroundColour(Theme::Get(Theme::Role::Text));
+	}
+}
+
+void LuaScriptsWindow::RefreshEventStats() {
+	if (!event_list) {
+		return;
+	}
+
+	const auto stats = g_luaScripts.getEventStats();
+	event_list->Freeze();
+	event_list->DeleteAllItems();
+	for (const auto& event : stats) {
+		const std::chrono::nanoseconds average = event.dispatches > 0 ? event.total / event.dispatches : std::chrono::nanoseconds::zero();
+
+		wxVector<wxVariant> row;
+		row.push_back(wxVariant(wxString::FromUTF8(event.name)));
+		row.push_back(wxVariant(wxString::Format("%zu", event.listeners)));
+		row.push_back(wxVariant(wxString::Format("%llu", static_cast<unsigned long long>(event.dispatches))));
+		row.push_back(wxVariant(FormatMicroseconds(average)));
+		row.push_back(wxVariant(FormatMicroseconds(event.longest)));
+		event_list->AppendItem(row);
+	}
+	event_list->Thaw();
 }
 
 void LuaScriptsWindow::RefreshScriptList() {
@@ -541,6 +592,12 @@ void LuaScriptsWindow::OnItemContextMenu(wxDataViewEvent& event) {
 	PopupMenu(&menu);
 }
 
+void LuaScriptsWindow::OnEventStatsTimer(wxTimerEvent&) {
+	if (IsShownOnScreen()) {
+		RefreshEventStats();
+	}
+}
+
 void LuaScriptsWindow::OnReloadScripts(wxCommandEvent&) {
 	LogMessage("Reloading scripts...");
 	g_luaScripts.reloadScripts();
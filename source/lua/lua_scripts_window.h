@@ -25,6 +25,7 @@
 #include <wx/splitter.h>
 #include <wx/stattext.h>
 #include <wx/textctrl.h>
+#include <wx/timer.h>
 
 #include <optional>
 #include <string>
@@ -49,6 +50,7 @@ private:
 	void BuildUI();
 	void ApplyTheme();
 	void RefreshSelectionSummary();
+	void RefreshEventStats();
 	void UpdateActionState();
 	void SelectScriptById(const std::string& uniqueId);
 	std::optional<size_t> GetSelectedScriptIndex() const;
@@ -71,6 +73,7 @@ private:
 	void OnEditOpen(wxCommandEvent& event);
 	void OnReveal(wxCommandEvent& event);
 	void OnRemoveScript(wxCommandEvent& event);
+	void OnEventStatsTimer(wxTimerEvent& event);
 
 	wxSplitterWindow* main_splitter = nullptr;
 	wxAuiToolBar* action_toolbar = nullptr;
@@ -78,6 +81,8 @@ private:
 	wxDataViewListCtrl* script_list = nullptr;
 	wxStaticText* selection_summary = nullptr;
 	wxTextCtrl* console_output = nullptr;
+	wxDataViewListCtrl* event_list = nullptr;
+	wxTimer event_stats_timer;
 	wxIcon file_script_icon;
 	wxIcon package_script_icon;
 	std::string selected_script_id;
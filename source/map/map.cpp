@@ -82,6 +82,7 @@ bool Map::open(const std::string& file) {
 
 	generation = g_nextMapGeneration.fetch_add(1, std::memory_order_relaxed);
 	tilecount = 0;
+	itemIndex.invalidate();
 
 	IOMapOTBM maploader(getVersion());
 
@@ -112,10 +113,12 @@ bool Map::convert(MapVersion to, bool showdialog) {
 }
 
 bool Map::convert(const ConversionMap& rm, bool showdialog) {
+	itemIndex.invalidate();
 	return MapConverter::convert(*this, rm, showdialog);
 }
 
 void Map::cleanInvalidTiles(bool showdialog) {
+	itemIndex.invalidate();
 	MapConverter::cleanInvalidTiles(*this, showdialog);
 }
 
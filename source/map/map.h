@@ -21,6 +21,7 @@
 #include <cstdint>
 #include "map/basemap.h"
 #include "map/tile.h"
+#include "map/map_item_index.h"
 #include "game/town.h"
 #include "game/house.h"
 #include "game/spawn.h"
@@ -134,6 +135,10 @@ public:
 		return generation;
 	}
 
+	MapItemIndex& getItemIndex() {
+		return itemIndex;
+	}
+
 	void flagAsNamed() {
 		unnamed = false;
 	}
@@ -185,6 +190,7 @@ public:
 
 private:
 	uint64_t generation;
+	MapItemIndex itemIndex;
 };
 
 template <typename ForeachType>
@@ -246,6 +252,8 @@ inline void foreach_TileOnMap(Map& map, ForeachType& foreach) {
 
 template <typename RemoveIfType>
 inline long long remove_if_TileOnMap(Map& map, RemoveIfType& remove_if) {
+	map.getItemIndex().invalidate();
+
 	long long done = 0;
 	long long removed = 0;
 	long long total = map.getTileCount();
@@ -264,6 +272,8 @@ inline long long remove_if_TileOnMap(Map& map, RemoveIfType& remove_if) {
 
 template <typename RemoveIfType>
 inline int64_t RemoveItemOnMap(Map& map, RemoveIfType& condition, bool selectedOnly) {
+	map.getItemIndex().invalidate();
+
 	int64_t done = 0;
 	int64_t removed = 0;
 
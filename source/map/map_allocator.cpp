@@ -0,0 +1,152 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "app/main.h"
+
+#include "map/map_allocator.h"
+#include "game/item.h"
+#include "app/task_scheduler.h"
+
+#include <memory>
+#include <spdlog/spdlog.h>
+
+namespace {
+	// Grids smaller than this (brush previews, copy buffers) are cheaper to free inline.
+	constexpr size_t BACKGROUND_RELEASE_MIN_CELLS = 16;
+
+	// Never destroyed, like the pools: its destructor would wait on a
+	// scheduler that static destruction may already have taken down.
+	TaskGroup& releaseGroup() {
+		static TaskGroup& group = *new TaskGroup(g_scheduler, TaskPriority::Bulk);
+		return group;
+	}
+}
+
+// The pools are never destroyed: tiles may still be released by static
+// destructors while the program exits.
+SlabPool& MapAllocator::itemPool() {
+	static SlabPool& pool = *new SlabPool("Item", sizeof(Item), alignof(Item));
+	return pool;
+}
+
+SlabPool& MapAllocator::tilePool() {
+	static SlabPool& pool = *new SlabPool("Tile", sizeof(Tile), alignof(Tile));
+	return pool;
+}
+
+SlabPool& MapAllocator::floorPool() {
+	static SlabPool& pool = *new SlabPool("Floor", sizeof(Floor), alignof(Floor));
+	return pool;
+}
+
+SlabPool& MapAllocator::nodePool() {
+	static SlabPool& pool = *new SlabPool("MapNode", sizeof(MapNode), alignof(MapNode));
+	return pool;
+}
+
+SlabPool& MapAllocator::cellPool() {
+	static SlabPool& pool = *new SlabPool("GridCell", sizeof(SpatialHashGrid::GridCell), alignof(SpatialHashGrid::GridCell));
+	return pool;
+}
+
+MapAllocator::Statistics MapAllocator::getStatistics() {
+	Statistics stats;
+	stats.items = itemPool().getStats();
+	stats.tiles = tilePool().getStats();
+	stats.floors = floorPool().getStats();
+	stats.nodes = nodePool().getStats();
+	stats.cells = cellPool().getStats();
+	return stats;
+}
+
+void MapAllocator::releaseCells(std::vector<SpatialHashGrid::CellEntry> cells) {
+	if (cells.size() < BACKGROUND_RELEASE_MIN_CELLS) {
+		return;
+	}
+
+	// Nothing in a detached grid refers back to the map, so it can be torn down
+	// on any thread; the pools are thread-safe. Items may still touch globals
+	// as they go, hence waitForReleases() on shutdown. Shared so the task
+	// stays cheap to copy.
+	auto shared = std::make_shared<std::vector<SpatialHashGrid::CellEntry>>(std::move(cells));
+	releaseGroup().run([shared]() {
+		const size_t count = shared->size();
+		shared->clear();
+		spdlog::debug("Released {} map cells in the background", count);
+	});
+}
+
+void MapAllocator::waitForReleases() {
+	releaseGroup().wait();
+}
+
+//=============================================================================
+// Pooled operator new/delete
+
+// Subclasses inherit these. Routing is decided by size alone, and the size seen
+// by delete is the dynamic type's (Item has a virtual destructor), so a subclass
+// that happens to be as small as Item is pooled consistently too.
+void* Item::operator new(size_t size) {
+	if (size == sizeof(Item)) {
+		return MapAllocator::itemPool().allocate();
+	}
+	return ::operator new(size);
+}
+
+void Item::operator delete(void* ptr, size_t size) noexcept {
+	if (size == sizeof(Item)) {
+		MapAllocator::itemPool().deallocate(ptr);
+	} else {
+		::operator delete(ptr);
+	}
+}
+
+void* Tile::operator new(size_t size) {
+	ASSERT(size == sizeof(Tile));
+	return MapAllocator::tilePool().allocate();
+}
+
+void Tile::operator delete(void* ptr) noexcept {
+	MapAllocator::tilePool().deallocate(ptr);
+}
+
+void* Floor::operator new(size_t size) {
+	ASSERT(size == sizeof(Floor));
+	return MapAllocator::floorPool().allocate();
+}
+
+void Floor::operator delete(void* ptr) noexcept {
+	MapAllocator::floorPool().deallocate(ptr);
+}
+
+void* MapNode::operator new(size_t size) {
+	ASSERT(size == sizeof(MapNode));
+	return MapAllocator::nodePool().allocate();
+}
+
+void MapNode::operator delete(void* ptr) noexcept {
+	MapAllocator::nodePool().deallocate(ptr);
+}
+
+void* SpatialHashGrid::GridCell::operator new(size_t size) {
+	ASSERT(size == sizeof(SpatialHashGrid::GridCell));
+	return MapAllocator::cellPool().allocate();
+}
+
+void SpatialHashGrid::GridCell::operator delete(void* ptr) noexcept {
+	MapAllocator::cellPool().deallocate(ptr);
+}
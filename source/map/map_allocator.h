@@ -20,15 +20,35 @@
 
 #include "map/tile.h"
 #include "map/map_region.h"
+#include "map/slab_pool.h"
+#include "map/spatial_hash_grid.h"
+
+#include <vector>
 
 class BaseMap;
 
+// Item, Tile, Floor, MapNode and SpatialHashGrid::GridCell route their operator
+// new through the slab pools below, so tiles created anywhere (loaders, brushes,
+// copy buffer, undo) come from the same contiguous slabs. Ownership is still
+// expressed with std::unique_ptr as everywhere else.
 class MapAllocator {
 
 public:
 	MapAllocator() { }
 	~MapAllocator() { }
 
+	struct Statistics {
+		SlabPool::Stats items;
+		SlabPool::Stats tiles;
+		SlabPool::Stats floors;
+		SlabPool::Stats nodes;
+		SlabPool::Stats cells;
+
+		size_t reservedBytes() const {
+			return items.reservedBytes() + tiles.reservedBytes() + floors.reservedBytes() + nodes.reservedBytes() + cells.reservedBytes();
+		}
+	};
+
 	// shorthands for tiles
 	std::unique_ptr<Tile> operator()(TileLocation* location) {
 		return allocateTile(location);
@@ -48,6 +68,21 @@ public:
 	std::unique_ptr<MapNode> allocateNode(BaseMap& map) {
 		return std::make_unique<MapNode>(map);
 	}
+
+	static SlabPool& itemPool();
+	static SlabPool& tilePool();
+	static SlabPool& floorPool();
+	static SlabPool& nodePool();
+	static SlabPool& cellPool();
+
+	static Statistics getStatistics();
+
+	// Takes over a whole detached grid. Large grids are torn down on the task
+	// scheduler, so closing a map returns immediately instead of walking every tile.
+	static void releaseCells(std::vector<SpatialHashGrid::CellEntry> cells);
+	// Blocks until every grid handed to releaseCells is gone. Called on
+	// shutdown, before the scheduler stops and the globals go away.
+	static void waitForReleases();
 };
 
 #endif
@@ -0,0 +1,283 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "app/main.h"
+
+#include "map/map_item_index.h"
+#include "map/map_scan.h"
+
+#include <algorithm>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+namespace {
+	using Field = MapItemIndex::Field;
+
+	constexpr size_t fieldIndex(Field field) {
+		return static_cast<size_t>(field);
+	}
+
+	// Ground, items and container contents; the order does not matter here
+	template <typename Func>
+	void forEachItem(const Tile* tile, Func&& func) {
+		if (tile->ground) {
+			func(tile->ground.get());
+		}
+		for (const auto& item : tile->items) {
+			func(item.get());
+
+			const Container* container = item->asContainer();
+			if (!container) {
+				continue;
+			}
+
+			std::vector<const Container*> containers { container };
+			for (size_t index = 0; index < containers.size(); ++index) {
+				for (const auto& inner : containers[index]->getVector()) {
+					func(inner.get());
+					if (const Container* c = inner->asContainer()) {
+						containers.push_back(c);
+					}
+				}
+			}
+		}
+	}
+
+	template <typename Func>
+	void forEachKey(const Item* item, Func&& func) {
+		if (const uint16_t id = item->getID()) {
+			func(Field::ServerId, id);
+		}
+		if (const uint16_t aid = item->getActionID()) {
+			func(Field::ActionId, aid);
+		}
+		if (const uint16_t uid = item->getUniqueID()) {
+			func(Field::UniqueId, uid);
+		}
+	}
+
+	// build() partial: cells are visited in key order, so the per-value lists
+	// come out sorted by appending, and later chunks only hold later cells.
+	struct IndexBuilder {
+		std::array<MapItemIndex::FieldIndex, MapItemIndex::FIELD_COUNT> fields;
+
+		void operator()(const Tile* tile) {
+			const Position position = tile->getPosition();
+			const uint64_t key = SpatialHashGrid::makeKey(position.x, position.y);
+			forEachItem(tile, [&](const Item* item) {
+				forEachKey(item, [&](Field field, uint16_t value) {
+					MapItemIndex::CellCounts& cells = fields[fieldIndex(field)][value];
+					if (!cells.empty() && cells.back().key == key) {
+						++cells.back().count;
+					} else {
+						cells.push_back({ key, 1 });
+					}
+				});
+			});
+		}
+
+		void merge(IndexBuilder&& other) {
+			for (size_t field = 0; field < MapItemIndex::FIELD_COUNT; ++field) {
+				for (auto& [value, cells] : other.fields[field]) {
+					MapItemIndex::CellCounts& target = fields[field][value];
+					if (target.empty()) {
+						target = std::move(cells);
+					} else {
+						target.insert(target.end(), cells.begin(), cells.end());
+					}
+				}
+			}
+		}
+	};
+}
+
+void MapItemIndex::invalidate() {
+	for (FieldIndex& field : fields) {
+		field.clear();
+	}
+	built = false;
+}
+
+void MapItemIndex::build(Map& map) {
+	const auto start = std::chrono::steady_clock::now();
+
+	IndexBuilder builder = MapScan::reduce(map, IndexBuilder {}, [](IndexBuilder& partial, Tile* tile) {
+		partial(tile);
+	}, nullptr);
+	fields = std::move(builder.fields);
+	built = true;
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	spdlog::info("Item index built: {} item ids, {} action ids, {} unique ids in {} ms", fields[fieldIndex(Field::ServerId)].size(), fields[fieldIndex(Field::ActionId)].size(), fields[fieldIndex(Field::UniqueId)].size(), elapsed.count());
+}
+
+void MapItemIndex::ensureBuilt(Map& map) {
+	if (!built) {
+		build(map);
+	}
+}
+
+void MapItemIndex::add(CellCounts& cells, uint64_t key, int32_t delta) {
+	auto it = std::ranges::lower_bound(cells, key, {}, &CellCount::key);
+	if (it != cells.end() && it->key == key) {
+		if (delta < 0 && it->count <= static_cast<uint32_t>(-delta)) {
+			cells.erase(it);
+		} else {
+			it->count = static_cast<uint32_t>(static_cast<int64_t>(it->count) + delta);
+		}
+	} else if (delta > 0) {
+		cells.insert(it, { key, static_cast<uint32_t>(delta) });
+	}
+}
+
+void MapItemIndex::update(const Position& position, const Tile* tile, int32_t delta) {
+	if (!built || !tile) {
+		return;
+	}
+
+	const uint64_t key = SpatialHashGrid::makeKey(position.x, position.y);
+	forEachItem(tile, [&](const Item* item) {
+		forEachKey(item, [&](Field field, uint16_t value) {
+			FieldIndex& index = fields[fieldIndex(field)];
+			if (delta > 0) {
+				add(index[value], key, delta);
+				return;
+			}
+
+			auto it = index.find(value);
+			if (it != index.end()) {
+				add(it->second, key, delta);
+				if (it->second.empty()) {
+					index.erase(it);
+				}
+			}
+		});
+	});
+}
+
+void MapItemIndex::addTile(const Position& position, const Tile* tile) {
+	update(position, tile, 1);
+}
+
+void MapItemIndex::removeTile(const Position& position, const Tile* tile) {
+	update(position, tile, -1);
+}
+
+bool MapItemIndex::matches(const Item* item, Field field, uint16_t value) {
+	uint16_t actual = 0;
+	switch (field) {
+		case Field::ServerId:
+			actual = item->getID();
+			break;
+		case Field::ActionId:
+			actual = item->getActionID();
+			break;
+		case Field::UniqueId:
+			actual = item->getUniqueID();
+			break;
+	}
+	return value == 0 ? actual != 0 : actual == value;
+}
+
+std::vector<SpatialHashGrid::SortedGridCell> MapItemIndex::findCells(Map& map, std::span<const Lookup> lookups) {
+	ensureBuilt(map);
+
+	std::vector<uint64_t> keys;
+	for (const Lookup& lookup : lookups) {
+		const FieldIndex& index = fields[fieldIndex(lookup.field)];
+		if (lookup.value != 0) {
+			if (auto it = index.find(lookup.value); it != index.end()) {
+				for (const CellCount& cell : it->second) {
+					keys.push_back(cell.key);
+				}
+			}
+			continue;
+		}
+		for (const auto& [value, cells] : index) {
+			for (const CellCount& cell : cells) {
+				keys.push_back(cell.key);
+			}
+		}
+	}
+	std::ranges::sort(keys);
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	std::vector<SpatialHashGrid::SortedGridCell> result;
+	if (keys.empty()) {
+		return result;
+	}
+
+	// Both sides are sorted by key
+	auto key = keys.begin();
+	for (const auto& cell : map.getGrid().getSortedCells()) {
+		while (key != keys.end() && *key < cell.key) {
+			++key;
+		}
+		if (key == keys.end()) {
+			break;
+		}
+		if (*key == cell.key) {
+			result.push_back(cell);
+		}
+	}
+	return result;
+}
+
+uint32_t MapItemIndex::count(Map& map, Field field, uint16_t value) {
+	ensureBuilt(map);
+
+	const FieldIndex& index = fields[fieldIndex(field)];
+	auto it = index.find(value);
+	if (it == index.end()) {
+		return 0;
+	}
+
+	uint32_t total = 0;
+	for (const CellCount& cell : it->second) {
+		total += cell.count;
+	}
+	return total;
+}
+
+std::vector<Position> MapItemIndex::findPositions(Map& map, Field field, uint16_t value) {
+	std::vector<Position> positions;
+	for (const auto& cell : findCells(map, field, value)) {
+		MapScan::forEachTile(*cell.cell, [&](Tile* tile) {
+			bool found = false;
+			forEachItem(tile, [&](const Item* item) {
+				found = found || matches(item, field, value);
+			});
+			if (found) {
+				positions.push_back(tile->getPosition());
+			}
+		});
+	}
+	return positions;
+}
+
+std::vector<uint16_t> MapItemIndex::findDuplicateUniqueIds(Map& map) {
+	ensureBuilt(map);
+
+	std::vector<uint16_t> duplicates;
+	for (const auto& [value, cells] : fields[fieldIndex(Field::UniqueId)]) {
+		if (cells.size() > 1 || (cells.size() == 1 && cells.front().count > 1)) {
+			duplicates.push_back(value);
+		}
+	}
+	std::ranges::sort(duplicates);
+	return duplicates;
+}
@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAP_ITEM_INDEX_H
+#define RME_MAP_ITEM_INDEX_H
+
+#include "map/spatial_hash_grid.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+class Map;
+class Tile;
+class Item;
+class Position;
+
+// Secondary index from server item id, action id and unique id to the grid
+// cells (64x64 columns, all floors) holding them, with a count per cell.
+//
+// It is built once after a map is loaded and then kept current by
+// Action::commit / Action::undo, which report every tile they swap in or
+// out. Queries narrow a search to the listed cells; callers still check the
+// tiles they visit, so an entry that outlived an edit made outside the action
+// queue only costs a wasted cell scan. Edits that bypass the queue
+// (conversions, cleanups, imports, Lua scripts changing items outside a
+// transaction) call invalidate() and the next query rebuilds the index.
+class MapItemIndex {
+public:
+	enum class Field : uint8_t {
+		ServerId,
+		ActionId,
+		UniqueId,
+	};
+	static constexpr size_t FIELD_COUNT = 3;
+
+	struct Lookup {
+		Field field;
+		uint16_t value; // 0 matches any non-zero value of the field
+	};
+
+	struct CellCount {
+		uint64_t key; // SpatialHashGrid cell key
+		uint32_t count;
+	};
+	// Sorted by key, i.e. in map iteration order
+	using CellCounts = std::vector<CellCount>;
+	using FieldIndex = std::unordered_map<uint16_t, CellCounts>;
+
+	bool isBuilt() const {
+		return built;
+	}
+	void invalidate();
+	void build(Map& map);
+
+	// Tile entering / leaving the map at position; null tiles are ignored
+	void addTile(const Position& position, const Tile* tile);
+	void removeTile(const Position& position, const Tile* tile);
+
+	// Existing grid cells that may hold any of the lookups, in map order
+	std::vector<SpatialHashGrid::SortedGridCell> findCells(Map& map, std::span<const Lookup> lookups);
+	std::vector<SpatialHashGrid::SortedGridCell> findCells(Map& map, Field field, uint16_t value) {
+		const Lookup lookup { field, value };
+		return findCells(map, std::span<const Lookup>(&lookup, 1));
+	}
+
+	// Number of items carrying the value, container contents included
+	uint32_t count(Map& map, Field field, uint16_t value);
+	// Positions of all tiles holding the value, in map order
+	std::vector<Position> findPositions(Map& map, Field field, uint16_t value);
+	// Unique ids carried by more than one item, ascending
+	std::vector<uint16_t> findDuplicateUniqueIds(Map& map);
+
+	static bool matches(const Item* item, Field field, uint16_t value);
+
+private:
+	static void add(CellCounts& cells, uint64_t key, int32_t delta);
+	void update(const Position& position, const Tile* tile, int32_t delta);
+	void ensureBuilt(Map& map);
+
+	std::array<FieldIndex, FIELD_COUNT> fields;
+	// A fresh map is empty, so its (empty) index is exact
+	bool built = true;
+};
+
+#endif
@@ -19,6 +19,7 @@
 
 #include <bit>
 #include <algorithm>
+#include <atomic>
 #include <ranges>
 
 #include "map/map_region.h"
@@ -29,11 +30,26 @@
 
 //**************** Tile Location **********************
 
+namespace {
+	// Only advanced by the renderer (once per frame that records anything), so
+	// touching a location is a plain relaxed load even from the loader threads.
+	std::atomic<uint32_t> render_revision { 1 };
+}
+
+uint32_t TileLocation::currentRevision() {
+	return render_revision.load(std::memory_order_relaxed);
+}
+
+uint32_t TileLocation::advanceRevision() {
+	return render_revision.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
 TileLocation::TileLocation() :
 	position(0, 0, 0),
 	spawn_count(0),
 	waypoint_count(0),
-	town_count(0) {
+	town_count(0),
+	revision(currentRevision()) {
 	////
 }
 
@@ -229,6 +245,7 @@ std::unique_ptr<Tile> MapNode::setTile(int x, int y, int z, std::unique_ptr<Tile
 	}
 	std::unique_ptr<Tile> oldtile = std::move(tmp->tile);
 	tmp->tile = std::move(newtile);
+	tmp->touch();
 
 	if (tmp->tile && !oldtile) {
 		++map.tilecount;
@@ -247,6 +264,7 @@ void MapNode::clearTile(int x, int y, int z) {
 
 	TileLocation* tmp = &f->locs[offset_x * 4 + offset_y];
 	tmp->tile = map.allocator(tmp);
+	tmp->touch();
 }
 
 //**************** SpatialHashGrid **********************
@@ -268,7 +286,9 @@ SpatialHashGrid::~SpatialHashGrid() {
 }
 
 void SpatialHashGrid::clear() {
+	MapAllocator::releaseCells(std::move(cells_));
 	cells_.clear();
+	++layout_generation_;
 	last_key_ = 0;
 	last_idx_ = 0;
 	last_valid_ = false;
@@ -44,6 +44,7 @@ protected:
 	uint16_t spawn_count;
 	uint16_t waypoint_count;
 	uint16_t town_count;
+	uint32_t revision; // See touch()
 	std::unique_ptr<HouseExitList> house_exits; // Any house exits pointing here
 
 public:
@@ -77,32 +78,52 @@ public:
 		return position.z;
 	}
 
+	// Render revision: stamped with the current global revision whenever what is
+	// drawn for this location may have changed (tile swapped, edited in place,
+	// selection, markers). The map renderer's instance cache compares these
+	// stamps against the revision it recorded a node at.
+	uint32_t getRevision() const {
+		return revision;
+	}
+	void touch() {
+		revision = currentRevision();
+	}
+	static uint32_t currentRevision();
+	// Returns a revision newer than every stamp handed out so far.
+	static uint32_t advanceRevision();
+
 	uint16_t getSpawnCount() const {
 		return spawn_count;
 	}
 	void increaseSpawnCount() {
 		spawn_count++;
+		touch();
 	}
 	void decreaseSpawnCount() {
 		spawn_count--;
+		touch();
 	}
 	uint16_t getWaypointCount() const {
 		return waypoint_count;
 	}
 	void increaseWaypointCount() {
 		waypoint_count++;
+		touch();
 	}
 	void decreaseWaypointCount() {
 		waypoint_count--;
+		touch();
 	}
 	uint16_t getTownCount() const {
 		return town_count;
 	}
 	void increaseTownCount() {
 		town_count++;
+		touch();
 	}
 	void decreaseTownCount() {
 		town_count--;
+		touch();
 	}
 	HouseExitList* createHouseExits() {
 		if (house_exits) {
@@ -127,6 +148,11 @@ public:
 class Floor {
 public:
 	Floor(int x, int y, int z);
+
+	// Allocated from MapAllocator's floor pool
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr) noexcept;
+
 	std::array<TileLocation, MAP_LAYERS> locs;
 };
 
@@ -138,6 +164,10 @@ public:
 	MapNode(const MapNode&) = delete;
 	MapNode& operator=(const MapNode&) = delete;
 
+	// Allocated from MapAllocator's node pool
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr) noexcept;
+
 	TileLocation* createTile(int x, int y, int z);
 	TileLocation* getTile(int x, int y, int z);
 	std::unique_ptr<Tile> setTile(int x, int y, int z, std::unique_ptr<Tile> tile);
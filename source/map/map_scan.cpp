@@ -0,0 +1,58 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "app/main.h"
+
+#include "map/map_scan.h"
+
+#include "app/task_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+
+void MapScan::run(Cells cells, const CellVisitor& visit, const ChunkFinisher& finish, uint64_t total_tiles, const ProgressCallback& progress) {
+	const size_t chunk_count = chunkCount(cells.size());
+	if (chunk_count == 0) {
+		return;
+	}
+
+	std::atomic<uint64_t> tiles_done { 0 };
+	auto reportProgress = [&]() {
+		if (progress && total_tiles > 0) {
+			progress(static_cast<int>(std::min<uint64_t>(100, 100 * tiles_done.load(std::memory_order_relaxed) / total_tiles)));
+		}
+	};
+
+	runOrdered(
+		g_scheduler, TaskPriority::Bulk, chunk_count,
+		[&](size_t chunk) {
+			const size_t begin = chunk * CELLS_PER_CHUNK;
+			for (const auto& cell : cells.subspan(begin, std::min(CELLS_PER_CHUNK, cells.size() - begin))) {
+				if (cell.cell) {
+					tiles_done.fetch_add(visit(chunk, *cell.cell), std::memory_order_relaxed);
+				}
+			}
+		},
+		// Merge strictly in chunk order while later chunks are still being scanned
+		[&](size_t chunk) {
+			finish(chunk);
+			return true;
+		},
+		reportProgress
+	);
+	reportProgress();
+}
@@ -0,0 +1,193 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAP_SCAN_H
+#define RME_MAP_SCAN_H
+
+#include "map/map.h"
+#include "map/spatial_hash_grid.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Parallel, read-only counterparts of foreach_ItemOnMap / foreach_TileOnMap.
+//
+// The sorted grid cells are cut into small chunks that are scanned as a bulk
+// job on g_scheduler (see runOrdered). Each chunk is scanned with its own copy
+// of the visitor (a reducer), and the calling thread folds finished chunks
+// into the result with `result.merge(std::move(partial))` strictly in chunk
+// order, so the outcome is exactly that of the serial scan. A reducer may
+// provide `fork()` to create its partials when a plain copy is not right
+// (e.g. paged searchers). Visitors run on any thread with done == -1 and
+// must neither touch the GUI nor modify the map; progress is reported from
+// the calling thread instead.
+class MapScan {
+public:
+	using Cells = std::span<const SpatialHashGrid::SortedGridCell>;
+	// Visits one cell for the given chunk, returns the number of tiles seen
+	using CellVisitor = std::function<uint64_t(size_t chunk, SpatialHashGrid::GridCell& cell)>;
+	using ChunkFinisher = std::function<void(size_t chunk)>;
+	using ProgressCallback = std::function<void(int percent)>;
+
+	static constexpr size_t CELLS_PER_CHUNK = 8;
+
+	static size_t chunkCount(size_t cells) {
+		return (cells + CELLS_PER_CHUNK - 1) / CELLS_PER_CHUNK;
+	}
+
+	// Runs visit() for every cell on the workers and finish() for every chunk
+	// on the calling thread, in order, as soon as the chunk is done.
+	static void run(Cells cells, const CellVisitor& visit, const ChunkFinisher& finish, uint64_t total_tiles, const ProgressCallback& progress);
+
+	// Same tile order as MapIterator
+	template <typename Func>
+	static uint64_t forEachTile(SpatialHashGrid::GridCell& cell, Func&& func) {
+		uint64_t count = 0;
+		for (const auto& node : cell.nodes) {
+			if (!node) {
+				continue;
+			}
+			for (uint32_t z = 0; z < MAP_LAYERS; ++z) {
+				Floor* floor = node->getFloor(z);
+				if (!floor) {
+					continue;
+				}
+				for (TileLocation& location : floor->locs) {
+					if (Tile* tile = location.get()) {
+						func(tile);
+						++count;
+					}
+				}
+			}
+		}
+		return count;
+	}
+
+	template <typename Reducer>
+	static Reducer fork(const Reducer& prototype) {
+		if constexpr (requires { prototype.fork(); }) {
+			return prototype.fork();
+		} else {
+			return prototype;
+		}
+	}
+
+	template <typename Reducer, typename Visit>
+	static Reducer reduce(Cells cells, uint64_t total_tiles, const Reducer& prototype, Visit&& visit, const ProgressCallback& progress) {
+		std::vector<std::optional<Reducer>> partials(chunkCount(cells.size()));
+		Reducer result = prototype;
+
+		run(
+			cells,
+			[&](size_t chunk, SpatialHashGrid::GridCell& cell) -> uint64_t {
+				std::optional<Reducer>& partial = partials[chunk];
+				if (!partial) {
+					partial.emplace(fork(prototype));
+				}
+				return forEachTile(cell, [&](Tile* tile) {
+					visit(*partial, tile);
+				});
+			},
+			[&](size_t chunk) {
+				if (partials[chunk]) {
+					result.merge(std::move(*partials[chunk]));
+					partials[chunk].reset();
+				}
+			},
+			total_tiles, progress
+		);
+		return result;
+	}
+
+	template <typename Reducer, typename Visit>
+	static Reducer reduce(Map& map, const Reducer& prototype, Visit&& visit, const ProgressCallback& progress) {
+		const auto cells = map.getGrid().getSortedCells();
+		return reduce(cells, map.getTileCount(), prototype, std::forward<Visit>(visit), progress);
+	}
+
+	// foreach_ItemOnMap order: ground, then items, each followed by its
+	// container contents breadth-first
+	template <typename Reducer>
+	static void visitItems(Map& map, Reducer& reducer, Tile* tile, bool selectedTiles) {
+		if (selectedTiles && !tile->isSelected()) {
+			return;
+		}
+
+		if (tile->ground) {
+			reducer(map, tile, tile->ground.get(), -1);
+		}
+
+		for (const auto& item : tile->items) {
+			reducer(map, tile, item.get(), -1);
+
+			Container* container = item->asContainer();
+			if (!container) {
+				continue;
+			}
+
+			// Shared by all workers, so no scratch state outside the call
+			std::vector<Container*> containers { container };
+			for (size_t index = 0; index < containers.size(); ++index) {
+				for (const auto& inner : containers[index]->getVector()) {
+					reducer(map, tile, inner.get(), -1);
+					if (Container* c = inner->asContainer()) {
+						containers.push_back(c);
+					}
+				}
+			}
+		}
+	}
+};
+
+template <typename Reducer>
+inline Reducer parallel_foreach_ItemOnMap(Map& map, const Reducer& prototype, bool selectedTiles, const MapScan::ProgressCallback& progress = nullptr) {
+	return MapScan::reduce(map, prototype, [&map, selectedTiles](Reducer& reducer, Tile* tile) {
+		MapScan::visitItems(map, reducer, tile, selectedTiles);
+	}, progress);
+}
+
+// parallel_foreach_ItemOnMap over just the cells the item index lists for the
+// lookups. Results come out in the same order; the reducer still has to test
+// every item it is given.
+template <typename Reducer>
+inline Reducer indexed_foreach_ItemOnMap(Map& map, std::span<const MapItemIndex::Lookup> lookups, const Reducer& prototype, bool selectedTiles, const MapScan::ProgressCallback& progress = nullptr) {
+	const auto cells = map.getItemIndex().findCells(map, lookups);
+	const size_t all_cells = map.getGrid().cellCount();
+	const uint64_t total_tiles = all_cells == 0 ? 0 : map.getTileCount() * cells.size() / all_cells;
+	return MapScan::reduce(cells, total_tiles, prototype, [&map, selectedTiles](Reducer& reducer, Tile* tile) {
+		MapScan::visitItems(map, reducer, tile, selectedTiles);
+	}, progress);
+}
+
+template <typename Reducer>
+inline Reducer indexed_foreach_ItemOnMap(Map& map, MapItemIndex::Field field, uint16_t value, const Reducer& prototype, bool selectedTiles, const MapScan::ProgressCallback& progress = nullptr) {
+	const MapItemIndex::Lookup lookup { field, value };
+	return indexed_foreach_ItemOnMap(map, std::span<const MapItemIndex::Lookup>(&lookup, 1), prototype, selectedTiles, progress);
+}
+
+template <typename Reducer>
+inline Reducer parallel_foreach_TileOnMap(Map& map, const Reducer& prototype, const MapScan::ProgressCallback& progress = nullptr) {
+	return MapScan::reduce(map, prototype, [&map](Reducer& reducer, Tile* tile) {
+		reducer(map, tile, -1);
+	}, progress);
+}
+
+#endif
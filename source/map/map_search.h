@@ -5,11 +5,16 @@
 #include <vector>
 #include <utility>
 #include <string>
+#include <functional>
 
 class Map;
 class Tile;
 class Item;
 
+namespace EditorOperations {
+	struct MapSearcher;
+}
+
 struct SearchResult {
 	Tile* tile;
 	Item* item;
@@ -19,6 +24,9 @@ struct SearchResult {
 class MapSearchUtility {
 public:
 	static std::vector<SearchResult> SearchItems(Map& map, bool unique, bool action, bool container, bool writable, bool onSelection);
+	// Runs the searcher over the map; action/unique id searches only visit
+	// the cells the map's item index lists for them.
+	static EditorOperations::MapSearcher Run(Map& map, const EditorOperations::MapSearcher& prototype, bool onSelection, const std::function<void(int)>& progress = nullptr);
 };
 
 #endif
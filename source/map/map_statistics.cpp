@@ -116,5 +116,7 @@ MapStatistics MapStatisticsCollector::Collect(Map* map) {
 		}
 	}
 
+	stats.memory = MapAllocator::getStatistics();
+
 	return stats;
 }
@@ -2,6 +2,7 @@
 #define RME_MAP_STATISTICS_H_
 
 #include "app/main.h"
+#include "map/map_allocator.h"
 #include <string>
 #include <map>
 
@@ -37,6 +38,8 @@ struct MapStatistics {
 	double houses_per_town = 0.0;
 	double sqm_per_house = 0.0;
 	double sqm_per_town = 0.0;
+
+	MapAllocator::Statistics memory;
 };
 
 class MapStatisticsCollector {
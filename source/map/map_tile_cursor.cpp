@@ -0,0 +1,183 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "app/main.h"
+#include "map/map_tile_cursor.h"
+#include "map/basemap.h"
+#include "map/map_region.h"
+
+#include <algorithm>
+
+namespace {
+	constexpr auto entry_key_less = [](const SpatialHashGrid::CellEntry& entry, uint64_t key) {
+		return entry.key < key;
+	};
+}
+
+MapTileCursor::MapTileCursor(BaseMap& map) :
+	map(map),
+	layout_generation(map.getGrid().layoutGeneration()) {
+}
+
+MapTileCursor::MapTileCursor(BaseMap& map, const Area& area) :
+	MapTileCursor(map) {
+	bounded = true;
+	this->area = area;
+	this->area.min_z = std::max(area.min_z, 0);
+	this->area.max_z = std::min(area.max_z, MAP_LAYERS - 1);
+	min_cx = area.min_x >> SpatialHashGrid::CELL_SHIFT;
+	min_cy = area.min_y >> SpatialHashGrid::CELL_SHIFT;
+	max_cx = area.max_x >> SpatialHashGrid::CELL_SHIFT;
+	max_cy = area.max_y >> SpatialHashGrid::CELL_SHIFT;
+	floor_i = this->area.min_z;
+	done = area.min_x > area.max_x || area.min_y > area.max_y || this->area.min_z > this->area.max_z;
+}
+
+MapTileCursor::Cells MapTileCursor::cells() const {
+	const SpatialHashGrid& grid = map.getGrid();
+	return Cells(grid.begin(), grid.end());
+}
+
+void MapTileCursor::relocate(Cells cells) {
+	layout_generation = map.getGrid().layoutGeneration();
+	cell_index = static_cast<size_t>(std::lower_bound(cells.begin(), cells.end(), cell_key, entry_key_less) - cells.begin());
+	if (in_cell && (cell_index == cells.size() || cells[cell_index].key != cell_key)) {
+		// The cell went away with everything in it (map cleared)
+		in_cell = false;
+	}
+}
+
+bool MapTileCursor::seekCell(Cells cells) {
+	while (cell_index < cells.size()) {
+		const SpatialHashGrid::CellEntry& entry = cells[cell_index];
+		if (bounded) {
+			int cx, cy;
+			SpatialHashGrid::getCellCoordsFromKey(entry.key, cx, cy);
+			if (cy > max_cy) {
+				break;
+			}
+
+			// Cells are sorted by row, then column: jump to the area's left edge
+			// on this row or the next.
+			uint64_t target = entry.key;
+			if (cy < min_cy) {
+				target = SpatialHashGrid::makeKeyFromCell(min_cx, min_cy);
+			} else if (cx < min_cx) {
+				target = SpatialHashGrid::makeKeyFromCell(min_cx, cy);
+			} else if (cx > max_cx) {
+				target = SpatialHashGrid::makeKeyFromCell(min_cx, cy + 1);
+			}
+			if (target != entry.key) {
+				cell_index = static_cast<size_t>(std::lower_bound(cells.begin() + cell_index, cells.end(), target, entry_key_less) - cells.begin());
+				continue;
+			}
+		}
+
+		if (entry.cell) {
+			cell_key = entry.key;
+			in_cell = true;
+			node_i = 0;
+			floor_i = area.min_z;
+			tile_i = 0;
+			return true;
+		}
+		++cell_index;
+	}
+	return false;
+}
+
+Tile* MapTileCursor::scanCell(SpatialHashGrid::GridCell& cell) {
+	int cx, cy;
+	SpatialHashGrid::getCellCoordsFromKey(cell_key, cx, cy);
+
+	for (; node_i < SpatialHashGrid::NODES_IN_CELL; ++node_i, floor_i = area.min_z, tile_i = 0) {
+		MapNode* node = cell.nodes[node_i].get();
+		if (!node) {
+			continue;
+		}
+
+		const int node_x = ((cx << SpatialHashGrid::NODES_PER_CELL_SHIFT) + (node_i & (SpatialHashGrid::NODES_PER_CELL - 1))) << SpatialHashGrid::NODE_SHIFT;
+		const int node_y = ((cy << SpatialHashGrid::NODES_PER_CELL_SHIFT) + (node_i >> SpatialHashGrid::NODES_PER_CELL_SHIFT)) << SpatialHashGrid::NODE_SHIFT;
+		constexpr int NODE_EXTENT = (1 << SpatialHashGrid::NODE_SHIFT) - 1;
+		if (bounded && (node_x > area.max_x || node_x + NODE_EXTENT < area.min_x || node_y > area.max_y || node_y + NODE_EXTENT < area.min_y)) {
+			continue;
+		}
+
+		for (; floor_i <= area.max_z; ++floor_i, tile_i = 0) {
+			Floor* floor = node->getFloor(floor_i);
+			if (!floor) {
+				continue;
+			}
+
+			for (; tile_i < SpatialHashGrid::TILES_PER_NODE; ++tile_i) {
+				Tile* tile = floor->locs[tile_i].get();
+				if (!tile) {
+					continue;
+				}
+				if (bounded) {
+					// Floor::locs is column-major within the node
+					const int x = node_x + (tile_i >> 2);
+					const int y = node_y + (tile_i & 3);
+					if (x < area.min_x || x > area.max_x || y < area.min_y || y > area.max_y) {
+						continue;
+					}
+				}
+				++tile_i;
+				return tile;
+			}
+		}
+	}
+	return nullptr;
+}
+
+Tile* MapTileCursor::next() {
+	if (done) {
+		return nullptr;
+	}
+
+	const Cells all = cells();
+	if (layout_generation != map.getGrid().layoutGeneration()) {
+		relocate(all);
+	}
+
+	while (true) {
+		if (!in_cell && !seekCell(all)) {
+			done = true;
+			return nullptr;
+		}
+		if (Tile* tile = scanCell(*all[cell_index].cell)) {
+			return tile;
+		}
+		// Resume at whatever cell comes after this one, even if cells get
+		// inserted in between
+		in_cell = false;
+		cell_key = all[cell_index].key + 1;
+		++cell_index;
+	}
+}
+
+size_t MapTileCursor::next(std::span<Tile*> out) {
+	size_t count = 0;
+	while (count < out.size()) {
+		Tile* tile = next();
+		if (!tile) {
+			break;
+		}
+		out[count++] = tile;
+	}
+	return count;
+}
@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAP_TILE_CURSOR_H
+#define RME_MAP_TILE_CURSOR_H
+
+#include "map/spatial_hash_grid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+class BaseMap;
+class Tile;
+
+// Resumable walk over the tiles of a map, in MapIterator order, optionally
+// limited to an area. Meant for callers that hand control back between steps
+// (scripts), where the map may change under the walk.
+//
+// Between steps the cursor holds no pointer into the map, only the key of the
+// current cell and node, floor and tile indices. Those are resolved again on
+// every step, and the cell index is looked up again by key whenever the grid's
+// layout generation moved. Tiles can therefore be created or deleted freely
+// while walking; tiles created behind the cursor are not visited.
+class MapTileCursor {
+public:
+	// Inclusive bounds
+	struct Area {
+		int min_x, min_y, min_z;
+		int max_x, max_y, max_z;
+	};
+
+	explicit MapTileCursor(BaseMap& map);
+	MapTileCursor(BaseMap& map, const Area& area);
+
+	// nullptr once every tile has been visited
+	Tile* next();
+	// Fills out from the front, returns how many tiles were written. Fewer
+	// than out.size() means the walk is over.
+	size_t next(std::span<Tile*> out);
+
+	bool isDone() const {
+		return done;
+	}
+
+private:
+	using Cells = std::span<const SpatialHashGrid::CellEntry>;
+
+	Cells cells() const;
+	void relocate(Cells cells);
+	bool seekCell(Cells cells);
+	Tile* scanCell(SpatialHashGrid::GridCell& cell);
+
+	BaseMap& map;
+	bool bounded = false;
+	Area area { 0, 0, 0, 0, 0, MAP_LAYERS - 1 }; // Only the floors matter when unbounded
+	// Area in grid cells
+	int min_cx = 0, min_cy = 0, max_cx = 0, max_cy = 0;
+
+	uint64_t layout_generation = 0;
+	size_t cell_index = 0;
+	uint64_t cell_key = 0;
+	bool in_cell = false; // cell_key/cell_index name a cell inside the area
+	int node_i = 0;
+	int floor_i = 0;
+	int tile_i = 0; // Next tile to look at
+	bool done = false;
+};
+
+#endif
@@ -7,27 +7,91 @@
 #include "map/operations/map_processor.h"
 #include "editor/editor.h"
 #include "map/map.h"
+#include "map/map_scan.h"
 #include "map/tile_operations.h"
 #include "ui/gui.h"
 #include "brushes/ground/ground_brush.h"
+#include "brushes/ground/ground_border_calculator.h"
+
+#include <array>
+#include <atomic>
+
+namespace {
+	using CellPass = std::function<uint64_t(SpatialHashGrid::GridCell& cell)>;
+
+	// Runs pass on every grid cell, spread over the MapScan workers in four
+	// waves by cell parity (cx & 1, cy & 1). Two cells of the same wave are
+	// never neighbours, so a pass may touch anything within one tile of the
+	// tile it works on: those tiles belong to cells that are idle during the
+	// wave. Passes run off the main thread and must not touch the GUI.
+	void runInWaves(Map& map, const CellPass& pass, bool showdialog) {
+		const auto cells = map.getGrid().getSortedCells();
+		if (cells.empty()) {
+			return;
+		}
+
+		std::array<std::vector<SpatialHashGrid::SortedGridCell>, 4> waves;
+		for (const auto& cell : cells) {
+			waves[(cell.cx & 1) | ((cell.cy & 1) << 1)].push_back(cell);
+		}
+
+		size_t cells_done = 0;
+		for (const auto& wave : waves) {
+			MapScan::ProgressCallback progress;
+			if (showdialog) {
+				progress = [&](int percent) {
+					g_gui.SetLoadDone(static_cast<int32_t>((cells_done * 100 + wave.size() * percent) / cells.size()));
+				};
+			}
+
+			MapScan::run(
+				wave,
+				[&pass](size_t, SpatialHashGrid::GridCell& cell) {
+					return pass(cell);
+				},
+				[](size_t) { },
+				map.getTileCount() * wave.size() / cells.size(), progress
+			);
+			cells_done += wave.size();
+		}
+	}
+
+	// Per-tile roll that only depends on the seed and the position, so the
+	// result does not depend on which worker gets to a tile first.
+	uint64_t positionHash(uint64_t seed, const Position& position) {
+		uint64_t h = seed ^ ((static_cast<uint64_t>(position.z) << 40) | (static_cast<uint64_t>(static_cast<uint16_t>(position.y)) << 20) | static_cast<uint16_t>(position.x));
+		h += 0x9E3779B97F4A7C15ull;
+		h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+		h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+		return h ^ (h >> 31);
+	}
+}
 
 void MapProcessor::borderizeMap(Editor& editor, bool showdialog) {
 	if (showdialog) {
 		g_gui.CreateLoadBar("Borderizing map...");
 	}
 
-	uint64_t tiles_done = 0;
-	for (TileLocation& tileLocation : editor.map) {
-		if (showdialog && tiles_done % 4096 == 0) {
-			g_gui.SetLoadDone(static_cast<int32_t>(tiles_done / double(editor.map.getTileCount()) * 100.0));
+	// Borders only depend on the neighbours' ground, which this pass never
+	// changes, so the outcome is the same as bordering tile by tile in order.
+	const BaseMap& map = editor.map;
+	std::atomic<bool> selection_changed { false };
+	runInWaves(editor.map, [&](SpatialHashGrid::GridCell& cell) {
+		GroundBorderCalculator::Scratch scratch;
+		TileOperations::SelectionChangeCollector collector;
+		const uint64_t tiles = MapScan::forEachTile(cell, [&](Tile* tile) {
+			GroundBorderCalculator::calculate(map, tile, scratch);
+		});
+		if (collector.changed()) {
+			selection_changed = true;
 		}
+		return tiles;
+	}, showdialog);
 
-		Tile* tile = tileLocation.get();
-		ASSERT(tile);
-
-		TileOperations::borderize(tile, &editor.map);
-		++tiles_done;
+	if (selection_changed) {
+		editor.selection.markChanged();
 	}
+	editor.map.getItemIndex().invalidate();
 
 	if (showdialog) {
 		g_gui.DestroyLoadBar();
@@ -39,17 +103,16 @@ void MapProcessor::randomizeMap(Editor& editor, bool showdialog) {
 		g_gui.CreateLoadBar("Randomizing map...");
 	}
 
-	uint64_t tiles_done = 0;
-	for (TileLocation& tileLocation : editor.map) {
-		if (showdialog && tiles_done % 4096 == 0) {
-			g_gui.SetLoadDone(static_cast<int32_t>(tiles_done / double(editor.map.getTileCount()) * 100.0));
-		}
-
-		Tile* tile = tileLocation.get();
-		ASSERT(tile);
+	const uint64_t seed = (static_cast<uint64_t>(uniform_random(0, INT32_MAX)) << 32) | static_cast<uint32_t>(uniform_random(0, INT32_MAX));
+	std::atomic<bool> selection_changed { false };
+	runInWaves(editor.map, [&](SpatialHashGrid::GridCell& cell) {
+		TileOperations::SelectionChangeCollector collector;
+		const uint64_t tiles = MapScan::forEachTile(cell, [&](Tile* tile) {
+			GroundBrush* groundBrush = tile->getGroundBrush();
+			if (!groundBrush) {
+				return;
+			}
 
-		GroundBrush* groundBrush = tile->getGroundBrush();
-		if (groundBrush) {
 			Item* oldGround = tile->ground.get();
 
 			uint16_t actionId, uniqueId;
@@ -60,7 +123,10 @@ void MapProcessor::randomizeMap(Editor& editor, bool showdialog) {
 				actionId = 0;
 				uniqueId = 0;
 			}
-			groundBrush->draw(&editor.map, tile, nullptr);
+
+			const int totalChance = groundBrush->getTotalChance();
+			const int roll = totalChance > 0 ? 1 + static_cast<int>(positionHash(seed, tile->getPosition()) % totalChance) : 1;
+			groundBrush->drawVariation(tile, roll);
 
 			Item* newGround = tile->ground.get();
 			if (newGround) {
@@ -68,9 +134,17 @@ void MapProcessor::randomizeMap(Editor& editor, bool showdialog) {
 				newGround->setUniqueID(uniqueId);
 			}
 			TileOperations::update(tile);
+		});
+		if (collector.changed()) {
+			selection_changed = true;
 		}
-		++tiles_done;
+		return tiles;
+	}, showdialog);
+
+	if (selection_changed) {
+		editor.selection.markChanged();
 	}
+	editor.map.getItemIndex().invalidate();
 
 	if (showdialog) {
 		g_gui.DestroyLoadBar();
@@ -0,0 +1,228 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "map/slab_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+struct SlabPool::Slab {
+	Slab* prev;
+	Slab* next;
+	FreeBlock* free_list;
+	uint32_t live; // Blocks of this slab currently handed out
+	uint32_t bumped; // Blocks ever carved from the untouched tail of the slab
+	bool linked;
+};
+
+struct SlabPool::ThreadCache {
+	SlabPool* owner = nullptr;
+	FreeBlock* head = nullptr;
+	size_t count = 0;
+	uint64_t allocations = 0;
+
+	~ThreadCache() {
+		if (owner) {
+			owner->flush(*this, 0);
+		}
+	}
+};
+
+namespace {
+	std::atomic<size_t> next_pool_index { 0 };
+}
+
+SlabPool::SlabPool(const char* name, size_t object_size, size_t alignment) :
+	name(name),
+	index(next_pool_index.fetch_add(1)) {
+	// Checked in release builds too: the thread caches are a fixed array
+	if (index >= MAX_POOLS) {
+		throw std::length_error(std::string("SlabPool: cannot create pool \"") + name + "\", all " + std::to_string(MAX_POOLS) + " slots are taken");
+	}
+	alignment = std::max(alignment, alignof(FreeBlock));
+	this->object_size = (std::max(object_size, sizeof(FreeBlock)) + alignment - 1) & ~(alignment - 1);
+	first_offset = (sizeof(Slab) + alignment - 1) & ~(alignment - 1);
+	objects_per_slab = (SLAB_SIZE - first_offset) / this->object_size;
+	assert(objects_per_slab > 0);
+}
+
+SlabPool::~SlabPool() {
+	// Pools live for the whole program; objects may still be freed while static
+	// destructors run, so the slabs are deliberately left to the OS.
+}
+
+SlabPool::ThreadCache& SlabPool::threadCache() {
+	thread_local ThreadCache caches[MAX_POOLS];
+	ThreadCache& cache = caches[index];
+	cache.owner = this;
+	return cache;
+}
+
+void* SlabPool::allocate() {
+	ThreadCache& cache = threadCache();
+	if (!cache.head) {
+		refill(cache);
+	}
+	FreeBlock* block = cache.head;
+	cache.head = block->next;
+	--cache.count;
+	++cache.allocations;
+	return block;
+}
+
+void SlabPool::deallocate(void* ptr) noexcept {
+	if (!ptr) {
+		return;
+	}
+	ThreadCache& cache = threadCache();
+	FreeBlock* block = static_cast<FreeBlock*>(ptr);
+	block->next = cache.head;
+	cache.head = block;
+	if (++cache.count >= CACHE_BATCH * 2) {
+		flush(cache, CACHE_BATCH);
+	}
+}
+
+void SlabPool::refill(ThreadCache& cache) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t i = 0; i < CACHE_BATCH; ++i) {
+		FreeBlock* block = static_cast<FreeBlock*>(allocateLocked());
+		block->next = cache.head;
+		cache.head = block;
+	}
+	cache.count += CACHE_BATCH;
+
+	total_allocations += cache.allocations;
+	cache.allocations = 0;
+	peak_live_objects = std::max(peak_live_objects, live_objects);
+}
+
+void SlabPool::flush(ThreadCache& cache, size_t keep) noexcept {
+	std::lock_guard<std::mutex> lock(mutex);
+	while (cache.count > keep) {
+		FreeBlock* block = cache.head;
+		cache.head = block->next;
+		--cache.count;
+		deallocateLocked(block);
+	}
+	total_allocations += cache.allocations;
+	cache.allocations = 0;
+}
+
+void* SlabPool::allocateLocked() {
+	if (!available) {
+		if (spare) {
+			linkAvailable(spare);
+			spare = nullptr;
+		} else {
+			linkAvailable(newSlab());
+		}
+	}
+
+	Slab* slab = available;
+	void* ptr;
+	if (slab->free_list) {
+		ptr = slab->free_list;
+		slab->free_list = slab->free_list->next;
+	} else {
+		ptr = reinterpret_cast<uint8_t*>(slab) + first_offset + slab->bumped * object_size;
+		++slab->bumped;
+	}
+	++slab->live;
+	++live_objects;
+
+	if (!slab->free_list && slab->bumped == objects_per_slab) {
+		unlinkAvailable(slab);
+	}
+	return ptr;
+}
+
+void SlabPool::deallocateLocked(void* ptr) noexcept {
+	Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t(SLAB_SIZE) - 1));
+	FreeBlock* block = static_cast<FreeBlock*>(ptr);
+	block->next = slab->free_list;
+	slab->free_list = block;
+	--slab->live;
+	--live_objects;
+
+	if (slab->live > 0) {
+		if (!slab->linked) {
+			linkAvailable(slab);
+		}
+		return;
+	}
+
+	// Completely free: keep one slab as a spare, hand the rest back.
+	if (slab->linked) {
+		unlinkAvailable(slab);
+	}
+	if (!spare) {
+		slab->free_list = nullptr;
+		slab->bumped = 0;
+		spare = slab;
+	} else {
+		::operator delete(slab, std::align_val_t(SLAB_SIZE));
+		--slab_count;
+	}
+}
+
+SlabPool::Slab* SlabPool::newSlab() {
+	void* memory = ::operator new(SLAB_SIZE, std::align_val_t(SLAB_SIZE));
+	Slab* slab = new (memory) Slab {};
+	++slab_count;
+	return slab;
+}
+
+void SlabPool::linkAvailable(Slab* slab) noexcept {
+	slab->prev = nullptr;
+	slab->next = available;
+	if (available) {
+		available->prev = slab;
+	}
+	available = slab;
+	slab->linked = true;
+}
+
+void SlabPool::unlinkAvailable(Slab* slab) noexcept {
+	if (slab->prev) {
+		slab->prev->next = slab->next;
+	} else {
+		available = slab->next;
+	}
+	if (slab->next) {
+		slab->next->prev = slab->prev;
+	}
+	slab->prev = slab->next = nullptr;
+	slab->linked = false;
+}
+
+SlabPool::Stats SlabPool::getStats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	Stats stats;
+	stats.name = name;
+	stats.object_size = object_size;
+	stats.objects_per_slab = objects_per_slab;
+	stats.slab_count = slab_count;
+	stats.live_objects = live_objects;
+	stats.peak_live_objects = peak_live_objects;
+	stats.total_allocations = total_allocations;
+	return stats;
+}
@@ -0,0 +1,101 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_SLAB_POOL_H_
+#define RME_SLAB_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Fixed-size object pool that carves objects out of large, aligned slabs.
+// Every slab starts with a small header, so the owning slab of any block is
+// found by masking its address; no per-object bookkeeping is needed.
+//
+// Each thread keeps a small cache of free blocks and exchanges them with the
+// shared pool in batches, so the parallel loaders do not fight over the lock.
+// Slabs that become completely free are given back to the system (one spare
+// is kept around to avoid thrashing).
+class SlabPool {
+public:
+	static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+	struct Stats {
+		const char* name = "";
+		size_t object_size = 0;
+		size_t objects_per_slab = 0;
+		size_t slab_count = 0;
+		// Includes the few blocks parked in per-thread caches.
+		size_t live_objects = 0;
+		size_t peak_live_objects = 0;
+		uint64_t total_allocations = 0;
+
+		size_t reservedBytes() const {
+			return slab_count * SLAB_SIZE;
+		}
+	};
+
+	SlabPool(const char* name, size_t object_size, size_t alignment);
+	~SlabPool();
+
+	SlabPool(const SlabPool&) = delete;
+	SlabPool& operator=(const SlabPool&) = delete;
+
+	void* allocate();
+	void deallocate(void* ptr) noexcept;
+
+	[[nodiscard]] size_t objectSize() const {
+		return object_size;
+	}
+	[[nodiscard]] Stats getStats() const;
+
+private:
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+	struct Slab;
+	struct ThreadCache;
+
+	static constexpr size_t MAX_POOLS = 8;
+	static constexpr size_t CACHE_BATCH = 32;
+
+	ThreadCache& threadCache();
+	void refill(ThreadCache& cache);
+	void flush(ThreadCache& cache, size_t keep) noexcept;
+
+	void* allocateLocked();
+	void deallocateLocked(void* ptr) noexcept;
+	Slab* newSlab();
+	void linkAvailable(Slab* slab) noexcept;
+	void unlinkAvailable(Slab* slab) noexcept;
+
+	const char* name;
+	size_t object_size;
+	size_t first_offset;
+	size_t objects_per_slab;
+	size_t index;
+
+	mutable std::mutex mutex;
+	Slab* available = nullptr; // Slabs with at least one free block
+	Slab* spare = nullptr; // One completely empty slab kept for reuse
+	size_t slab_count = 0;
+	size_t live_objects = 0; // Blocks handed out, including those parked in thread caches
+	size_t peak_live_objects = 0;
+	uint64_t total_allocations = 0;
+};
+
+#endif
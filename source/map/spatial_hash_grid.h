@@ -27,6 +27,10 @@ public:
 		std::array<std::unique_ptr<MapNode>, NODES_IN_CELL> nodes;
 		GridCell();
 		~GridCell();
+
+		// Allocated from MapAllocator's cell pool
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr) noexcept;
 	};
 
 	// CellEntry: the flat sorted storage element
@@ -58,11 +62,26 @@ public:
 	std::vector<SortedGridCell> getSortedCells() const;
 	static void getCellCoordsFromKey(uint64_t key, int& cx, int& cy);
 
+	static uint64_t makeKeyFromCell(int cx, int cy) {
+		static_assert(sizeof(int) == 4, "Key packing assumes exactly 32-bit integers");
+		return (static_cast<uint64_t>(static_cast<uint32_t>(cy) ^ 0x80000000u) << 32) | (static_cast<uint32_t>(cx) ^ 0x80000000u);
+	}
+
+	static uint64_t makeKey(int x, int y) {
+		return makeKeyFromCell(x >> CELL_SHIFT, y >> CELL_SHIFT);
+	}
+
 	// Cell count for strategy decisions
 	[[nodiscard]] size_t cellCount() const {
 		return cells_.size();
 	}
 
+	// Bumped whenever cells are added or dropped, i.e. whenever an index into
+	// begin()..end() may start naming a different cell.
+	[[nodiscard]] uint64_t layoutGeneration() const {
+		return layout_generation_;
+	}
+
 	template <typename Func>
 	void visitLeaves(int min_x, int min_y, int max_x, int max_y, Func&& func) {
 		if (max_x <= min_x || max_y <= min_y) {
@@ -111,6 +130,7 @@ public:
 protected:
 	BaseMap& map;
 	std::vector<CellEntry> cells_; // Sorted by key â€” contiguous, cache-friendly
+	uint64_t layout_generation_ = 0;
 
 	mutable uint64_t last_key_ = 0;
 	mutable size_t last_idx_ = 0; // Index into cells_ for 1-element cache
@@ -153,6 +173,7 @@ protected:
 		auto inserted = cells_.insert(it, CellEntry { key, std::make_unique<GridCell>() });
 		// Invalidate cache since vector may have reallocated
 		last_valid_ = false;
+		++layout_generation_;
 		return static_cast<size_t>(inserted - cells_.begin());
 	}
 
@@ -271,15 +292,6 @@ protected:
 		}
 	}
 
-	static uint64_t makeKeyFromCell(int cx, int cy) {
-		static_assert(sizeof(int) == 4, "Key packing assumes exactly 32-bit integers");
-		return (static_cast<uint64_t>(static_cast<uint32_t>(cy) ^ 0x80000000u) << 32) | (static_cast<uint32_t>(cx) ^ 0x80000000u);
-	}
-
-	static uint64_t makeKey(int x, int y) {
-		return makeKeyFromCell(x >> CELL_SHIFT, y >> CELL_SHIFT);
-	}
-
 	friend class BaseMap;
 	friend class MapIterator;
 };
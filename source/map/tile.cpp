@@ -385,6 +385,9 @@ uint8_t Tile::getMiniMapColor() const {
 void Tile::modify() {
 	statflags |= TILESTATE_MODIFIED;
 	minimapColor = INVALID_MINIMAP_COLOR;
+	if (location) {
+		location->touch();
+	}
 
 	if (!ownedLocation) {
 		if (Editor* editor = g_gui.GetCurrentEditor()) {
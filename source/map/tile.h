@@ -83,6 +83,10 @@ public:
 	Tile(const Tile&) = delete;
 	Tile& operator=(const Tile&) = delete;
 
+	// Allocated from MapAllocator's tile pool
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr) noexcept;
+
 	std::unique_ptr<Tile> deepCopy() const;
 
 	// The location of the tile
@@ -74,6 +74,14 @@ namespace TileOperations {
 				std::ranges::any_of(tile->items, [](const auto& item) { return item->isSelected(); });
 		}
 
+		// Tiles edited in place keep their location, so the renderer's instance
+		// cache has to be told explicitly.
+		void touchLocation(Tile* tile) {
+			if (tile->location) {
+				tile->location->touch();
+			}
+		}
+
 		void applySelectionState(Tile* tile, bool isSelected) {
 			if (isSelected) {
 				tile->statflags |= TILESTATE_SELECTED;
@@ -82,13 +90,29 @@ namespace TileOperations {
 			}
 		}
 
+		thread_local SelectionChangeCollector* active_collector = nullptr;
+
 	} // anonymous namespace
 
+	SelectionChangeCollector::SelectionChangeCollector() :
+		previous(active_collector) {
+		active_collector = this;
+	}
+
+	SelectionChangeCollector::~SelectionChangeCollector() {
+		active_collector = previous;
+	}
+
 	void markSelectionChanged(Tile* tile) {
 		if (!tile) {
 			return;
 		}
 
+		if (active_collector) {
+			active_collector->markChanged();
+			return;
+		}
+
 		if (Editor* editor = g_gui.GetCurrentEditor()) {
 			editor->selection.markChanged();
 		}
@@ -421,6 +445,7 @@ namespace TileOperations {
 		}
 		HouseExitList* house_exits = tile->location->createHouseExits();
 		house_exits->push_back(h->getID());
+		tile->location->touch();
 	}
 
 	void removeHouseExit(Tile* tile, House* h) {
@@ -434,12 +459,14 @@ namespace TileOperations {
 		}
 
 		std::erase(*house_exits, h->getID());
+		tile->location->touch();
 	}
 
 	void updateSelectionState(Tile* tile) {
 		const bool wasSelected = tile->isSelected();
 		const bool isSelected = computeTileSelected(tile);
 		applySelectionState(tile, isSelected);
+		touchLocation(tile);
 
 		if (wasSelected != isSelected) {
 			markSelectionChanged(tile);
@@ -451,6 +478,7 @@ namespace TileOperations {
 		const bool isSelected = computeTileSelected(tile);
 		tile->statflags &= TILESTATE_MODIFIED;
 		applySelectionState(tile, isSelected);
+		touchLocation(tile);
 
 		tile->minimapColor = 0;
 
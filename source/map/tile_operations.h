@@ -38,6 +38,29 @@ namespace TileOperations {
 	void deselectGround(Tile* tile);
 	void markSelectionChanged(Tile* tile);
 
+	// While alive, markSelectionChanged() calls on this thread are recorded
+	// here instead of reaching the editor, so tiles can be updated off the
+	// main thread. The owner reports changed() to the selection afterwards.
+	class SelectionChangeCollector {
+	public:
+		SelectionChangeCollector();
+		~SelectionChangeCollector();
+
+		SelectionChangeCollector(const SelectionChangeCollector&) = delete;
+		SelectionChangeCollector& operator=(const SelectionChangeCollector&) = delete;
+
+		void markChanged() {
+			changed_ = true;
+		}
+		bool changed() const {
+			return changed_;
+		}
+
+	private:
+		SelectionChangeCollector* previous;
+		bool changed_ = false;
+	};
+
 	std::vector<std::unique_ptr<Item>> popSelectedItems(Tile* tile, bool ignoreTileSelected = false);
 	ItemVector getSelectedItems(Tile* tile, bool unzoomed = false);
 	Item* getTopSelectedItem(Tile* tile);
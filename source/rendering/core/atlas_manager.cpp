@@ -106,6 +106,7 @@ void AtlasManager::removeSprite(uint32_t sprite_id) {
 		// this region object after the slot has been reused for a new sprite.
 		region->debug_sprite_id = AtlasRegion::INVALID_SENTINEL;
 		region->atlas_index = AtlasRegion::INVALID_SENTINEL;
+		++generation_;
 	}
 }
 
@@ -118,6 +119,7 @@ void AtlasManager::clearMapping(uint32_t sprite_id) {
 		direct_lookup_[sprite_id] = nullptr;
 	}
 	sprite_regions_.erase(sprite_id);
+	++generation_;
 }
 
 const AtlasRegion* AtlasManager::getWhitePixel() const {
@@ -152,5 +154,6 @@ void AtlasManager::clear() {
 	sprite_regions_.clear();
 	std::fill(direct_lookup_.begin(), direct_lookup_.end(), nullptr);
 	white_pixel_cache_ = nullptr;
+	++generation_;
 	spdlog::info("AtlasManager cleared");
 }
@@ -21,7 +21,10 @@ public:
 	static constexpr uint32_t DIRECT_LOOKUP_SIZE = 2000000; // Support 10.x+ sprite counts
 	static constexpr uint32_t WHITE_PIXEL_ID = 0xFFFFFFFF;
 
-	AtlasManager() = default;
+	// A headless manager hands out regions without uploading anything (see TextureAtlas).
+	explicit AtlasManager(bool headless = false) :
+		atlas_(headless) {
+	}
 	~AtlasManager() = default;
 
 	// Non-copyable
@@ -93,6 +96,15 @@ public:
 	 */
 	void clear();
 
+	/**
+	 * Bumped whenever a region may stop describing the sprite it was handed
+	 * out for (slot freed, mapping dropped, atlas cleared). Anything that keeps
+	 * UVs across frames must drop them when this changes.
+	 */
+	uint64_t getGeneration() const {
+		return generation_;
+	}
+
 	/**
 	 * Ensure atlas is initialized.
 	 */
@@ -112,6 +124,8 @@ private:
 
 	// Cache for white pixel region to avoid hash map lookup
 	const AtlasRegion* white_pixel_cache_ = nullptr;
+
+	uint64_t generation_ = 0;
 };
 
 #endif
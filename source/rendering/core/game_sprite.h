@@ -105,6 +105,8 @@ public:
 
 	// Helper for SpritePreloader to decompress data off-thread
 	[[nodiscard]] static std::unique_ptr<uint8_t[]> Decompress(std::span<const uint8_t> dump, bool use_alpha, int id = 0);
+	// Same, into a caller-owned buffer of SpriteDecoder::OUTPUT_SIZE bytes
+	static void DecompressInto(std::span<const uint8_t> dump, bool use_alpha, std::span<uint8_t> out, int id = 0);
 
 	static void ColorizeTemplatePixels(uint8_t* dest, const uint8_t* mask, size_t pixelCount, int lookHead, int lookBody, int lookLegs, int lookFeet, bool destHasAlpha);
 
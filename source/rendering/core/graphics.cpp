@@ -114,7 +114,7 @@ bool GraphicManager::ensureAtlasManager() {
 
 	// Create and initialize on first use
 	if (!atlas_manager_) {
-		atlas_manager_ = std::make_unique<AtlasManager>();
+		atlas_manager_ = std::make_unique<AtlasManager>(headless);
 	}
 
 	// Lazy initialization happens inside AtlasManager::ensureInitialized()
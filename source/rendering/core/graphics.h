@@ -125,6 +125,14 @@ public:
 	}
 	// Lazy initialization of atlas
 	bool ensureAtlasManager();
+	// Create the atlas without GL textures, for tools running without a context.
+	// Must be set before the atlas is first used.
+	void setHeadless(bool value) {
+		headless = value;
+	}
+	bool isHeadless() const {
+		return headless;
+	}
 
 private:
 	std::atomic<bool> unloaded;
@@ -133,6 +141,7 @@ private:
 
 	// Atlas manager for Phase 2 texture array rendering
 	std::unique_ptr<AtlasManager> atlas_manager_ = nullptr;
+	bool headless = false;
 
 	// These are indexed by ID for O(1) access
 	using SpriteVector = std::vector<std::unique_ptr<Sprite>>;
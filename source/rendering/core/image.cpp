@@ -15,7 +15,7 @@ void Image::clean(time_t time, int longevity) {
 	// Base implementation does nothing
 }
 
-const AtlasRegion* Image::EnsureAtlasSprite(uint32_t sprite_id, std::unique_ptr<uint8_t[]> preloaded_data) {
+const AtlasRegion* Image::EnsureAtlasSprite(uint32_t sprite_id, const uint8_t* preloaded_data) {
 	if (g_gui.gfx.ensureAtlasManager()) {
 		AtlasManager* atlas_mgr = g_gui.gfx.getAtlasManager();
 
@@ -37,13 +37,11 @@ const AtlasRegion* Image::EnsureAtlasSprite(uint32_t sprite_id, std::unique_ptr<
 
 		// 2. Load data
 		std::unique_ptr<uint8_t[]> rgba;
-		if (preloaded_data) {
-			rgba = std::move(preloaded_data);
-		} else {
+		if (!preloaded_data) {
 			rgba = getRGBAData();
 		}
 
-		if (!rgba) {
+		if (!preloaded_data && !rgba) {
 			// Fallback: Create a magenta texture to distinguish failure from garbage
 			// Use literal 32 to ensure compilation (OT sprites are always 32x32)
 			constexpr int SPRITE_DIMENSION = 32;
@@ -60,7 +58,7 @@ const AtlasRegion* Image::EnsureAtlasSprite(uint32_t sprite_id, std::unique_ptr<
 		}
 
 		// 3. Add to Atlas
-		region = atlas_mgr->addSprite(sprite_id, rgba.get());
+		region = atlas_mgr->addSprite(sprite_id, preloaded_data ? preloaded_data : rgba.get());
 
 		if (region) {
 			if (!isGLLoaded) {
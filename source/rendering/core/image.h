@@ -27,7 +27,8 @@ public:
 
 protected:
 	// Helper to handle atlas interactions
-	const AtlasRegion* EnsureAtlasSprite(uint32_t sprite_id, std::unique_ptr<uint8_t[]> preloaded_data = nullptr);
+	// preloaded_data is only read during the call
+	const AtlasRegion* EnsureAtlasSprite(uint32_t sprite_id, const uint8_t* preloaded_data = nullptr);
 };
 
 #endif
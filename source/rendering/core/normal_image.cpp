@@ -8,9 +8,30 @@
 constexpr int RGB_COMPONENTS = 3;
 
 namespace {
-	bool loadDumpFromArchive(uint32_t id, std::unique_ptr<uint8_t[]>& dump, uint16_t& size) {
-		const auto archive = g_gui.gfx.getSpriteArchive();
-		return archive && archive->readCompressed(id, dump, size);
+	// Resolves the compressed bytes of a sprite. Mapped archives are viewed in place
+	// (archive keeps the mapping alive for the caller); otherwise the bytes are
+	// cached in dump so repeated requests within the dump lifetime skip the disk.
+	bool resolveCompressedData(NormalImage& image, std::shared_ptr<SpriteArchive>& archive, std::span<const uint8_t>& compressed) {
+		if (image.dump) {
+			compressed = std::span<const uint8_t>(image.dump.get(), image.size);
+			return true;
+		}
+
+		archive = g_gui.gfx.getSpriteArchive();
+		if (!archive) {
+			return false;
+		}
+
+		if (archive->isMapped()) {
+			std::vector<uint8_t> unused;
+			return archive->viewCompressed(image.id, unused, compressed);
+		}
+
+		if (!archive->readCompressed(image.id, image.dump, image.size)) {
+			return false;
+		}
+		compressed = std::span<const uint8_t>(image.dump.get(), image.size);
+		return true;
 	}
 }
 
@@ -30,8 +51,8 @@ NormalImage::~NormalImage() {
 	}
 }
 
-void NormalImage::fulfillPreload(std::unique_ptr<uint8_t[]> data) {
-	atlas_region = EnsureAtlasSprite(id, std::move(data));
+void NormalImage::fulfillPreload(const uint8_t* data) {
+	atlas_region = EnsureAtlasSprite(id, data);
 }
 
 void NormalImage::clean(time_t time, int longevity) {
@@ -66,11 +87,13 @@ std::unique_ptr<uint8_t[]> NormalImage::getRGBData() {
 		return std::make_unique<uint8_t[]>(pixels_data_size); // Value-initialized (zeroed)
 	}
 
-	if (!dump) {
-		if (!loadDumpFromArchive(id, dump, size)) {
-			return nullptr;
-		}
+	std::shared_ptr<SpriteArchive> archive;
+	std::span<const uint8_t> compressed;
+	if (!resolveCompressedData(*this, archive, compressed)) {
+		return nullptr;
 	}
+	const size_t compressed_size = compressed.size();
+	const uint8_t* source = compressed.data();
 
 	const int pixels_data_size = SPRITE_PIXELS * SPRITE_PIXELS * RGB_COMPONENTS;
 	auto data = std::make_unique<uint8_t[]>(pixels_data_size);
@@ -79,12 +102,12 @@ std::unique_ptr<uint8_t[]> NormalImage::getRGBData() {
 	size_t read = 0;
 
 	// decompress pixels
-	while (read < size && write < static_cast<size_t>(pixels_data_size)) {
-		if (read + 1 >= size) {
-			spdlog::warn("NormalImage::getRGBData: Transparency header truncated (read={}, size={})", read, size);
+	while (read < compressed_size && write < static_cast<size_t>(pixels_data_size)) {
+		if (read + 1 >= compressed_size) {
+			spdlog::warn("NormalImage::getRGBData: Transparency header truncated (read={}, size={})", read, compressed_size);
 			break;
 		}
-		int transparent = dump[read] | dump[read + 1] << 8;
+		int transparent = source[read] | source[read + 1] << 8;
 		read += 2;
 		for (int cnt = 0; cnt < transparent && write < static_cast<size_t>(pixels_data_size); ++cnt) {
 			data[write + 0] = 0xFF; // red
@@ -93,23 +116,23 @@ std::unique_ptr<uint8_t[]> NormalImage::getRGBData() {
 			write += RGB_COMPONENTS;
 		}
 
-		if (read + 1 >= size) {
-			spdlog::warn("NormalImage::getRGBData: Colored header truncated (read={}, size={})", read, size);
+		if (read + 1 >= compressed_size) {
+			spdlog::warn("NormalImage::getRGBData: Colored header truncated (read={}, size={})", read, compressed_size);
 			break;
 		}
 
-		int colored = dump[read] | dump[read + 1] << 8;
+		int colored = source[read] | source[read + 1] << 8;
 		read += 2;
 
-		if (read + static_cast<size_t>(colored) * bpp > size) {
-			spdlog::warn("NormalImage::getRGBData: Read buffer overrun (colored={}, bpp={}, read={}, size={})", colored, bpp, read, size);
+		if (read + static_cast<size_t>(colored) * bpp > compressed_size) {
+			spdlog::warn("NormalImage::getRGBData: Read buffer overrun (colored={}, bpp={}, read={}, size={})", colored, bpp, read, compressed_size);
 			break;
 		}
 
 		for (int cnt = 0; cnt < colored && write < static_cast<size_t>(pixels_data_size); ++cnt) {
-			data[write + 0] = dump[read + 0]; // red
-			data[write + 1] = dump[read + 1]; // green
-			data[write + 2] = dump[read + 2]; // blue
+			data[write + 0] = source[read + 0]; // red
+			data[write + 1] = source[read + 1]; // green
+			data[write + 2] = source[read + 2]; // blue
 			write += RGB_COMPONENTS;
 			read += bpp;
 		}
@@ -132,15 +155,15 @@ std::unique_ptr<uint8_t[]> NormalImage::getRGBAData() {
 		return std::make_unique<uint8_t[]>(pixels_data_size); // Value-initialized (zeroed)
 	}
 
-	if (!dump) {
-		if (!loadDumpFromArchive(id, dump, size)) {
-			// This is the only case where we return nullptr for non-zero ID
-			// effectively warning the caller that the sprite is missing from file
-			return nullptr;
-		}
+	std::shared_ptr<SpriteArchive> archive;
+	std::span<const uint8_t> compressed;
+	if (!resolveCompressedData(*this, archive, compressed)) {
+		// This is the only case where we return nullptr for non-zero ID
+		// effectively warning the caller that the sprite is missing from file
+		return nullptr;
 	}
 
-	return GameSprite::Decompress(std::span { dump.get(), size }, g_gui.gfx.hasTransparency(), id);
+	return GameSprite::Decompress(compressed, g_gui.gfx.hasTransparency(), id);
 }
 
 const AtlasRegion* NormalImage::getAtlasRegion() {
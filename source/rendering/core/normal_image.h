@@ -29,7 +29,7 @@ public:
 	std::unique_ptr<uint8_t[]> getRGBData() override;
 	std::unique_ptr<uint8_t[]> getRGBAData() override;
 
-	void fulfillPreload(std::unique_ptr<uint8_t[]> preloaded_data);
+	void fulfillPreload(const uint8_t* preloaded_data);
 
 	GameSprite* parent = nullptr;
 };
@@ -9,6 +9,7 @@
 #include "ingame_preview/floor_visibility_calculator.h"
 
 #include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
 
 void RenderView::Setup(MapCanvas* canvas, const DrawingOptions& options) {
 	canvas->MouseToMap(&mouse_map_x, &mouse_map_y);
@@ -35,6 +36,39 @@ void RenderView::Setup(MapCanvas* canvas, const DrawingOptions& options) {
 		draw_all_visited_floors = floor_range.draw_all_visited_floors;
 	}
 
+	UpdateBounds();
+}
+
+void RenderView::SetupOffscreen(int scroll_x, int scroll_y, int width, int height, float zoom_level, int current_floor, const DrawingOptions& options) {
+	view_scroll_x = scroll_x;
+	view_scroll_y = scroll_y;
+	screensize_x = width;
+	screensize_y = height;
+	viewport_x = 0;
+	viewport_y = 0;
+
+	zoom = zoom_level;
+	tile_size = std::max(1, static_cast<int>(TILE_SIZE / zoom));
+	floor = current_floor;
+	camera_pos.x = static_cast<int>((view_scroll_x + width * zoom / 2) / TILE_SIZE);
+	camera_pos.y = static_cast<int>((view_scroll_y + height * zoom / 2) / TILE_SIZE);
+	camera_pos.z = floor;
+	mouse_map_x = camera_pos.x;
+	mouse_map_y = camera_pos.y;
+
+	// No map at hand to trace light visibility, so lights use the plain floor range too
+	const auto floor_range = BuildFloorVisibilityRange(floor, options.show_all_floors, options.floor_visibility_mode);
+	start_z = floor_range.start_floor;
+	superend_z = floor_range.end_floor;
+	draw_all_visited_floors = floor_range.draw_all_visited_floors;
+
+	UpdateBounds();
+
+	projectionMatrix = glm::ortho(0.0f, logical_width, logical_height, 0.0f, -1.0f, 1.0f);
+	viewMatrix = glm::mat4(1.0f);
+}
+
+void RenderView::UpdateBounds() {
 	end_z = floor;
 
 	start_x = view_scroll_x / TILE_SIZE;
@@ -107,8 +141,6 @@ void RenderView::getScreenPosition(int map_x, int map_y, int map_z, int& out_x,
 	out_y = (map_y * TILE_SIZE) - view_scroll_y - offset;
 }
 
-#include <glm/gtc/matrix_transform.hpp>
-
 void RenderView::SetupGL() {
 	glViewport(viewport_x, viewport_y, screensize_x, screensize_y);
 
@@ -35,6 +35,9 @@ struct RenderView {
 	glm::mat4 viewMatrix;
 
 	void Setup(MapCanvas* canvas, const DrawingOptions& options);
+	// Same as Setup() for a view that has no canvas (e.g. headless tools).
+	// scroll_x/scroll_y are in map pixels, width/height in screen pixels.
+	void SetupOffscreen(int scroll_x, int scroll_y, int width, int height, float zoom_level, int current_floor, const DrawingOptions& options);
 	void SetupGL();
 	void ReleaseGL();
 	void Clear();
@@ -51,6 +54,10 @@ struct RenderView {
 	// Cached logical viewport dimensions for optimization
 	float logical_width = 0.0f;
 	float logical_height = 0.0f;
+
+private:
+	// Tile range and logical size from scroll, screen size, zoom and floor
+	void UpdateBounds();
 };
 
 #endif
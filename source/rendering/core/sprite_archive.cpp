@@ -2,6 +2,7 @@
 
 #include "app/definitions.h"
 #include "io/filehandle.h"
+#include "io/mapped_file.h"
 
 #include <format>
 #include <utility>
@@ -35,13 +36,16 @@ namespace {
 	}
 }
 
-SpriteArchive::SpriteArchive(std::string filename, bool is_extended, uint32_t sprite_count, std::vector<uint32_t> sprite_offsets) :
+SpriteArchive::SpriteArchive(std::string filename, bool is_extended, uint32_t sprite_count, std::vector<uint32_t> sprite_offsets, std::unique_ptr<MappedFile> file) :
 	filename_(std::move(filename)),
 	is_extended_(is_extended),
 	sprite_count_(sprite_count),
-	sprite_offsets_(std::move(sprite_offsets)) {
+	sprite_offsets_(std::move(sprite_offsets)),
+	file_(std::move(file)) {
 }
 
+SpriteArchive::~SpriteArchive() = default;
+
 std::shared_ptr<SpriteArchive> SpriteArchive::load(const wxFileName& path, bool is_extended, wxString& error, std::vector<std::string>& warnings) {
 	FileReadHandle file(path.GetFullPath().ToStdString());
 	if (!file.isOk()) {
@@ -71,17 +75,32 @@ std::shared_ptr<SpriteArchive> SpriteArchive::load(const wxFileName& path, bool
 		warnings.push_back("Sprite archive contains zero sprites.");
 	}
 
-	return std::shared_ptr<SpriteArchive>(new SpriteArchive(path.GetFullPath().ToStdString(), is_extended, sprite_count, std::move(offsets)));
+	// One shared handle serves every reader. Mapping failure (e.g. 32-bit address
+	// space exhaustion) is not fatal, reads then go through positional I/O.
+	auto mapped = std::make_unique<MappedFile>();
+	if (!mapped->open(path.GetFullPath().ToStdString())) {
+		error = wxString::FromUTF8(std::format("Failed to open {} for shared reading.", path.GetFullPath().utf8_string()));
+		return nullptr;
+	}
+	if (!mapped->isMapped()) {
+		warnings.push_back("Sprite archive could not be memory-mapped, falling back to buffered reads.");
+	}
+
+	return std::shared_ptr<SpriteArchive>(new SpriteArchive(path.GetFullPath().ToStdString(), is_extended, sprite_count, std::move(offsets), std::move(mapped)));
 }
 
-bool SpriteArchive::readCompressed(uint32_t sprite_id, std::unique_ptr<uint8_t[]>& target, uint16_t& size) const {
-	size = 0;
-	target.reset();
+bool SpriteArchive::isMapped() const {
+	return file_ && file_->isMapped();
+}
+
+bool SpriteArchive::locate(uint32_t sprite_id, size_t& data_offset, uint16_t& data_size) const {
+	data_offset = 0;
+	data_size = 0;
 
 	if (sprite_id == 0) {
 		return true;
 	}
-	if (sprite_id >= sprite_offsets_.size()) {
+	if (sprite_id >= sprite_offsets_.size() || !file_) {
 		return false;
 	}
 
@@ -90,25 +109,62 @@ bool SpriteArchive::readCompressed(uint32_t sprite_id, std::unique_ptr<uint8_t[]
 		return true;
 	}
 
-	FileReadHandle file(filename_);
-	if (!file.isOk()) {
+	// Each entry starts with a 3-byte colour key followed by the u16 payload size.
+	const size_t header_offset = static_cast<size_t>(offset) + kSpriteDataOffset;
+	uint8_t size_bytes[2];
+	if (!file_->read(header_offset, size_bytes, sizeof(size_bytes))) {
+		return false;
+	}
+
+	data_offset = header_offset + sizeof(size_bytes);
+	data_size = static_cast<uint16_t>(size_bytes[0] | (size_bytes[1] << 8));
+	return data_offset + data_size <= file_->size();
+}
+
+bool SpriteArchive::viewCompressed(uint32_t sprite_id, std::vector<uint8_t>& scratch, std::span<const uint8_t>& view) const {
+	view = {};
+
+	size_t data_offset = 0;
+	uint16_t data_size = 0;
+	if (!locate(sprite_id, data_offset, data_size)) {
 		return false;
 	}
-	if (!file.seek(offset + kSpriteDataOffset)) {
+	if (data_size == 0) {
+		return true;
+	}
+
+	if (file_->isMapped()) {
+		view = file_->view(data_offset, data_size);
+		return !view.empty();
+	}
+
+	scratch.resize(data_size);
+	if (!file_->read(data_offset, scratch.data(), data_size)) {
 		return false;
 	}
+	view = std::span<const uint8_t>(scratch.data(), data_size);
+	return true;
+}
 
-	uint16_t compressed_size = 0;
-	if (!file.getU16(compressed_size)) {
+bool SpriteArchive::readCompressed(uint32_t sprite_id, std::unique_ptr<uint8_t[]>& target, uint16_t& size) const {
+	size = 0;
+	target.reset();
+
+	size_t data_offset = 0;
+	uint16_t data_size = 0;
+	if (!locate(sprite_id, data_offset, data_size)) {
 		return false;
 	}
+	if (data_size == 0) {
+		return true;
+	}
 
-	auto buffer = std::make_unique<uint8_t[]>(compressed_size);
-	if (!file.getRAW(buffer.get(), compressed_size)) {
+	auto buffer = std::make_unique<uint8_t[]>(data_size);
+	if (!file_->read(data_offset, buffer.get(), data_size)) {
 		return false;
 	}
 
-	size = compressed_size;
+	size = data_size;
 	target = std::move(buffer);
 	return true;
 }
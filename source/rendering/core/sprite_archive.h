@@ -3,14 +3,21 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
+class MappedFile;
 class wxFileName;
 class wxString;
 
+// Index over a client .spr file. The file is kept open for the lifetime of the
+// archive and shared by every reader; when it can be memory-mapped, sprite data
+// is handed out as views into the mapping without any copy.
 class SpriteArchive {
 public:
+	~SpriteArchive();
+
 	[[nodiscard]] static std::shared_ptr<SpriteArchive> load(const wxFileName& path, bool is_extended, wxString& error, std::vector<std::string>& warnings);
 
 	[[nodiscard]] uint32_t spriteCount() const {
@@ -25,15 +32,26 @@ public:
 		return filename_;
 	}
 
+	[[nodiscard]] bool isMapped() const;
+
+	// Resolves the compressed pixel data of a sprite. Mapped archives return a view
+	// straight into the file; otherwise the bytes are read into scratch and the view
+	// points there. The view stays valid while this archive and scratch are alive.
+	// An empty view with a true result means the sprite is blank.
+	[[nodiscard]] bool viewCompressed(uint32_t sprite_id, std::vector<uint8_t>& scratch, std::span<const uint8_t>& view) const;
+
 	[[nodiscard]] bool readCompressed(uint32_t sprite_id, std::unique_ptr<uint8_t[]>& target, uint16_t& size) const;
 
 private:
-	SpriteArchive(std::string filename, bool is_extended, uint32_t sprite_count, std::vector<uint32_t> sprite_offsets);
+	SpriteArchive(std::string filename, bool is_extended, uint32_t sprite_count, std::vector<uint32_t> sprite_offsets, std::unique_ptr<MappedFile> file);
+
+	[[nodiscard]] bool locate(uint32_t sprite_id, size_t& data_offset, uint16_t& data_size) const;
 
 	std::string filename_;
 	bool is_extended_ = false;
 	uint32_t sprite_count_ = 0;
 	std::vector<uint32_t> sprite_offsets_;
+	std::unique_ptr<MappedFile> file_;
 };
 
 #endif
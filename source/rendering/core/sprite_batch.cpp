@@ -1,6 +1,7 @@
 #include "rendering/core/sprite_batch.h"
 #include "rendering/core/shared_geometry.h"
 #include <iostream>
+#include <algorithm>
 #include <cstring>
 #include <utility>
 #include <spdlog/spdlog.h>
@@ -130,6 +131,7 @@ void SpriteBatch::begin(const glm::mat4& projection, const AtlasManager& atlas_m
 	current_atlas_manager_ = &atlas_manager;
 	pending_sprites_.clear();
 	in_batch_ = true;
+	recording_ = false;
 	draw_call_count_ = 0;
 	sprite_count_ = 0;
 	global_tint_ = glm::vec4(1.0f);
@@ -145,6 +147,17 @@ void SpriteBatch::begin(const glm::mat4& projection, const AtlasManager& atlas_m
 	shader_->SetVec4("uGlobalTint", global_tint_);
 }
 
+void SpriteBatch::beginRecording() {
+	// No atlas manager: draw() and drawInstances() never try to flush
+	current_atlas_manager_ = nullptr;
+	pending_sprites_.clear();
+	in_batch_ = true;
+	recording_ = true;
+	draw_call_count_ = 0;
+	sprite_count_ = 0;
+	global_tint_ = glm::vec4(1.0f);
+}
+
 void SpriteBatch::setGlobalTint(float r, float g, float b, float a, const AtlasManager& atlas_manager) {
 	if (!in_batch_) {
 		return;
@@ -156,7 +169,9 @@ void SpriteBatch::setGlobalTint(float r, float g, float b, float a, const AtlasM
 	}
 
 	global_tint_ = glm::vec4(r, g, b, a);
-	shader_->SetVec4("uGlobalTint", global_tint_);
+	if (!recording_) {
+		shader_->SetVec4("uGlobalTint", global_tint_);
+	}
 }
 
 void SpriteBatch::ensureCapacity(size_t capacity) {
@@ -170,15 +185,19 @@ void SpriteBatch::draw(float x, float y, float w, float h, const AtlasRegion& re
 }
 
 void SpriteBatch::draw(float x, float y, float w, float h, const AtlasRegion& region, float r, float g, float b, float a) {
-	if (!in_batch_) {
-		return;
-	}
+	std::vector<SpriteInstance>* target = capture_target_;
+	if (!target) {
+		if (!in_batch_) {
+			return;
+		}
 
-	if (pending_sprites_.size() >= MAX_SPRITES_PER_BATCH && current_atlas_manager_) {
-		flush(*current_atlas_manager_);
+		if (pending_sprites_.size() >= MAX_SPRITES_PER_BATCH && current_atlas_manager_) {
+			flush(*current_atlas_manager_);
+		}
+		target = &pending_sprites_;
 	}
 
-	SpriteInstance& inst = pending_sprites_.emplace_back();
+	SpriteInstance& inst = target->emplace_back();
 	inst.x = x;
 	inst.y = y;
 	inst.w = w;
@@ -194,6 +213,40 @@ void SpriteBatch::draw(float x, float y, float w, float h, const AtlasRegion& re
 	inst.atlas_layer = static_cast<float>(region.atlas_index);
 }
 
+void SpriteBatch::beginCapture(std::vector<SpriteInstance>& target) {
+	ASSERT(!capture_target_);
+	capture_target_ = &target;
+	capture_volatile_ = false;
+}
+
+bool SpriteBatch::endCapture() {
+	capture_target_ = nullptr;
+	return !std::exchange(capture_volatile_, false);
+}
+
+void SpriteBatch::drawInstances(std::span<const SpriteInstance> instances, float dx, float dy) {
+	if (!in_batch_ || capture_target_) {
+		return;
+	}
+
+	while (!instances.empty()) {
+		size_t count = instances.size();
+		if (current_atlas_manager_) {
+			if (pending_sprites_.size() >= MAX_SPRITES_PER_BATCH) {
+				flush(*current_atlas_manager_);
+			}
+			count = std::min(count, MAX_SPRITES_PER_BATCH - pending_sprites_.size());
+		}
+		const size_t first = pending_sprites_.size();
+		pending_sprites_.insert(pending_sprites_.end(), instances.begin(), instances.begin() + count);
+		for (SpriteInstance* inst = pending_sprites_.data() + first, *last = inst + count; inst != last; ++inst) {
+			inst->x += dx;
+			inst->y += dy;
+		}
+		instances = instances.subspan(count);
+	}
+}
+
 void SpriteBatch::drawRect(float x, float y, float w, float h, const glm::vec4& color, const AtlasManager& atlas_manager) {
 	const AtlasRegion* region = atlas_manager.getWhitePixel();
 	if (region) {
@@ -213,7 +266,7 @@ void SpriteBatch::drawRectLines(float x, float y, float w, float h, const glm::v
 }
 
 void SpriteBatch::flush(const AtlasManager& atlas_manager) {
-	if (pending_sprites_.empty()) {
+	if (pending_sprites_.empty() || recording_) {
 		return;
 	}
 
@@ -341,6 +394,13 @@ void SpriteBatch::end(const AtlasManager& atlas_manager) {
 		return;
 	}
 
+	if (recording_) {
+		in_batch_ = false;
+		recording_ = false;
+		sprite_count_ = static_cast<int>(pending_sprites_.size());
+		return;
+	}
+
 	flush(atlas_manager);
 
 	in_batch_ = false;
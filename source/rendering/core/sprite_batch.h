@@ -14,6 +14,7 @@
 #include <memory>
 #include <glm/glm.hpp>
 #include <optional>
+#include <span>
 
 /**
  * High-performance batched sprite renderer using instanced drawing.
@@ -51,6 +52,20 @@ public:
 	 */
 	void begin(const glm::mat4& projection, const AtlasManager& atlas_manager);
 
+	/**
+	 * Begin a batch that only collects instances: nothing is flushed and no GL
+	 * call is made, so it works without a context or initialize().
+	 * The instances stay available through getRecordedInstances() after end().
+	 */
+	void beginRecording();
+
+	/**
+	 * Instances collected since the last beginRecording().
+	 */
+	std::span<const SpriteInstance> getRecordedInstances() const {
+		return pending_sprites_;
+	}
+
 	/**
 	 * Queue a sprite for rendering.
 	 * @param x Screen X
@@ -94,6 +109,37 @@ public:
 	 */
 	void ensureCapacity(size_t capacity);
 
+	/**
+	 * Redirect subsequent draws into target instead of the pending batch.
+	 * Used to record instance lists that are replayed with drawInstances().
+	 * Capturing works outside begin()/end() and without GPU resources.
+	 * @param target List to append to (not cleared)
+	 */
+	void beginCapture(std::vector<SpriteInstance>& target);
+
+	/**
+	 * Stop capturing. Returns false if the captured content was marked volatile.
+	 */
+	bool endCapture();
+
+	/**
+	 * Flag the content being captured as frame-dependent (animated, not yet
+	 * uploaded, or feeding per-frame overlays), so it must not be replayed.
+	 * No-op when not capturing.
+	 */
+	void markVolatile() {
+		capture_volatile_ = true;
+	}
+
+	bool isCapturing() const {
+		return capture_target_ != nullptr;
+	}
+
+	/**
+	 * Queue pre-built instances, translated by (dx, dy).
+	 */
+	void drawInstances(std::span<const SpriteInstance> instances, float dx, float dy);
+
 	int getDrawCallCount() const {
 		return draw_call_count_;
 	}
@@ -112,6 +158,8 @@ private:
 	MultiDrawIndirectRenderer mdi_renderer_;
 
 	std::vector<SpriteInstance> pending_sprites_;
+	std::vector<SpriteInstance>* capture_target_ = nullptr;
+	bool capture_volatile_ = false;
 	glm::mat4 projection_ { 1.0f };
 	glm::vec4 global_tint_ { 1.0f };
 	const AtlasManager* current_atlas_manager_ = nullptr;
@@ -121,6 +169,7 @@ private:
 	std::optional<ScopedGLBlend> blend_func_;
 
 	bool in_batch_ = false;
+	bool recording_ = false;
 	bool use_mdi_ = false;
 
 	int draw_call_count_ = 0;
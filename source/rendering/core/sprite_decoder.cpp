@@ -0,0 +1,167 @@
+#include "rendering/core/sprite_decoder.h"
+
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+	#include <tmmintrin.h>
+	#define RME_SPRITE_DECODER_SSSE3 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define RME_SPRITE_DECODER_NEON 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define RME_SPRITE_DECODER_SSE2 1
+#endif
+
+namespace {
+	constexpr size_t RGB_COMPONENTS = 3;
+	constexpr size_t RGBA_COMPONENTS = 4;
+
+	// Masks over one RGBA pixel loaded as a native 32-bit word
+	constexpr uint32_t ALPHA_MASK = std::endian::native == std::endian::little ? 0xFF000000u : 0x000000FFu;
+	constexpr uint32_t COLOR_MASK = ~ALPHA_MASK;
+
+	uint16_t readU16(const uint8_t* data) {
+		return static_cast<uint16_t>(data[0] | data[1] << 8);
+	}
+
+	// RGB to opaque RGBA. available is how many bytes may be read from src,
+	// usually more than pixels * 3, which lets the loops load whole words.
+	void expandRGB(const uint8_t* src, size_t available, uint8_t* dst, size_t pixels) {
+		size_t i = 0;
+
+#if defined(RME_SPRITE_DECODER_SSSE3)
+		// 4 pixels per 16-byte load, the last 4 input bytes are ignored
+		const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+		for (; i + 4 <= pixels && i * RGB_COMPONENTS + 16 <= available; i += 4) {
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * RGB_COMPONENTS));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * RGBA_COMPONENTS), _mm_or_si128(_mm_shuffle_epi8(in, shuffle), alpha));
+		}
+#elif defined(RME_SPRITE_DECODER_NEON)
+		for (; i + 16 <= pixels; i += 16) {
+			const uint8x16x3_t in = vld3q_u8(src + i * RGB_COMPONENTS);
+			uint8x16x4_t out;
+			out.val[0] = in.val[0];
+			out.val[1] = in.val[1];
+			out.val[2] = in.val[2];
+			out.val[3] = vdupq_n_u8(0xFF);
+			vst4q_u8(dst + i * RGBA_COMPONENTS, out);
+		}
+#endif
+
+		for (; i < pixels && i * RGB_COMPONENTS + 4 <= available; ++i) {
+			uint32_t pixel;
+			memcpy(&pixel, src + i * RGB_COMPONENTS, sizeof(pixel));
+			pixel |= ALPHA_MASK;
+			memcpy(dst + i * RGBA_COMPONENTS, &pixel, sizeof(pixel));
+		}
+
+		for (; i < pixels; ++i) {
+			dst[i * RGBA_COMPONENTS + 0] = src[i * RGB_COMPONENTS + 0];
+			dst[i * RGBA_COMPONENTS + 1] = src[i * RGB_COMPONENTS + 1];
+			dst[i * RGBA_COMPONENTS + 2] = src[i * RGB_COMPONENTS + 2];
+			dst[i * RGBA_COMPONENTS + 3] = 0xFF;
+		}
+	}
+
+	void countPixels(const uint8_t* rgba, size_t pixels, SpriteDecodeStats& stats) {
+		// Locals, as stores through rgba could otherwise alias the counters
+		uint32_t visible = 0;
+		uint32_t colored = 0;
+		size_t i = 0;
+
+#if defined(RME_SPRITE_DECODER_SSE2)
+		// Each compare yields -1 per matching lane; summed per lane and folded
+		// at the end, which also avoids popcnt, absent from baseline x86-64.
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(ALPHA_MASK));
+		const __m128i color = _mm_set1_epi32(static_cast<int>(COLOR_MASK));
+		const __m128i zero = _mm_setzero_si128();
+		__m128i hidden = zero;
+		__m128i black = zero;
+		for (; i + 4 <= pixels; i += 4) {
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * RGBA_COMPONENTS));
+			hidden = _mm_add_epi32(hidden, _mm_cmpeq_epi32(_mm_and_si128(in, alpha), zero));
+			black = _mm_add_epi32(black, _mm_cmpeq_epi32(_mm_and_si128(in, color), zero));
+		}
+		alignas(16) int32_t lanes[2][4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes[0]), hidden);
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes[1]), black);
+		visible += static_cast<uint32_t>(i + lanes[0][0] + lanes[0][1] + lanes[0][2] + lanes[0][3]);
+		colored += static_cast<uint32_t>(i + lanes[1][0] + lanes[1][1] + lanes[1][2] + lanes[1][3]);
+#endif
+
+		for (; i < pixels; ++i) {
+			uint32_t pixel;
+			memcpy(&pixel, rgba + i * RGBA_COMPONENTS, sizeof(pixel));
+			visible += (pixel & ALPHA_MASK) != 0;
+			colored += (pixel & COLOR_MASK) != 0;
+		}
+
+		stats.visible_pixels += visible;
+		stats.colored_pixels += colored;
+	}
+}
+
+bool SpriteDecoder::decode(std::span<const uint8_t> dump, bool use_alpha, std::span<uint8_t> out, SpriteDecodeStats* stats) {
+	assert(out.size() >= OUTPUT_SIZE);
+
+	const uint8_t* in = dump.data();
+	const size_t size = dump.size();
+	const size_t bpp = use_alpha ? RGBA_COMPONENTS : RGB_COMPONENTS;
+	uint8_t* dst = out.data();
+
+	if (stats) {
+		*stats = {};
+	}
+
+	bool intact = true;
+	size_t read = 0;
+	size_t write = 0; // In pixels
+	while (read + 2 <= size && write < PIXELS) {
+		size_t transparent = readU16(in + read);
+		read += 2;
+		if (transparent > PIXELS - write) {
+			transparent = PIXELS - write;
+			intact = false;
+		}
+		memset(dst + write * RGBA_COMPONENTS, 0, transparent * RGBA_COMPONENTS);
+		write += transparent;
+
+		if (read + 2 > size || write >= PIXELS) {
+			break;
+		}
+
+		size_t colored = readU16(in + read);
+		read += 2;
+		if (colored > PIXELS - write) {
+			colored = PIXELS - write;
+			intact = false;
+		}
+		if (colored * bpp > size - read) {
+			// Nothing sensible to read the run from
+			intact = false;
+			break;
+		}
+
+		uint8_t* run = dst + write * RGBA_COMPONENTS;
+		if (use_alpha) {
+			memcpy(run, in + read, colored * RGBA_COMPONENTS);
+		} else {
+			expandRGB(in + read, size - read, run, colored);
+		}
+		if (stats) {
+			countPixels(run, colored, *stats);
+		}
+
+		read += colored * bpp;
+		write += colored;
+	}
+
+	memset(dst + write * RGBA_COMPONENTS, 0, (PIXELS - write) * RGBA_COMPONENTS);
+	return intact;
+}
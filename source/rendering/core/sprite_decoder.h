@@ -0,0 +1,34 @@
+#ifndef RME_RENDERING_CORE_SPRITE_DECODER_H_
+#define RME_RENDERING_CORE_SPRITE_DECODER_H_
+
+#include "app/definitions.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Pixel counts over a decoded sprite. Only computed when asked for.
+struct SpriteDecodeStats {
+	uint32_t visible_pixels = 0; // alpha > 0
+	uint32_t colored_pixels = 0; // any of r, g, b > 0
+};
+
+// Decoder for the .spr pixel format: a 32x32 sprite stored as alternating
+// [u16 transparent count][u16 colored count][colored * RGB(A)] runs. Colored
+// runs are expanded to RGBA with SSSE3 or NEON shuffles where the build
+// enables them, and with one 4-byte load per pixel otherwise.
+//
+// Nothing here allocates or depends on wx, so it can decode straight into an
+// atlas staging slot, a pooled buffer or a benchmark's arena.
+class SpriteDecoder {
+public:
+	static constexpr size_t PIXELS = SPRITE_PIXELS_SIZE;
+	static constexpr size_t OUTPUT_SIZE = PIXELS * 4;
+
+	// Writes exactly OUTPUT_SIZE bytes of RGBA to out; whatever the dump does
+	// not cover is transparent. Returns false if a run overflowed the sprite
+	// or the dump, keeping the pixels decoded up to that point.
+	static bool decode(std::span<const uint8_t> dump, bool use_alpha, std::span<uint8_t> out, SpriteDecodeStats* stats = nullptr);
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include "rendering/core/graphics.h"
 #include "rendering/core/normal_image.h"
 #include "rendering/core/sprite_archive.h"
+#include "rendering/core/sprite_decoder.h"
 #include "ui/gui.h"
 
 #include <algorithm>
@@ -17,14 +18,9 @@ SpritePreloader& SpritePreloader::get() {
 	return instance;
 }
 
-SpritePreloader::SpritePreloader() : stopping(false) {
-	unsigned int num_threads = std::clamp(std::thread::hardware_concurrency(), MIN_WORKER_THREADS, MAX_WORKER_THREADS);
-	workers.reserve(num_threads);
-	for (unsigned int i = 0; i < num_threads; ++i) {
-		workers.emplace_back([this](std::stop_token stop_token) {
-			this->workerLoop(stop_token);
-		});
-	}
+SpritePreloader::SpritePreloader() :
+	stopping(false),
+	tasks(g_scheduler, TaskPriority::Interactive) {
 }
 
 SpritePreloader::~SpritePreloader() {
@@ -39,17 +35,15 @@ void SpritePreloader::shutdown() {
 		}
 		stopping = true;
 	}
-	for (auto& worker : workers) {
-		worker.request_stop(); // Correctly signaled transition for jthread's stop_token
-	}
-	cv.notify_all();
+	tasks.cancel();
+	tasks.wait();
 }
 
 void SpritePreloader::clear() {
 	std::lock_guard<std::mutex> lock(queue_mutex);
-	// Bump the epoch so any in-flight worker result becomes stale.
+	// Bump the epoch so queued and in-flight decodes become stale; they are
+	// skipped or their results dropped.
 	++active_epoch;
-	task_queue = std::queue<Task>();
 	result_queue = std::queue<Result>();
 	pending_ids.clear();
 }
@@ -106,9 +100,15 @@ void SpritePreloader::preload(GameSprite* spr, int pattern_x, int pattern_y, int
 		}
 	}
 
-	if (!ids_to_enqueue.empty()) {
+	if (ids_to_enqueue.empty()) {
+		return;
+	}
+
+	static thread_local std::vector<Task> to_submit;
+	to_submit.clear();
+	{
 		std::lock_guard<std::mutex> lock(queue_mutex);
-		if (task_queue.size() > MAX_QUEUE_SIZE) {
+		if (stopping || queued_tasks > MAX_QUEUE_SIZE) {
 			return; // Drop requests if queue is slammed
 		}
 
@@ -119,42 +119,64 @@ void SpritePreloader::preload(GameSprite* spr, int pattern_x, int pattern_y, int
 				.epoch = active_epoch,
 			};
 			if (pending_ids.insert(pending_key).second) {
-				task_queue.push({ pending_key, archive, has_transparency });
+				to_submit.push_back({ pending_key, archive, has_transparency });
 			}
 		}
-		cv.notify_all();
+		queued_tasks += to_submit.size();
+	}
+
+	for (Task& task : to_submit) {
+		tasks.run([this, task = std::move(task)]() mutable {
+			decode(std::move(task));
+		});
 	}
 }
 
-void SpritePreloader::workerLoop(std::stop_token stop_token) {
-	while (!stop_token.stop_requested()) {
-		Task task;
-		{
-			std::unique_lock<std::mutex> lock(queue_mutex);
-			cv.wait(lock, [this, &stop_token] { return stop_token.stop_requested() || !task_queue.empty(); });
-			if (stop_token.stop_requested()) {
-				break;
-			}
-			task = std::move(task_queue.front());
-			task_queue.pop();
-		}
+SpritePreloader::PixelBuffer SpritePreloader::acquireBuffer() {
+	if (spare_buffers.empty()) {
+		return std::make_unique_for_overwrite<uint8_t[]>(SpriteDecoder::OUTPUT_SIZE);
+	}
+	PixelBuffer buffer = std::move(spare_buffers.back());
+	spare_buffers.pop_back();
+	return buffer;
+}
 
-		std::unique_ptr<uint8_t[]> dump;
-		uint16_t size = 0;
-		const bool success = task.archive && task.archive->readCompressed(task.pending.key.id, dump, size);
+void SpritePreloader::recycleBuffer(PixelBuffer buffer) {
+	if (buffer && spare_buffers.size() < MAX_SPARE_BUFFERS) {
+		spare_buffers.push_back(std::move(buffer));
+	}
+}
 
-		std::unique_ptr<uint8_t[]> rgba;
-		if (success && dump) {
-			rgba = GameSprite::Decompress(std::span { dump.get(), size }, task.has_transparency, task.pending.key.id);
+void SpritePreloader::decode(Task task) {
+	PixelBuffer rgba;
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		--queued_tasks;
+		if (task.pending.epoch != active_epoch) {
+			return; // Cleared while queued; pending_ids was reset with it
 		}
+		rgba = acquireBuffer();
+	}
 
-		{
-			std::lock_guard<std::mutex> lock(queue_mutex);
-			if (rgba) {
-				result_queue.push({ task.pending, std::move(rgba), std::move(task.archive) });
-			} else {
-				pending_ids.erase(task.pending);
-			}
+	// Only used when the archive is not memory-mapped; reused across tasks.
+	static thread_local std::vector<uint8_t> scratch;
+
+	// task.archive keeps the mapping alive while the view is decoded.
+	std::span<const uint8_t> compressed;
+	const bool success = task.archive && task.archive->viewCompressed(task.pending.key.id, scratch, compressed);
+
+	const bool decoded = success && !compressed.empty();
+	if (decoded) {
+		GameSprite::DecompressInto(compressed, task.has_transparency, { rgba.get(), SpriteDecoder::OUTPUT_SIZE }, task.pending.key.id);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		if (decoded) {
+			result_queue.push({ task.pending, std::move(rgba), std::move(task.archive) });
+		} else {
+			pending_ids.erase(task.pending);
+			recycleBuffer(std::move(rgba));
 		}
 	}
 }
@@ -178,6 +200,8 @@ void SpritePreloader::update() {
 	thread_local std::vector<PendingSpriteKey> keys_processed;
 	keys_processed.clear();
 	keys_processed.reserve(results.size());
+	std::vector<PixelBuffer> consumed;
+	consumed.reserve(results.size());
 
 	const auto current_archive = g_gui.gfx.getSpriteArchive();
 	const bool graphics_unloaded = g_gui.gfx.isUnloaded();
@@ -189,6 +213,7 @@ void SpritePreloader::update() {
 		const auto pending = res.pending;
 		const auto id = pending.key.id;
 		keys_processed.push_back(pending);
+		consumed.push_back(std::move(res.data));
 
 		if (pending.epoch != current_epoch) {
 			continue;
@@ -204,7 +229,7 @@ void SpritePreloader::update() {
 				// Validate Sprite Identity & Generation
 				// Check ID match, Generation match, and GLLoaded state
 				if (img->id == id && img->generation_id == pending.generation_id && !img->isGLLoaded) {
-					img->fulfillPreload(std::move(res.data));
+					img->fulfillPreload(consumed.back().get());
 				}
 			}
 		}
@@ -215,6 +240,10 @@ void SpritePreloader::update() {
 		for (const auto& pending : keys_processed) {
 			pending_ids.erase(pending);
 		}
+		// The atlas copied the pixels, the buffers can go to the next decodes
+		for (PixelBuffer& buffer : consumed) {
+			recycleBuffer(std::move(buffer));
+		}
 	}
 }
 
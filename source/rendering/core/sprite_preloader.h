@@ -5,15 +5,15 @@
 #ifndef RME_RENDERING_CORE_SPRITE_PRELOADER_H_
 #define RME_RENDERING_CORE_SPRITE_PRELOADER_H_
 
+#include "app/task_scheduler.h"
 #include "rendering/core/game_sprite.h"
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <thread>
-#include <condition_variable>
 #include <cstdint>
 #include <queue>
 #include <unordered_set>
+#include <vector>
 
 class SpriteArchive;
 
@@ -75,6 +75,8 @@ private:
 		}
 	};
 
+	using PixelBuffer = std::unique_ptr<uint8_t[]>;
+
 	struct Task {
 		PendingSpriteKey pending;
 		std::shared_ptr<SpriteArchive> archive;
@@ -83,26 +85,33 @@ private:
 
 	struct Result {
 		PendingSpriteKey pending;
-		std::unique_ptr<uint8_t[]> data;
+		PixelBuffer data;
 		std::shared_ptr<SpriteArchive> archive;
 	};
 
-	void workerLoop(std::stop_token stop_token);
+	// Runs on a scheduler worker
+	void decode(Task task);
 
-	static constexpr unsigned int MIN_WORKER_THREADS = 2u;
-	static constexpr unsigned int MAX_WORKER_THREADS = 8u;
+	// Hands out a decode buffer, reusing one from a consumed result if possible.
+	// Both expect queue_mutex to be held.
+	PixelBuffer acquireBuffer();
+	void recycleBuffer(PixelBuffer buffer);
 
 	static constexpr size_t MAX_QUEUE_SIZE = 50000; // Limit pending tasks to prevent memory blowup
+	static constexpr size_t MAX_SPARE_BUFFERS = 1024;
 
 	std::mutex queue_mutex;
-	std::condition_variable cv;
 	bool stopping = false;
-	std::vector<std::jthread> workers;
+	size_t queued_tasks = 0; // Submitted to the scheduler, not decoded yet
 
-	std::queue<Task> task_queue;
 	std::queue<Result> result_queue;
 	std::unordered_set<PendingSpriteKey, PendingSpriteKeyHash> pending_ids; // To avoid duplicate tasks for the same archive/id/generation/epoch
 	uint64_t active_epoch = 0;
+	std::vector<PixelBuffer> spare_buffers;
+
+	// Declared last: its destructor waits for in-flight decodes, which still
+	// touch the members above.
+	TaskGroup tasks;
 };
 
 namespace rme {
@@ -3,7 +3,9 @@
 #include <algorithm>
 #include <spdlog/spdlog.h>
 
-TextureAtlas::TextureAtlas() = default;
+TextureAtlas::TextureAtlas(bool headless) :
+	headless_(headless) {
+}
 
 TextureAtlas::~TextureAtlas() {
 	release();
@@ -12,6 +14,7 @@ TextureAtlas::~TextureAtlas() {
 TextureAtlas::TextureAtlas(TextureAtlas&& other) noexcept
 	:
 	texture_id_(std::move(other.texture_id_)),
+	headless_(other.headless_),
 	layer_count_(other.layer_count_),
 	allocated_layers_(other.allocated_layers_),
 	total_sprite_count_(other.total_sprite_count_),
@@ -32,6 +35,7 @@ TextureAtlas& TextureAtlas::operator=(TextureAtlas&& other) noexcept {
 	if (this != &other) {
 		release();
 		texture_id_ = std::move(other.texture_id_);
+		headless_ = other.headless_;
 		layer_count_ = other.layer_count_;
 		allocated_layers_ = other.allocated_layers_;
 		total_sprite_count_ = other.total_sprite_count_;
@@ -52,7 +56,7 @@ TextureAtlas& TextureAtlas::operator=(TextureAtlas&& other) noexcept {
 }
 
 bool TextureAtlas::initialize(int initial_layers) {
-	if (texture_id_) {
+	if (isValid()) {
 		return true; // Already initialized
 	}
 
@@ -63,6 +67,16 @@ bool TextureAtlas::initialize(int initial_layers) {
 		initial_layers = MAX_LAYERS;
 	}
 
+	if (headless_) {
+		allocated_layers_ = initial_layers;
+		layer_count_ = 1;
+		current_layer_ = 0;
+		next_x_ = 0;
+		next_y_ = 0;
+		spdlog::info("TextureAtlas created without a texture: {}x{} x {} layers", ATLAS_SIZE, ATLAS_SIZE, initial_layers);
+		return true;
+	}
+
 	texture_id_ = std::make_unique<GLTextureResource>(GL_TEXTURE_2D_ARRAY);
 
 	// Set texture parameters
@@ -100,7 +114,10 @@ bool TextureAtlas::addLayer() {
 	}
 
 	// If we need more layers than allocated, reallocate
-	if (layer_count_ >= allocated_layers_) {
+	if (layer_count_ >= allocated_layers_ && headless_) {
+		// Nothing to copy without a texture
+		allocated_layers_ = std::min(allocated_layers_ + 4, MAX_LAYERS);
+	} else if (layer_count_ >= allocated_layers_) {
 		// Linear growth to prevent massive VRAM spikes
 		// 4 layers = ~268 MB VRAM
 		int new_allocated = std::min(allocated_layers_ + 4, MAX_LAYERS);
@@ -191,7 +208,7 @@ std::optional<AtlasRegion> TextureAtlas::addSprite(const uint8_t* rgba_data) {
 	}
 
 	// Upload sprite data to texture array
-	bool uploaded = false;
+	bool uploaded = headless_; // Headless atlases have nothing to upload to
 	if (pbo_) {
 		void* ptr = pbo_->mapWrite();
 		if (ptr) {
@@ -250,11 +267,15 @@ void TextureAtlas::freeSlot(const AtlasRegion& region) {
 }
 
 void TextureAtlas::bind(uint32_t slot) const {
-	glBindTextureUnit(slot, texture_id_->GetID());
+	if (texture_id_) {
+		glBindTextureUnit(slot, texture_id_->GetID());
+	}
 }
 
 void TextureAtlas::unbind(uint32_t slot) const {
-	glBindTextureUnit(slot, 0);
+	if (texture_id_) {
+		glBindTextureUnit(slot, 0);
+	}
 }
 
 void TextureAtlas::release() {
@@ -42,7 +42,11 @@ public:
 	static constexpr int SPRITES_PER_LAYER = SPRITES_PER_ROW * SPRITES_PER_ROW; // 16384
 	static constexpr int MAX_LAYERS = 64; // 64 * 16384 = 1M+ sprites
 
-	TextureAtlas();
+	/**
+	 * @param headless Allocate slots and UVs without any GL texture, for tools
+	 * that only need the sprite instances (e.g. benchmarks without a context).
+	 */
+	explicit TextureAtlas(bool headless = false);
 	~TextureAtlas();
 
 	// Non-copyable
@@ -101,7 +105,11 @@ public:
 	 * Check if atlas is valid.
 	 */
 	bool isValid() const {
-		return texture_id_ != nullptr;
+		return texture_id_ != nullptr || (headless_ && allocated_layers_ > 0);
+	}
+
+	bool isHeadless() const {
+		return headless_;
 	}
 
 	/**
@@ -116,6 +124,7 @@ private:
 	std::unique_ptr<PixelBufferObject> pbo_;
 
 	std::unique_ptr<GLTextureResource> texture_id_;
+	bool headless_ = false;
 	int layer_count_ = 0;
 	int allocated_layers_ = 0;
 	int total_sprite_count_ = 0;
@@ -81,6 +81,8 @@ void ItemDrawer::BlitItem(SpriteBatch& sprite_batch, SpriteDrawer* sprite_drawer
 	// Locked door indicator
 	if (!options.ingame && options.highlight_locked_doors && it.isDoor()) {
 		bool locked = item->isLocked();
+		// Indicators are collected per frame, outside the sprite batch
+		sprite_batch.markVolatile();
 
 		// Door orientation: horizontal wall -> West border (south=true), vertical wall -> North border (east=true)
 		if (static_cast<BorderType>(it.attribute(ItemAttributeKey::BorderAlignment)) == WALL_HORIZONTAL) {
@@ -197,6 +199,10 @@ void ItemDrawer::BlitItem(SpriteBatch& sprite_batch, SpriteDrawer* sprite_drawer
 	}
 
 	if (draw_visuals) {
+		if (spr->animator) {
+			sprite_batch.markVolatile();
+		}
+
 		// Atlas-only rendering
 		// g_gui.gfx.ensureAtlasManager();
 		// BatchRenderer::SetAtlasManager(g_gui.gfx.getAtlasManager());
@@ -221,6 +227,8 @@ void ItemDrawer::BlitItem(SpriteBatch& sprite_batch, SpriteDrawer* sprite_drawer
 				}
 #endif
 				sprite_drawer->glBlitAtlasQuad(sprite_batch, screenx, screeny, region, DrawColor(red, green, blue, alpha));
+			} else {
+				sprite_batch.markVolatile();
 			}
 		} else {
 			for (int cx = 0; cx != spr->width; cx++) {
@@ -229,6 +237,8 @@ void ItemDrawer::BlitItem(SpriteBatch& sprite_batch, SpriteDrawer* sprite_drawer
 						const AtlasRegion* region = spr->getAtlasRegion(cx, cy, cf, subtype, pattern_x, pattern_y, pattern_z, frame);
 						if (region) {
 							sprite_drawer->glBlitAtlasQuad(sprite_batch, screenx - cx * TILE_SIZE, screeny - cy * TILE_SIZE, region, DrawColor(red, green, blue, alpha));
+						} else {
+							sprite_batch.markVolatile();
 						}
 					}
 				}
@@ -266,6 +276,7 @@ void ItemDrawer::BlitItem(SpriteBatch& sprite_batch, SpriteDrawer* sprite_drawer
 
 	// draw wall hook
 	if (draw_visuals && !options.ingame && options.show_hooks && (it.hasFlag(ItemFlag::HookSouth) || it.hasFlag(ItemFlag::HookEast))) {
+		sprite_batch.markVolatile();
 		DrawHookIndicator(it, pos);
 	}
 
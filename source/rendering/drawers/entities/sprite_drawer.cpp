@@ -93,8 +93,10 @@ void SpriteDrawer::BlitSprite(SpriteBatch& sprite_batch, int screenx, int screen
 				const AtlasRegion* region = spr->getAtlasRegion(cx, cy, cf, -1, 0, 0, 0, tme);
 				if (region) {
 					glBlitAtlasQuad(sprite_batch, screenx - cx * TILE_SIZE, screeny - cy * TILE_SIZE, region, color);
+				} else {
+					// No fallback - if region is null, sprite failed to load (or is still loading)
+					sprite_batch.markVolatile();
 				}
-				// No fallback - if region is null, sprite failed to load
 			}
 		}
 	}
@@ -32,8 +32,54 @@
 #include "rendering/core/sprite_preloader.h"
 
 #include <cmath>
+#include <iterator>
 #include <limits>
 
+namespace {
+	// Everything besides the tiles themselves that changes what DrawTile emits
+	// for a node. Positions are excluded: recordings are node-relative.
+	uint64_t hashTileOptions(const DrawingOptions& options, const RenderView& view) {
+		const bool flags[] = {
+			options.transparent_floors,
+			options.transparent_items,
+			options.show_light_str,
+			options.show_tech_items,
+			options.show_invalid_tiles,
+			options.show_invalid_zones,
+			options.show_waypoints,
+			options.ingame,
+			options.show_creatures,
+			options.show_spawns,
+			options.show_houses,
+			options.show_special_tiles,
+			options.show_items,
+			options.highlight_items,
+			options.highlight_locked_doors,
+			options.show_blocking,
+			options.show_as_minimap,
+			options.show_only_colors,
+			options.show_only_modified,
+			options.show_hooks,
+			options.hide_items_when_zoomed,
+			options.show_towns,
+			options.always_show_zones,
+			options.extended_house_shader,
+			view.zoom < 10.0,
+		};
+
+		static_assert(std::size(flags) <= 27, "flags, floor and house id must pack into 64 bits");
+
+		// Packed rather than mixed, so two option sets never share recordings.
+		uint64_t hash = 0;
+		for (bool flag : flags) {
+			hash = (hash << 1) | static_cast<uint64_t>(flag);
+		}
+		hash |= static_cast<uint64_t>(view.floor & 0x1F) << 27;
+		hash |= static_cast<uint64_t>(options.current_house_id) << 32;
+		return hash;
+	}
+}
+
 MapLayerDrawer::MapLayerDrawer(TileRenderer* tile_renderer, GridDrawer* grid_drawer, Editor* editor) :
 	tile_renderer(tile_renderer),
 	grid_drawer(grid_drawer),
@@ -43,6 +89,10 @@ MapLayerDrawer::MapLayerDrawer(TileRenderer* tile_renderer, GridDrawer* grid_dra
 MapLayerDrawer::~MapLayerDrawer() {
 }
 
+void MapLayerDrawer::BeginFrame(const AtlasManager& atlas_manager) {
+	render_cache.beginFrame(atlas_manager);
+}
+
 void MapLayerDrawer::Draw(SpriteBatch& sprite_batch, int map_z, bool live_client, const RenderView& view, const DrawingOptions& options, LightBuffer& light_buffer, bool light_collection_only) {
 	// Optimization: Pre-calculate offset and base coordinates
 	// IsTileVisible does this for every tile, but it's constant per layer/frame.
@@ -168,5 +218,44 @@ void MapLayerDrawer::Draw(SpriteBatch& sprite_batch, int map_z, bool live_client
 		tile_renderer->DrawTile(sprite_batch, location, view, options, options.current_house_id, draw_x, draw_y, draw_lights ? &light_buffer : nullptr, light_collection_only);
 	};
 
-	visitAllVisibleNodes(drawVisibleTiles);
+	// Recorded nodes can't feed lights, tooltips or live-node requests, and the
+	// box selection preview changes every frame while dragging.
+	const bool use_render_cache = render_cache_enabled && !live_client && !light_collection_only && !draw_lights && !options.show_tooltips && !options.transient_selection_bounds;
+	if (!use_render_cache) {
+		visitAllVisibleNodes(drawVisibleTiles);
+		return;
+	}
+
+	const uint64_t options_hash = hashTileOptions(options, view);
+	editor->map.visitLeaves(nd_start_x - visibility_margin_tiles, nd_start_y - visibility_margin_tiles, nd_end_x + visibility_margin_tiles, nd_end_y + visibility_margin_tiles, [&](MapNode* nd, int nd_map_x, int nd_map_y) {
+		const int node_draw_x = nd_map_x * TILE_SIZE + base_screen_x;
+		const int node_draw_y = nd_map_y * TILE_SIZE + base_screen_y;
+		if (!view.IsRectVisible(node_draw_x, node_draw_y, 4 * TILE_SIZE, 4 * TILE_SIZE, visibility_margin_pixels)) {
+			return;
+		}
+
+		const Floor* floor = nd->getFloor(map_z);
+		if (!floor) {
+			return;
+		}
+
+		switch (render_cache.beginNode(sprite_batch, floor, nd_map_x, nd_map_y, map_z, options_hash, node_draw_x, node_draw_y)) {
+			case MapRenderCache::NodeAction::Replayed:
+				break;
+			case MapRenderCache::NodeAction::DrawLive:
+				visitNodeTiles(nd, nd_map_x, nd_map_y, false, drawVisibleTiles);
+				break;
+			case MapRenderCache::NodeAction::Record: {
+				// Record all 16 tiles so the node can be replayed wherever it is on screen
+				const TileLocation* location = floor->locs.data();
+				for (int map_x = 0; map_x < 4; ++map_x) {
+					for (int map_y = 0; map_y < 4; ++map_y, ++location) {
+						drawVisibleTiles(location, node_draw_x + map_x * TILE_SIZE, node_draw_y + map_y * TILE_SIZE);
+					}
+				}
+				render_cache.endNode(sprite_batch);
+				break;
+			}
+		}
+	});
 }
@@ -20,6 +20,8 @@
 
 #include <iosfwd>
 
+#include "rendering/drawers/map_render_cache.h"
+
 class Editor;
 class TileRenderer;
 class GridDrawer;
@@ -28,18 +30,30 @@ struct DrawingOptions;
 struct LightBuffer;
 class SpriteBatch;
 class PrimitiveRenderer;
+class AtlasManager;
 
 class MapLayerDrawer {
 public:
 	MapLayerDrawer(TileRenderer* tile_renderer, GridDrawer* grid_drawer, Editor* editor);
 	~MapLayerDrawer();
 
+	void BeginFrame(const AtlasManager& atlas_manager);
 	void Draw(SpriteBatch& sprite_batch, int map_z, bool live_client, const RenderView& view, const DrawingOptions& options, LightBuffer& light_buffer, bool light_collection_only = false);
 
+	const MapRenderCache& GetRenderCache() const {
+		return render_cache;
+	}
+	// Draw every node live; for comparisons (e.g. the render benchmark)
+	void SetRenderCacheEnabled(bool enabled) {
+		render_cache_enabled = enabled;
+	}
+
 private:
 	TileRenderer* tile_renderer;
 	GridDrawer* grid_drawer;
 	Editor* editor;
+	MapRenderCache render_cache;
+	bool render_cache_enabled = true;
 };
 
 #endif
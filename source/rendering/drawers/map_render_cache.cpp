@@ -0,0 +1,207 @@
+#include "app/main.h"
+
+#include "rendering/drawers/map_render_cache.h"
+
+#include "map/map_region.h"
+#include "rendering/core/atlas_manager.h"
+#include "rendering/core/sprite_batch.h"
+
+#include <algorithm>
+
+namespace {
+	// Compaction threshold: rewrite a cell's instance list once stale ranges
+	// from re-recorded nodes outweigh the live ones.
+	constexpr size_t MIN_GARBAGE_INSTANCES = 4096;
+}
+
+size_t MapRenderCache::KeyHash::operator()(const Key& key) const noexcept {
+	uint64_t h = key.cell * 0x9E3779B97F4A7C15ull;
+	h ^= key.options_hash + 0x7F4A7C159E3779B9ull + (h << 6) + (h >> 2);
+	h ^= static_cast<uint64_t>(key.z) + (h << 6) + (h >> 2);
+	return static_cast<size_t>(h);
+}
+
+size_t MapRenderCache::CellEntry::bytes() const {
+	return sizeof(CellEntry) + instances.capacity() * sizeof(SpriteInstance);
+}
+
+void MapRenderCache::CellEntry::compact() {
+	std::vector<SpriteInstance> packed;
+	packed.reserve(used_instances);
+	for (NodeSlot& slot : slots) {
+		if (slot.state != SlotState::Cached) {
+			continue;
+		}
+		const uint32_t offset = static_cast<uint32_t>(packed.size());
+		packed.insert(packed.end(), instances.begin() + slot.offset, instances.begin() + slot.offset + slot.count);
+		slot.offset = offset;
+	}
+	instances = std::move(packed);
+}
+
+MapRenderCache::MapRenderCache() = default;
+
+MapRenderCache::~MapRenderCache() = default;
+
+void MapRenderCache::clear() {
+	cells_.clear();
+	last_cell_ = nullptr;
+	recording_cell_ = nullptr;
+	recording_slot_ = nullptr;
+}
+
+void MapRenderCache::beginFrame(const AtlasManager& atlas) {
+	ASSERT(!recording_slot_);
+
+	// Recorded UVs point into atlas slots; once a slot may have been handed to
+	// another sprite every recording is suspect.
+	if (atlas_ != &atlas || atlas_generation_ != atlas.getGeneration()) {
+		clear();
+		atlas_ = &atlas;
+		atlas_generation_ = atlas.getGeneration();
+	}
+
+	++frame_;
+	frame_stamp_ = 0;
+	stats_ = Statistics {};
+	trimToBudget();
+}
+
+void MapRenderCache::trimToBudget() {
+	size_t total = 0;
+	for (const auto& [key, cell] : cells_) {
+		total += cell->bytes();
+	}
+
+	if (total > MemoryBudget) {
+		// Oldest first; whatever was drawn last frame stays.
+		std::vector<std::pair<uint64_t, Key>> candidates;
+		for (const auto& [key, cell] : cells_) {
+			if (cell->last_used_frame + 1 < frame_) {
+				candidates.emplace_back(cell->last_used_frame, key);
+			}
+		}
+		std::ranges::sort(candidates, {}, &std::pair<uint64_t, Key>::first);
+
+		for (const auto& [last_used, key] : candidates) {
+			if (total <= MemoryBudget) {
+				break;
+			}
+			auto it = cells_.find(key);
+			total -= it->second->bytes();
+			cells_.erase(it);
+		}
+		last_cell_ = nullptr;
+	}
+
+	stats_.cells = cells_.size();
+	stats_.bytes = total;
+}
+
+MapRenderCache::CellEntry& MapRenderCache::findCell(int nd_map_x, int nd_map_y, int map_z, uint64_t options_hash) {
+	const Key key {
+		.cell = (static_cast<uint64_t>(static_cast<uint32_t>(nd_map_y >> 6)) << 32) | static_cast<uint32_t>(nd_map_x >> 6),
+		.options_hash = options_hash,
+		.z = map_z,
+	};
+	if (last_cell_ && last_key_ == key) {
+		return *last_cell_;
+	}
+
+	auto& cell = cells_[key];
+	if (!cell) {
+		cell = std::make_unique<CellEntry>();
+	}
+	last_key_ = key;
+	last_cell_ = cell.get();
+	return *cell;
+}
+
+MapRenderCache::NodeAction MapRenderCache::beginNode(SpriteBatch& sprite_batch, const Floor* floor, int nd_map_x, int nd_map_y, int map_z, uint64_t options_hash, int draw_x, int draw_y) {
+	ASSERT(!recording_slot_);
+
+	CellEntry& cell = findCell(nd_map_x, nd_map_y, map_z, options_hash);
+	cell.last_used_frame = frame_;
+
+	const int local_x = (nd_map_x & 63) >> 2;
+	const int local_y = (nd_map_y & 63) >> 2;
+	NodeSlot& slot = cell.slots[local_y * NodesPerCell + local_x];
+
+	bool current = slot.state != SlotState::Empty && slot.floor == floor;
+	if (current) {
+		current = std::ranges::none_of(floor->locs, [stamp = slot.stamp](const TileLocation& location) {
+			return location.getRevision() >= stamp;
+		});
+	}
+
+	if (current && slot.state == SlotState::Cached) {
+		sprite_batch.drawInstances({ cell.instances.data() + slot.offset, slot.count }, static_cast<float>(draw_x), static_cast<float>(draw_y));
+		++stats_.nodes_replayed;
+		stats_.instances_replayed += slot.count;
+		return NodeAction::Replayed;
+	}
+	if (current && slot.state == SlotState::Volatile && frame_ < slot.retry_frame) {
+		++stats_.nodes_live;
+		return NodeAction::DrawLive;
+	}
+
+	// Every touch from here on stamps a revision >= frame_stamp_, which makes
+	// this recording stale.
+	if (frame_stamp_ == 0) {
+		frame_stamp_ = TileLocation::advanceRevision();
+	}
+
+	if (slot.state == SlotState::Cached) {
+		cell.used_instances -= slot.count;
+	}
+	slot.floor = floor;
+	slot.stamp = frame_stamp_;
+	slot.state = SlotState::Empty;
+	slot.count = 0;
+
+	recording_cell_ = &cell;
+	recording_slot_ = &slot;
+	recording_x_ = draw_x;
+	recording_y_ = draw_y;
+
+	scratch_.clear();
+	sprite_batch.beginCapture(scratch_);
+	return NodeAction::Record;
+}
+
+void MapRenderCache::endNode(SpriteBatch& sprite_batch) {
+	ASSERT(recording_slot_);
+
+	const bool stable = sprite_batch.endCapture();
+	CellEntry& cell = *recording_cell_;
+	NodeSlot& slot = *recording_slot_;
+	recording_cell_ = nullptr;
+	recording_slot_ = nullptr;
+
+	if (stable) {
+		const float dx = static_cast<float>(recording_x_);
+		const float dy = static_cast<float>(recording_y_);
+
+		slot.state = SlotState::Cached;
+		slot.offset = static_cast<uint32_t>(cell.instances.size());
+		slot.count = static_cast<uint32_t>(scratch_.size());
+		for (SpriteInstance instance : scratch_) {
+			instance.x -= dx;
+			instance.y -= dy;
+			cell.instances.push_back(instance);
+		}
+		cell.used_instances += slot.count;
+
+		if (cell.instances.size() > cell.used_instances * 2 + MIN_GARBAGE_INSTANCES) {
+			cell.compact();
+		}
+	} else {
+		slot.state = SlotState::Volatile;
+		slot.retry_frame = frame_ + VolatileRetryFrames;
+	}
+
+	// The recording itself is this frame's output for the node.
+	sprite_batch.drawInstances(scratch_, 0.0f, 0.0f);
+	++stats_.nodes_recorded;
+	stats_.instances_recorded += scratch_.size();
+}
@@ -0,0 +1,132 @@
+#ifndef RME_RENDERING_DRAWERS_MAP_RENDER_CACHE_H_
+#define RME_RENDERING_DRAWERS_MAP_RENDER_CACHE_H_
+
+#include "rendering/core/sprite_instance.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class AtlasManager;
+class Floor;
+class SpriteBatch;
+
+// Recorded sprite instances for the map layer drawer, so a static view does
+// not re-run TileRenderer::DrawTile for every tile on every frame.
+//
+// Entries are keyed by (64x64 grid cell, floor, options hash) and hold one
+// instance range per 4x4 map node, stored relative to the node origin so the
+// same recording is valid at any scroll position. A node's recording is
+// current while none of its TileLocations was touched since it was made
+// (see TileLocation::touch). Nodes whose output depends on the frame
+// (animations, creatures, sprites still loading, pulses, side-channel
+// overlays) mark themselves volatile while recording and are drawn live.
+class MapRenderCache {
+public:
+	static constexpr size_t MemoryBudget = 64 * 1024 * 1024;
+	// Volatile nodes are re-recorded this often in case they settled (e.g. finished loading).
+	static constexpr uint64_t VolatileRetryFrames = 64;
+
+	enum class NodeAction {
+		Replayed, // Instances were queued, nothing else to do
+		Record, // Draw the whole node (no per-tile culling), then call endNode()
+		DrawLive, // Draw the node normally
+	};
+
+	struct Statistics {
+		uint64_t nodes_replayed = 0;
+		uint64_t nodes_recorded = 0;
+		uint64_t nodes_live = 0;
+		uint64_t instances_replayed = 0;
+		uint64_t instances_recorded = 0;
+		size_t cells = 0;
+		size_t bytes = 0;
+	};
+
+	MapRenderCache();
+	~MapRenderCache();
+
+	MapRenderCache(const MapRenderCache&) = delete;
+	MapRenderCache& operator=(const MapRenderCache&) = delete;
+
+	// Starts a frame: drops every recording if the atlas moved sprites around
+	// and trims entries that were not used recently when over budget.
+	void beginFrame(const AtlasManager& atlas);
+	void clear();
+
+	NodeAction beginNode(SpriteBatch& sprite_batch, const Floor* floor, int nd_map_x, int nd_map_y, int map_z, uint64_t options_hash, int draw_x, int draw_y);
+	void endNode(SpriteBatch& sprite_batch);
+
+	// Counters for the current (or last finished) frame.
+	const Statistics& getStatistics() const {
+		return stats_;
+	}
+
+private:
+	enum class SlotState : uint8_t {
+		Empty,
+		Cached,
+		Volatile,
+	};
+
+	struct NodeSlot {
+		const Floor* floor = nullptr;
+		uint32_t stamp = 0;
+		uint32_t offset = 0;
+		uint32_t count = 0;
+		SlotState state = SlotState::Empty;
+		uint64_t retry_frame = 0;
+	};
+
+	static constexpr int NodesPerCellShift = 4;
+	static constexpr int NodesPerCell = 1 << NodesPerCellShift;
+
+	struct CellEntry {
+		std::vector<SpriteInstance> instances;
+		size_t used_instances = 0; // Instances still referenced by a slot
+		std::array<NodeSlot, NodesPerCell * NodesPerCell> slots;
+		uint64_t last_used_frame = 0;
+
+		size_t bytes() const;
+		void compact();
+	};
+
+	struct Key {
+		uint64_t cell;
+		uint64_t options_hash;
+		int z;
+
+		bool operator==(const Key&) const = default;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const noexcept;
+	};
+
+	CellEntry& findCell(int nd_map_x, int nd_map_y, int map_z, uint64_t options_hash);
+	void trimToBudget();
+
+	std::unordered_map<Key, std::unique_ptr<CellEntry>, KeyHash> cells_;
+	std::vector<SpriteInstance> scratch_;
+
+	// Single-entry lookup memo; nodes arrive row by row, 16 per cell.
+	Key last_key_ {};
+	CellEntry* last_cell_ = nullptr;
+
+	// Node being recorded between beginNode() and endNode()
+	CellEntry* recording_cell_ = nullptr;
+	NodeSlot* recording_slot_ = nullptr;
+	int recording_x_ = 0;
+	int recording_y_ = 0;
+
+	const AtlasManager* atlas_ = nullptr;
+	uint64_t atlas_generation_ = 0;
+	uint64_t frame_ = 0;
+	uint32_t frame_stamp_ = 0; // Lazily taken from TileLocation::advanceRevision()
+	Statistics stats_;
+};
+
+#endif
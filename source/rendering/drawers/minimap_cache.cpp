@@ -5,8 +5,10 @@
 #include "map/map.h"
 #include "map/map_region.h"
 #include "map/tile.h"
+#include "app/task_scheduler.h"
 
 #include <algorithm>
+#include <cstring>
 
 uint64_t MinimapCache::makePageKey(int page_x, int page_y) {
 	return (static_cast<uint64_t>(page_y) << 32) | static_cast<uint32_t>(page_x);
@@ -38,7 +40,17 @@ void MinimapCache::bindMap(uint64_t map_generation, int width, int height) {
 }
 
 void MinimapCache::invalidateAll() {
-	releaseGL();
+	// Pages keep their textures so the old image stays up while they are redone.
+	for (auto& floor_cache : floors_) {
+		for (auto& [key, page] : floor_cache.pages) {
+			page.dirty_rect = MinimapDirtyRect {
+				.x = 0,
+				.y = 0,
+				.width = PageSize,
+				.height = PageSize,
+			};
+		}
+	}
 }
 
 void MinimapCache::markDirty(int floor, const MinimapDirtyRect& rect) {
@@ -114,22 +126,13 @@ void MinimapCache::ensurePageTexture(FloorCachePage& page) {
 	glTextureParameteri(page.texture->GetID(), GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 }
 
-void MinimapCache::uploadRect(const Map& map, int floor, FloorCachePage& page, const MinimapDirtyRect& rect) {
-	ensurePageTexture(page);
-
-	const MinimapDirtyRect clamped_rect = clampRect(rect, PageSize, PageSize);
-	if (!IsValidMinimapRect(clamped_rect)) {
-		return;
-	}
-
-	const size_t buffer_size = static_cast<size_t>(clamped_rect.width) * clamped_rect.height;
-	upload_buffer_.resize(buffer_size);
-	std::fill(upload_buffer_.begin(), upload_buffer_.end(), 0);
+void MinimapCache::rasterize(const Map& map, int floor, const FloorCachePage& page, const MinimapDirtyRect& rect, std::vector<uint8_t>& pixels) {
+	pixels.assign(static_cast<size_t>(rect.width) * rect.height, 0);
 
-	const int origin_x = page.page_x * PageSize + clamped_rect.x;
-	const int origin_y = page.page_y * PageSize + clamped_rect.y;
-	const int rect_end_x = origin_x + clamped_rect.width - 1;
-	const int rect_end_y = origin_y + clamped_rect.height - 1;
+	const int origin_x = page.page_x * PageSize + rect.x;
+	const int origin_y = page.page_y * PageSize + rect.y;
+	const int rect_end_x = origin_x + rect.width - 1;
+	const int rect_end_y = origin_y + rect.height - 1;
 	map.visitLeaves(origin_x, origin_y, rect_end_x, rect_end_y, [&](const MapNode* node, int node_map_x, int node_map_y) {
 		const Floor* node_floor = node->getFloor(floor);
 		if (!node_floor) {
@@ -157,33 +160,60 @@ void MinimapCache::uploadRect(const Map& map, int floor, FloorCachePage& page, c
 
 				const int buffer_x = map_x - origin_x;
 				const int buffer_y = map_y - origin_y;
-				upload_buffer_[static_cast<size_t>(buffer_y) * clamped_rect.width + buffer_x] = tile->getMiniMapColor();
+				pixels[static_cast<size_t>(buffer_y) * rect.width + buffer_x] = tile->getMiniMapColor();
 			}
 		}
 	});
+}
+
+void MinimapCache::upload(const RasterJob& job) {
+	FloorCachePage& page = *job.page;
+	ensurePageTexture(page);
+
+	if (!pbo_) {
+		pbo_ = std::make_unique<PixelBufferObject>();
+		pbo_->initialize(static_cast<size_t>(PageSize) * PageSize);
+	}
+
+	// Staged through the PBO so the copy into the texture happens on the GPU
+	// timeline; a page that cannot be mapped goes up from client memory.
+	const void* source = job.pixels.data();
+	void* mapped = pbo_->mapWrite();
+	if (mapped) {
+		memcpy(mapped, job.pixels.data(), job.pixels.size());
+		pbo_->unmap();
+		pbo_->bind();
+		source = nullptr; // Offset into the bound PBO
+	}
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glTextureSubImage2D(
 		page.texture->GetID(),
 		0,
-		clamped_rect.x,
-		clamped_rect.y,
-		clamped_rect.width,
-		clamped_rect.height,
+		job.rect.x,
+		job.rect.y,
+		job.rect.width,
+		job.rect.height,
 		GL_RED_INTEGER,
 		GL_UNSIGNED_BYTE,
-		upload_buffer_.data());
+		source);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if (mapped) {
+		pbo_->unbind();
+		pbo_->advance();
+	}
+	page.has_content = true;
 }
 
-void MinimapCache::flushVisible(const Map& map, int floor, const MinimapDirtyRect& visible_rect) {
+bool MinimapCache::flushVisible(const Map& map, int floor, const MinimapDirtyRect& visible_rect, size_t max_pages) {
 	if (floor < 0 || floor >= MAP_LAYERS || width_ <= 0 || height_ <= 0) {
-		return;
+		return true;
 	}
 
 	const MinimapDirtyRect clamped_visible = clampRect(visible_rect, width_, height_);
 	if (!IsValidMinimapRect(clamped_visible)) {
-		return;
+		return true;
 	}
 
 	const int start_page_x = clamped_visible.x / PageSize;
@@ -191,6 +221,8 @@ void MinimapCache::flushVisible(const Map& map, int floor, const MinimapDirtyRec
 	const int start_page_y = clamped_visible.y / PageSize;
 	const int end_page_y = (clamped_visible.y + clamped_visible.height - 1) / PageSize;
 
+	size_t job_count = 0;
+	bool complete = true;
 	for (int page_y = start_page_y; page_y <= end_page_y; ++page_y) {
 		for (int page_x = start_page_x; page_x <= end_page_x; ++page_x) {
 			auto& page = getOrCreatePage(floor, page_x, page_y);
@@ -198,10 +230,47 @@ void MinimapCache::flushVisible(const Map& map, int floor, const MinimapDirtyRec
 				continue;
 			}
 
-			uploadRect(map, floor, page, *page.dirty_rect);
+			const MinimapDirtyRect rect = clampRect(*page.dirty_rect, PageSize, PageSize);
+			if (!IsValidMinimapRect(rect)) {
+				page.dirty_rect.reset();
+				continue;
+			}
+			if (max_pages != 0 && job_count == max_pages) {
+				complete = false;
+				continue;
+			}
+
+			if (jobs_.size() == job_count) {
+				jobs_.emplace_back();
+			}
+			jobs_[job_count].page = &page;
+			jobs_[job_count].rect = rect;
 			page.dirty_rect.reset();
+			++job_count;
+		}
+	}
+
+	if (job_count == 0) {
+		return complete;
+	}
+
+	// Pages are independent, one task each. The map is not touched by the UI
+	// thread while we wait, so the workers can read it without locking.
+	{
+		TaskGroup tasks(g_scheduler);
+		for (size_t i = 0; i < job_count; ++i) {
+			RasterJob& job = jobs_[i];
+			tasks.run([&map, floor, &job]() {
+				rasterize(map, floor, *job.page, job.rect, job.pixels);
+			});
 		}
+		tasks.wait();
 	}
+
+	for (size_t i = 0; i < job_count; ++i) {
+		upload(jobs_[i]);
+	}
+	return complete;
 }
 
 std::vector<MinimapCache::VisiblePage> MinimapCache::collectVisiblePages(int floor, const MinimapDirtyRect& visible_rect) {
@@ -223,7 +292,9 @@ std::vector<MinimapCache::VisiblePage> MinimapCache::collectVisiblePages(int flo
 	for (int page_y = start_page_y; page_y <= end_page_y; ++page_y) {
 		for (int page_x = start_page_x; page_x <= end_page_x; ++page_x) {
 			auto& page = getOrCreatePage(floor, page_x, page_y);
-			ensurePageTexture(page);
+			if (!page.has_content) {
+				continue;
+			}
 			visible_pages.push_back({
 				.texture_id = page.texture->GetID(),
 				.page_x = page_x,
@@ -239,5 +310,6 @@ void MinimapCache::releaseGL() {
 	for (auto& floor_cache : floors_) {
 		floor_cache.pages.clear();
 	}
-	upload_buffer_.clear();
+	jobs_.clear();
+	pbo_.reset();
 }
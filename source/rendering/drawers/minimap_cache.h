@@ -3,6 +3,7 @@
 
 #include "app/definitions.h"
 #include "rendering/core/gl_resources.h"
+#include "rendering/core/pixel_buffer_object.h"
 #include "rendering/drawers/minimap_rect.h"
 
 #include <array>
@@ -10,6 +11,7 @@
 #include <memory>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 class Map;
 
@@ -18,6 +20,7 @@ struct FloorCachePage {
 	int page_y = 0;
 	std::unique_ptr<GLTextureResource> texture;
 	std::optional<MinimapDirtyRect> dirty_rect;
+	bool has_content = false; // Rasterized at least once; until then it is not drawn
 };
 
 class MinimapCache {
@@ -33,7 +36,11 @@ public:
 	void bindMap(uint64_t map_generation, int width, int height);
 	void invalidateAll();
 	void markDirty(int floor, const MinimapDirtyRect& rect);
-	void flushVisible(const Map& map, int floor, const MinimapDirtyRect& visible_rect);
+	// Rasterizes the dirty visible pages of a floor on the task scheduler's
+	// workers and uploads them once all are done. At most max_pages pages are
+	// rebuilt per call (0 for no limit); the others keep showing what they
+	// had. Returns false while dirty visible pages are left.
+	bool flushVisible(const Map& map, int floor, const MinimapDirtyRect& visible_rect, size_t max_pages);
 	std::vector<VisiblePage> collectVisiblePages(int floor, const MinimapDirtyRect& visible_rect);
 	void releaseGL();
 
@@ -55,10 +62,20 @@ private:
 
 	FloorCachePage& getOrCreatePage(int floor, int page_x, int page_y);
 	void ensurePageTexture(FloorCachePage& page);
-	void uploadRect(const Map& map, int floor, FloorCachePage& page, const MinimapDirtyRect& rect);
+
+	struct RasterJob {
+		FloorCachePage* page = nullptr;
+		MinimapDirtyRect rect; // Page-local
+		std::vector<uint8_t> pixels;
+	};
+
+	// Worker side; reads the map but no GL or cache state.
+	static void rasterize(const Map& map, int floor, const FloorCachePage& page, const MinimapDirtyRect& rect, std::vector<uint8_t>& pixels);
+	void upload(const RasterJob& job);
 
 	std::array<FloorCache, MAP_LAYERS> floors_;
-	std::vector<uint8_t> upload_buffer_;
+	std::vector<RasterJob> jobs_; // Kept between calls to reuse the pixel buffers
+	std::unique_ptr<PixelBufferObject> pbo_;
 	uint64_t map_generation_ = 0;
 	int width_ = 0;
 	int height_ = 0;
@@ -9,6 +9,7 @@
 #include "rendering/ui/map_display.h"
 #include "ui/gui.h"
 #include "ui/managers/minimap_manager.h"
+#include "app/task_scheduler.h"
 
 #include <algorithm>
 #include <cmath>
@@ -147,6 +148,7 @@ void MinimapDrawer::DrawMapBoundsBorder(const glm::mat4& projection, const wxSiz
 }
 
 void MinimapDrawer::Draw(const wxSize& size, Editor& editor, MapCanvas& canvas, const MinimapViewportState& viewport_state, MinimapDrawOptions options) {
+	pages_pending_ = false;
 	const int window_width = size.GetWidth();
 	const int window_height = size.GetHeight();
 	if (window_width <= 0 || window_height <= 0) {
@@ -194,9 +196,17 @@ void MinimapDrawer::Draw(const wxSize& size, Editor& editor, MapCanvas& canvas,
 	if (pending.invalidate_all) {
 		renderer->invalidateAll();
 	}
-	for (int floor = 0; floor < MAP_LAYERS; ++floor) {
-		if (pending.floor_rects[floor].has_value()) {
-			renderer->markDirty(floor, *pending.floor_rects[floor]);
+	for (const DirtyList::Rect& rect : pending.nodes.GetRects()) {
+		const MinimapDirtyRect dirty_rect = {
+			.x = rect.x,
+			.y = rect.y,
+			.width = rect.width,
+			.height = rect.height,
+		};
+		for (int floor = 0; floor < MAP_LAYERS; ++floor) {
+			if (rect.floors & (1u << floor)) {
+				renderer->markDirty(floor, dirty_rect);
+			}
 		}
 	}
 
@@ -212,13 +222,18 @@ void MinimapDrawer::Draw(const wxSize& size, Editor& editor, MapCanvas& canvas,
 		.height = std::max(1, static_cast<int>(std::ceil(visible_rect.start_y + visible_rect.height)) - static_cast<int>(std::floor(visible_rect.start_y))),
 	};
 
+	// One page per worker keeps a frame at roughly the cost of rasterizing a
+	// single page, however much of the map just became dirty.
+	const size_t page_budget = options.rasterizeAllPages ? 0 : static_cast<size_t>(std::max(1, g_scheduler.getWorkerCount()));
 	const int last_render_floor = floor_range.draw_all_visited_floors ? floor_range.end_floor : floor_range.current_floor;
 	for (int floor = floor_range.start_floor; floor >= last_render_floor; --floor) {
 		if (floor == floor_range.current_floor && floor_range.start_floor > floor_range.current_floor) {
 			DrawFloorShade(projection, size);
 		}
 
-		renderer->flushVisible(editor.map, floor, visible_rect_pixels);
+		if (!renderer->flushVisible(editor.map, floor, visible_rect_pixels, page_budget)) {
+			pages_pending_ = true;
+		}
 		renderer->renderVisible(projection, 0, 0, window_width, window_height, floor, visible_rect_pixels);
 	}
 	if (options.drawBoundsBorder) {
@@ -17,6 +17,7 @@ class PrimitiveRenderer;
 struct MinimapDrawOptions {
 	bool drawCameraBox = true;
 	bool drawBoundsBorder = true;
+	bool rasterizeAllPages = false; // Otherwise a few dirty pages per frame
 };
 
 class MinimapDrawer {
@@ -29,6 +30,11 @@ public:
 
 	void ScreenToMap(int screen_x, int screen_y, int& map_x, int& map_y);
 
+	// Visible pages were left dirty by the last Draw and need another frame.
+	bool HasPendingPages() const {
+		return pages_pending_;
+	}
+
 private:
 	struct LastViewportMetrics {
 		double start_x = 0.0;
@@ -58,6 +64,7 @@ private:
 	std::unique_ptr<PrimitiveRenderer> primitive_renderer;
 	LastViewportMetrics last_viewport_;
 	bool initialized_ = false;
+	bool pages_pending_ = false;
 };
 
 #endif
@@ -79,8 +79,8 @@ void MinimapRenderer::markDirty(int floor, const MinimapDirtyRect& rect) {
 	cache_.markDirty(floor, rect);
 }
 
-void MinimapRenderer::flushVisible(const Map& map, int floor, const MinimapDirtyRect& visible_rect) {
-	cache_.flushVisible(map, floor, visible_rect);
+bool MinimapRenderer::flushVisible(const Map& map, int floor, const MinimapDirtyRect& visible_rect, size_t max_pages) {
+	return cache_.flushVisible(map, floor, visible_rect, max_pages);
 }
 
 void MinimapRenderer::renderVisible(const glm::mat4& projection, int x, int y, int w, int h, int floor, const MinimapDirtyRect& visible_rect) {
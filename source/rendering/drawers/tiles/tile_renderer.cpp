@@ -408,6 +408,8 @@ void TileRenderer::DrawTile(SpriteBatch& sprite_batch, const TileLocation* locat
 		uint8_t hr, hg, hb;
 		TileColorCalculator::GetHouseColor(tile->getHouseID(), hr, hg, hb);
 
+		// Pulses with highlight_pulse
+		sprite_batch.markVolatile();
 		float intensity = 0.5f + (0.5f * options.highlight_pulse);
 		// Optimization: Use integer math for border color to avoid vec4 construction and casting
 		int ba = static_cast<int>(intensity * 255.0f);
@@ -427,6 +429,7 @@ void TileRenderer::DrawTile(SpriteBatch& sprite_batch, const TileLocation* locat
 				TileColorCalculator::GetHouseColor(tile->getHouseID(), house_r, house_g, house_b);
 				if (should_pulse) {
 					boost = options.highlight_pulse * 0.6f;
+					sprite_batch.markVolatile();
 				}
 			}
 
@@ -305,6 +305,7 @@ void MapDrawer::Draw() {
 		return;
 	}
 	auto* atlas = g_gui.gfx.getAtlasManager();
+	map_layer_drawer->BeginFrame(*atlas);
 
 	// Begin Batches
 	sprite_batch->begin(view.projectionMatrix, *atlas);
@@ -477,6 +477,7 @@ bool MinimapCanvas::SaveCleanScreenshot(const wxFileName& file) {
 	drawer->Draw(size, *editor, *active_canvas, *state, {
 		.drawCameraBox = false,
 		.drawBoundsBorder = false,
+		.rasterizeAllPages = true,
 	});
 
 	std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * PixelFormatRGB);
@@ -535,6 +536,10 @@ void MinimapCanvas::OnPaint(wxPaintEvent& event) {
 	ClampViewportState(*state);
 	drawer->Draw(GetClientSize(), *editor, *active_canvas, *state);
 	SwapBuffers();
+
+	if (drawer->HasPendingPages()) {
+		CallAfter([this]() { Refresh(); });
+	}
 }
 
 void MinimapCanvas::OnDelayedUpdate(wxTimerEvent& event) {
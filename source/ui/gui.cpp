@@ -77,7 +77,7 @@ void emitBrushChangeIfNeeded(GUI& gui) {
 		lastBrush = currentBrush;
 		lastBrushName = currentName;
 		if (g_luaScripts.isInitialized()) {
-			g_luaScripts.emit("brushChange", currentName);
+			g_luaScripts.emit(LuaScriptManager::EVENT_BRUSH_CHANGE, currentName);
 		}
 	}
 }
@@ -24,6 +24,11 @@ LoadingManager::~LoadingManager() {
 }
 
 void LoadingManager::CreateLoadBar(wxString message, bool canCancel) {
+	// Console tools (e.g. the benchmarks) load data without any window to show a dialog on
+	if (!wxTheApp || !wxTheApp->IsGUI()) {
+		return;
+	}
+
 	progressText = message;
 
 	progressFrom = 0;
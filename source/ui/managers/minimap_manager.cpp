@@ -125,9 +125,7 @@ void MinimapManager::Update(bool immediate) {
 void MinimapManager::InvalidateAll(const Map& map) {
 	auto& pending = pending_invalidations_[makeKey(map)];
 	pending.invalidate_all = true;
-	for (auto& floor_rects : pending.floor_rects) {
-		floor_rects.reset();
-	}
+	pending.nodes = DirtyList();
 }
 
 void MinimapManager::MarkTileDirty(const Map& map, const Position& position) {
@@ -140,15 +138,16 @@ void MinimapManager::MarkTileDirty(const Map& map, const Position& position) {
 		return;
 	}
 
-	const MinimapDirtyRect tile_rect = {
-		.x = position.x,
-		.y = position.y,
-		.width = 1,
-		.height = 1,
-	};
+	pending.nodes.AddPosition(position.x, position.y, position.z);
+}
+
+void MinimapManager::MarkDirty(const Map& map, const DirtyList& dirty_list) {
+	auto& pending = pending_invalidations_[makeKey(map)];
+	if (pending.invalidate_all) {
+		return;
+	}
 
-	auto& floor_rect = pending.floor_rects[position.z];
-	floor_rect = floor_rect ? UnionMinimapRects(*floor_rect, tile_rect) : tile_rect;
+	pending.nodes.Merge(dirty_list);
 }
 
 PendingMinimapInvalidation MinimapManager::TakePendingInvalidation(const Map& map) {
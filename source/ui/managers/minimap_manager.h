@@ -7,9 +7,8 @@
 
 #include "app/main.h"
 #include "rendering/drawers/minimap_cache.h"
+#include "editor/dirty_list.h"
 
-#include <array>
-#include <optional>
 #include <unordered_map>
 
 class MinimapWindow;
@@ -18,7 +17,7 @@ class Position;
 
 struct PendingMinimapInvalidation {
 	bool invalidate_all = false;
-	std::array<std::optional<MinimapDirtyRect>, MAP_LAYERS> floor_rects;
+	DirtyList nodes; // Dirty map nodes, read back as coalesced rectangles
 };
 
 class MinimapManager {
@@ -33,6 +32,7 @@ public:
 	bool IsVisible() const;
 	void InvalidateAll(const Map& map);
 	void MarkTileDirty(const Map& map, const Position& position);
+	void MarkDirty(const Map& map, const DirtyList& dirty_list);
 	PendingMinimapInvalidation TakePendingInvalidation(const Map& map);
 
 	MinimapWindow* GetWindow() {
@@ -82,6 +82,12 @@ void MapStatisticsDialog::Show(wxWindow* parent) {
 		os << "\t\tLargest House: \"" << stats.largest_house->name << "\" (" << stats.largest_house_size << " sqm)\n";
 	}
 
+	os << "\tMemory (all open maps):\n";
+	for (const SlabPool::Stats* pool : { &stats.memory.items, &stats.memory.tiles, &stats.memory.floors, &stats.memory.nodes, &stats.memory.cells }) {
+		os << "\t\t" << pool->name << ": " << pool->live_objects << " live (peak " << pool->peak_live_objects << "), " << pool->slab_count << " slabs, " << (pool->reservedBytes() / (1024.0 * 1024.0)) << " MB\n";
+	}
+	os << "\t\tTotal reserved: " << (stats.memory.reservedBytes() / (1024.0 * 1024.0)) << " MB\n";
+
 	os << "\n";
 	os << "Generated by Remere's Map Editor version " + __RME_VERSION__ + "\n";
 
@@ -10,10 +10,15 @@
 #include "app/preferences.h"
 #include "ui/result_window.h"
 #include "editor/operations/search_operations.h"
+#include "map/map_scan.h"
 
 #include <algorithm>
 
 namespace {
+	void reportSearchProgress(int percent) {
+		g_gui.SetLoadDone(percent);
+	}
+
 	[[nodiscard]] uint32_t searchResultsLimit() {
 		return static_cast<uint32_t>(std::clamp(g_settings.getInteger(Config::SEARCH_RESULTS_LIMIT), 1, 100000));
 	}
@@ -54,9 +59,8 @@ namespace {
 		}
 
 		const uint32_t page_limit = searchResultsLimit();
-		EditorOperations::ItemSearcher finder(item_id, page_limit, page_offset);
 		g_gui.CreateLoadBar(load_bar_label);
-		foreach_ItemOnMap(*search_map, finder, false);
+		const auto finder = indexed_foreach_ItemOnMap(*search_map, MapItemIndex::Field::ServerId, item_id, EditorOperations::ItemSearcher(item_id, page_limit, page_offset), false, reportSearchProgress);
 		g_gui.DestroyLoadBar();
 
 		SearchResultWindow* window = g_gui.ShowSearchWindow();
@@ -84,9 +88,8 @@ namespace {
 		}
 
 		const uint32_t page_limit = searchResultsLimit();
-		EditorOperations::CreatureSearcher finder(creature_brush, page_limit, page_offset);
 		g_gui.CreateLoadBar(load_bar_label);
-		foreach_TileOnMap(*search_map, finder);
+		const auto finder = parallel_foreach_TileOnMap(*search_map, EditorOperations::CreatureSearcher(creature_brush, page_limit, page_offset), reportSearchProgress);
 		g_gui.DestroyLoadBar();
 
 		SearchResultWindow* window = g_gui.ShowSearchWindow();
@@ -12,11 +12,17 @@
 #include "editor/operations/search_operations.h"
 #include "editor/operations/clean_operations.h"
 #include "map/map.h"
+#include "map/map_scan.h"
+#include "map/map_search.h"
 #include "editor/action_queue.h"
 
 #include <algorithm>
 
 namespace {
+	void reportSearchProgress(int percent) {
+		g_gui.SetLoadDone(percent);
+	}
+
 	[[nodiscard]] uint32_t searchResultsLimit() {
 		return static_cast<uint32_t>(std::clamp(g_settings.getInteger(Config::SEARCH_RESULTS_LIMIT), 1, 100000));
 	}
@@ -57,9 +63,8 @@ namespace {
 		}
 
 		const uint32_t page_limit = searchResultsLimit();
-		EditorOperations::ItemSearcher finder(item_id, page_limit, page_offset);
 		g_gui.CreateLoadBar(load_bar_label);
-		foreach_ItemOnMap(*search_map, finder, false);
+		const auto finder = indexed_foreach_ItemOnMap(*search_map, MapItemIndex::Field::ServerId, item_id, EditorOperations::ItemSearcher(item_id, page_limit, page_offset), false, reportSearchProgress);
 		g_gui.DestroyLoadBar();
 
 		SearchResultWindow* window = g_gui.ShowSearchWindow();
@@ -87,9 +92,8 @@ namespace {
 		}
 
 		const uint32_t page_limit = searchResultsLimit();
-		EditorOperations::CreatureSearcher finder(creature_brush, page_limit, page_offset);
 		g_gui.CreateLoadBar(load_bar_label);
-		foreach_TileOnMap(*search_map, finder);
+		const auto finder = parallel_foreach_TileOnMap(*search_map, EditorOperations::CreatureSearcher(creature_brush, page_limit, page_offset), reportSearchProgress);
 		g_gui.DestroyLoadBar();
 
 		SearchResultWindow* window = g_gui.ShowSearchWindow();
@@ -117,9 +121,8 @@ namespace {
 		}
 
 		const uint32_t page_limit = searchResultsLimit();
-		EditorOperations::ItemSearcher finder(item_id, page_limit, page_offset);
 		g_gui.CreateLoadBar(load_bar_label);
-		foreach_ItemOnMap(*search_map, finder, true);
+		const auto finder = indexed_foreach_ItemOnMap(*search_map, MapItemIndex::Field::ServerId, item_id, EditorOperations::ItemSearcher(item_id, page_limit, page_offset), true, reportSearchProgress);
 		g_gui.DestroyLoadBar();
 
 		SearchResultWindow* window = g_gui.ShowSearchWindow();
@@ -262,12 +265,6 @@ void SearchHandler::OnRemoveItemOnSelection(wxCommandEvent& WXUNUSED(event)) {
 	}
 }
 
-struct SearchResult {
-	Tile* tile;
-	Item* item;
-	std::string description;
-};
-
 void SearchHandler::SearchItems(bool unique, bool action, bool container, bool writable, bool onSelection /* = false*/) {
 	if (!unique && !action && !container && !writable) {
 		return;
@@ -290,7 +287,7 @@ void SearchHandler::SearchItems(bool unique, bool action, bool container, bool w
 	finder.search_container = container;
 	finder.search_writeable = writable;
 
-	foreach_ItemOnMap(g_gui.GetCurrentMap(), finder, onSelection);
+	finder = MapSearchUtility::Run(g_gui.GetCurrentMap(), finder, onSelection, reportSearchProgress);
 	finder.sort();
 
 	std::vector<SearchResult> found;
@@ -20,6 +20,7 @@
 #include "ui/replace_items_window.h"
 #include "ui/find_item_window.h"
 #include "editor/action_queue.h"
+#include "map/map_scan.h"
 #include "rendering/core/graphics.h"
 #include "ui/gui.h"
 #include "util/image_manager.h"
@@ -402,10 +403,8 @@ void ReplaceItemsDialog::OnExecuteButtonClicked(wxCommandEvent& WXUNUSED(event))
 
 	int done = 0;
 	for (const ReplacingItem& info : items) {
-		ItemFinder finder(info.replaceId, (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE));
-
 		// search on map
-		foreach_ItemOnMap(editor->map, finder, selectionOnly);
+		ItemFinder finder = indexed_foreach_ItemOnMap(editor->map, MapItemIndex::Field::ServerId, info.replaceId, ItemFinder(info.replaceId, (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE)), selectionOnly);
 
 		uint32_t total = 0;
 		std::vector<std::pair<Tile*, Item*>>& result = finder.result;
@@ -103,6 +103,16 @@ struct ItemFinder {
 		}
 	}
 
+	void merge(ItemFinder&& other) {
+		for (const auto& match : other.result) {
+			if (exceeded) {
+				return;
+			}
+			result.push_back(match);
+			exceeded = limit > 0 && result.size() >= size_t(limit);
+		}
+	}
+
 	std::vector<std::pair<Tile*, Item*>> result;
 
 private:
@@ -39,6 +39,7 @@ bool ReplacementEngine::ResolveReplacement(uint16_t& resultId, const Replacement
 #include "editor/editor.h"
 #include "ui/gui.h"
 #include "map/tile.h"
+#include "map/map_item_index.h"
 #include "map/tile_operations.h"
 #include "game/item.h"
 #include <algorithm>
@@ -57,7 +58,8 @@ void ReplacementEngine::ExecuteReplacement(Editor* editor, const std::vector<Rep
 		}
 	}
 
-	auto tileProcessor = [this, &ruleMap, editor](Tile* tile) {
+	bool anyChanged = false;
+	auto tileProcessor = [this, &ruleMap, editor, &anyChanged](Tile* tile) {
 		bool changed = false;
 		auto finder = [this, &ruleMap](Map&, Tile*, Item* item, long long) {
 			auto it = ruleMap.find(item->getID());
@@ -106,6 +108,7 @@ void ReplacementEngine::ExecuteReplacement(Editor* editor, const std::vector<Rep
 		if (changed) {
 			TileOperations::update(tile);
 			tile->modify();
+			anyChanged = true;
 		}
 	};
 
@@ -130,6 +133,11 @@ void ReplacementEngine::ExecuteReplacement(Editor* editor, const std::vector<Rep
 		foreach_TileOnMap(editor->map, allMapTileProcessor);
 	}
 
+	// Ids were changed in place, outside of any action, so the search index
+	// no longer matches the map.
+	if (anyChanged) {
+		editor->map.getItemIndex().invalidate();
+	}
 	editor->map.doChange();
 	g_gui.RefreshView();
 }
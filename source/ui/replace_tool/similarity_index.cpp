@@ -0,0 +1,498 @@
+#include "ui/replace_tool/similarity_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define RME_SIMILARITY_AVX2 1
+#endif
+
+namespace {
+	constexpr char INDEX_MAGIC[8] = { 'R', 'M', 'E', 'S', 'I', 'M', 'I', 'X' };
+	// Alpha above this counts as a visible pixel
+	constexpr uint8_t ALPHA_THRESHOLD = 10;
+
+	struct IndexHeader {
+		char magic[8];
+		uint32_t format_version;
+		uint32_t item_count;
+		uint64_t key;
+		uint64_t word_count;
+		uint64_t payload_hash;
+	};
+	static_assert(std::is_trivially_copyable_v<IndexHeader>);
+
+#if defined(RME_SIMILARITY_AVX2)
+	// Per-byte popcount through a nibble lookup, summed into the four 64-bit
+	// lanes by SAD against zero.
+	inline __m256i popcount256(__m256i v) {
+		const __m256i lookup = _mm256_setr_epi8(
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i low_mask = _mm256_set1_epi8(0x0F);
+		const __m256i lo = _mm256_and_si256(v, low_mask);
+		const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+		const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+		return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+	}
+#endif
+
+	// Number of pixels set in both masks.
+	uint32_t andPopcount(const uint64_t* a, const uint64_t* b, size_t count) {
+		size_t i = 0;
+		uint64_t total = 0;
+#if defined(RME_SIMILARITY_AVX2)
+		__m256i sums = _mm256_setzero_si256();
+		for (; i + 4 <= count; i += 4) {
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			sums = _mm256_add_epi64(sums, popcount256(_mm256_and_si256(va, vb)));
+		}
+		alignas(32) uint64_t lanes[4];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sums);
+		total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+		for (; i < count; ++i) {
+			total += std::popcount(a[i] & b[i]);
+		}
+		return static_cast<uint32_t>(total);
+	}
+
+	// Hamming distance of every hash to the source, four hashes per step.
+	void hammingDistances(std::span<const uint64_t> hashes, uint64_t source, std::vector<uint8_t>& distances) {
+		distances.resize(hashes.size());
+		size_t i = 0;
+#if defined(RME_SIMILARITY_AVX2)
+		const __m256i broadcast = _mm256_set1_epi64x(static_cast<long long>(source));
+		alignas(32) uint64_t lanes[4];
+		for (; i + 4 <= hashes.size(); i += 4) {
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hashes.data() + i));
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), popcount256(_mm256_xor_si256(v, broadcast)));
+			for (int lane = 0; lane < 4; ++lane) {
+				distances[i + lane] = static_cast<uint8_t>(lanes[lane]);
+			}
+		}
+#endif
+		for (; i < hashes.size(); ++i) {
+			distances[i] = static_cast<uint8_t>(std::popcount(hashes[i] ^ source));
+		}
+	}
+
+	size_t wordCount(int width, int height) {
+		return (static_cast<size_t>(width) * height + 63) / 64;
+	}
+
+	uint32_t countOnes(std::span<const uint64_t> mask) {
+		uint32_t ones = 0;
+		for (const uint64_t word : mask) {
+			ones += std::popcount(word);
+		}
+		return ones;
+	}
+
+	uint64_t calculateAHash(std::span<const uint8_t> rgba, int w, int h) {
+		// mappingtool: 1. Resize to 8x8 using box sampling
+		// grayscale = 0.299*R + 0.587*G + 0.114*B
+		uint8_t gray_8x8[64];
+		double total_brightness = 0;
+
+		float block_w = (float)w / 8.0f;
+		float block_h = (float)h / 8.0f;
+
+		for (int y = 0; y < 8; ++y) {
+			for (int x = 0; x < 8; ++x) {
+				double block_sum = 0;
+				int pixel_count = 0;
+
+				int start_x = (int)(x * block_w);
+				int start_y = (int)(y * block_h);
+				int end_x = (int)((x + 1) * block_w);
+				int end_y = (int)((y + 1) * block_h);
+
+				for (int py = start_y; py < end_y && py < h; ++py) {
+					for (int px = start_x; px < end_x && px < w; ++px) {
+						int idx = (py * w + px) * 4;
+						double gray = 0.299 * rgba[idx] + 0.587 * rgba[idx + 1] + 0.114 * rgba[idx + 2];
+						block_sum += gray;
+						pixel_count++;
+					}
+				}
+
+				uint8_t avg = (uint8_t)((pixel_count > 0) ? (block_sum / pixel_count) : 0);
+				gray_8x8[y * 8 + x] = avg;
+				total_brightness += avg;
+			}
+		}
+
+		uint8_t global_avg = (uint8_t)(total_brightness / 64.0);
+		uint64_t hash = 0;
+		for (int i = 0; i < 64; ++i) {
+			if (gray_8x8[i] >= global_avg) {
+				hash |= (1ULL << i);
+			}
+		}
+		return hash;
+	}
+}
+
+SimilarityFeatures SimilarityIndex::extract(uint16_t id, std::span<const uint8_t> rgba, int width, int height) {
+	SimilarityFeatures features;
+	features.id = id;
+	features.width = width;
+	features.height = height;
+
+	const size_t pixels = std::min(rgba.size() / 4, static_cast<size_t>(width) * height);
+	features.mask.assign(wordCount(width, height), 0);
+
+	std::array<uint32_t, SimilarityFeatures::HISTOGRAM_BINS> histogram {};
+	bool opaque = true;
+	for (size_t i = 0; i < pixels; ++i) {
+		const uint8_t* pixel = rgba.data() + i * 4;
+		if (pixel[3] <= ALPHA_THRESHOLD) {
+			opaque = false;
+			continue;
+		}
+
+		features.mask[i / 64] |= uint64_t { 1 } << (i % 64);
+		++features.truePixels;
+		++histogram[(pixel[0] >> 5) * 64 + (pixel[1] >> 5) * 8 + (pixel[2] >> 5)];
+	}
+
+	features.isOpaque = opaque;
+	features.aHash = calculateAHash(rgba, width, height);
+	if (features.truePixels > 0) {
+		for (size_t bin = 0; bin < histogram.size(); ++bin) {
+			features.histogram[bin] = static_cast<uint8_t>((histogram[bin] * 255 + features.truePixels / 2) / features.truePixels);
+		}
+	}
+	return features;
+}
+
+uint64_t SimilarityIndex::hash(std::span<const uint8_t> bytes, uint64_t seed) {
+	constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+
+	uint64_t h = seed ^ (bytes.size() * PRIME1);
+	size_t i = 0;
+	for (; i + 8 <= bytes.size(); i += 8) {
+		uint64_t word;
+		std::memcpy(&word, bytes.data() + i, sizeof(word));
+		h = std::rotl(h ^ (word * PRIME2), 31) * PRIME1;
+	}
+	uint64_t tail = 0;
+	std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+	h ^= tail * PRIME2;
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	return h;
+}
+
+int SimilarityIndex::canonicalIndex(int width, int height) {
+	if ((width != 32 && width != 64) || (height != 32 && height != 64)) {
+		return -1;
+	}
+	return (width == 64 ? 1 : 0) | (height == 64 ? 2 : 0);
+}
+
+void SimilarityIndex::resizeMask(const uint64_t* src, int src_width, int src_height, std::vector<uint64_t>& dst, int dst_width, int dst_height) {
+	dst.assign(wordCount(dst_width, dst_height), 0);
+	for (int y = 0; y < dst_height; ++y) {
+		// mappingtool: nearest neighbor scaling
+		const int sy = std::min((y * src_height) / dst_height, src_height - 1);
+		for (int x = 0; x < dst_width; ++x) {
+			const int sx = std::min((x * src_width) / dst_width, src_width - 1);
+			const size_t from = static_cast<size_t>(sy) * src_width + sx;
+			if (src[from / 64] & (uint64_t { 1 } << (from % 64))) {
+				const size_t to = static_cast<size_t>(y) * dst_width + x;
+				dst[to / 64] |= uint64_t { 1 } << (to % 64);
+			}
+		}
+	}
+}
+
+void SimilarityIndex::appendMasks(const SimilarityFeatures& features, Item& item, std::vector<uint64_t>& words) {
+	item.nativeOffset = static_cast<uint32_t>(words.size());
+	words.insert(words.end(), features.mask.begin(), features.mask.end());
+
+	item.maskOffsets.fill(NO_MASK);
+	item.maskOnes.fill(0);
+	const int native = canonicalIndex(features.width, features.height);
+
+	std::vector<uint64_t> resized;
+	for (int index = 0; index < CANONICAL_SIZES; ++index) {
+		const int width = canonicalWidth(index);
+		const int height = canonicalHeight(index);
+		if (width < features.width || height < features.height) {
+			continue;
+		}
+
+		if (index == native) {
+			item.maskOffsets[index] = item.nativeOffset;
+			item.maskOnes[index] = features.truePixels;
+			continue;
+		}
+		resizeMask(features.mask.data(), features.width, features.height, resized, width, height);
+		item.maskOffsets[index] = static_cast<uint32_t>(words.size());
+		item.maskOnes[index] = countOnes(resized);
+		words.insert(words.end(), resized.begin(), resized.end());
+	}
+}
+
+void SimilarityIndex::build(std::vector<SimilarityFeatures> features) {
+	clear();
+	std::ranges::sort(features, {}, &SimilarityFeatures::id);
+
+	items.reserve(features.size());
+	for (const SimilarityFeatures& entry : features) {
+		Item item {};
+		item.aHash = entry.aHash;
+		item.truePixels = entry.truePixels;
+		item.id = entry.id;
+		item.width = static_cast<uint16_t>(entry.width);
+		item.height = static_cast<uint16_t>(entry.height);
+		item.isOpaque = entry.isOpaque ? 1 : 0;
+		appendMasks(entry, item, words);
+		items.push_back(item);
+	}
+	finalize();
+}
+
+void SimilarityIndex::clear() {
+	items.clear();
+	words.clear();
+	opaqueHashes.clear();
+	opaqueIds.clear();
+	transparentItems.clear();
+}
+
+void SimilarityIndex::finalize() {
+	opaqueHashes.clear();
+	opaqueIds.clear();
+	transparentItems.clear();
+	for (size_t i = 0; i < items.size(); ++i) {
+		if (items[i].isOpaque) {
+			opaqueHashes.push_back(items[i].aHash);
+			opaqueIds.push_back(items[i].id);
+		} else {
+			transparentItems.push_back(static_cast<uint32_t>(i));
+		}
+	}
+}
+
+const SimilarityIndex::Item* SimilarityIndex::find(uint16_t id) const {
+	const auto it = std::ranges::lower_bound(items, id, {}, &Item::id);
+	return it != items.end() && it->id == id ? &*it : nullptr;
+}
+
+bool SimilarityIndex::contains(uint16_t id) const {
+	return find(id) != nullptr;
+}
+
+std::vector<uint16_t> SimilarityIndex::findSimilar(uint16_t id, size_t count) const {
+	const Item* item = find(id);
+	if (!item) {
+		return {};
+	}
+	return query({ item, words.data() }, count);
+}
+
+std::vector<uint16_t> SimilarityIndex::findSimilar(const SimilarityFeatures& source, size_t count) const {
+	Item item {};
+	item.aHash = source.aHash;
+	item.truePixels = source.truePixels;
+	item.id = source.id;
+	item.width = static_cast<uint16_t>(source.width);
+	item.height = static_cast<uint16_t>(source.height);
+	item.isOpaque = source.isOpaque ? 1 : 0;
+
+	std::vector<uint64_t> source_words;
+	appendMasks(source, item, source_words);
+	return query({ &item, source_words.data() }, count);
+}
+
+double SimilarityIndex::diceScore(const Query& source, const Item& target) const {
+	const int width = std::max(source.item->width, target.width);
+	const int height = std::max(source.item->height, target.height);
+
+	uint32_t tp;
+	uint32_t source_ones;
+	uint32_t target_ones;
+	const int index = canonicalIndex(width, height);
+	if (index >= 0) {
+		// Both items fit in the canonical size, so both have a mask there.
+		tp = andPopcount(source.words + source.item->maskOffsets[index], words.data() + target.maskOffsets[index], wordCount(width, height));
+		source_ones = source.item->maskOnes[index];
+		target_ones = target.maskOnes[index];
+	} else if (source.item->width == target.width && source.item->height == target.height) {
+		tp = andPopcount(source.words + source.item->nativeOffset, words.data() + target.nativeOffset, wordCount(width, height));
+		source_ones = source.item->truePixels;
+		target_ones = target.truePixels;
+	} else {
+		std::vector<uint64_t> m1;
+		std::vector<uint64_t> m2;
+		resizeMask(source.words + source.item->nativeOffset, source.item->width, source.item->height, m1, width, height);
+		resizeMask(words.data() + target.nativeOffset, target.width, target.height, m2, width, height);
+		tp = andPopcount(m1.data(), m2.data(), m1.size());
+		source_ones = countOnes(m1);
+		target_ones = countOnes(m2);
+	}
+
+	if (tp == 0) {
+		return 0.0;
+	}
+	// Dice: (2.0 * TP) / (|A| + |B|)
+	return (2.0 * tp) / static_cast<double>(source_ones + target_ones);
+}
+
+std::vector<uint16_t> SimilarityIndex::query(const Query& source, size_t count) const {
+	struct ScoredItem {
+		uint16_t id;
+		double score;
+		bool operator<(const ScoredItem& other) const {
+			// mappingtool: sort by similarity_score DESC, then ID ASC
+			if (std::abs(score - other.score) > 0.00001) {
+				return score > other.score;
+			}
+			return id < other.id;
+		}
+	};
+	std::vector<ScoredItem> candidates;
+
+	const uint16_t source_id = source.item->id;
+	if (source.item->isOpaque) {
+		// Strategy A: aHash, and only against other opaque sprites so walls do
+		// not match items.
+		std::vector<uint8_t> distances;
+		hammingDistances(opaqueHashes, source.item->aHash, distances);
+		candidates.reserve(opaqueIds.size());
+		for (size_t i = 0; i < opaqueIds.size(); ++i) {
+			// Score: 1.0 is perfect match (dist 0), 0.0 is max distance (64)
+			const double score = 1.0 - (static_cast<double>(distances[i]) / 64.0);
+			if (opaqueIds[i] != source_id && score > 0.0) {
+				candidates.push_back({ opaqueIds[i], score });
+			}
+		}
+	} else {
+		// Strategy B: Dice coefficient of the binary masks
+		for (const uint32_t index : transparentItems) {
+			const Item& target = items[index];
+			if (target.id == source_id) {
+				continue;
+			}
+			const double score = diceScore(source, target);
+			if (score > 0.0) {
+				candidates.push_back({ target.id, score });
+			}
+		}
+	}
+
+	count = std::min(count, candidates.size());
+	std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(count), candidates.end());
+
+	std::vector<uint16_t> results;
+	results.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		results.push_back(candidates[i].id);
+	}
+	return results;
+}
+
+bool SimilarityIndex::save(const std::string& path, uint64_t key) const {
+	static_assert(std::is_trivially_copyable_v<Item>);
+
+	const size_t items_size = items.size() * sizeof(Item);
+	const size_t words_size = words.size() * sizeof(uint64_t);
+	std::vector<uint8_t> payload(items_size + words_size);
+	if (!items.empty()) {
+		std::memcpy(payload.data(), items.data(), items_size);
+	}
+	if (!words.empty()) {
+		std::memcpy(payload.data() + items_size, words.data(), words_size);
+	}
+
+	IndexHeader header {};
+	std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	header.format_version = FORMAT_VERSION;
+	header.item_count = static_cast<uint32_t>(items.size());
+	header.key = key;
+	header.word_count = words.size();
+	header.payload_hash = hash(payload, key);
+
+	// Written aside and renamed so a crash never leaves a half-written index
+	const std::string temporary = path + ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+		if (!out) {
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error) {
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+	return true;
+}
+
+bool SimilarityIndex::load(const std::string& path, uint64_t key) {
+	clear();
+
+	std::ifstream in(path, std::ios::binary);
+	IndexHeader header;
+	if (!in || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		return false;
+	}
+	if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header.format_version != FORMAT_VERSION || header.key != key) {
+		return false;
+	}
+
+	const size_t items_size = static_cast<size_t>(header.item_count) * sizeof(Item);
+	if (header.word_count > UINT32_MAX) {
+		return false;
+	}
+	const size_t words_size = header.word_count * sizeof(uint64_t);
+	std::vector<uint8_t> payload(items_size + words_size);
+	if (!in.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payload.size())) || in.peek() != std::ifstream::traits_type::eof()) {
+		return false;
+	}
+	if (hash(payload, key) != header.payload_hash) {
+		return false;
+	}
+
+	items.resize(header.item_count);
+	words.resize(header.word_count);
+	if (!items.empty()) {
+		std::memcpy(items.data(), payload.data(), items_size);
+	}
+	if (!words.empty()) {
+		std::memcpy(words.data(), payload.data() + items_size, words_size);
+	}
+
+	// Offsets are trusted from here on, so check them once.
+	for (const Item& item : items) {
+		const size_t native_words = wordCount(item.width, item.height);
+		bool valid = item.nativeOffset <= words.size() && native_words <= words.size() - item.nativeOffset;
+		for (int index = 0; index < CANONICAL_SIZES && valid; ++index) {
+			const uint32_t offset = item.maskOffsets[index];
+			valid = offset == NO_MASK || (offset <= words.size() && wordCount(canonicalWidth(index), canonicalHeight(index)) <= words.size() - offset);
+		}
+		if (!valid) {
+			clear();
+			return false;
+		}
+	}
+
+	finalize();
+	return true;
+}
@@ -0,0 +1,115 @@
+#ifndef RME_SIMILARITY_INDEX_H_
+#define RME_SIMILARITY_INDEX_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Visual features of one item icon, see ALGORITHM_DOCS.md. The mask is packed
+// 64 pixels per word, row-major, bit i being pixel i.
+struct SimilarityFeatures {
+	static constexpr int HISTOGRAM_BINS = 512;
+
+	uint16_t id = 0;
+	int width = 0;
+	int height = 0;
+	bool isOpaque = false;
+	uint64_t aHash = 0;
+	std::vector<uint64_t> mask;
+	uint32_t truePixels = 0;
+	// 8x8x8 RGB histogram of the visible pixels, each bin scaled to 0-255
+	std::array<uint8_t, HISTOGRAM_BINS> histogram {};
+};
+
+// Immutable index over the features of every item, built once and then queried
+// from any thread without locking. Transparent items are compared with the
+// Dice coefficient of their masks, opaque ones by aHash Hamming distance.
+//
+// Two masks of different sizes are compared at (max width, max height) after a
+// nearest neighbour resize. Item icons are 32 or 64 pixels a side, so every
+// item keeps its mask at each of those canonical sizes it fits in, and a
+// comparison is always a straight AND + popcount over two word arrays. Other
+// sizes fall back to resizing at query time.
+//
+// Nothing here depends on wx or the sprite loaders, so the headless benchmark
+// builds it from raw RGBA.
+class SimilarityIndex {
+public:
+	static constexpr uint32_t FORMAT_VERSION = 1;
+
+	// RGBA, 4 bytes per pixel
+	static SimilarityFeatures extract(uint16_t id, std::span<const uint8_t> rgba, int width, int height);
+	static uint64_t hash(std::span<const uint8_t> bytes, uint64_t seed);
+
+	void build(std::vector<SimilarityFeatures> items);
+	void clear();
+
+	bool empty() const {
+		return items.empty();
+	}
+	size_t size() const {
+		return items.size();
+	}
+	bool contains(uint16_t id) const;
+
+	// Best matches first, by score and then id. The source is left out.
+	std::vector<uint16_t> findSimilar(uint16_t id, size_t count) const;
+	std::vector<uint16_t> findSimilar(const SimilarityFeatures& source, size_t count) const;
+
+	// Cache file keyed by whatever the caller derives from the inputs; a
+	// different key, version or a damaged file fails to load.
+	bool save(const std::string& path, uint64_t key) const;
+	bool load(const std::string& path, uint64_t key);
+
+private:
+	static constexpr int CANONICAL_SIZES = 4; // 32x32, 64x32, 32x64, 64x64
+	static constexpr uint32_t NO_MASK = UINT32_MAX;
+
+	// Fixed-layout row, also the on-disk record.
+	struct Item {
+		uint64_t aHash;
+		uint32_t truePixels;
+		uint32_t nativeOffset; // Into words
+		std::array<uint32_t, CANONICAL_SIZES> maskOffsets;
+		std::array<uint32_t, CANONICAL_SIZES> maskOnes;
+		uint16_t id;
+		uint16_t width;
+		uint16_t height;
+		uint8_t isOpaque;
+		uint8_t reserved;
+	};
+
+	// A source mask set, either an indexed item or an outside query.
+	struct Query {
+		const Item* item;
+		const uint64_t* words;
+	};
+
+	static int canonicalIndex(int width, int height);
+	static int canonicalWidth(int index) {
+		return 32 << (index & 1);
+	}
+	static int canonicalHeight(int index) {
+		return 32 << (index >> 1);
+	}
+	static void resizeMask(const uint64_t* src, int src_width, int src_height, std::vector<uint64_t>& dst, int dst_width, int dst_height);
+	static void appendMasks(const SimilarityFeatures& features, Item& item, std::vector<uint64_t>& words);
+
+	const Item* find(uint16_t id) const;
+	std::vector<uint16_t> query(const Query& source, size_t count) const;
+	double diceScore(const Query& source, const Item& target) const;
+	void finalize();
+
+	std::vector<Item> items; // Sorted by id
+	std::vector<uint64_t> words;
+
+	// Opaque items, split out so the aHash scan streams through one array.
+	std::vector<uint64_t> opaqueHashes;
+	std::vector<uint16_t> opaqueIds;
+	std::vector<uint32_t> transparentItems;
+};
+
+#endif
@@ -4,8 +4,11 @@
 #include "ui/gui.h"
 #include "item_definitions/core/item_definition_store.h"
 #include "rendering/core/graphics.h"
+#include "rendering/core/sprite_archive.h"
+#include "rendering/core/sprite_decoder.h"
 #include <algorithm>
-#include <cmath>
+#include <array>
+#include <iterator>
 #include <vector>
 #include <memory>
 #include <span>
@@ -16,342 +19,204 @@ VisualSimilarityService& VisualSimilarityService::Get() {
 	return instance;
 }
 
-VisualSimilarityService::VisualSimilarityService() : m_timer(this), m_nextIdToIndex(1), isIndexed(false) {
-	Bind(wxEVT_TIMER, &VisualSimilarityService::OnTimer, this, m_timer.GetId());
+VisualSimilarityService::VisualSimilarityService() :
+	indexingStarted(false),
+	isIndexed(false),
+	remainingBatches(0),
+	indexTasks(g_scheduler, TaskPriority::Bulk) {
 }
 
 VisualSimilarityService::~VisualSimilarityService() {
-	m_timer.Stop();
+	indexTasks.cancel();
+	indexTasks.wait();
 }
 
 void VisualSimilarityService::StartIndexing() {
-	if (isIndexed || m_timer.IsRunning()) {
+	if (indexingStarted || !g_version.getLoadedVersion()) {
 		return;
 	}
-	m_timer.Start(50); // Faster background indexing
-}
-
-// ============================================================================
-// CORE ALGORITHM HELPERS (Mappingtool 1:1)
-// ============================================================================
 
-static bool IsFullyOpaqueRGBA(std::span<const uint8_t> rgba, uint8_t threshold = 10) {
-	for (size_t i = 3; i < rgba.size(); i += 4) {
-		if (rgba[i] <= threshold) {
-			return false;
-		}
+	const DecodeSource source = GetDecodeSource();
+	if (!source.archive) {
+		return;
 	}
-	return true;
-}
-
-static uint64_t CalculateAHashRGBA(std::span<const uint8_t> rgba, int w, int h) {
-	// mappingtool: 1. Resize to 8x8 using box sampling
-	// grayscale = 0.299*R + 0.587*G + 0.114*B
-	uint8_t gray_8x8[64];
-	double total_brightness = 0;
-
-	float block_w = (float)w / 8.0f;
-	float block_h = (float)h / 8.0f;
-
-	for (int y = 0; y < 8; ++y) {
-		for (int x = 0; x < 8; ++x) {
-			double block_sum = 0;
-			int pixel_count = 0;
-
-			int start_x = (int)(x * block_w);
-			int start_y = (int)(y * block_h);
-			int end_x = (int)((x + 1) * block_w);
-			int end_y = (int)((y + 1) * block_h);
+	indexingStarted = true;
 
-			for (int py = start_y; py < end_y && py < h; ++py) {
-				for (int px = start_x; px < end_x && px < w; ++px) {
-					int idx = (py * w + px) * 4;
-					double gray = 0.299 * rgba[idx] + 0.587 * rgba[idx + 1] + 0.114 * rgba[idx + 2];
-					block_sum += gray;
-					pixel_count++;
-				}
-			}
-
-			uint8_t avg = (uint8_t)((pixel_count > 0) ? (block_sum / pixel_count) : 0);
-			gray_8x8[y * 8 + x] = avg;
-			total_brightness += avg;
+	// Sprites are looked up here, on the UI thread; the tasks only hash,
+	// decode and compare.
+	LayoutList layouts;
+	const int maxId = g_item_definitions.getMaxID();
+	for (int id = 1; id <= maxId; ++id) {
+		SpriteLayout layout;
+		if (SnapshotLayout(static_cast<uint16_t>(id), layout)) {
+			layouts.push_back(std::move(layout));
 		}
 	}
 
-	uint8_t global_avg = (uint8_t)(total_brightness / 64.0);
-	uint64_t hash = 0;
-	for (int i = 0; i < 64; ++i) {
-		if (gray_8x8[i] >= global_avg) {
-			hash |= (1ULL << i);
-		}
+	if (layouts.empty()) {
+		isIndexed = true;
+		return;
 	}
-	return hash;
-}
 
-static std::vector<bool> ExtractBinaryMaskRGBA(std::span<const uint8_t> rgba, int& outTruePixels) {
-	size_t count = rgba.size() / 4;
-	std::vector<bool> mask(count);
-	outTruePixels = 0;
-	for (size_t i = 0; i < count; ++i) {
-		// Strictly > 10 per mappingtool docs
-		bool val = (rgba[i * 4 + 3] > 10);
-		mask[i] = val;
-		if (val) {
-			outTruePixels++;
+	const std::string cachePath = wxFileName(g_version.getLoadedVersion()->getLocalDataPath().GetPath(), "similarity.index").GetFullPath().ToStdString();
+	indexTasks.addWork(layouts.size());
+
+	auto shared = std::make_shared<const LayoutList>(std::move(layouts));
+	indexTasks.run([this, shared, source, cachePath]() {
+		const uint64_t key = ComputeIndexKey(*shared, source);
+		if (index.load(cachePath, key)) {
+			spdlog::info("Visual similarity index loaded from {} ({} items)", cachePath, index.size());
+			indexTasks.advance(shared->size());
+			isIndexed = true;
+			return;
 		}
-	}
-	return mask;
+		BuildIndex(shared, source, cachePath, key);
+	});
 }
 
-static std::vector<float> CalculateHistogramRGBA(std::span<const uint8_t> rgba, uint8_t threshold = 10) {
-	const int BINS = 8;
-	std::vector<int> hist(BINS * BINS * BINS, 0);
-	int pixel_count = 0;
-	size_t count = rgba.size() / 4;
-
-	for (size_t i = 0; i < count; ++i) {
-		if (rgba[i * 4 + 3] > threshold) {
-			int r_bin = std::min((int)(rgba[i * 4 + 0] * BINS / 256), BINS - 1);
-			int g_bin = std::min((int)(rgba[i * 4 + 1] * BINS / 256), BINS - 1);
-			int b_bin = std::min((int)(rgba[i * 4 + 2] * BINS / 256), BINS - 1);
+void VisualSimilarityService::BuildIndex(std::shared_ptr<const LayoutList> layouts, const DecodeSource& source, std::string cachePath, uint64_t key) {
+	const size_t batches = (layouts->size() + INDEX_BATCH_SIZE - 1) / INDEX_BATCH_SIZE;
+	remainingBatches = batches;
+	pendingData.reserve(layouts->size());
+
+	for (size_t batch = 0; batch < batches; ++batch) {
+		indexTasks.run([this, layouts, source, cachePath, key, batch]() {
+			const size_t first = batch * INDEX_BATCH_SIZE;
+			const size_t last = std::min(first + INDEX_BATCH_SIZE, layouts->size());
+
+			std::vector<VisualItemData> computed;
+			computed.reserve(last - first);
+			for (size_t i = first; i < last && !indexTasks.isCancelled(); ++i) {
+				VisualItemData data = ComputeData((*layouts)[i], source);
+				if (data.width > 0) {
+					computed.push_back(std::move(data));
+				}
+			}
 
-			int bin_idx = r_bin * BINS * BINS + g_bin * BINS + b_bin;
-			hist[bin_idx]++;
-			pixel_count++;
-		}
-	}
+			{
+				std::lock_guard<std::mutex> lock(dataMutex);
+				std::ranges::move(computed, std::back_inserter(pendingData));
+			}
+			indexTasks.advance(last - first);
 
-	std::vector<float> normalized(hist.size(), 0.0f);
-	if (pixel_count > 0) {
-		for (size_t i = 0; i < hist.size(); ++i) {
-			normalized[i] = (float)hist[i] / pixel_count;
-		}
-	}
-	return normalized;
-}
+			if (remainingBatches.fetch_sub(1) != 1) {
+				return;
+			}
 
-static float CompareHistograms(std::span<const float> h1, std::span<const float> h2) {
-	if (h1.empty() || h2.empty()) {
-		return 0.0f;
-	}
-	float intersection = 0.0f;
-	size_t minSize = std::min(h1.size(), h2.size());
-	for (size_t i = 0; i < minSize; ++i) {
-		intersection += std::min(h1[i], h2[i]);
+			// Last batch: every other one has handed its data over.
+			index.build(std::move(pendingData));
+			pendingData = {};
+			if (!indexTasks.isCancelled() && !index.save(cachePath, key)) {
+				spdlog::warn("Could not write the visual similarity index to {}", cachePath);
+			}
+			isIndexed = true;
+		});
 	}
-	return intersection;
 }
 
-#include <bit>
-
-static int HammingDistance(uint64_t h1, uint64_t h2) {
-	return std::popcount(h1 ^ h2);
-}
+uint64_t VisualSimilarityService::ComputeIndexKey(const LayoutList& layouts, const DecodeSource& source) {
+	const auto bytesOf = [](const auto& value) {
+		return std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+	};
 
-static std::vector<bool> ResizeMask(const std::vector<bool>& src, int srcW, int srcH, int dstW, int dstH) {
-	std::vector<bool> dst(dstW * dstH);
-	for (int y = 0; y < dstH; ++y) {
-		for (int x = 0; x < dstW; ++x) {
-			// mappingtool: nearest neighbor scaling
-			int sx = (x * srcW) / dstW;
-			int sy = (y * srcH) / dstH;
-			sx = std::min(sx, srcW - 1);
-			sy = std::min(sy, srcH - 1);
-			dst[y * dstW + x] = src[sy * srcW + sx];
+	uint64_t key = SimilarityIndex::hash(bytesOf(SimilarityIndex::FORMAT_VERSION), source.hasTransparency ? 1 : 0);
+	std::vector<uint8_t> scratch;
+	for (const SpriteLayout& layout : layouts) {
+		const std::array<int32_t, 3> header = { layout.id, layout.width, layout.height };
+		key = SimilarityIndex::hash(bytesOf(header), key);
+		for (const SpriteLayout::Part& part : layout.parts) {
+			const std::array<int32_t, 3> placement = { static_cast<int32_t>(part.spriteId), part.x, part.y };
+			key = SimilarityIndex::hash(bytesOf(placement), key);
+
+			std::span<const uint8_t> compressed;
+			if (source.archive->viewCompressed(part.spriteId, scratch, compressed)) {
+				key = SimilarityIndex::hash(compressed, key);
+			}
 		}
 	}
-	return dst;
+	return key;
 }
 
 // ============================================================================
 // SERVICE IMPLEMENTATION
 // ============================================================================
 
-VisualSimilarityService::VisualItemData VisualSimilarityService::CalculateData(uint16_t itemId) {
-	VisualItemData data;
-	data.id = itemId;
-	data.isOpaque = false;
-	data.aHash = 0;
-	data.width = 0;
-	data.height = 0;
-	data.truePixels = 0;
-
-	if (!g_version.getLoadedVersion()) {
-		return data;
-	}
-
+bool VisualSimilarityService::SnapshotLayout(uint16_t itemId, SpriteLayout& layout) {
 	const auto it = g_item_definitions.get(itemId);
 	if (!it || it.clientId() == 0) {
-		return data;
+		return false;
 	}
 
-	Sprite* sprite = g_gui.gfx.getSprite(it.clientId());
-	if (!sprite) {
-		return data;
+	GameSprite* gs = dynamic_cast<GameSprite*>(g_gui.gfx.getSprite(it.clientId()));
+	if (!gs || gs->width <= 0 || gs->height <= 0) {
+		return false;
 	}
 
-	GameSprite* gs = dynamic_cast<GameSprite*>(sprite);
-	if (!gs) {
+	layout.id = itemId;
+	layout.width = gs->width * 32;
+	layout.height = gs->height * 32;
+	layout.parts.clear();
+	NvgUtils::ForEachCompositePart(*gs, [&layout](NormalImage* image, int part_x, int part_y) {
+		// Sprite 0 is fully transparent and adds nothing to the composite
+		if (image && image->id != 0) {
+			layout.parts.push_back({ image->id, part_x, part_y });
+		}
+	});
+	return true;
+}
+
+VisualSimilarityService::DecodeSource VisualSimilarityService::GetDecodeSource() {
+	return { g_gui.gfx.getSpriteArchive(), g_gui.gfx.hasTransparency() };
+}
+
+VisualSimilarityService::VisualItemData VisualSimilarityService::CalculateData(uint16_t itemId) {
+	SpriteLayout layout;
+	if (!g_version.getLoadedVersion() || !SnapshotLayout(itemId, layout)) {
+		VisualItemData data {};
+		data.id = itemId;
 		return data;
 	}
+	return ComputeData(layout, GetDecodeSource());
+}
 
-	int w, h;
-	auto composite = NvgUtils::CreateCompositeRGBA(*gs, w, h);
-	if (!composite) {
+VisualSimilarityService::VisualItemData VisualSimilarityService::ComputeData(const SpriteLayout& layout, const DecodeSource& source) {
+	if (!source.archive) {
+		VisualItemData data {};
+		data.id = layout.id;
 		return data;
 	}
 
-	data.width = w;
-	data.height = h;
-	data.isOpaque = IsFullyOpaqueRGBA({composite.get(), static_cast<size_t>(w * h * 4)});
-
-	// Store both for robustness
-	data.aHash = CalculateAHashRGBA({composite.get(), static_cast<size_t>(w * h * 4)}, w, h);
-	data.binaryMask = ExtractBinaryMaskRGBA({composite.get(), static_cast<size_t>(w * h * 4)}, data.truePixels);
-	data.histogram = CalculateHistogramRGBA({composite.get(), static_cast<size_t>(w * h * 4)});
-
-	return data;
-}
-
-void VisualSimilarityService::OnTimer(wxTimerEvent&) {
-	int processed = 0;
-	int maxId = g_item_definitions.getMaxID();
+	const int w = layout.width;
+	const int h = layout.height;
+	auto composite = std::make_unique<uint8_t[]>(static_cast<size_t>(w) * h * 4); // Zeroed
 
-	// Process fewer items per tick to prevent UI lag and handle spikes
-	while (processed < 100 && m_nextIdToIndex <= maxId) {
-		uint16_t id = m_nextIdToIndex++;
-		const auto it = g_item_definitions.get(id);
-		if (it && it.clientId() != 0) {
-			VisualItemData data = CalculateData(id);
-			if (data.width > 0) {
-				std::lock_guard<std::mutex> lock(dataMutex);
-				itemDataCache[id] = std::move(data);
-			}
+	// Only used when the archive is not memory-mapped
+	static thread_local std::vector<uint8_t> scratch;
+	static thread_local std::array<uint8_t, SpriteDecoder::OUTPUT_SIZE> spriteData;
+	for (const SpriteLayout::Part& part : layout.parts) {
+		std::span<const uint8_t> compressed;
+		if (!source.archive->viewCompressed(part.spriteId, scratch, compressed) || compressed.empty()) {
+			continue;
 		}
-		processed++;
+		GameSprite::DecompressInto(compressed, source.hasTransparency, spriteData, part.spriteId);
+		NvgUtils::BlendSpritePart(composite.get(), w, h, part.x, part.y, spriteData.data());
 	}
 
-	if (m_nextIdToIndex > maxId) {
-		m_timer.Stop();
-		std::lock_guard<std::mutex> lock(dataMutex);
-		isIndexed = true;
-	}
+	return SimilarityIndex::extract(layout.id, { composite.get(), static_cast<size_t>(w) * h * 4 }, w, h);
 }
 
 std::vector<uint16_t> VisualSimilarityService::FindSimilar(uint16_t itemId, size_t count) {
-	VisualItemData sourceData;
-	{
-		std::lock_guard<std::mutex> lock(dataMutex);
-		auto it = itemDataCache.find(itemId);
-		if (it != itemDataCache.end()) {
-			sourceData = it->second;
-		}
-	}
-
 	if (!isIndexed) {
 		return {};
 	}
 
-	if (sourceData.width == 0) {
-		sourceData = CalculateData(itemId);
-		if (sourceData.width == 0) {
-			return {};
-		}
+	if (index.contains(itemId)) {
+		return index.findSimilar(itemId, count);
 	}
 
-	struct ScoredItem {
-		uint16_t id;
-		double score;
-		float histogram;
-		bool operator<(const ScoredItem& other) const {
-			// mappingtool: sort by similarity_score DESC, then ID ASC
-			if (std::abs(score - other.score) > 0.00001) {
-				return score > other.score;
-			}
-			return id < other.id;
-		}
-	};
-	std::vector<ScoredItem> candidates;
-
-	{
-		std::lock_guard<std::mutex> lock(dataMutex);
-		for (const auto& pair : itemDataCache) {
-			const auto& target = pair.second;
-			if (target.id == itemId) {
-				continue;
-			}
-
-			double score = 0.0;
-			float histScore = CompareHistograms(sourceData.histogram, target.histogram);
-
-			if (sourceData.isOpaque) {
-				// Strategy A: aHash for opaque sprites
-				// Mappingtool: We only compare against other opaque sprites to avoid matching walls with items
-				if (target.isOpaque) {
-					int dist = HammingDistance(sourceData.aHash, target.aHash);
-					// Score: 1.0 is perfect match (dist 0), 0.0 is max distance (64)
-					score = 1.0 - (static_cast<double>(dist) / 64.0);
-				} else {
-					continue; // Strict 1:1 behavior
-				}
-			} else {
-				// Strategy B: Standard Binary Mask for transparent sprites
-				if (target.isOpaque) {
-					continue; // Mappingtool: Transparent target does not match opaque candidate
-				}
-
-				int tp = 0;
-				int sourceOnes = sourceData.truePixels;
-				int targetOnes = target.truePixels;
-
-				if (sourceData.width == target.width && sourceData.height == target.height) {
-					for (size_t i = 0; i < sourceData.binaryMask.size(); ++i) {
-						if (sourceData.binaryMask[i] && target.binaryMask[i]) {
-							tp++;
-						}
-					}
-				} else {
-					// 1:1 Resize Logic (Nearest Neighbor)
-					int w = std::max(sourceData.width, target.width);
-					int h = std::max(sourceData.height, target.height);
-					auto m1 = ResizeMask(sourceData.binaryMask, sourceData.width, sourceData.height, w, h);
-					auto m2 = ResizeMask(target.binaryMask, target.width, target.height, w, h);
-					sourceOnes = 0;
-					targetOnes = 0;
-					for (size_t i = 0; i < m1.size(); ++i) {
-						if (m1[i]) {
-							sourceOnes++;
-						}
-						if (m2[i]) {
-							targetOnes++;
-						}
-						if (m1[i] && m2[i]) {
-							tp++;
-						}
-					}
-				}
-
-				if (tp > 0) {
-					// Dice: (2.0 * TP) / (|A| + |B|)
-					score = (2.0 * tp) / (double)(sourceOnes + targetOnes);
-				}
-			}
-
-			if (score > 0.0) {
-				candidates.push_back({ target.id, score, histScore });
-			}
-		}
-	}
-
-	if (count > candidates.size()) {
-		count = candidates.size();
-	}
-	std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
-
-	std::vector<uint16_t> results;
-	results.reserve(count);
-	for (const auto& candidate : candidates | std::views::take(count)) {
-		results.push_back(candidate.id);
+	const VisualItemData sourceData = CalculateData(itemId);
+	if (sourceData.width == 0) {
+		return {};
 	}
-	return results;
+	return index.findSimilar(sourceData, count);
 }
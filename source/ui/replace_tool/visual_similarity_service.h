@@ -2,34 +2,34 @@
 #define RME_VISUAL_SIMILARITY_SERVICE_H_
 
 #include "app/main.h"
-#include <wx/event.h>
-#include <wx/timer.h>
+#include "app/task_scheduler.h"
+#include "ui/replace_tool/similarity_index.h"
 #include <vector>
-#include <unordered_map>
 #include <mutex>
 #include <cstdint>
 #include <atomic>
+#include <memory>
+#include <string>
 
-class VisualSimilarityService : public wxEvtHandler {
+class SpriteArchive;
+
+class VisualSimilarityService {
 public:
 	static VisualSimilarityService& Get();
 
-	struct VisualItemData {
-		uint16_t id;
-		bool isOpaque;
-		uint64_t aHash;
-		int width;
-		int height;
-		std::vector<bool> binaryMask; // Flattened mask
-		int truePixels; // Count of 1s
-		std::vector<float> histogram; // 512-bin RGB histogram (normalized)
-	};
+	using VisualItemData = SimilarityFeatures;
 
 	// Find top N similar items
 	std::vector<uint16_t> FindSimilar(uint16_t itemId, size_t count = 50);
 
-	// Start background indexing
+	// Start background indexing on the task scheduler. The index is read back
+	// from the client version's data directory when the sprites it was built
+	// from are unchanged.
 	void StartIndexing();
+	// Fraction of the items indexed so far
+	double GetIndexingProgress() const {
+		return indexTasks.getProgress();
+	}
 
 	// Calculate data for a single item (useful for preview/debug)
 	VisualItemData CalculateData(uint16_t itemId);
@@ -38,14 +38,49 @@ private:
 	VisualSimilarityService();
 	~VisualSimilarityService();
 
-	void OnTimer(wxTimerEvent& event);
+	// Which sprites make up an item's icon and where, taken on the UI thread
+	// so workers never touch the sprite objects themselves.
+	struct SpriteLayout {
+		struct Part {
+			uint32_t spriteId;
+			int x;
+			int y;
+		};
+
+		uint16_t id = 0;
+		int width = 0;
+		int height = 0;
+		std::vector<Part> parts;
+	};
+
+	struct DecodeSource {
+		std::shared_ptr<SpriteArchive> archive;
+		bool hasTransparency = false;
+	};
+
+	using LayoutList = std::vector<SpriteLayout>;
+
+	static bool SnapshotLayout(uint16_t itemId, SpriteLayout& layout);
+	static DecodeSource GetDecodeSource();
+	// Thread-safe: decodes straight from the archive
+	static VisualItemData ComputeData(const SpriteLayout& layout, const DecodeSource& source);
+	// Covers the layouts and the compressed bytes of every sprite they use
+	static uint64_t ComputeIndexKey(const LayoutList& layouts, const DecodeSource& source);
 
-	std::unordered_map<uint16_t, VisualItemData> itemDataCache;
+	void BuildIndex(std::shared_ptr<const LayoutList> layouts, const DecodeSource& source, std::string cachePath, uint64_t key);
+
+	// Written once by the last indexing task, read-only after isIndexed
+	SimilarityIndex index;
+	std::vector<VisualItemData> pendingData;
 	std::mutex dataMutex;
 
-	wxTimer m_timer;
-	uint16_t m_nextIdToIndex;
-	bool isIndexed;
+	static constexpr size_t INDEX_BATCH_SIZE = 256;
+
+	bool indexingStarted;
+	std::atomic<bool> isIndexed;
+	std::atomic<size_t> remainingBatches;
+	// Declared last so its destructor cancels and drains the batches first
+	TaskGroup indexTasks;
 };
 
 #endif
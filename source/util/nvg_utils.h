@@ -17,20 +17,10 @@ namespace NvgUtils {
 		return nvgRGBA(c.Red(), c.Green(), c.Blue(), c.Alpha());
 	}
 
-	// Creates a composite RGBA buffer from a GameSprite.
-	// Returns a unique_ptr to the buffer, or nullptr on failure.
-	inline std::unique_ptr<uint8_t[]> CreateCompositeRGBA(GameSprite& gs, int& outW, int& outH) {
-		outW = gs.width * 32;
-		outH = gs.height * 32;
-
-		if (outW <= 0 || outH <= 0) {
-			return nullptr;
-		}
-
-		size_t bufferSize = static_cast<size_t>(outW) * outH * 4;
-		auto composite = std::make_unique<uint8_t[]>(bufferSize);
-		std::fill(composite.get(), composite.get() + bufferSize, 0);
-
+	// Calls fn(NormalImage*, part_x, part_y) for every sprite part making up
+	// the icon of a GameSprite, in the order they are composited.
+	template <typename Fn>
+	inline void ForEachCompositePart(GameSprite& gs, Fn&& fn) {
 		int pattern_x = (gs.pattern_x >= 3) ? 2 : 0;
 		int pattern_y = 0;
 		int pattern_z = 0;
@@ -44,50 +34,69 @@ namespace NvgUtils {
 						continue;
 					}
 
-					auto spriteData = gs.spriteList[spriteIdx]->getRGBAData();
-					if (!spriteData) {
-						continue;
-					}
-
 					// Right-to-left, bottom-to-top arrangement (standard RME rendering order)
-					int part_x = (gs.width - w - 1) * 32;
-					int part_y = (gs.height - h - 1) * 32;
-
-					for (int sy = 0; sy < 32; ++sy) {
-						for (int sx = 0; sx < 32; ++sx) {
-							int dy = part_y + sy;
-							int dx = part_x + sx;
-
-							if (dx < 0 || dx >= outW || dy < 0 || dy >= outH) {
-								continue;
-							}
-
-							int src_idx = (sy * 32 + sx) * 4;
-							int dst_idx = (dy * outW + dx) * 4;
-
-							uint8_t sa = spriteData[src_idx + 3];
-							if (sa == 0) {
-								continue;
-							}
-
-							if (sa == 255) {
-								composite[dst_idx + 0] = spriteData[src_idx + 0];
-								composite[dst_idx + 1] = spriteData[src_idx + 1];
-								composite[dst_idx + 2] = spriteData[src_idx + 2];
-								composite[dst_idx + 3] = 255;
-							} else {
-								float a = sa / 255.0f;
-								float inv_a = 1.0f - a;
-								composite[dst_idx + 0] = (uint8_t)(spriteData[src_idx + 0] * a + composite[dst_idx + 0] * inv_a);
-								composite[dst_idx + 1] = (uint8_t)(spriteData[src_idx + 1] * a + composite[dst_idx + 1] * inv_a);
-								composite[dst_idx + 2] = (uint8_t)(spriteData[src_idx + 2] * a + composite[dst_idx + 2] * inv_a);
-								composite[dst_idx + 3] = std::max(composite[dst_idx + 3], sa);
-							}
-						}
-					}
+					fn(gs.spriteList[spriteIdx], (gs.width - w - 1) * 32, (gs.height - h - 1) * 32);
+				}
+			}
+		}
+	}
+
+	// Alpha-blends one decoded 32x32 RGBA sprite part onto a composite buffer.
+	inline void BlendSpritePart(uint8_t* composite, int outW, int outH, int part_x, int part_y, const uint8_t* spriteData) {
+		for (int sy = 0; sy < 32; ++sy) {
+			for (int sx = 0; sx < 32; ++sx) {
+				int dy = part_y + sy;
+				int dx = part_x + sx;
+
+				if (dx < 0 || dx >= outW || dy < 0 || dy >= outH) {
+					continue;
+				}
+
+				int src_idx = (sy * 32 + sx) * 4;
+				int dst_idx = (dy * outW + dx) * 4;
+
+				uint8_t sa = spriteData[src_idx + 3];
+				if (sa == 0) {
+					continue;
+				}
+
+				if (sa == 255) {
+					composite[dst_idx + 0] = spriteData[src_idx + 0];
+					composite[dst_idx + 1] = spriteData[src_idx + 1];
+					composite[dst_idx + 2] = spriteData[src_idx + 2];
+					composite[dst_idx + 3] = 255;
+				} else {
+					float a = sa / 255.0f;
+					float inv_a = 1.0f - a;
+					composite[dst_idx + 0] = (uint8_t)(spriteData[src_idx + 0] * a + composite[dst_idx + 0] * inv_a);
+					composite[dst_idx + 1] = (uint8_t)(spriteData[src_idx + 1] * a + composite[dst_idx + 1] * inv_a);
+					composite[dst_idx + 2] = (uint8_t)(spriteData[src_idx + 2] * a + composite[dst_idx + 2] * inv_a);
+					composite[dst_idx + 3] = std::max(composite[dst_idx + 3], sa);
 				}
 			}
 		}
+	}
+
+	// Creates a composite RGBA buffer from a GameSprite.
+	// Returns a unique_ptr to the buffer, or nullptr on failure.
+	inline std::unique_ptr<uint8_t[]> CreateCompositeRGBA(GameSprite& gs, int& outW, int& outH) {
+		outW = gs.width * 32;
+		outH = gs.height * 32;
+
+		if (outW <= 0 || outH <= 0) {
+			return nullptr;
+		}
+
+		size_t bufferSize = static_cast<size_t>(outW) * outH * 4;
+		auto composite = std::make_unique<uint8_t[]>(bufferSize);
+		std::fill(composite.get(), composite.get() + bufferSize, 0);
+
+		ForEachCompositePart(gs, [&](NormalImage* image, int part_x, int part_y) {
+			auto spriteData = image->getRGBAData();
+			if (spriteData) {
+				BlendSpritePart(composite.get(), outW, outH, part_x, part_y, spriteData.get());
+			}
+		});
 		return composite;
 	}
 
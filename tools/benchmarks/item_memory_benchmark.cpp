@@ -0,0 +1,360 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// Resident memory of a tile's item storage in four layouts:
+//   heap    the old 32-byte Item from the general heap,
+//   pool32  the same Item from a SlabPool,
+//   pool24  the current Item (invalid OTBM data moved to a side table) from a SlabPool,
+//   inline  plain items stored inline as 4-byte (id, subtype) records, the
+//           rest as pooled 24-byte Items next to them.
+// The stand-ins have the same size and layout as Item: a vtable, the attribute
+// list pointer, id/subtype/selected and, in the old layout, the invalid OTBM
+// data pointer. Every layout runs in its own process so the numbers don't mix.
+//
+// The tiles either come from an OTBM file or are made up (a full 2048x2048
+// floor by default). From an OTBM, an item counts as plain when its node
+// carries nothing but an id and a count or charges, and has no children.
+// Containers, doors and the like without attributes can't be told apart
+// without items.otb and count as plain too, so the inline row is a lower bound.
+//
+// Usage: item_memory_benchmark [tiles | map.otbm]
+
+#include "map/slab_pool.h"
+#include "io/otbm/otbm_types.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
+
+namespace {
+	struct LegacyItem {
+		virtual ~LegacyItem() = default;
+		void* attributes = nullptr;
+		uint16_t id = 0;
+		uint16_t subtype = 0;
+		bool selected = false;
+		void* invalid_otbm_data = nullptr;
+	};
+
+	struct CompactItem {
+		virtual ~CompactItem() = default;
+		void* attributes = nullptr;
+		uint16_t id = 0;
+		uint16_t subtype = 0;
+		bool selected = false;
+		bool has_invalid_otbm_data = false;
+	};
+
+	template <typename Base>
+	struct Pooled : Base {
+		static SlabPool& pool() {
+			static SlabPool pool("Item", sizeof(Pooled), alignof(Pooled));
+			return pool;
+		}
+		static void* operator new(size_t) {
+			return pool().allocate();
+		}
+		static void operator delete(void* ptr) noexcept {
+			pool().deallocate(ptr);
+		}
+	};
+
+	// The items of every tile, first one being the ground, flattened into one
+	// array so even a large map costs only a few bytes per item to describe.
+	struct MapModel {
+		static constexpr uint32_t PLAIN = 1u << 16;
+
+		std::vector<uint32_t> tile_begin { 0 };
+		std::vector<uint32_t> items; // id | PLAIN
+
+		size_t tileCount() const {
+			return tile_begin.size() - 1;
+		}
+		size_t plainCount() const {
+			size_t count = 0;
+			for (const uint32_t item : items) {
+				count += (item & PLAIN) ? 1 : 0;
+			}
+			return count;
+		}
+	};
+
+	// Items stacked on top of the ground: most tiles are bare ground, a third
+	// carry a border or a decoration, a few carry several.
+	MapModel makeSyntheticMap(size_t tile_count) {
+		MapModel model;
+		std::mt19937 rng(42);
+		std::uniform_int_distribution<int> percent(0, 99);
+		model.tile_begin.reserve(tile_count + 1);
+		for (size_t i = 0; i < tile_count; ++i) {
+			const int roll = percent(rng);
+			const int extra = roll < 55 ? 0 : roll < 85 ? 1 : roll < 95 ? 2 : 3;
+			model.items.push_back((100 + model.items.size() % 50) | MapModel::PLAIN);
+			for (int n = 0; n < extra; ++n) {
+				model.items.push_back((4500 + model.items.size() % 300) | MapModel::PLAIN);
+			}
+			model.tile_begin.push_back(static_cast<uint32_t>(model.items.size()));
+		}
+		return model;
+	}
+
+	// Walks the OTBM node tree and records the tiles and their top-level items.
+	class OtbmScanner {
+	public:
+		explicit OtbmScanner(std::vector<uint8_t> data) :
+			data(std::move(data)) { }
+
+		bool scan(MapModel& model) {
+			out = &model;
+			// 4-byte identifier, then the root node
+			pos = 4;
+			return pos < data.size() && data[pos] == NODE_START && node(0);
+		}
+
+	private:
+		static constexpr uint8_t NODE_START = 0xFE;
+		static constexpr uint8_t NODE_END = 0xFF;
+		static constexpr uint8_t ESCAPE_CHAR = 0xFD;
+
+		// Parses the node at pos (which holds NODE_START) and everything below it.
+		// parent is the type of the enclosing node.
+		bool node(uint8_t parent) {
+			if (++pos >= data.size()) {
+				return false;
+			}
+			const uint8_t type = data[pos++];
+			std::vector<uint8_t> props;
+			while (pos < data.size() && data[pos] != NODE_START && data[pos] != NODE_END) {
+				if (data[pos] == ESCAPE_CHAR) {
+					++pos;
+				}
+				if (pos < data.size()) {
+					props.push_back(data[pos++]);
+				}
+			}
+
+			const bool tile = parent == OTBM_TILE_AREA && (type == OTBM_TILE || type == OTBM_HOUSETILE);
+			if (tile) {
+				beginTile(type, props);
+			}
+			bool has_children = false;
+			while (pos < data.size() && data[pos] == NODE_START) {
+				has_children = true;
+				if (!node(type)) {
+					return false;
+				}
+			}
+			if (pos >= data.size() || data[pos] != NODE_END) {
+				return false;
+			}
+			++pos;
+
+			if (tile) {
+				out->tile_begin.push_back(static_cast<uint32_t>(out->items.size()));
+			} else if (type == OTBM_ITEM && (parent == OTBM_TILE || parent == OTBM_HOUSETILE) && props.size() >= 2) {
+				const uint16_t id = static_cast<uint16_t>(props[0] | (props[1] << 8));
+				out->items.push_back(id | (!has_children && onlySubtype(props, 2) ? MapModel::PLAIN : 0));
+			}
+			return true;
+		}
+
+		void beginTile(uint8_t type, const std::vector<uint8_t>& props) {
+			// x and y offsets, then the house id on house tiles, then attributes
+			size_t at = type == OTBM_HOUSETILE ? 6 : 2;
+			while (at < props.size()) {
+				const uint8_t attribute = props[at++];
+				if (attribute == OTBM_ATTR_TILE_FLAGS) {
+					at += 4;
+				} else if (attribute == OTBM_ATTR_ITEM && at + 2 <= props.size()) {
+					out->items.push_back(props[at] | (props[at + 1] << 8) | MapModel::PLAIN);
+					at += 2;
+				} else {
+					break;
+				}
+			}
+		}
+
+		static bool onlySubtype(const std::vector<uint8_t>& props, size_t at) {
+			while (at < props.size()) {
+				const uint8_t attribute = props[at++];
+				if (attribute == OTBM_ATTR_COUNT || attribute == OTBM_ATTR_RUNE_CHARGES) {
+					at += 1;
+				} else if (attribute == OTBM_ATTR_CHARGES) {
+					at += 2;
+				} else {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		std::vector<uint8_t> data;
+		size_t pos = 0;
+		MapModel* out = nullptr;
+	};
+
+	template <typename T>
+	struct PointerTile {
+		std::unique_ptr<T> ground;
+		std::vector<std::unique_ptr<T>> items;
+	};
+
+	struct InlineTile {
+		uint32_t ground = 0; // id | subtype << 16, 0 when the ground is a full item
+		std::vector<uint32_t> items;
+		std::vector<std::unique_ptr<Pooled<CompactItem>>> full;
+	};
+
+	size_t residentBytes() {
+		size_t pages = 0;
+		size_t resident = 0;
+		if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+			if (std::fscanf(f, "%zu %zu", &pages, &resident) != 2) {
+				resident = 0;
+			}
+			std::fclose(f);
+		}
+		return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	}
+
+	void report(const char* name, const MapModel& model, size_t before) {
+		const size_t used = residentBytes() - before;
+		const size_t item_count = model.items.size();
+		std::printf("%-8s %10zu %10zu %10.1f MiB %10.1f B\n", name, model.tileCount(), item_count, used / (1024.0 * 1024.0), static_cast<double>(used) / item_count);
+		std::fflush(stdout);
+	}
+
+	template <typename T>
+	void runPointer(const char* name, const MapModel& model) {
+		const size_t before = residentBytes();
+		std::vector<PointerTile<T>> tiles(model.tileCount());
+		for (size_t t = 0; t < tiles.size(); ++t) {
+			const uint32_t begin = model.tile_begin[t];
+			const uint32_t end = model.tile_begin[t + 1];
+			if (begin == end) {
+				continue;
+			}
+			tiles[t].ground = std::make_unique<T>();
+			tiles[t].ground->id = static_cast<uint16_t>(model.items[begin]);
+			tiles[t].items.reserve(end - begin - 1);
+			for (uint32_t i = begin + 1; i < end; ++i) {
+				auto item = std::make_unique<T>();
+				item->id = static_cast<uint16_t>(model.items[i]);
+				tiles[t].items.push_back(std::move(item));
+			}
+		}
+		report(name, model, before);
+	}
+
+	void runInline(const MapModel& model) {
+		const size_t before = residentBytes();
+		std::vector<InlineTile> tiles(model.tileCount());
+		for (size_t t = 0; t < tiles.size(); ++t) {
+			InlineTile& tile = tiles[t];
+			for (uint32_t i = model.tile_begin[t]; i < model.tile_begin[t + 1]; ++i) {
+				const uint32_t item = model.items[i];
+				if (!(item & MapModel::PLAIN)) {
+					tile.full.push_back(std::make_unique<Pooled<CompactItem>>());
+					tile.full.back()->id = static_cast<uint16_t>(item);
+				} else if (i == model.tile_begin[t]) {
+					tile.ground = item & 0xFFFF;
+				} else {
+					tile.items.push_back(item & 0xFFFF);
+				}
+			}
+		}
+		report("inline", model, before);
+	}
+
+	bool loadOtbm(const char* path, MapModel& model) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			std::printf("Could not open %s\n", path);
+			return false;
+		}
+		std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (!OtbmScanner(std::move(data)).scan(model)) {
+			std::printf("%s is not a readable OTBM file\n", path);
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+	MapModel model;
+	const std::string arg = argc > 1 ? argv[1] : "";
+	if (!arg.empty() && arg.find_first_not_of("0123456789") != std::string::npos) {
+		if (!loadOtbm(argv[1], model)) {
+			return 1;
+		}
+		std::printf("Map: %s\n", argv[1]);
+	} else {
+		const size_t tile_count = arg.empty() ? 2048 * 2048 : std::strtoull(arg.c_str(), nullptr, 10);
+		if (tile_count == 0) {
+			std::printf("Usage: %s [tiles | map.otbm]\n", argv[0]);
+			return 1;
+		}
+		model = makeSyntheticMap(tile_count);
+		std::printf("Map: synthetic\n");
+	}
+	if (model.items.empty()) {
+		std::printf("The map has no items\n");
+		return 1;
+	}
+
+	std::printf("Item size: %zu bytes before, %zu bytes now\n", sizeof(LegacyItem), sizeof(CompactItem));
+	std::printf("Plain items: %zu of %zu (%.1f%%)\n", model.plainCount(), model.items.size(), 100.0 * model.plainCount() / model.items.size());
+	std::printf("%-8s %10s %10s %14s %12s\n", "layout", "tiles", "items", "resident", "per item");
+	std::fflush(stdout);
+
+	const auto isolated = [](auto&& body) {
+		const pid_t pid = fork();
+		if (pid == 0) {
+			body();
+			std::_Exit(0);
+		}
+		int status = 0;
+		waitpid(pid, &status, 0);
+		return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	};
+
+	bool ok = true;
+	ok &= isolated([&] { runPointer<LegacyItem>("heap", model); });
+	ok &= isolated([&] { runPointer<Pooled<LegacyItem>>("pool32", model); });
+	ok &= isolated([&] { runPointer<Pooled<CompactItem>>("pool24", model); });
+	ok &= isolated([&] { runInline(model); });
+	return ok ? 0 : 1;
+#else
+	(void)argc;
+	(void)argv;
+	std::printf("item_memory_benchmark reads /proc/self/statm and only runs on Linux.\n");
+	return 0;
+#endif
+}
@@ -0,0 +1,423 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// Replays a scripted town paste over a loopback live session and reports the
+// bytes on the wire and the time until the client has applied the last node,
+// for one full node per message (what protocol 5 sent), batched full nodes,
+// zlib, per-tile deltas and both. Batching follows LiveServer::broadcastNodes;
+// the client decodes and applies every packet, then its copy of the map is
+// checked against the server's. Pass a link speed in Mbit/s to also time a
+// throttled link (default 8).
+
+#include "live/live_node_codec.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace {
+	constexpr int NODES = 64; // 256x256 tiles
+	constexpr int PASTE_BEGIN = 8;
+	constexpr int PASTE_NODES = 48; // 192x192 tile town
+	constexpr int SIDE = NODES * 4;
+	constexpr int FLOORS = LiveNodeImage::FLOORS;
+	constexpr uint32_t SURFACE_MASK = 0x00FF;
+	constexpr size_t NODE_BATCH_SIZE = 64 * 1024; // LiveSocket::NODE_BATCH_SIZE
+
+	constexpr uint8_t NODE_START = 0xFE;
+	constexpr uint8_t NODE_END = 0xFF;
+	constexpr uint8_t ESCAPE_CHAR = 0xFD;
+	constexpr uint8_t OTBM_TILE = 5;
+	constexpr uint8_t OTBM_ITEM = 6;
+	constexpr uint8_t OTBM_ATTR_ITEM = 9;
+
+	constexpr uint8_t PACKET_NODE = 0x90;
+	constexpr uint8_t PACKET_NODE_DELTA = 0x95;
+	constexpr uint8_t PACKET_COMPRESSED = 0x7F;
+	constexpr uint8_t PACKET_END = 0x00; // Benchmark only: marks the end of the paste
+
+	using Tile = std::vector<uint8_t>;
+
+	// Serialized tiles per floor; a floor without storage does not exist.
+	struct World {
+		std::array<std::vector<Tile>, FLOORS> floors;
+
+		Tile& at(int z, int x, int y) {
+			if (floors[z].empty()) {
+				floors[z].resize(SIDE * SIDE);
+			}
+			return floors[z][y * SIDE + x];
+		}
+		const Tile* find(int z, int x, int y) const {
+			return floors[z].empty() ? nullptr : &floors[z][y * SIDE + x];
+		}
+	};
+
+	// Same shape as LiveSocket::sendTile output for plain items
+	Tile makeTile(uint16_t ground, std::initializer_list<uint16_t> items) {
+		Tile tile;
+		tile.reserve(6 + items.size() * 5);
+		tile.insert(tile.end(), { NODE_START, OTBM_TILE, OTBM_ATTR_ITEM, static_cast<uint8_t>(ground), static_cast<uint8_t>(ground >> 8) });
+		for (uint16_t item : items) {
+			tile.insert(tile.end(), { NODE_START, OTBM_ITEM, static_cast<uint8_t>(item), static_cast<uint8_t>(item >> 8), NODE_END });
+		}
+		tile.push_back(NODE_END);
+		return tile;
+	}
+
+	World makeTerrain() {
+		std::mt19937 rng(7);
+		std::uniform_int_distribution<int> grass(4526, 4541);
+		std::uniform_int_distribution<int> tree(2700, 2720);
+		std::uniform_int_distribution<int> percent(0, 99);
+
+		World world;
+		for (int y = 0; y < SIDE; ++y) {
+			for (int x = 0; x < SIDE; ++x) {
+				const uint16_t ground = static_cast<uint16_t>(grass(rng));
+				world.at(7, x, y) = percent(rng) < 10 ? makeTile(ground, { static_cast<uint16_t>(tree(rng)) }) : makeTile(ground, {});
+			}
+		}
+		return world;
+	}
+
+	// Streets, houses with walls and furniture, and roofs one floor up. About
+	// a quarter of the area keeps its terrain.
+	World pasteTown(const World& terrain) {
+		std::mt19937 rng(11);
+		std::uniform_int_distribution<int> percent(0, 99);
+		std::uniform_int_distribution<int> cobble(406, 410);
+		std::uniform_int_distribution<int> wall(1026, 1040);
+		std::uniform_int_distribution<int> decoration(1600, 1700);
+
+		World town = terrain;
+		const int begin = PASTE_BEGIN * 4;
+		const int end = (PASTE_BEGIN + PASTE_NODES) * 4;
+		for (int y = begin; y < end; ++y) {
+			for (int x = begin; x < end; ++x) {
+				const int roll = percent(rng);
+				if (roll < 35) {
+					town.at(7, x, y) = makeTile(static_cast<uint16_t>(cobble(rng)), {});
+				} else if (roll < 75) {
+					const bool walled = percent(rng) < 50;
+					const bool decorated = percent(rng) < 30;
+					if (walled && decorated) {
+						town.at(7, x, y) = makeTile(405, { static_cast<uint16_t>(wall(rng)), static_cast<uint16_t>(decoration(rng)) });
+					} else if (walled) {
+						town.at(7, x, y) = makeTile(405, { static_cast<uint16_t>(wall(rng)) });
+					} else if (decorated) {
+						town.at(7, x, y) = makeTile(405, { static_cast<uint16_t>(decoration(rng)) });
+					} else {
+						town.at(7, x, y) = makeTile(405, {});
+					}
+					town.at(6, x, y) = makeTile(1112, {});
+				}
+			}
+		}
+		return town;
+	}
+
+	void buildImage(const World& world, int ndx, int ndy, LiveNodeImage& image) {
+		image.clear(SURFACE_MASK);
+		for (int z = 0; z < 8; ++z) {
+			if (world.floors[z].empty()) {
+				continue;
+			}
+			image.addFloor(z);
+			for (int x = 0; x < 4; ++x) {
+				for (int y = 0; y < 4; ++y) {
+					const Tile& tile = *world.find(z, ndx * 4 + x, ndy * 4 + y);
+					if (!tile.empty()) {
+						image.addTile(z, x * 4 + y, tile);
+					}
+				}
+			}
+		}
+	}
+
+	// Splits a tile stream (tile nodes + NODE_END) at the top level nodes.
+	bool applyStream(World& world, const LiveFloorPatch& patch, int ndx, int ndy) {
+		size_t offset = 0;
+		for (int index = 0; index < LiveNodeImage::TILES; ++index) {
+			const int x = ndx * 4 + index / 4;
+			const int y = ndy * 4 + index % 4;
+			if (patch.changedBits & (1 << index)) {
+				const size_t begin = offset;
+				int depth = 0;
+				do {
+					if (offset >= patch.stream.size()) {
+						return false;
+					}
+					const uint8_t byte = patch.stream[offset++];
+					if (byte == ESCAPE_CHAR) {
+						++offset;
+					} else if (byte == NODE_START) {
+						++depth;
+					} else if (byte == NODE_END) {
+						--depth;
+					}
+				} while (depth > 0);
+				world.at(patch.z, x, y).assign(patch.stream.begin() + begin, patch.stream.begin() + offset);
+			} else if (patch.clearedBits & (1 << index)) {
+				world.at(patch.z, x, y).clear();
+			}
+		}
+		return true;
+	}
+
+	bool sameTiles(const World& a, const World& b) {
+		for (int z = 0; z < FLOORS; ++z) {
+			for (int y = 0; y < SIDE; ++y) {
+				for (int x = 0; x < SIDE; ++x) {
+					const Tile* left = a.find(z, x, y);
+					const Tile* right = b.find(z, x, y);
+					const bool leftEmpty = !left || left->empty();
+					const bool rightEmpty = !right || right->empty();
+					if (leftEmpty != rightEmpty || (!leftEmpty && *left != *right)) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	struct Mode {
+		const char* name;
+		bool batch;
+		bool compress;
+		bool delta;
+	};
+
+	struct Result {
+		size_t bytes = 0;
+		size_t messages = 0;
+		double milliseconds = 0;
+		bool ok = false;
+	};
+
+	template <typename T>
+	void put(std::vector<uint8_t>& out, T value) {
+		const size_t offset = out.size();
+		out.resize(offset + sizeof(T));
+		memcpy(out.data() + offset, &value, sizeof(T));
+	}
+
+	template <typename T>
+	T take(std::span<const uint8_t> in, size_t& offset) {
+		T value;
+		memcpy(&value, in.data() + offset, sizeof(T));
+		offset += sizeof(T);
+		return value;
+	}
+
+	// Size header, then the packets or their PACKET_COMPRESSED envelope, the
+	// way LiveSocket::finishMessage frames them.
+	void frame(std::vector<uint8_t>& out, const std::vector<uint8_t>& packets, bool compress, std::vector<uint8_t>& scratch) {
+		out.clear();
+		if (compress && packets.size() >= LiveNodeCodec::MIN_COMPRESS_SIZE && LiveNodeCodec::compress(packets, scratch)) {
+			put<uint32_t>(out, static_cast<uint32_t>(1 + 4 + 4 + scratch.size()));
+			put<uint8_t>(out, PACKET_COMPRESSED);
+			put<uint32_t>(out, static_cast<uint32_t>(packets.size()));
+			put<uint32_t>(out, static_cast<uint32_t>(scratch.size()));
+			out.insert(out.end(), scratch.begin(), scratch.end());
+		} else {
+			put<uint32_t>(out, static_cast<uint32_t>(packets.size()));
+			out.insert(out.end(), packets.begin(), packets.end());
+		}
+	}
+
+	// A message holds any number of packets, possibly inside one envelope.
+	bool applyMessage(World& world, std::span<const uint8_t> message, std::vector<uint8_t>& inflated, std::vector<LiveFloorPatch>& patches, bool& finished) {
+		size_t offset = 0;
+		if (message[0] == PACKET_COMPRESSED) {
+			++offset;
+			inflated.resize(take<uint32_t>(message, offset));
+			const uint32_t length = take<uint32_t>(message, offset);
+			if (!LiveNodeCodec::decompress(message.subspan(offset, length), inflated)) {
+				return false;
+			}
+			message = inflated;
+			offset = 0;
+		}
+
+		while (offset < message.size()) {
+			const uint8_t type = take<uint8_t>(message, offset);
+			if (type == PACKET_END) {
+				finished = true;
+				return true;
+			} else if (type != PACKET_NODE && type != PACKET_NODE_DELTA) {
+				return false;
+			}
+
+			const uint32_t ind = take<uint32_t>(message, offset);
+			const size_t length = LiveNodeCodec::read(message.subspan(offset), patches);
+			if (length == 0) {
+				return false;
+			}
+			offset += length;
+
+			for (const LiveFloorPatch& patch : patches) {
+				if (!applyStream(world, patch, ind >> 18, (ind >> 4) & 0x3FFF)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	Result run(const Mode& mode, const World& before, const World& after, double mbit) {
+		using boost::asio::ip::tcp;
+		boost::asio::io_context service;
+		tcp::acceptor acceptor(service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+		tcp::socket server(service);
+		tcp::socket client(service);
+		client.connect(acceptor.local_endpoint());
+		acceptor.accept(server);
+		server.set_option(tcp::no_delay(true));
+		client.set_option(tcp::no_delay(true));
+
+		// Both sides start out agreeing on the terrain, as after the initial node requests.
+		std::vector<LiveNodeBaseline> baselines(PASTE_NODES * PASTE_NODES);
+		LiveNodeImage image;
+		for (int ny = 0; ny < PASTE_NODES; ++ny) {
+			for (int nx = 0; nx < PASTE_NODES; ++nx) {
+				buildImage(before, PASTE_BEGIN + nx, PASTE_BEGIN + ny, image);
+				baselines[ny * PASTE_NODES + nx].update(image);
+			}
+		}
+
+		Result result;
+		World received = before;
+		std::chrono::steady_clock::time_point applied;
+		bool clientOk = false;
+
+		std::thread reader([&] {
+			std::vector<uint8_t> packet;
+			std::vector<uint8_t> inflated;
+			std::vector<LiveFloorPatch> patches;
+			bool finished = false;
+			try {
+				while (!finished) {
+					uint32_t size;
+					boost::asio::read(client, boost::asio::buffer(&size, sizeof(size)));
+					packet.resize(size);
+					boost::asio::read(client, boost::asio::buffer(packet));
+					if (!applyMessage(received, packet, inflated, patches, finished)) {
+						return;
+					}
+					if (!finished) {
+						applied = std::chrono::steady_clock::now();
+					}
+				}
+				clientOk = true;
+			} catch (const std::exception& e) {
+				std::printf("client: %s\n", e.what());
+			}
+		});
+
+		const double bytesPerSecond = mbit > 0 ? mbit * 1000.0 * 1000.0 / 8.0 : 0;
+		std::vector<uint8_t> batch;
+		std::vector<uint8_t> wire;
+		std::vector<uint8_t> scratch;
+		const auto start = std::chrono::steady_clock::now();
+
+		auto transmit = [&] {
+			frame(wire, batch, mode.compress, scratch);
+			batch.clear();
+			boost::asio::write(server, boost::asio::buffer(wire));
+			result.bytes += wire.size();
+			++result.messages;
+			if (bytesPerSecond > 0) {
+				std::this_thread::sleep_until(start + std::chrono::duration<double>(result.bytes / bytesPerSecond));
+			}
+		};
+
+		for (int ny = 0; ny < PASTE_NODES; ++ny) {
+			for (int nx = 0; nx < PASTE_NODES; ++nx) {
+				const int ndx = PASTE_BEGIN + nx;
+				const int ndy = PASTE_BEGIN + ny;
+				buildImage(after, ndx, ndy, image);
+
+				LiveNodeBaseline& baseline = baselines[ny * PASTE_NODES + nx];
+				const LiveNodeDiff diff = mode.delta ? LiveNodeCodec::diff(image, baseline) : LiveNodeCodec::full(image);
+				if (diff.empty()) {
+					continue;
+				}
+				baseline.update(image);
+
+				put<uint8_t>(batch, mode.delta ? PACKET_NODE_DELTA : PACKET_NODE);
+				put<uint32_t>(batch, (static_cast<uint32_t>(ndx) << 18) | (static_cast<uint32_t>(ndy) << 4));
+				LiveNodeCodec::write(batch, image, diff);
+				if (!mode.batch || batch.size() >= NODE_BATCH_SIZE) {
+					transmit();
+				}
+			}
+		}
+		if (!batch.empty()) {
+			transmit();
+		}
+
+		batch.assign(1, PACKET_END);
+		frame(wire, batch, false, scratch);
+		boost::asio::write(server, boost::asio::buffer(wire));
+		reader.join();
+
+		result.milliseconds = std::chrono::duration<double, std::milli>(applied - start).count();
+		result.ok = clientOk && sameTiles(received, after);
+		return result;
+	}
+}
+
+int main(int argc, char** argv) {
+	const double throttled = argc > 1 ? std::atof(argv[1]) : 8.0;
+
+	const World terrain = makeTerrain();
+	const World town = pasteTown(terrain);
+
+	const Mode modes[] = {
+		{ "v5 full nodes", false, false, false },
+		{ "full, batched", true, false, false },
+		{ "full + zlib", true, true, false },
+		{ "tile delta", true, false, true },
+		{ "delta + zlib", true, true, true },
+	};
+
+	char throttledLabel[32];
+	std::snprintf(throttledLabel, sizeof(throttledLabel), "%.0f Mbit/s ms", throttled);
+
+	std::printf("Pasting a %dx%d tile town (%d nodes) over loopback\n", PASTE_NODES * 4, PASTE_NODES * 4, PASTE_NODES * PASTE_NODES);
+	std::printf("%-14s %8s %12s %12s %16s\n", "mode", "messages", "bytes", "loopback ms", throttled > 0 ? throttledLabel : "");
+
+	bool ok = true;
+	for (const Mode& mode : modes) {
+		const Result fast = run(mode, terrain, town, 0);
+		const Result slow = throttled > 0 ? run(mode, terrain, town, throttled) : Result { .ok = true };
+		ok = ok && fast.ok && slow.ok;
+
+		std::printf("%-14s %8zu %12zu %12.1f %16.1f%s\n", mode.name, fast.messages, fast.bytes, fast.milliseconds, slow.milliseconds, fast.ok && slow.ok ? "" : "  MISMATCH");
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// Compares the byte-at-a-time node escaping loops the editor used to run with
+// the word-at-a-time NodeEscape routines, on a few payload shapes that show up
+// in real OTBM files.
+
+#include "io/node_escape.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+	constexpr uint8_t ESCAPE_CHAR = 0xFD;
+	constexpr size_t PAYLOAD_SIZE = 16 * 1024 * 1024;
+	constexpr int ITERATIONS = 20;
+
+	size_t scalarEscape(const uint8_t* src, size_t size, uint8_t* dst) {
+		uint8_t* out = dst;
+		for (size_t i = 0; i < size; ++i) {
+			const uint8_t c = src[i];
+			if (c == 0xFE || c == 0xFF || c == ESCAPE_CHAR) {
+				*out++ = ESCAPE_CHAR;
+			}
+			*out++ = c;
+		}
+		return out - dst;
+	}
+
+	size_t scalarUnescape(const uint8_t* src, size_t size, uint8_t* dst) {
+		uint8_t* out = dst;
+		for (size_t i = 0; i < size; ++i) {
+			if (src[i] == ESCAPE_CHAR && i + 1 < size) {
+				++i;
+			}
+			*out++ = src[i];
+		}
+		return out - dst;
+	}
+
+	// special_per_mille: how many bytes out of 1000 are >= 0xFD.
+	std::vector<uint8_t> makePayload(int special_per_mille, uint32_t seed) {
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<int> per_mille(0, 999);
+		std::uniform_int_distribution<int> plain(0, 0xFC);
+		std::uniform_int_distribution<int> special(0xFD, 0xFF);
+
+		std::vector<uint8_t> data(PAYLOAD_SIZE);
+		for (uint8_t& c : data) {
+			c = static_cast<uint8_t>(per_mille(rng) < special_per_mille ? special(rng) : plain(rng));
+		}
+		return data;
+	}
+
+	template <typename Fn>
+	double measureMBps(Fn&& fn, size_t bytes) {
+		fn(); // warm-up
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < ITERATIONS; ++i) {
+			fn();
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return (static_cast<double>(bytes) * ITERATIONS) / (1024.0 * 1024.0) / elapsed.count();
+	}
+}
+
+int main() {
+	struct Case {
+		const char* name;
+		int special_per_mille;
+	};
+	const Case cases[] = {
+		{ "no specials", 0 },
+		{ "typical map (0.5%)", 5 },
+		{ "dense (5%)", 50 },
+		{ "worst case (30%)", 300 },
+	};
+
+#if defined(RME_NODE_ESCAPE_AVX2)
+	std::printf("NodeEscape path: AVX2\n");
+#elif defined(RME_NODE_ESCAPE_SSE2)
+	std::printf("NodeEscape path: SSE2\n");
+#else
+	std::printf("NodeEscape path: SWAR\n");
+#endif
+	std::printf("%-22s %14s %14s %14s %14s\n", "payload", "esc scalar", "esc fast", "unesc scalar", "unesc fast");
+
+	bool ok = true;
+	uint32_t seed = 1;
+	for (const Case& c : cases) {
+		const std::vector<uint8_t> input = makePayload(c.special_per_mille, seed++);
+		std::vector<uint8_t> escaped_ref(input.size() * 2);
+		std::vector<uint8_t> escaped(input.size() * 2);
+		std::vector<uint8_t> decoded_ref(input.size());
+		std::vector<uint8_t> decoded(input.size());
+
+		size_t escaped_size = 0;
+		size_t escaped_ref_size = 0;
+		size_t decoded_size = 0;
+		size_t decoded_ref_size = 0;
+
+		const double esc_scalar = measureMBps([&] { escaped_ref_size = scalarEscape(input.data(), input.size(), escaped_ref.data()); }, input.size());
+		const double esc_fast = measureMBps([&] { escaped_size = NodeEscape::escape(input.data(), input.size(), escaped.data()); }, input.size());
+		const double unesc_scalar = measureMBps([&] { decoded_ref_size = scalarUnescape(escaped_ref.data(), escaped_ref_size, decoded_ref.data()); }, escaped_ref_size);
+		const double unesc_fast = measureMBps([&] { decoded_size = NodeEscape::unescape(escaped.data(), escaped_size, decoded.data()); }, escaped_size);
+
+		if (escaped_size != escaped_ref_size || std::memcmp(escaped.data(), escaped_ref.data(), escaped_size) != 0) {
+			std::printf("MISMATCH: escaped output differs for '%s'\n", c.name);
+			ok = false;
+		}
+		if (decoded_size != input.size() || decoded_ref_size != input.size() || std::memcmp(decoded.data(), input.data(), input.size()) != 0) {
+			std::printf("MISMATCH: round trip failed for '%s'\n", c.name);
+			ok = false;
+		}
+
+		std::printf("%-22s %9.0f MB/s %9.0f MB/s %9.0f MB/s %9.0f MB/s\n", c.name, esc_scalar, esc_fast, unesc_scalar, unesc_fast);
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,482 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// Loads a map with its client assets and runs MapLayerDrawer over scripted
+// camera paths, without a window or GL context: the atlas only hands out
+// slots and the sprite batch records instances instead of flushing them.
+// Reports time, recorded instances and heap allocations per frame, with the
+// render cache on and off.
+
+#include "app/main.h"
+
+#include "app/client_version.h"
+#include "app/managers/version_manager.h"
+#include "app/settings.h"
+#include "editor/editor.h"
+#include "editor/persistence/map_load_options.h"
+#include "io/iomap_otbm.h"
+#include "rendering/core/atlas_manager.h"
+#include "rendering/core/drawing_options.h"
+#include "rendering/core/graphics.h"
+#include "rendering/core/light_buffer.h"
+#include "rendering/core/render_view.h"
+#include "rendering/core/sprite_batch.h"
+#include "rendering/core/sprite_preloader.h"
+#include "rendering/drawers/entities/creature_drawer.h"
+#include "rendering/drawers/entities/creature_name_drawer.h"
+#include "rendering/drawers/entities/item_drawer.h"
+#include "rendering/drawers/entities/sprite_drawer.h"
+#include "rendering/drawers/map_layer_drawer.h"
+#include "rendering/drawers/overlays/grid_drawer.h"
+#include "rendering/drawers/overlays/marker_drawer.h"
+#include "rendering/drawers/tiles/floor_drawer.h"
+#include "rendering/drawers/tiles/tile_renderer.h"
+#include "rendering/ui/tooltip_drawer.h"
+#include "ui/gui.h"
+#include "util/file_system.h"
+
+#include <wx/init.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+//=============================================================================
+// Allocation counting
+
+namespace {
+	// Counts every allocation in the process, worker threads included.
+	std::atomic<uint64_t> allocation_count { 0 };
+
+	void* countedAllocate(std::size_t size) {
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		if (void* ptr = std::malloc(size ? size : 1)) {
+			return ptr;
+		}
+		throw std::bad_alloc();
+	}
+
+	void* countedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		const std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+		void* ptr = _aligned_malloc(size ? size : 1, align);
+#else
+		void* ptr = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) & ~(align - 1));
+#endif
+		if (!ptr) {
+			throw std::bad_alloc();
+		}
+		return ptr;
+	}
+
+	void releaseAligned(void* ptr) noexcept {
+#ifdef _MSC_VER
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+}
+
+void* operator new(std::size_t size) {
+	return countedAllocate(size);
+}
+void* operator new[](std::size_t size) {
+	return countedAllocate(size);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	return countedAllocateAligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return countedAllocateAligned(size, alignment);
+}
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+void operator delete[](void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept {
+	releaseAligned(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+	releaseAligned(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+	releaseAligned(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+	releaseAligned(ptr);
+}
+
+//=============================================================================
+// Benchmark
+
+namespace {
+	struct Options {
+		std::string map_path;
+		std::string client_id;
+		std::string client_path;
+		int frames = 240;
+		int warmup = 30;
+		int width = 1920;
+		int height = 1080;
+		int center_x = -1;
+		int center_y = -1;
+		int floor = GROUND_LAYER;
+	};
+
+	// Centre of the view in map pixels, so paths can move by less than a tile.
+	struct Camera {
+		int x;
+		int y;
+		int floor;
+		float zoom;
+	};
+
+	struct PathResult {
+		double ns_mean = 0;
+		double ns_p95 = 0;
+		double instances = 0;
+		double allocations = 0;
+		double nodes_replayed = 0;
+		double nodes_recorded = 0;
+		double nodes_live = 0;
+	};
+
+	std::vector<Camera> staticPath(const Camera& start, int frames) {
+		return std::vector<Camera>(frames, start);
+	}
+
+	std::vector<Camera> panPath(const Camera& start, int frames) {
+		// Roughly what holding an arrow key does: half a tile per frame
+		std::vector<Camera> path;
+		for (int i = 0; i < frames; ++i) {
+			path.push_back({ start.x + i * TILE_SIZE / 2, start.y + i * TILE_SIZE / 4, start.floor, start.zoom });
+		}
+		return path;
+	}
+
+	std::vector<Camera> zoomPath(const Camera& start, int frames) {
+		static constexpr float levels[] = { 1.0f, 1.25f, 1.5f, 2.0f, 3.0f, 4.0f, 3.0f, 2.0f, 1.5f, 1.25f, 1.0f, 0.5f };
+		std::vector<Camera> path;
+		for (int i = 0; i < frames; ++i) {
+			path.push_back({ start.x, start.y, start.floor, levels[i % std::size(levels)] });
+		}
+		return path;
+	}
+
+	std::vector<Camera> floorPath(const Camera& start, int frames) {
+		// Up to the top floor, down to the bottom one and back, a few frames each
+		std::vector<int> floors;
+		for (int z = start.floor; z > 0; --z) {
+			floors.push_back(z);
+		}
+		for (int z = 0; z < MAP_MAX_LAYER; ++z) {
+			floors.push_back(z);
+		}
+		for (int z = MAP_MAX_LAYER; z > start.floor; --z) {
+			floors.push_back(z);
+		}
+
+		constexpr int FRAMES_PER_FLOOR = 4;
+		std::vector<Camera> path;
+		for (int i = 0; i < frames; ++i) {
+			path.push_back({ start.x, start.y, floors[(i / FRAMES_PER_FLOOR) % floors.size()], start.zoom });
+		}
+		return path;
+	}
+
+	class RenderListBenchmark {
+	public:
+		RenderListBenchmark(Editor& editor, const Options& options) :
+			tile_renderer(&item_drawer, &sprite_drawer, &creature_drawer, &creature_name_drawer, &floor_drawer, &marker_drawer, &tooltip_drawer, &editor),
+			layer_drawer(&tile_renderer, &grid_drawer, &editor),
+			width(options.width),
+			height(options.height) {
+		}
+
+		PathResult run(const std::vector<Camera>& path, int warmup, bool use_cache) {
+			layer_drawer.SetRenderCacheEnabled(use_cache);
+
+			// Sprites are decoded by the preloader threads and only show up a
+			// few frames later; keep drawing the first view until they settle.
+			for (int i = 0; i < warmup; ++i) {
+				drawFrame(path.front());
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
+
+			std::vector<int64_t> times;
+			times.reserve(path.size());
+			PathResult result;
+
+			const uint64_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+			for (const Camera& camera : path) {
+				const auto start = std::chrono::steady_clock::now();
+				drawFrame(camera);
+				const auto end = std::chrono::steady_clock::now();
+				times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+				const MapRenderCache::Statistics& stats = layer_drawer.GetRenderCache().getStatistics();
+				result.instances += sprite_batch.getRecordedInstances().size();
+				if (use_cache) {
+					result.nodes_replayed += stats.nodes_replayed;
+					result.nodes_recorded += stats.nodes_recorded;
+					result.nodes_live += stats.nodes_live;
+				}
+			}
+			const uint64_t allocations = allocation_count.load(std::memory_order_relaxed) - allocations_before;
+
+			const double frames = static_cast<double>(path.size());
+			int64_t total = 0;
+			for (int64_t t : times) {
+				total += t;
+			}
+			std::ranges::sort(times);
+
+			result.ns_mean = total / frames;
+			result.ns_p95 = static_cast<double>(times[std::min(times.size() - 1, times.size() * 95 / 100)]);
+			result.instances /= frames;
+			result.allocations = allocations / frames;
+			result.nodes_replayed /= frames;
+			result.nodes_recorded /= frames;
+			result.nodes_live /= frames;
+			return result;
+		}
+
+	private:
+		// Mirrors MapDrawer::Draw/DrawMap for the map layers
+		void drawFrame(const Camera& camera) {
+			g_gui.gfx.updateTime();
+			light_buffer.Clear();
+			creature_name_drawer.clear();
+			tooltip_drawer.clear();
+
+			const int scroll_x = camera.x - static_cast<int>(width * camera.zoom / 2);
+			const int scroll_y = camera.y - static_cast<int>(height * camera.zoom / 2);
+			view.SetupOffscreen(scroll_x, scroll_y, width, height, camera.zoom, camera.floor, drawing_options);
+
+			const AtlasManager& atlas = *g_gui.gfx.getAtlasManager();
+			layer_drawer.BeginFrame(atlas);
+			sprite_batch.beginRecording();
+
+			for (int map_z = view.start_z; map_z >= view.superend_z; map_z--) {
+				if (view.draw_all_visited_floors || map_z >= view.end_z) {
+					layer_drawer.Draw(sprite_batch, map_z, false, view, drawing_options, light_buffer);
+				}
+
+				--view.start_x;
+				--view.start_y;
+				++view.end_x;
+				++view.end_y;
+			}
+
+			sprite_batch.end(atlas);
+		}
+
+		ItemDrawer item_drawer;
+		SpriteDrawer sprite_drawer;
+		CreatureDrawer creature_drawer;
+		CreatureNameDrawer creature_name_drawer;
+		FloorDrawer floor_drawer;
+		MarkerDrawer marker_drawer;
+		TooltipDrawer tooltip_drawer;
+		TileRenderer tile_renderer;
+		GridDrawer grid_drawer;
+		MapLayerDrawer layer_drawer;
+
+		SpriteBatch sprite_batch;
+		RenderView view {};
+		DrawingOptions drawing_options;
+		LightBuffer light_buffer;
+		int width;
+		int height;
+	};
+
+	void printUsage() {
+		std::printf(
+			"usage: render_list_benchmark <map.otbm> [options]\n"
+			"  --client <id>         client version from clients.toml (default: best match for the map)\n"
+			"  --client-path <dir>   directory holding the client .dat/.spr\n"
+			"  --frames <n>          frames per camera path (default 240)\n"
+			"  --warmup <n>          untimed frames before each path (default 30)\n"
+			"  --size <w>x<h>        viewport in screen pixels (default 1920x1080)\n"
+			"  --center <x>,<y>,<z>  starting camera position (default: middle of the map, floor 7)\n"
+		);
+	}
+
+	bool parseArguments(int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; ++i) {
+			const char* arg = argv[i];
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+			if (arg[0] != '-') {
+				options.map_path = arg;
+				continue;
+			}
+			if (!value) {
+				return false;
+			}
+			++i;
+			if (std::strcmp(arg, "--client") == 0) {
+				options.client_id = value;
+			} else if (std::strcmp(arg, "--client-path") == 0) {
+				options.client_path = value;
+			} else if (std::strcmp(arg, "--frames") == 0) {
+				options.frames = std::max(1, std::atoi(value));
+			} else if (std::strcmp(arg, "--warmup") == 0) {
+				options.warmup = std::max(0, std::atoi(value));
+			} else if (std::strcmp(arg, "--size") == 0) {
+				if (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0) {
+					return false;
+				}
+			} else if (std::strcmp(arg, "--center") == 0) {
+				if (std::sscanf(value, "%d,%d,%d", &options.center_x, &options.center_y, &options.floor) != 3) {
+					return false;
+				}
+				options.floor = std::clamp(options.floor, 0, MAP_MAX_LAYER);
+			} else {
+				return false;
+			}
+		}
+		return !options.map_path.empty();
+	}
+
+	// Loads the client data and the map the way EditorManager::LoadMap does,
+	// minus every dialog.
+	std::unique_ptr<Editor> loadEditor(const Options& options) {
+		const FileName map_file(wxstr(options.map_path));
+		MapVersion map_version;
+		if (!IOMapOTBM::getVersionInfo(map_file, map_version)) {
+			std::fprintf(stderr, "%s is not a valid OTBM file\n", options.map_path.c_str());
+			return nullptr;
+		}
+
+		ClientVersion* client = options.client_id.empty() ? ClientVersion::getBestMatch(map_version.client) : ClientVersion::get(options.client_id);
+		if (!client) {
+			std::fprintf(stderr, "No client version found for this map; pass --client\n");
+			return nullptr;
+		}
+		if (!options.client_path.empty()) {
+			FileName client_dir;
+			client_dir.AssignDir(wxstr(options.client_path));
+			client->setClientPath(client_dir);
+		}
+
+		wxString error;
+		std::vector<std::string> warnings;
+		if (!g_version.LoadVersionData(client->getID(), error, warnings)) {
+			std::fprintf(stderr, "Could not load client %s: %s\n", client->getName().c_str(), nstr(error).c_str());
+			return nullptr;
+		}
+
+		MapLoadOptions load_options;
+		load_options.force_client_mismatch = true;
+		try {
+			return std::make_unique<Editor>(g_gui.copybuffer, map_version, map_file, load_options);
+		} catch (const std::exception& e) {
+			std::fprintf(stderr, "Could not load map: %s\n", e.what());
+		}
+		return nullptr;
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseArguments(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	// Skip the editor's wxApp: without a registered initializer wx falls back
+	// to a console app, so nothing tries to open a display.
+	wxApp::SetInitializerFunction(nullptr);
+	wxInitializer initializer(argc, argv);
+	if (!initializer.IsOk()) {
+		std::fprintf(stderr, "Failed to initialize wxWidgets\n");
+		return 1;
+	}
+
+	spdlog::set_level(spdlog::level::warn);
+
+	g_settings.load();
+	FileSystem::DiscoverDataDirectory("menubar.xml");
+	ClientVersion::loadVersions();
+	g_gui.gfx.setHeadless(true);
+
+	int result = 1;
+	if (std::unique_ptr<Editor> editor = loadEditor(options)) {
+		if (g_gui.gfx.ensureAtlasManager()) {
+			const Camera start {
+				.x = (options.center_x >= 0 ? options.center_x : editor->map.getWidth() / 2) * TILE_SIZE + TILE_SIZE / 2,
+				.y = (options.center_y >= 0 ? options.center_y : editor->map.getHeight() / 2) * TILE_SIZE + TILE_SIZE / 2,
+				.floor = options.floor,
+				.zoom = 1.0f,
+			};
+
+			struct Path {
+				const char* name;
+				std::vector<Camera> cameras;
+			};
+			const Path paths[] = {
+				{ "static", staticPath(start, options.frames) },
+				{ "pan", panPath(start, options.frames) },
+				{ "zoom", zoomPath(start, options.frames) },
+				{ "floor", floorPath(start, options.frames) },
+			};
+
+			std::printf("%s, %d tiles, %dx%d viewport, %d frames per path\n", options.map_path.c_str(), static_cast<int>(editor->map.getTileCount()), options.width, options.height, options.frames);
+			std::printf("%-8s %-6s %12s %12s %12s %12s %10s %10s %10s\n", "path", "cache", "ns/frame", "p95 ns", "instances", "allocs", "replayed", "recorded", "live");
+
+			RenderListBenchmark benchmark(*editor, options);
+			for (const Path& path : paths) {
+				for (bool use_cache : { false, true }) {
+					const PathResult r = benchmark.run(path.cameras, options.warmup, use_cache);
+					std::printf("%-8s %-6s %12.0f %12.0f %12.0f %12.1f", path.name, use_cache ? "on" : "off", r.ns_mean, r.ns_p95, r.instances, r.allocations);
+					if (use_cache) {
+						std::printf(" %10.1f %10.1f %10.1f\n", r.nodes_replayed, r.nodes_recorded, r.nodes_live);
+					} else {
+						std::printf(" %10s %10s %10s\n", "-", "-", "-");
+					}
+				}
+			}
+			result = 0;
+		} else {
+			std::fprintf(stderr, "Could not create the sprite atlas\n");
+		}
+	}
+
+	g_version.UnloadVersion();
+	SpritePreloader::get().shutdown();
+	ClientVersion::unloadVersions();
+	return result;
+}
@@ -0,0 +1,260 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// Builds a SimilarityIndex over synthetic item icons (mostly 32x32, some 64
+// pixel sides, a fifth of them opaque) and times FindSimilar queries against
+// the per-pixel comparison the replace tool used before: std::vector<bool>
+// masks, nearest neighbour resizing on every size mismatch. Both must return
+// the same items. Also times a save/load round trip of the index file.
+
+#include "ui/replace_tool/similarity_index.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+	constexpr int ITEMS = 30000;
+	constexpr int QUERIES = 200;
+	constexpr size_t RESULTS = 50;
+
+	struct Icon {
+		uint16_t id;
+		int width;
+		int height;
+		std::vector<uint8_t> rgba;
+	};
+
+	// Blobs over a transparent background, or noise over a full tile.
+	Icon makeIcon(uint16_t id, std::mt19937& rng) {
+		static constexpr int SIDES[][2] = { { 32, 32 }, { 32, 32 }, { 32, 32 }, { 32, 32 }, { 32, 32 }, { 32, 32 }, { 64, 32 }, { 32, 64 }, { 64, 64 } };
+		const auto& side = SIDES[rng() % std::size(SIDES)];
+
+		Icon icon { id, side[0], side[1], {} };
+		icon.rgba.assign(static_cast<size_t>(icon.width) * icon.height * 4, 0);
+		const bool opaque = rng() % 5 == 0;
+		const int cx = static_cast<int>(rng() % icon.width);
+		const int cy = static_cast<int>(rng() % icon.height);
+		const int radius = 6 + static_cast<int>(rng() % 20);
+		for (int y = 0; y < icon.height; ++y) {
+			for (int x = 0; x < icon.width; ++x) {
+				uint8_t* pixel = &icon.rgba[(static_cast<size_t>(y) * icon.width + x) * 4];
+				const bool inside = (x - cx) * (x - cx) + (y - cy) * (y - cy) < radius * radius;
+				if (opaque || inside) {
+					pixel[0] = static_cast<uint8_t>(rng());
+					pixel[1] = static_cast<uint8_t>(x * 4);
+					pixel[2] = static_cast<uint8_t>(y * 4);
+					pixel[3] = 255;
+				}
+			}
+		}
+		return icon;
+	}
+
+	// The comparison as it was, kept here as the reference.
+	struct ReferenceItem {
+		uint16_t id;
+		int width;
+		int height;
+		bool isOpaque;
+		uint64_t aHash;
+		std::vector<bool> mask;
+		int truePixels;
+	};
+
+	ReferenceItem makeReference(const SimilarityFeatures& features) {
+		ReferenceItem item { features.id, features.width, features.height, features.isOpaque, features.aHash, {}, static_cast<int>(features.truePixels) };
+		item.mask.resize(static_cast<size_t>(features.width) * features.height);
+		for (size_t i = 0; i < item.mask.size(); ++i) {
+			item.mask[i] = (features.mask[i / 64] >> (i % 64)) & 1;
+		}
+		return item;
+	}
+
+	std::vector<bool> resizeMask(const std::vector<bool>& src, int srcW, int srcH, int dstW, int dstH) {
+		std::vector<bool> dst(dstW * dstH);
+		for (int y = 0; y < dstH; ++y) {
+			for (int x = 0; x < dstW; ++x) {
+				int sx = std::min((x * srcW) / dstW, srcW - 1);
+				int sy = std::min((y * srcH) / dstH, srcH - 1);
+				dst[y * dstW + x] = src[sy * srcW + sx];
+			}
+		}
+		return dst;
+	}
+
+	std::vector<uint16_t> referenceFindSimilar(const std::vector<ReferenceItem>& items, const ReferenceItem& source, size_t count) {
+		struct ScoredItem {
+			uint16_t id;
+			double score;
+			bool operator<(const ScoredItem& other) const {
+				if (std::abs(score - other.score) > 0.00001) {
+					return score > other.score;
+				}
+				return id < other.id;
+			}
+		};
+		std::vector<ScoredItem> candidates;
+
+		for (const ReferenceItem& target : items) {
+			if (target.id == source.id || target.isOpaque != source.isOpaque) {
+				continue;
+			}
+
+			double score = 0.0;
+			if (source.isOpaque) {
+				score = 1.0 - (static_cast<double>(std::popcount(source.aHash ^ target.aHash)) / 64.0);
+			} else {
+				int tp = 0;
+				int sourceOnes = source.truePixels;
+				int targetOnes = target.truePixels;
+				if (source.width == target.width && source.height == target.height) {
+					for (size_t i = 0; i < source.mask.size(); ++i) {
+						if (source.mask[i] && target.mask[i]) {
+							tp++;
+						}
+					}
+				} else {
+					int w = std::max(source.width, target.width);
+					int h = std::max(source.height, target.height);
+					auto m1 = resizeMask(source.mask, source.width, source.height, w, h);
+					auto m2 = resizeMask(target.mask, target.width, target.height, w, h);
+					sourceOnes = 0;
+					targetOnes = 0;
+					for (size_t i = 0; i < m1.size(); ++i) {
+						sourceOnes += m1[i];
+						targetOnes += m2[i];
+						tp += m1[i] && m2[i];
+					}
+				}
+				if (tp > 0) {
+					score = (2.0 * tp) / (double)(sourceOnes + targetOnes);
+				}
+			}
+
+			if (score > 0.0) {
+				candidates.push_back({ target.id, score });
+			}
+		}
+
+		count = std::min(count, candidates.size());
+		std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+		std::vector<uint16_t> results;
+		for (size_t i = 0; i < count; ++i) {
+			results.push_back(candidates[i].id);
+		}
+		return results;
+	}
+
+	double millisecondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main() {
+#if defined(__AVX2__)
+	std::printf("Popcount path: AVX2\n");
+#else
+	std::printf("Popcount path: scalar\n");
+#endif
+
+	std::mt19937 rng(7);
+	std::vector<Icon> icons;
+	icons.reserve(ITEMS);
+	for (int i = 0; i < ITEMS; ++i) {
+		icons.push_back(makeIcon(static_cast<uint16_t>(i + 1), rng));
+	}
+
+	// Feature extraction split over threads the way the editor splits it over
+	// scheduler batches.
+	auto start = std::chrono::steady_clock::now();
+	std::vector<SimilarityFeatures> features(icons.size());
+	{
+		const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+		std::vector<std::jthread> workers;
+		for (unsigned t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t]() {
+				for (size_t i = t; i < icons.size(); i += threads) {
+					features[i] = SimilarityIndex::extract(icons[i].id, icons[i].rgba, icons[i].width, icons[i].height);
+				}
+			});
+		}
+	}
+	const double extract_ms = millisecondsSince(start);
+
+	std::vector<ReferenceItem> reference;
+	reference.reserve(features.size());
+	for (const SimilarityFeatures& entry : features) {
+		reference.push_back(makeReference(entry));
+	}
+
+	start = std::chrono::steady_clock::now();
+	SimilarityIndex index;
+	index.build(features);
+	const double build_ms = millisecondsSince(start);
+	std::printf("%d items: extract %.1f ms (threaded), build %.1f ms\n", ITEMS, extract_ms, build_ms);
+
+	std::vector<uint16_t> sources;
+	for (int i = 0; i < QUERIES; ++i) {
+		sources.push_back(static_cast<uint16_t>(1 + rng() % ITEMS));
+	}
+
+	bool ok = true;
+	start = std::chrono::steady_clock::now();
+	std::vector<std::vector<uint16_t>> expected;
+	for (const uint16_t id : sources) {
+		expected.push_back(referenceFindSimilar(reference, reference[id - 1], RESULTS));
+	}
+	const double reference_ms = millisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < sources.size(); ++i) {
+		if (index.findSimilar(sources[i], RESULTS) != expected[i]) {
+			std::printf("mismatch for item %u\n", sources[i]);
+			ok = false;
+		}
+	}
+	const double index_ms = millisecondsSince(start);
+	std::printf("%-24s %10.3f ms/query\n", "per-pixel reference", reference_ms / QUERIES);
+	std::printf("%-24s %10.3f ms/query (%.0fx)\n", "bit-packed index", index_ms / QUERIES, reference_ms / std::max(index_ms, 1e-6));
+
+	const std::string path = (std::filesystem::temp_directory_path() / "rme_similarity_benchmark.index").string();
+	start = std::chrono::steady_clock::now();
+	const bool saved = index.save(path, 42);
+	const double save_ms = millisecondsSince(start);
+
+	SimilarityIndex loaded;
+	start = std::chrono::steady_clock::now();
+	const bool read_back = loaded.load(path, 42);
+	const double load_ms = millisecondsSince(start);
+	const size_t file_size = saved ? std::filesystem::file_size(path) : 0;
+	std::printf("cache file: %.1f KiB, save %.1f ms, load %.1f ms\n", file_size / 1024.0, save_ms, load_ms);
+
+	if (!saved || !read_back || loaded.findSimilar(sources[0], RESULTS) != expected[0] || loaded.load(path, 43)) {
+		std::printf("cache round trip failed\n");
+		ok = false;
+	}
+	std::filesystem::remove(path);
+
+	std::printf("%s\n", ok ? "results match" : "RESULTS DIFFER");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+// Decodes every sprite of a .spr archive with SpriteDecoder and with the
+// per-pixel loop GameSprite::Decompress used before (one allocation per
+// sprite, bounds-checked span writes, transparency flags on every pixel),
+// checks both produce the same pixels and reports the throughput of each.
+//
+//   sprite_decode_benchmark [Tibia.spr [--extended] [--alpha]]
+//
+// Without a file it runs over a synthetic archive of 100K sprites shaped like
+// client ones: a few long transparent runs around mostly colored rows.
+
+#include "rendering/core/sprite_decoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+	struct Archive {
+		std::vector<uint8_t> bytes;
+		std::vector<std::span<const uint8_t>> sprites;
+	};
+
+	bool loadArchive(const std::string& path, bool extended, Archive& archive) {
+		std::ifstream file(path, std::ios::binary);
+		archive.bytes.assign(std::istreambuf_iterator<char>(file), {});
+		const std::vector<uint8_t>& bytes = archive.bytes;
+
+		const size_t count_size = extended ? 4 : 2;
+		if (bytes.size() < 4 + count_size) {
+			return false;
+		}
+		uint32_t count = 0;
+		memcpy(&count, bytes.data() + 4, count_size);
+
+		const size_t table = 4 + count_size;
+		if (bytes.size() < table + static_cast<size_t>(count) * 4) {
+			return false;
+		}
+		for (uint32_t i = 0; i < count; ++i) {
+			uint32_t offset;
+			memcpy(&offset, bytes.data() + table + i * 4, sizeof(offset));
+			// 3-byte colour key, then the u16 payload size
+			if (offset == 0 || offset + 5 > bytes.size()) {
+				continue;
+			}
+			const size_t size = bytes[offset + 3] | bytes[offset + 4] << 8;
+			if (size != 0 && offset + 5 + size <= bytes.size()) {
+				archive.sprites.emplace_back(bytes.data() + offset + 5, size);
+			}
+		}
+		return true;
+	}
+
+	void synthesizeArchive(bool use_alpha, Archive& archive) {
+		constexpr int SPRITES = 100000;
+		const size_t bpp = use_alpha ? 4 : 3;
+
+		std::mt19937 rng(11);
+		std::vector<std::pair<size_t, size_t>> ranges;
+		for (int i = 0; i < SPRITES; ++i) {
+			const size_t begin = archive.bytes.size();
+			size_t pixels = 0;
+			while (pixels < SpriteDecoder::PIXELS) {
+				const size_t left = SpriteDecoder::PIXELS - pixels;
+				const size_t transparent = std::min<size_t>(left, rng() % 48);
+				const size_t colored = std::min<size_t>(left - transparent, 1 + rng() % 64);
+				archive.bytes.push_back(static_cast<uint8_t>(transparent));
+				archive.bytes.push_back(static_cast<uint8_t>(transparent >> 8));
+				archive.bytes.push_back(static_cast<uint8_t>(colored));
+				archive.bytes.push_back(static_cast<uint8_t>(colored >> 8));
+				for (size_t p = 0; p < colored * bpp; ++p) {
+					archive.bytes.push_back(static_cast<uint8_t>(rng()));
+				}
+				pixels += transparent + colored;
+			}
+			ranges.emplace_back(begin, archive.bytes.size() - begin);
+		}
+		for (const auto& [begin, size] : ranges) {
+			archive.sprites.emplace_back(archive.bytes.data() + begin, size);
+		}
+	}
+
+	// GameSprite::Decompress as it was, minus the logging
+	std::unique_ptr<uint8_t[]> legacyDecompress(std::span<const uint8_t> dump, bool use_alpha, bool& non_zero_alpha_found, bool& non_black_pixel_found) {
+		const int pixels_data_size = SpriteDecoder::OUTPUT_SIZE;
+		auto data_buffer = std::make_unique<uint8_t[]>(pixels_data_size);
+		std::span<uint8_t> data(data_buffer.get(), pixels_data_size);
+
+		const uint8_t bpp = use_alpha ? 4 : 3;
+		size_t write = 0;
+		size_t read = 0;
+		while (read < dump.size() && write < data.size()) {
+			if (read + 1 >= dump.size()) {
+				break;
+			}
+			size_t transparent = dump[read] | dump[read + 1] << 8;
+			if (write + transparent * 4 > data.size()) {
+				transparent = (data.size() - write) / 4;
+			}
+			read += 2;
+			std::ranges::fill(data.subspan(write, transparent * 4), 0);
+			write += transparent * 4;
+
+			if (read >= dump.size() || write >= data.size() || read + 1 >= dump.size()) {
+				break;
+			}
+			size_t colored = dump[read] | dump[read + 1] << 8;
+			read += 2;
+			if (write + colored * 4 > data.size()) {
+				colored = (data.size() - write) / 4;
+			}
+			if (read + colored * bpp > dump.size()) {
+				break;
+			}
+			for (size_t cnt = 0; cnt < colored; ++cnt) {
+				uint8_t r = dump[read + 0];
+				uint8_t g = dump[read + 1];
+				uint8_t b = dump[read + 2];
+				uint8_t a = use_alpha ? dump[read + 3] : 0xFF;
+				data[write + 0] = r;
+				data[write + 1] = g;
+				data[write + 2] = b;
+				data[write + 3] = a;
+				if (a > 0) {
+					non_zero_alpha_found = true;
+				}
+				if (r > 0 || g > 0 || b > 0) {
+					non_black_pixel_found = true;
+				}
+				write += 4;
+				read += bpp;
+			}
+		}
+		while (write < data.size()) {
+			data[write + 0] = 0;
+			data[write + 1] = 0;
+			data[write + 2] = 0;
+			data[write + 3] = 0;
+			write += 4;
+		}
+		return data_buffer;
+	}
+
+	template <typename Fn>
+	double bestOf(int rounds, Fn&& fn) {
+		double best = 1e30;
+		for (int i = 0; i < rounds; ++i) {
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+}
+
+int main(int argc, char** argv) {
+#if defined(__SSSE3__) || defined(__AVX__)
+	std::printf("RGB expansion: SSSE3\n");
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	std::printf("RGB expansion: NEON\n");
+#else
+	std::printf("RGB expansion: scalar\n");
+#endif
+
+	bool extended = false;
+	bool use_alpha = false;
+	std::string path;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--extended") {
+			extended = true;
+		} else if (arg == "--alpha") {
+			use_alpha = true;
+		} else {
+			path = arg;
+		}
+	}
+
+	Archive archive;
+	if (path.empty()) {
+		synthesizeArchive(use_alpha, archive);
+		std::printf("synthetic archive, ");
+	} else if (!loadArchive(path, extended, archive)) {
+		std::printf("could not read %s\n", path.c_str());
+		return 1;
+	} else {
+		std::printf("%s, ", path.c_str());
+	}
+
+	size_t compressed = 0;
+	for (const auto& sprite : archive.sprites) {
+		compressed += sprite.size();
+	}
+	std::printf("%zu sprites, %.1f MiB compressed, %s\n", archive.sprites.size(), compressed / 1048576.0, use_alpha ? "RGBA" : "RGB");
+
+	// Reference pass, also the correctness check
+	std::vector<uint8_t> arena(SpriteDecoder::OUTPUT_SIZE * 64);
+	bool ok = true;
+	for (size_t i = 0; i < archive.sprites.size(); ++i) {
+		bool alpha_found = false;
+		bool color_found = false;
+		const auto expected = legacyDecompress(archive.sprites[i], use_alpha, alpha_found, color_found);
+
+		SpriteDecodeStats stats;
+		SpriteDecoder::decode(archive.sprites[i], use_alpha, arena, &stats);
+		if (memcmp(expected.get(), arena.data(), SpriteDecoder::OUTPUT_SIZE) != 0 || (stats.visible_pixels > 0) != alpha_found || (stats.colored_pixels > 0) != color_found) {
+			std::printf("sprite #%zu decodes differently\n", i);
+			ok = false;
+			break;
+		}
+	}
+
+	const double decoded_mib = archive.sprites.size() * SpriteDecoder::OUTPUT_SIZE / 1048576.0;
+	size_t sink = 0;
+
+	const double legacy_ms = bestOf(5, [&]() {
+		for (const auto& sprite : archive.sprites) {
+			bool alpha_found = false;
+			bool color_found = false;
+			sink += legacyDecompress(sprite, use_alpha, alpha_found, color_found)[SpriteDecoder::OUTPUT_SIZE - 1] + alpha_found;
+		}
+	});
+	const double decoder_ms = bestOf(5, [&]() {
+		for (size_t i = 0; i < archive.sprites.size(); ++i) {
+			uint8_t* slot = arena.data() + (i % 64) * SpriteDecoder::OUTPUT_SIZE;
+			sink += SpriteDecoder::decode(archive.sprites[i], use_alpha, { slot, SpriteDecoder::OUTPUT_SIZE });
+		}
+	});
+	const double stats_ms = bestOf(5, [&]() {
+		SpriteDecodeStats stats;
+		for (size_t i = 0; i < archive.sprites.size(); ++i) {
+			uint8_t* slot = arena.data() + (i % 64) * SpriteDecoder::OUTPUT_SIZE;
+			SpriteDecoder::decode(archive.sprites[i], use_alpha, { slot, SpriteDecoder::OUTPUT_SIZE }, &stats);
+			sink += stats.visible_pixels;
+		}
+	});
+
+	std::printf("%-28s %9.1f ms %8.0f MiB/s\n", "per-pixel loop + allocation", legacy_ms, decoded_mib / (legacy_ms / 1000.0));
+	std::printf("%-28s %9.1f ms %8.0f MiB/s\n", "SpriteDecoder", decoder_ms, decoded_mib / (decoder_ms / 1000.0));
+	std::printf("%-28s %9.1f ms %8.0f MiB/s\n", "SpriteDecoder + stats", stats_ms, decoded_mib / (stats_ms / 1000.0));
+	// Stored through a volatile so the timed loops are not optimized away
+	volatile size_t keep_alive = sink;
+	(void)keep_alive;
+	std::printf("%s\n", ok ? "output matches" : "OUTPUT DIFFERS");
+	return ok ? 0 : 1;
+}